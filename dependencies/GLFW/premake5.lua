@@ -75,3 +75,34 @@ project "GLFW"
 		{ 
             "_GLFW_X11"
 		}
+
+    -- The null platform with OSMesa contexts needs no display server, see WindowCreationParameters::headless
+    filter { "system:linux", "options:headless" }
+        removefiles
+        {
+            "src/x11_init.c",
+            "src/linux_joystick.c",
+            "src/x11_monitor.c",
+            "src/x11_window.c",
+            "src/glx_context.c",
+            "src/egl_context.c",
+            "src/xkb_unicode.c"
+        }
+
+        files
+        {
+            "src/null_init.c",
+            "src/null_joystick.c",
+            "src/null_monitor.c",
+            "src/null_window.c"
+        }
+
+        removedefines
+        {
+            "_GLFW_X11"
+        }
+
+        defines
+        {
+            "_GLFW_OSMESA"
+        }
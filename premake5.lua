@@ -17,6 +17,12 @@ workspace "qgfx"
     
     startproject "qgfx-test|x64"
 
+    newoption
+    {
+        trigger = "headless",
+        description = "Build GLFW on its OSMesa backend, for headless rendering on machines without a display"
+    }
+
     filter "platforms:x86"
         architecture "x86"
     
@@ -208,6 +214,19 @@ project "qgfx"
             "qtlRELEASEx64"
         }
 
+    filter { "configurations:VulkanDebug or OpenGLDebug or VulkanRelease or OpenGLRelease" }
+        defines
+        {
+            "QGFX_PROFILE"
+        }
+
+    -- Only the AVX2 kernels are built with AVX2, they are called after checking the CPU
+    filter { "files:projects/qgfx/src/qgfx/vertex_compression_avx2.cpp", "system:windows" }
+        buildoptions "/arch:AVX2"
+
+    filter { "files:projects/qgfx/src/qgfx/vertex_compression_avx2.cpp", "system:linux" }
+        buildoptions { "-mavx2", "-mf16c" }
+
     filter {} 
     
 project "qgfx-test"
@@ -371,6 +390,12 @@ project "qgfx-test"
             "vulkan-1"
         }
 
+    filter { "configurations:VulkanDebug or OpenGLDebug or VulkanRelease or OpenGLRelease" }
+        defines
+        {
+            "QGFX_PROFILE"
+        }
+
     filter {}
 
     postbuildcommands {
@@ -1,7 +1,48 @@
 #include "qgfx/qgfx.h"
+#include "checks.h"
+#include "regression.h"
 
-int main()
+#include <cstring>
+
+int main(int argc, char** argv)
 {
+	// qgfx-test --regression [--update] [--report <path>] [--golden <directory>] [--trace <path>]
+	// qgfx-test --checks
+	RegressionOptions regression;
+	bool runRegressionMode = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--regression") == 0)
+		{
+			runRegressionMode = true;
+		}
+		else if (strcmp(argv[i], "--checks") == 0)
+		{
+			return runChecks();
+		}
+		else if (strcmp(argv[i], "--update") == 0)
+		{
+			regression.update = true;
+		}
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+		{
+			regression.reportPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+		{
+			regression.goldenDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			regression.tracePath = argv[++i];
+		}
+	}
+
+	if (runRegressionMode)
+	{
+		return runRegression(regression);
+	}
+
 #if defined(QGFX_OPENGL)
 	/* Create a windowed mode window and its OpenGL context */
 	Window * win = new Window;
@@ -22,9 +63,13 @@ int main()
 	/* Loop until the user closes the window */
 	while (!win->shouldClose())
 	{
+		handle->startFrame();
+
 		/* Render here */
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		handle->endFrame();
+
 		/* Swap front and back buffers */
 		handle->swap();
 
@@ -57,36 +102,10 @@ int main()
 	CommandPool* pool = contextHandle->addCommandPool();
 	for (size_t i = 0; i < contextHandle->getSwapChainFramebuffers().size(); i++)
 	{
-		pool->addCommandBuffer();
+		pool->addCommandBuffer(CommandBufferUsage::OneTimeSubmit);
 	}
 	pool->construct();
 
-	for (size_t i = 0; i < contextHandle->getSwapChainFramebuffers().size(); i++)
-	{
-		CommandBuffer* cmdBuffer = pool->getBuffers()[i];
-		cmdBuffer->record();
-
-		VkRenderPassBeginInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = contextHandle->getPipeline()->getRenderPass();
-		renderPassInfo.framebuffer = contextHandle->getSwapChainFramebuffers()[i];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = contextHandle->getSwapChainExtent();
-
-		VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
-
-		vkCmdBeginRenderPass(cmdBuffer->getBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-		vkCmdBindPipeline(cmdBuffer->getBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, contextHandle->getPipeline()->getPipeline());
-		vkCmdDraw(cmdBuffer->getBuffer(), 3, 1, 0, 0);
-
-		vkCmdEndRenderPass(cmdBuffer->getBuffer());
-
-		cmdBuffer->end();
-	}
-
 	contextHandle->finalizeGraphics();
 
 	/* Loop until the user closes the window */
@@ -96,6 +115,21 @@ int main()
 
 		contextHandle->startFrame();
 
+		/* Re-record this frame's commands into the buffer of the acquired image */
+		const uint32_t imageIndex = contextHandle->getCurrentImageIndex();
+		CommandBuffer* cmdBuffer = pool->getBuffers()[imageIndex];
+		cmdBuffer->record();
+
+		ClearValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f }, 1.0f, 0 };
+		cmdBuffer->beginRenderPass(contextHandle->getPipeline()->getRenderPass(), contextHandle->getSwapChainFramebuffers()[imageIndex], &clearColor);
+
+		cmdBuffer->bindPipeline(contextHandle->getPipeline());
+		cmdBuffer->draw(3);
+
+		cmdBuffer->endRenderPass();
+
+		cmdBuffer->end();
+
 		contextHandle->endFrame();
 		contextHandle->swap();
 	}
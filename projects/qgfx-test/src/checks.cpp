@@ -0,0 +1,226 @@
+#include "checks.h"
+
+#include "qgfx/qgfx.h"
+#include "qgfx/image_format.h"
+#include "qgfx/vertex_compression.h"
+
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_image2d.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct Check
+{
+	const char* name;
+	bool(*run)(ContextHandle* handle, CommandPool* pool);
+};
+
+// The SIMD half conversion of the compressor, when the CPU has one, has to agree with the
+// scalar floatToHalf bit for bit, ties and denormals included
+static bool checkHalfConversionPathsAgree(ContextHandle* handle, CommandPool* pool)
+{
+	(void)handle;
+	(void)pool;
+
+	// Walks the float bits from half the smallest half denormal up to the largest half, each
+	// step either exact, halfway between two halves or just off halfway, in both signs
+	static const uint32_t roundingBits[4] = { 0x0000, 0x1000, 0x1001, 0x0FFF };
+
+	const size_t vertexCount = 4096;
+	std::vector<float> positions(vertexCount * 3, 0.0f);
+	std::vector<float> uvs(vertexCount * 2);
+	for (size_t i = 0; i < uvs.size(); i++)
+	{
+		const uint32_t bits = (0x33000000u + static_cast<uint32_t>(i) * 0x29000u + roundingBits[i % 4]) | ((i & 4) ? 0x80000000u : 0u);
+		memcpy(&uvs[i], &bits, sizeof(float));
+	}
+
+	VertexCompressionInput input = {};
+	input.positions = positions.data();
+	input.uvs = uvs.data();
+	input.vertexCount = vertexCount;
+
+	CompressedVertices output;
+	compressVertices(input, output);
+
+	const size_t stride = output.layout.getStride();
+	const size_t uvOffset = output.layout.getLayout()[1].offset;
+	for (size_t i = 0; i < uvs.size(); i++)
+	{
+		uint16_t half;
+		memcpy(&half, output.data + (i / 2) * stride + uvOffset + (i % 2) * sizeof(uint16_t), sizeof(half));
+		if (half != floatToHalf(uvs[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#if defined(QGFX_OPENGL)
+// Adjacent draws with different pipelines and the same vertex buffer have to bind it again, GL
+// attaches it to the vertex array of each pipeline
+static bool checkDrawQueueRebindsAfterPipelineChange(ContextHandle* handle, CommandPool* pool)
+{
+	VertexBufferLayout positions;
+	positions.push<float>("position", 3);
+
+	VertexBufferLayout packedPositions;
+	packedPositions.push("position", VertexAttribType::Half, 4);
+
+	Pipeline first(handle);
+	first.addVertexLayout(positions);
+	first.construct();
+
+	Pipeline second(handle);
+	second.addVertexLayout(packedPositions);
+	second.construct();
+
+	float vertices[9] = {};
+	VertexBuffer vertexBuffer(handle);
+	vertexBuffer.setData(vertices, sizeof(vertices));
+	vertexBuffer.setLayout(positions);
+	vertexBuffer.construct();
+
+	DrawQueue queue;
+
+	DrawPacket packet = {};
+	packet.pipeline = &first;
+	packet.vertexBuffer = &vertexBuffer;
+	packet.vertexCount = 3;
+	packet.instanceCount = 1;
+	queue.submit(packet);
+
+	packet.pipeline = &second;
+	queue.submit(packet);
+
+	CommandBuffer* commandBuffer = pool->getBuffers()[0];
+	commandBuffer->record();
+	queue.emit(commandBuffer);
+	commandBuffer->end();
+
+	return queue.getStatistics().pipelineBinds == 2 && queue.getStatistics().vertexBufferBinds == 2;
+}
+
+// Tightly packed RGB8 rows of an odd width are not four byte aligned, every level has to come
+// back exactly as it was uploaded
+static bool checkOddWidthMipUpload(ContextHandle* handle, CommandPool* pool)
+{
+	(void)pool;
+
+	const uint32_t width = 5;
+	const uint32_t height = 3;
+
+	Image2D image(handle);
+	image.construct(width, height, 24, ImageFormat::RGB, ImageDataType::UByte, ImageType::Color, fullMipChain);
+
+	const uint32_t levels = image.getMipLevels();
+	std::vector<std::vector<uint8_t>> mips(levels);
+	for (uint32_t level = 0; level < levels; level++)
+	{
+		mips[level].resize(getImageMipSize(width, height, level, ImageFormat::RGB, ImageDataType::UByte));
+		for (size_t i = 0; i < mips[level].size(); i++)
+		{
+			mips[level][i] = static_cast<uint8_t>(i * 7 + level * 31 + 1);
+		}
+		image.setMipData(level, mips[level].data(), static_cast<uint32_t>(mips[level].size()));
+	}
+
+	OpenGLStateTracker* tracker = handle->getStateTracker();
+	tracker->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	tracker->setPixelStore(GL_PACK_ALIGNMENT, 1);
+
+	const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(image.getImageHandle()));
+	for (uint32_t level = 0; level < levels; level++)
+	{
+		std::vector<uint8_t> pixels(mips[level].size());
+		glGetTextureImage(texture, static_cast<GLint>(level), GL_RGB, GL_UNSIGNED_BYTE, static_cast<GLsizei>(pixels.size()), pixels.data());
+		if (memcmp(pixels.data(), mips[level].data(), pixels.size()) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif
+
+static const Check checks[] = {
+	{ "half_conversion_paths_agree", checkHalfConversionPathsAgree },
+#if defined(QGFX_OPENGL)
+	{ "draw_queue_pipeline_rebind", checkDrawQueueRebindsAfterPipelineChange },
+	{ "odd_width_mip_upload", checkOddWidthMipUpload },
+#endif
+	{ nullptr, nullptr }
+};
+
+int runChecks()
+{
+	WindowCreationParameters params;
+	params.title = "QGFX CHECKS";
+	params.width = 64;
+	params.height = 64;
+	params.fullscreen = false;
+	params.vsync = false;
+	params.headless = true;
+
+	Window* window = new Window();
+	window->construct(params);
+
+	ContextHandle* handle = new ContextHandle(window);
+
+#if defined(QGFX_OPENGL)
+	const auto vs = loadText("media/effects/shader.vert");
+	const auto fs = loadText("media/effects/shader.frag");
+#elif defined(QGFX_VULKAN)
+	const auto vs = loadSpirv("media/effects/vert.spv");
+	const auto fs = loadSpirv("media/effects/frag.spv");
+#endif
+
+	Shader* shader = handle->getPipeline()->addShader();
+	shader->attachVertexShader(vs);
+	shader->attachFragmentShader(fs);
+	shader->compile();
+
+	handle->initializeGraphics();
+
+#if defined(QGFX_VULKAN)
+	shader->cleanup();
+#endif
+
+	CommandPool* pool = handle->addCommandPool();
+#if defined(QGFX_OPENGL)
+	pool->addCommandBuffer(CommandBufferUsage::OneTimeSubmit);
+#elif defined(QGFX_VULKAN)
+	for (size_t i = 0; i < handle->getSwapChainFramebuffers().size(); i++)
+	{
+		pool->addCommandBuffer(CommandBufferUsage::OneTimeSubmit);
+	}
+#endif
+	pool->construct();
+
+	handle->finalizeGraphics();
+
+	uint32_t failed = 0;
+	for (const Check* check = checks; check->run != nullptr; check++)
+	{
+		const bool passed = check->run(handle, pool);
+		failed += passed ? 0 : 1;
+
+		printf("%-32s %s\n", check->name, passed ? "passed" : "failed");
+	}
+
+#if defined(QGFX_VULKAN)
+	vkDeviceWaitIdle(handle->getLogicalDevice());
+#endif
+
+	delete handle;
+	delete window;
+
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#ifndef checks_h__
+#define checks_h__
+
+/// <summary>
+/// Runs the behavioural checks of the library against a headless context, printing one line
+/// per check.  Returns the process exit code, non zero when any check failed.
+/// </summary>
+int runChecks();
+
+#endif // checks_h__
@@ -0,0 +1,109 @@
+#include "golden_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+GoldenImage makeGoldenImage(const uint8_t* rgba, const uint32_t width, const uint32_t height)
+{
+	GoldenImage image;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 3);
+
+	const size_t count = static_cast<size_t>(width) * height;
+	for (size_t i = 0; i < count; i++)
+	{
+		image.pixels[i * 3 + 0] = rgba[i * 4 + 0];
+		image.pixels[i * 3 + 1] = rgba[i * 4 + 1];
+		image.pixels[i * 3 + 2] = rgba[i * 4 + 2];
+	}
+
+	return image;
+}
+
+bool loadGoldenImage(const std::string& path, GoldenImage& image)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t maxValue = 0;
+	const bool header = fscanf(file, "P6 %u %u %u", &width, &height, &maxValue) == 3 && maxValue == 255 && fgetc(file) != EOF;
+
+	bool result = false;
+	if (header)
+	{
+		image.width = width;
+		image.height = height;
+		image.pixels.resize(static_cast<size_t>(width) * height * 3);
+		result = fread(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+	}
+
+	fclose(file);
+	return result;
+}
+
+bool saveGoldenImage(const std::string& path, const GoldenImage& image)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "P6\n%u %u\n255\n", image.width, image.height);
+	const bool result = fwrite(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+
+	fclose(file);
+	return result;
+}
+
+static double yiqDelta(const uint8_t* a, const uint8_t* b)
+{
+	const double r1 = a[0], g1 = a[1], b1 = a[2];
+	const double r2 = b[0], g2 = b[1], b2 = b[2];
+
+	const double y = (r1 * 0.29889531 + g1 * 0.58662247 + b1 * 0.11448223) - (r2 * 0.29889531 + g2 * 0.58662247 + b2 * 0.11448223);
+	const double i = (r1 * 0.59597799 - g1 * 0.27417610 - b1 * 0.32180189) - (r2 * 0.59597799 - g2 * 0.27417610 - b2 * 0.32180189);
+	const double q = (r1 * 0.21147017 - g1 * 0.52261711 + b1 * 0.31114694) - (r2 * 0.21147017 - g2 * 0.52261711 + b2 * 0.31114694);
+
+	return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+ImageComparison compareGoldenImages(const GoldenImage& expected, const GoldenImage& actual, const double threshold)
+{
+	ImageComparison result = {};
+
+	const size_t count = static_cast<size_t>(expected.width) * expected.height;
+	if (expected.width != actual.width || expected.height != actual.height || actual.pixels.size() != count * 3)
+	{
+		result.differentPixels = std::max<size_t>(count, static_cast<size_t>(actual.width) * actual.height);
+		result.differentFraction = 1.0;
+		result.maxDelta = 1.0;
+		return result;
+	}
+
+	// 35215 is the YIQ delta between black and white
+	const double maxPossible = 35215.0;
+	const double limit = maxPossible * threshold * threshold;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const double delta = yiqDelta(&expected.pixels[i * 3], &actual.pixels[i * 3]);
+		if (delta > limit)
+		{
+			result.differentPixels++;
+		}
+		result.maxDelta = std::max(result.maxDelta, delta);
+	}
+
+	result.differentFraction = count > 0 ? static_cast<double>(result.differentPixels) / count : 0.0;
+	result.maxDelta = std::sqrt(result.maxDelta / maxPossible);
+
+	return result;
+}
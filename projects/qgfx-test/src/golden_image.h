@@ -0,0 +1,47 @@
+#ifndef golden_image_h__
+#define golden_image_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/// <summary>
+/// RGB8 image, rows top first.  Golden images are stored as binary PPM so that any image
+/// viewer can show them and no decoder is needed.
+/// </summary>
+struct GoldenImage
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<uint8_t> pixels;
+};
+
+struct ImageComparison
+{
+	// Pixels whose perceptual difference is above the threshold
+	uint64_t differentPixels;
+	double differentFraction;
+
+	// Largest perceptual difference, 0 for identical and 1 for black against white
+	double maxDelta;
+};
+
+/// <summary>
+/// Drops the alpha channel of tightly packed RGBA8 rows
+/// </summary>
+GoldenImage makeGoldenImage(const uint8_t* rgba, const uint32_t width, const uint32_t height);
+
+bool loadGoldenImage(const std::string& path, GoldenImage& image);
+bool saveGoldenImage(const std::string& path, const GoldenImage& image);
+
+/// <summary>
+/// Compares two images of the same size in YIQ space, which weights differences the way they
+/// are perceived rather than per channel.  threshold is the perceptual difference from 0 to 1
+/// below which two pixels count as equal, so rasterization differences between drivers of
+/// one or two codes per channel pass while visible changes do not.
+/// </summary>
+ImageComparison compareGoldenImages(const GoldenImage& expected, const GoldenImage& actual, const double threshold);
+
+#endif // golden_image_h__
@@ -0,0 +1,317 @@
+#include "regression.h"
+#include "golden_image.h"
+
+#include "qgfx/qgfx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct RegressionScene
+{
+	const char* name;
+
+	// Triangles drawn per frame, 0 only clears
+	uint32_t drawCount;
+};
+
+static const RegressionScene scenes[] = {
+	{ "clear", 0 },
+	{ "triangle", 1 },
+	{ "many_draws", 1000 }
+};
+
+struct SceneResult
+{
+	const char* name;
+	const char* status;
+	double meanFrameTimeMs;
+	double minFrameTimeMs;
+	uint32_t drawCalls;
+	uint64_t uploadBytes;
+
+	// Reading the last frame back, from the request until get() returned
+	uint64_t readbackBytes;
+	double readbackMs;
+	uint32_t readbackStalls;
+
+	ImageComparison comparison;
+};
+
+#if defined(QGFX_OPENGL)
+static const char* backendName = "opengl";
+#elif defined(QGFX_VULKAN)
+static const char* backendName = "vulkan";
+#endif
+
+static void renderFrame(ContextHandle* handle, CommandPool* pool, const RegressionScene& scene)
+{
+	QGFX_PROFILE_SCOPE(scene.name);
+
+	handle->startFrame();
+
+#if defined(QGFX_OPENGL)
+	CommandBuffer* cmdBuffer = pool->getBuffers()[0];
+
+	RenderPassDescription description;
+	description.colorAttachments[0].swapChain = true;
+	description.colorAttachmentCount = 1;
+
+	RenderPass* renderPass = handle->getRenderPassCache()->acquire(description);
+
+	const FrameBufferAttachment backBuffer = { nullptr, nullptr };
+	FrameBuffer* frameBuffer = handle->getRenderPassCache()->acquire(renderPass, &backBuffer, 1, handle->getBackBufferWidth(), handle->getBackBufferHeight());
+#elif defined(QGFX_VULKAN)
+	const uint32_t imageIndex = handle->getCurrentImageIndex();
+	CommandBuffer* cmdBuffer = pool->getBuffers()[imageIndex];
+
+	RenderPass* renderPass = handle->getPipeline()->getRenderPass();
+	FrameBuffer* frameBuffer = handle->getSwapChainFramebuffers()[imageIndex];
+#endif
+
+	cmdBuffer->record();
+
+	ClearValue clearColor = { { 0.1f, 0.2f, 0.3f, 1.0f }, 1.0f, 0 };
+	cmdBuffer->beginRenderPass(renderPass, frameBuffer, &clearColor);
+
+	if (scene.drawCount > 0)
+	{
+		cmdBuffer->bindPipeline(handle->getPipeline());
+		for (uint32_t i = 0; i < scene.drawCount; i++)
+		{
+			cmdBuffer->draw(3);
+		}
+	}
+
+	cmdBuffer->endRenderPass();
+	cmdBuffer->end();
+
+	handle->endFrame();
+}
+
+static SceneResult runScene(ContextHandle* handle, CommandPool* pool, ReadbackQueue* readback, const RegressionScene& scene, const RegressionOptions& options)
+{
+	SceneResult result = {};
+	result.name = scene.name;
+
+	for (uint32_t i = 0; i < options.warmupFrames; i++)
+	{
+		renderFrame(handle, pool, scene);
+		handle->swap();
+	}
+
+	handle->resetRenderStatistics();
+
+	double totalMs = 0.0;
+	result.minFrameTimeMs = 1e9;
+
+	readback->resetStatistics();
+
+	ReadbackFuture future;
+	std::chrono::steady_clock::time_point readbackStart;
+	for (uint32_t i = 0; i < options.frames; i++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		renderFrame(handle, pool, scene);
+		const auto end = std::chrono::steady_clock::now();
+
+		const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		totalMs += ms;
+		result.minFrameTimeMs = std::min(result.minFrameTimeMs, ms);
+
+		// Only the last frame is compared, it is read back after it has been timed
+		if (i + 1 == options.frames)
+		{
+			readbackStart = std::chrono::steady_clock::now();
+			future = readback->readBackBuffer();
+		}
+
+		handle->swap();
+	}
+
+	const RenderStatistics& statistics = handle->getRenderStatistics();
+	result.meanFrameTimeMs = options.frames > 0 ? totalMs / options.frames : 0.0;
+	result.drawCalls = options.frames > 0 ? statistics.drawCalls / options.frames : 0;
+	result.uploadBytes = statistics.uploadBytes;
+
+	if (!future.isValid())
+	{
+		result.status = "failed";
+		return result;
+	}
+
+	std::vector<uint8_t> pixels(future.getSize());
+	future.get(pixels.data());
+
+	const ReadbackStatistics& readbackStatistics = readback->getStatistics();
+	result.readbackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readbackStart).count();
+	result.readbackBytes = readbackStatistics.bytesRead;
+	result.readbackStalls = readbackStatistics.stalls;
+
+	const GoldenImage actual = makeGoldenImage(pixels.data(), future.getWidth(), future.getHeight());
+	const std::string goldenPath = options.goldenDirectory + "/" + scene.name + "_" + backendName + ".ppm";
+
+	if (options.update)
+	{
+		result.status = saveGoldenImage(goldenPath, actual) ? "recorded" : "failed";
+		return result;
+	}
+
+	// A scene without a golden image has nothing to be compared against.  It is reported as
+	// unrecorded instead of failing, so that a checkout without recorded images still runs.
+	GoldenImage expected;
+	if (!loadGoldenImage(goldenPath, expected))
+	{
+		printf("No golden image %s, record it with --update\n", goldenPath.c_str());
+		result.status = "unrecorded";
+		return result;
+	}
+
+	result.comparison = compareGoldenImages(expected, actual, options.threshold);
+	result.status = result.comparison.differentFraction <= options.maxDifferentFraction ? "passed" : "failed";
+
+	return result;
+}
+
+// Megabytes per second from requesting the readback until its data was copied out
+static double getReadbackThroughput(const SceneResult& result)
+{
+	return result.readbackMs > 0.0 ? static_cast<double>(result.readbackBytes) / (1024.0 * 1024.0) / (result.readbackMs / 1000.0) : 0.0;
+}
+
+static bool writeReport(const RegressionOptions& options, const std::vector<SceneResult>& results)
+{
+	FILE* file = fopen(options.reportPath.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"backend\": \"%s\",\n", backendName);
+	fprintf(file, "\t\"width\": %u,\n", options.width);
+	fprintf(file, "\t\"height\": %u,\n", options.height);
+	fprintf(file, "\t\"frames\": %u,\n", options.frames);
+	fprintf(file, "\t\"scenes\": [\n");
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const SceneResult& result = results[i];
+
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"name\": \"%s\",\n", result.name);
+		fprintf(file, "\t\t\t\"status\": \"%s\",\n", result.status);
+		fprintf(file, "\t\t\t\"cpuFrameTimeMs\": %.4f,\n", result.meanFrameTimeMs);
+		fprintf(file, "\t\t\t\"cpuFrameTimeMinMs\": %.4f,\n", result.minFrameTimeMs);
+		fprintf(file, "\t\t\t\"drawCalls\": %u,\n", result.drawCalls);
+		fprintf(file, "\t\t\t\"uploadBytes\": %llu,\n", static_cast<unsigned long long>(result.uploadBytes));
+		fprintf(file, "\t\t\t\"readbackBytes\": %llu,\n", static_cast<unsigned long long>(result.readbackBytes));
+		fprintf(file, "\t\t\t\"readbackMs\": %.4f,\n", result.readbackMs);
+		fprintf(file, "\t\t\t\"readbackMBps\": %.2f,\n", getReadbackThroughput(result));
+		fprintf(file, "\t\t\t\"readbackStalls\": %u,\n", result.readbackStalls);
+		fprintf(file, "\t\t\t\"differentPixels\": %llu,\n", static_cast<unsigned long long>(result.comparison.differentPixels));
+		fprintf(file, "\t\t\t\"maxDelta\": %.6f\n", result.comparison.maxDelta);
+		fprintf(file, "\t\t}%s\n", i + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+
+	fclose(file);
+	return true;
+}
+
+int runRegression(const RegressionOptions& options)
+{
+	if (!options.tracePath.empty())
+	{
+		CpuProfiler::beginCapture();
+	}
+
+	WindowCreationParameters params;
+	params.title = "QGFX REGRESSION";
+	params.width = options.width;
+	params.height = options.height;
+	params.fullscreen = false;
+	params.vsync = false;
+	params.headless = true;
+
+	Window* window = new Window();
+	window->construct(params);
+
+	ContextHandle* handle = new ContextHandle(window);
+
+#if defined(QGFX_OPENGL)
+	const auto vs = loadText("media/effects/shader.vert");
+	const auto fs = loadText("media/effects/shader.frag");
+#elif defined(QGFX_VULKAN)
+	const auto vs = loadSpirv("media/effects/vert.spv");
+	const auto fs = loadSpirv("media/effects/frag.spv");
+#endif
+
+	Shader* shader = handle->getPipeline()->addShader();
+	shader->attachVertexShader(vs);
+	shader->attachFragmentShader(fs);
+	shader->compile();
+
+	handle->initializeGraphics();
+
+#if defined(QGFX_VULKAN)
+	shader->cleanup();
+#endif
+
+	CommandPool* pool = handle->addCommandPool();
+#if defined(QGFX_OPENGL)
+	pool->addCommandBuffer(CommandBufferUsage::OneTimeSubmit);
+#elif defined(QGFX_VULKAN)
+	for (size_t i = 0; i < handle->getSwapChainFramebuffers().size(); i++)
+	{
+		pool->addCommandBuffer(CommandBufferUsage::OneTimeSubmit);
+	}
+#endif
+	pool->construct();
+
+	handle->finalizeGraphics();
+
+	ReadbackQueue* readback = new ReadbackQueue(handle);
+	readback->construct();
+
+	std::vector<SceneResult> results;
+	bool passed = true;
+	for (const RegressionScene& scene : scenes)
+	{
+		results.push_back(runScene(handle, pool, readback, scene, options));
+		passed = passed && strcmp(results.back().status, "failed") != 0;
+
+		printf("%-12s %-8s %8.3f ms %6u draws %10llu upload bytes %8.1f MB/s readback\n", results.back().name, results.back().status,
+			results.back().meanFrameTimeMs, results.back().drawCalls, static_cast<unsigned long long>(results.back().uploadBytes),
+			getReadbackThroughput(results.back()));
+	}
+
+	if (!writeReport(options, results))
+	{
+		printf("Failed to write %s\n", options.reportPath.c_str());
+		passed = false;
+	}
+
+#if defined(QGFX_VULKAN)
+	vkDeviceWaitIdle(handle->getLogicalDevice());
+#endif
+
+	delete readback;
+	delete handle;
+	delete window;
+
+	if (!options.tracePath.empty())
+	{
+		CpuProfiler::endCapture();
+		if (!CpuProfiler::writeChromeTrace(options.tracePath.c_str()))
+		{
+			printf("Failed to write %s\n", options.tracePath.c_str());
+		}
+	}
+
+	return passed ? 0 : 1;
+}
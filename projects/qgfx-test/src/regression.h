@@ -0,0 +1,42 @@
+#ifndef regression_h__
+#define regression_h__
+
+#include <stdint.h>
+
+#include <string>
+
+struct RegressionOptions
+{
+	uint32_t width = 256;
+	uint32_t height = 256;
+
+	// Frames rendered before timing starts, to get shader compilation and first uploads out of
+	// the numbers, and frames timed per scene
+	uint32_t warmupFrames = 5;
+	uint32_t frames = 60;
+
+	// Perceptual difference per pixel, and the fraction of pixels, that are tolerated
+	double threshold = 0.1;
+	double maxDifferentFraction = 0.001;
+
+	// Rewrites every golden image instead of comparing against it
+	bool update = false;
+
+	std::string goldenDirectory = "media/golden";
+	std::string reportPath = "regression.json";
+
+	// Chrome trace of the CPU zones of the whole run, none when empty
+	std::string tracePath;
+};
+
+/// <summary>
+/// Renders each test scene headlessly, compares the last frame against its golden image and
+/// writes CPU frame time, draw calls, upload bytes and readback throughput per scene to a
+/// JSON report with one value per line, so that reports of two commits can be diffed.  Run
+/// on a software driver (llvmpipe, lavapipe) for images that are stable across machines.
+/// Returns the process exit code, non zero when a scene no longer matches its golden image.
+/// Scenes without a golden image are reported as unrecorded and do not fail the run.
+/// </summary>
+int runRegression(const RegressionOptions& options);
+
+#endif // regression_h__
@@ -1,21 +1,50 @@
 #ifndef icommandbuffer_h__
 #define icommandbuffer_h__
 
+#include <stdint.h>
+
 #include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+struct ClearValue;
+
+enum class CommandBufferUsage : int32_t
+{
+	OneTimeSubmit,
+	Reusable,
+	Simultaneous
+};
 
 class ICommandBuffer
 {
 	public:
-		explicit ICommandBuffer(ContextHandle* handle);
+		explicit ICommandBuffer(ContextHandle* handle, const CommandBufferUsage usage = CommandBufferUsage::Reusable);
 		virtual ~ICommandBuffer() = default;
 
 		ICommandBuffer& operator = (const ICommandBuffer&) = delete;
 
 		virtual void record() = 0;
 		virtual void end() = 0;
+		virtual void reset() = 0;
+
+		/// <summary>
+		/// Begins a render pass on a framebuffer made for it or for a compatible pass.  clearValues
+		/// holds one value per attachment in framebuffer order and is read for cleared ones only.
+		/// </summary>
+		virtual void beginRenderPass(RenderPass* renderPass, FrameBuffer* frameBuffer, const ClearValue* clearValues = nullptr) = 0;
+		virtual void endRenderPass() = 0;
+
+		virtual void bindPipeline(Pipeline* pipeline) = 0;
+		virtual void bindVertexBuffer(VertexBuffer* buffer) = 0;
+		virtual void bindIndexBuffer(IndexBuffer* buffer) = 0;
+		virtual void draw(const uint32_t vertexCount, const uint32_t instanceCount = 1, const uint32_t firstVertex = 0, const uint32_t firstInstance = 0) = 0;
+		virtual void drawIndexed(const uint32_t indexCount, const uint32_t instanceCount = 1, const uint32_t firstIndex = 0, const int32_t vertexOffset = 0, const uint32_t firstInstance = 0) = 0;
+
+		CommandBufferUsage getUsage() const { return mUsage; }
 
 	protected:
 		ContextHandle* mHandle;
+		CommandBufferUsage mUsage;
 };
 
 #endif // icommandbuffer_h__
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <qtl/vector.h>
 
+#include "qgfx/api/icommandbuffer.h"
 #include "qgfx/context_handle.h"
 #include "qgfx/typedefs.h"
 
@@ -14,9 +15,10 @@ class ICommandPool
 
 		ICommandPool& operator = (const ICommandPool&) = delete;
 
-		virtual CommandBuffer* addCommandBuffer() = 0;
+		virtual CommandBuffer* addCommandBuffer(const CommandBufferUsage usage = CommandBufferUsage::Reusable) = 0;
 		virtual qtl::vector<CommandBuffer*> getBuffers() = 0;
 		virtual void construct() = 0;
+		virtual void reset() = 0;
 
 	protected:
 		ContextHandle* mHandle;
@@ -3,8 +3,23 @@
 
 #include "qgfx/typedefs.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <qtl/vector.h>
 
+enum class ImageFormat : uint32_t;
+enum class ImageDataType : uint32_t;
+
+struct RenderStatistics
+{
+	// Draw commands recorded, a multi draw counts once
+	uint32_t drawCalls;
+
+	// Bytes copied to the GPU by buffer and image uploads and stream buffer allocations
+	uint64_t uploadBytes;
+};
+
 class IContextHandle
 {
 	public:
@@ -27,8 +42,43 @@ class IContextHandle
 
 		virtual void swap() = 0;
 
+		/// <summary>
+		/// Whether images of the format can be created and sampled on this device
+		/// </summary>
+		virtual bool isImageFormatSupported(const ImageFormat format, const ImageDataType type) const = 0;
+
+		/// <summary>
+		/// Highest sample count usable for both color and depth attachments
+		/// </summary>
+		virtual uint32_t getMaxSampleCount() const = 0;
+
+		/// <summary>
+		/// Copies the back buffer of the frame submitted by the last endFrame() into destination as
+		/// tightly packed RGBA8 rows, top row first.  Call it before swap(), destination holds
+		/// getBackBufferWidth() * getBackBufferHeight() * 4 bytes.  Blocks until the frame is done.
+		/// </summary>
+		virtual void readBackBuffer(uint8_t* destination) = 0;
+
+		uint32_t getBackBufferWidth() const;
+		uint32_t getBackBufferHeight() const;
+
+		/// <summary>
+		/// Whether the context renders offscreen, see WindowCreationParameters::headless
+		/// </summary>
+		bool isHeadless() const;
+
+		/// <summary>
+		/// Counted since construction or the last reset, independent of frames
+		/// </summary>
+		const RenderStatistics& getRenderStatistics() const { return mRenderStatistics; }
+		void resetRenderStatistics() { mRenderStatistics = {}; }
+
+		void countDrawCall() { mRenderStatistics.drawCalls++; }
+		void countUpload(const size_t bytes) { mRenderStatistics.uploadBytes += bytes; }
+
 	protected:
 		Window* mWindow;
+		RenderStatistics mRenderStatistics;
 };
 
 #endif // icontexthandle_h__
\ No newline at end of file
@@ -1,7 +1,13 @@
 #ifndef iframebuffer_h__
 #define iframebuffer_h__
 
+#include <stdint.h>
+
+#include <qtl/vector.h>
+
+#include "qgfx/api/iimageview.h"
 #include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
 
 class IFrameBuffer
 {
@@ -11,10 +17,24 @@ class IFrameBuffer
 
 		IFrameBuffer& operator = (const IFrameBuffer&) = delete;
 
-//		virtual void construct(RenderPass* renderPass, attachments, uint32_t attachmentCount, uint32_t width, uint32_t height);
+		/// <summary>
+		/// Attachments are given in the order of the render pass, color first and depth last.
+		/// Any compatible render pass can be begun on the framebuffer afterwards.
+		/// </summary>
+		virtual void construct(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+			const uint32_t width, const uint32_t height) = 0;
+
+		RenderPass* getRenderPass() const { return mRenderPass; }
+		const qtl::vector<FrameBufferAttachment>& getAttachments() const { return mAttachments; }
+		uint32_t getWidth() const { return mWidth; }
+		uint32_t getHeight() const { return mHeight; }
 
 	protected:
 		ContextHandle* mHandle;
+		RenderPass* mRenderPass;
+		qtl::vector<FrameBufferAttachment> mAttachments;
+		uint32_t mWidth;
+		uint32_t mHeight;
 };
 
-#endif // iframebuffer_h__
\ No newline at end of file
+#endif // iframebuffer_h__
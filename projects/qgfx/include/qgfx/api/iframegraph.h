@@ -0,0 +1,284 @@
+#ifndef iframegraph_h__
+#define iframegraph_h__
+
+#include <stdint.h>
+
+#include <qtl/string.h>
+#include <qtl/vector.h>
+
+#include "qgfx/api/iimage2d.h"
+#include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+/// <summary>
+/// Handle to one version of a frame graph resource.  Every write produces a new version, so
+/// a handle always names the contents a pass expects to see.
+/// </summary>
+using FrameGraphResource = uint32_t;
+constexpr FrameGraphResource invalidFrameGraphResource = 0xFFFFFFFF;
+
+/// <summary>
+/// Shader stages that sample a frame graph resource
+/// </summary>
+enum class ShaderStage : uint32_t
+{
+	Vertex = 0x0001,
+	Fragment = 0x0002,
+	Compute = 0x0004
+};
+
+inline ShaderStage operator | (ShaderStage a, ShaderStage b)
+{
+	return static_cast<ShaderStage>(static_cast<int>(a) | static_cast<int>(b));
+}
+
+inline ShaderStage operator & (ShaderStage a, ShaderStage b)
+{
+	return static_cast<ShaderStage>(static_cast<int>(a) & static_cast<int>(b));
+}
+
+struct FrameGraphTextureDescription
+{
+	uint32_t width;
+	uint32_t height;
+	ImageFormat format;
+	ImageDataType type;
+
+	// Color, Depth or Depth | Stencil
+	ImageType imageType;
+
+	// Multisampled textures can only be rendered to and resolved, not sampled
+	uint32_t samples = 1;
+
+	// Contents written by the first pass that renders to a transient texture
+	float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float clearDepth = 1.0f;
+};
+
+struct FrameGraphStatistics
+{
+	uint32_t passes;
+	uint32_t culledPasses;
+
+	// Transient textures declared, and the textures or memory blocks backing them after aliasing
+	uint32_t transientTextures;
+	uint32_t physicalTextures;
+
+	uint64_t transientBytes;
+	uint64_t allocatedBytes;
+
+	// Transient textures that only live inside one render pass and may never get memory
+	uint32_t lazyTextures;
+
+	// Pipeline barriers recorded by the last execute()
+	uint32_t barriers;
+};
+
+class IFrameGraph;
+
+/// <summary>
+/// Declares the resources a pass reads and writes.  Only valid inside the setup callback of addPass.
+/// </summary>
+class FrameGraphBuilder
+{
+	public:
+		FrameGraphResource create(const char* name, const FrameGraphTextureDescription& description);
+
+		/// <summary>
+		/// Samples the resource in the pass from the given shader stages
+		/// </summary>
+		FrameGraphResource read(const FrameGraphResource resource, const ShaderStage stages = ShaderStage::Fragment);
+
+		/// <summary>
+		/// Renders to the resource, keeping its previous contents if it has any.  Returns the
+		/// new version that later passes have to read.
+		/// </summary>
+		FrameGraphResource write(const FrameGraphResource resource);
+
+		/// <summary>
+		/// Resolves a multisampled texture the pass renders to into a single sampled one at the
+		/// end of the pass.  Returns the new version of the destination.
+		/// </summary>
+		FrameGraphResource resolve(const FrameGraphResource source, const FrameGraphResource destination);
+
+		/// <summary>
+		/// Keeps the pass even when nothing reads what it writes
+		/// </summary>
+		void setSideEffect();
+	private:
+		friend class IFrameGraph;
+
+		FrameGraphBuilder(IFrameGraph* graph, const uint32_t pass) : mGraph(graph), mPass(pass) {}
+
+		IFrameGraph* mGraph;
+		uint32_t mPass;
+};
+
+/// <summary>
+/// Describes a frame as passes over transient and imported textures.  compile() culls passes
+/// whose results are never used, orders the rest by their dependencies, and lets transient
+/// textures whose lifetimes do not overlap share memory.  execute() then runs the passes with
+/// the attachments bound and the barriers between them inserted.
+///
+/// Build and compile a graph once and execute it every frame, resources are created by
+/// compile().  reset() clears the graph so it can be rebuilt, for instance on resize.
+/// </summary>
+class IFrameGraph
+{
+	public:
+		using SetupCallback = void(*)(FrameGraphBuilder& builder, void* userData);
+		using ExecuteCallback = void(*)(CommandBuffer* commandBuffer, void* userData);
+
+		explicit IFrameGraph(ContextHandle* handle);
+		virtual ~IFrameGraph() = default;
+
+		IFrameGraph& operator = (const IFrameGraph&) = delete;
+
+		/// <summary>
+		/// Makes an image owned by the caller available to passes.  Passes writing imported
+		/// images are never culled.
+		/// </summary>
+		FrameGraphResource importImage(const char* name, Image2D* image);
+
+		/// <summary>
+		/// setup runs right away and declares what the pass uses, execute runs every frame the pass
+		/// survives compile().  Both get userData, which has to stay valid until reset().
+		/// </summary>
+		void addPass(const char* name, SetupCallback setup, ExecuteCallback execute, void* userData = nullptr);
+
+		void compile();
+		void execute(CommandBuffer* commandBuffer);
+		void reset();
+
+		bool isCompiled() const { return mCompiled; }
+		bool isPassCulled(const char* name) const;
+
+		const FrameGraphTextureDescription& getDescription(const FrameGraphResource resource) const;
+
+		/// <summary>
+		/// Backend image of a resource, the same kind of handle IImage2D::getImageHandle returns.
+		/// Valid between compile() and reset().
+		/// </summary>
+		virtual void* getImageHandle(const FrameGraphResource resource) const = 0;
+
+		const FrameGraphStatistics& getStatistics() const { return mStatistics; }
+
+	protected:
+		struct ResourceNode
+		{
+			qtl::string name;
+			FrameGraphTextureDescription description;
+			Image2D* imported;
+
+			// Position of the first and last pass using the resource in the schedule
+			uint32_t firstUse;
+			uint32_t lastUse;
+
+			// Physical texture or memory block, and the resource that used it before
+			uint32_t slot;
+			uint32_t aliasedFrom;
+
+			// Only an attachment of a single pass that neither loads nor stores it, so its
+			// contents never leave tile memory
+			bool lazy;
+		};
+
+		struct Attachment
+		{
+			uint32_t resource;
+			bool clear;
+			bool store;
+		};
+
+		struct Resolve
+		{
+			FrameGraphResource source;
+			FrameGraphResource destination;
+		};
+
+		struct Read
+		{
+			FrameGraphResource version;
+			ShaderStage stages;
+		};
+
+		struct Sampled
+		{
+			uint32_t resource;
+			ShaderStage stages;
+		};
+
+		struct PassNode
+		{
+			qtl::string name;
+			ExecuteCallback execute;
+			void* userData;
+			bool sideEffect;
+
+			// Resource versions
+			qtl::vector<Read> reads;
+			qtl::vector<FrameGraphResource> writes;
+			qtl::vector<Resolve> resolves;
+
+			uint32_t references;
+			bool culled;
+
+			// Filled by compile(), in resource indices
+			qtl::vector<Sampled> sampled;
+			qtl::vector<Attachment> colorAttachments;
+			Attachment depthAttachment;
+			bool hasDepthAttachment;
+
+			// One per color attachment, with an invalid resource when it is not resolved
+			qtl::vector<Attachment> resolveAttachments;
+		};
+
+		ContextHandle* mHandle;
+
+		qtl::vector<ResourceNode> mResources;
+		qtl::vector<PassNode> mPasses;
+
+		// Surviving passes in execution order
+		qtl::vector<uint32_t> mSchedule;
+
+		FrameGraphStatistics mStatistics;
+
+		/// <summary>
+		/// Whether two transient textures with disjoint lifetimes may share a slot
+		/// </summary>
+		virtual bool _canAlias(const FrameGraphTextureDescription& a, const FrameGraphTextureDescription& b) const = 0;
+
+		virtual void _createResources() = 0;
+		virtual void _destroyResources() = 0;
+
+		virtual void _beginPass(const PassNode& pass, CommandBuffer* commandBuffer) = 0;
+		virtual void _endPass(const PassNode& pass, CommandBuffer* commandBuffer) = 0;
+		virtual void _beginExecute(CommandBuffer* commandBuffer) { (void)commandBuffer; }
+		virtual void _endExecute(CommandBuffer* commandBuffer) { (void)commandBuffer; }
+
+		uint32_t _getResourceIndex(const FrameGraphResource resource) const;
+	private:
+		friend class FrameGraphBuilder;
+
+		struct ResourceVersion
+		{
+			uint32_t resource;
+			uint32_t producer;
+			FrameGraphResource previous;
+			qtl::vector<uint32_t> readers;
+		};
+
+		qtl::vector<ResourceVersion> mVersions;
+
+		// Latest version of every resource
+		qtl::vector<FrameGraphResource> mLatest;
+
+		bool mCompiled;
+
+		void _cull();
+		void _schedule();
+		void _computeLifetimes();
+		void _assignSlots();
+};
+
+#endif // iframegraph_h__
@@ -0,0 +1,153 @@
+#ifndef igpuprofiler_h__
+#define igpuprofiler_h__
+
+#include <stdint.h>
+
+#include <qtl/vector.h>
+
+#include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+struct GpuScopeTiming
+{
+	// Name passed to beginScope, and how deep the scope was nested when it was first seen
+	const char* name;
+	uint32_t depth;
+
+	// GPU time of the scope in the last resolved frame, and over the rolling window of frames.
+	// Scopes opened more than once in a frame count with their total.
+	double lastMs;
+	double averageMs;
+	double minMs;
+	double maxMs;
+
+	uint32_t samples;
+};
+
+struct GpuProfilerStatistics
+{
+	// Frames whose timestamps were read back, and those whose queries were still pending when
+	// their slot came around again and were dropped rather than waited on
+	uint32_t resolvedFrames;
+	uint32_t droppedFrames;
+
+	// Scopes not recorded because the frame ran out of queries
+	uint32_t overflowedScopes;
+};
+
+/// <summary>
+/// Measures GPU time of named scopes with timestamp queries.  Every frame slot has its own set
+/// of queries, and a slot's results are only read when the slot is used again, so the frame
+/// that wrote them has finished and reading them never stalls.  Timings therefore lag a few
+/// frames behind.
+///
+/// Call beginFrame right after recording of the frame's command buffer starts and before the
+/// first render pass, and endFrame once the last scope is closed.  Scope names are kept by
+/// pointer and have to outlive the profiler, string literals in practice.
+/// </summary>
+class IGpuProfiler
+{
+	public:
+		explicit IGpuProfiler(ContextHandle* handle, const uint32_t maxScopes = 64, const uint32_t historyLength = 60);
+		virtual ~IGpuProfiler() = default;
+
+		IGpuProfiler& operator = (const IGpuProfiler&) = delete;
+
+		virtual void construct() = 0;
+
+		/// <summary>
+		/// False when the device has no timestamp support, every call is a no-op then
+		/// </summary>
+		virtual bool isSupported() const = 0;
+
+		void beginFrame(CommandBuffer* commandBuffer);
+		void endFrame();
+
+		void beginScope(CommandBuffer* commandBuffer, const char* name);
+		void endScope(CommandBuffer* commandBuffer);
+
+		/// <summary>
+		/// Timings of every scope seen so far, in the order they were first opened
+		/// </summary>
+		const qtl::vector<GpuScopeTiming>& getTimings() const { return mTimings; }
+		const GpuScopeTiming* findTiming(const char* name) const;
+
+		/// <summary>
+		/// Prints the rolling timings every interval resolved frames, 0 turns the summary off
+		/// </summary>
+		void setSummaryInterval(const uint32_t frames) { mSummaryInterval = frames; }
+		void printSummary() const;
+
+		const GpuProfilerStatistics& getStatistics() const { return mStatistics; }
+
+	protected:
+		ContextHandle* mHandle;
+		uint32_t mMaxScopes;
+
+		/// <summary>
+		/// Creates the per slot state of the base class, called by construct()
+		/// </summary>
+		void _initialize(const uint32_t slotCount);
+
+		/// <summary>
+		/// Slot the frame being recorded writes its queries to.  The previous frame that used
+		/// the slot has to have been submitted.
+		/// </summary>
+		virtual uint32_t _acquireSlot() = 0;
+
+		/// <summary>
+		/// Reset the slot's queries before the first timestamp of the frame is written
+		/// </summary>
+		virtual void _resetQueries(CommandBuffer* commandBuffer, const uint32_t slot) = 0;
+		virtual void _writeTimestamp(CommandBuffer* commandBuffer, const uint32_t slot, const uint32_t query) = 0;
+
+		/// <summary>
+		/// Reads count timestamps of the slot in milliseconds without waiting, returns false
+		/// when any of them is not available yet
+		/// </summary>
+		virtual bool _getTimestamps(const uint32_t slot, const uint32_t count, double* milliseconds) = 0;
+
+	private:
+		struct Scope
+		{
+			uint32_t timing;
+			uint32_t parent;
+			uint32_t beginQuery;
+			uint32_t endQuery;
+		};
+
+		struct Slot
+		{
+			qtl::vector<Scope> scopes;
+			uint32_t queryCount;
+			bool pending;
+		};
+
+		struct History
+		{
+			qtl::vector<double> samples;
+			uint32_t next;
+			double frameMs;
+			bool touched;
+		};
+
+		uint32_t mHistoryLength;
+		uint32_t mSummaryInterval;
+
+		qtl::vector<Slot> mSlots;
+		qtl::vector<GpuScopeTiming> mTimings;
+		qtl::vector<History> mHistories;
+		qtl::vector<double> mTimestamps;
+
+		uint32_t mCurrentSlot;
+		uint32_t mCurrentScope;
+		bool mInFrame;
+
+		GpuProfilerStatistics mStatistics;
+
+		uint32_t _findOrAddTiming(const char* name, const uint32_t depth);
+		void _resolve(Slot& slot, const uint32_t index);
+		void _addSample(const uint32_t timing, const double milliseconds);
+};
+
+#endif // igpuprofiler_h__
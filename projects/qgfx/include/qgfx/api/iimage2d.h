@@ -12,7 +12,22 @@ enum class ImageFormat : uint32_t
 	RGB,
 	RGBA,
 	Luminance,
-	LuminanceAlpha
+	LuminanceAlpha,
+
+	// Block compressed formats.  The data type selects the variant: BC4/BC5 are snorm for
+	// Byte, BC6H is signed for Float, everything else is unorm.
+	BC1,
+	BC2,
+	BC3,
+	BC4,
+	BC5,
+	BC6H,
+	BC7,
+	ETC2_RGB,
+	ETC2_RGBA,
+	ASTC_4x4,
+	ASTC_6x6,
+	ASTC_8x8
 };
 
 enum class ImageDataType : uint32_t
@@ -47,6 +62,21 @@ inline ImageType operator & (ImageType a, ImageType b)
 	return static_cast<ImageType>(static_cast<int>(a) & static_cast<int>(b));
 }
 
+inline bool hasDepthAspect(const ImageType type)
+{
+	return (type & ImageType::Depth) == ImageType::Depth;
+}
+
+inline bool hasStencilAspect(const ImageType type)
+{
+	return (type & ImageType::Stencil) == ImageType::Stencil;
+}
+
+/// <summary>
+/// Pass as the mip level count to construct() to allocate every level down to 1x1
+/// </summary>
+constexpr uint32_t fullMipChain = 0;
+
 class IImage2D
 {
 	public:
@@ -55,21 +85,71 @@ class IImage2D
 
 		IImage2D& operator = (const IImage2D&) = delete;
 
-		virtual void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType) = 0;
+		/// <summary>
+		/// Multisampled images have a single mip level and can only be rendered to and resolved,
+		/// where the device supports it they are transient and never get memory of their own.
+		/// </summary>
+		virtual void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType,
+			const uint32_t mipLevels = 1, const uint32_t samples = 1) = 0;
+
+		/// <summary>
+		/// Uploads the base level and generates the rest of the mip chain from it.  The data
+		/// is copied, the caller keeps ownership of it.
+		/// </summary>
 		virtual void setData(const uint8_t* data, const uint32_t dataSize) = 0;
 
+		/// <summary>
+		/// Uploads one mip level.  Nothing is uploaded when dataSize is smaller than the level.
+		/// </summary>
+		virtual void setMipData(const uint32_t level, const uint8_t* data, const uint32_t dataSize) = 0;
+
+		/// <summary>
+		/// Rebuilds every level below the base level on the GPU.  Only valid when
+		/// canGenerateMips() is true, setData falls back to the CPU otherwise.
+		/// </summary>
+		virtual void generateMips() = 0;
+		virtual bool canGenerateMips() const = 0;
+
+		/// <summary>
+		/// Restricts sampling to the mips from level down to the smallest one, so an image can be
+		/// used while its finer mips are still streaming in.  OpenGL clamps the texture's base
+		/// level, Vulkan clamps image views constructed after the call.
+		/// </summary>
+		virtual void setResidentMip(const uint32_t level);
+
 		virtual void* getImageHandle() const = 0;
 
+		virtual uint32_t getWidth() const = 0;
+		virtual uint32_t getHeight() const = 0;
+
 		ImageFormat getImageFormat() const { return mImageFormat; }
 		ImageDataType getImageDataType() const { return mImageDataType; }
 		ImageType getImageType() const { return mImageType; }
 
+		uint32_t getMipLevels() const { return mMipLevels; }
+		uint32_t getResidentMip() const { return mResidentMip; }
+		uint32_t getSamples() const { return mSamples; }
+
+		/// <summary>
+		/// Number of levels in a full mip chain down to 1x1
+		/// </summary>
+		static uint32_t getMipChainLength(const uint32_t width, const uint32_t height);
+
 	protected:
 		ContextHandle* mHandle;
 
 		ImageFormat mImageFormat;
 		ImageDataType mImageDataType;
 		ImageType mImageType;
+
+		uint32_t mMipLevels;
+		uint32_t mResidentMip;
+		uint32_t mSamples;
+
+		/// <summary>
+		/// Box filters the base level down the mip chain on the CPU and uploads every level
+		/// </summary>
+		void _generateMipsOnCpu(const uint8_t* data, const uint32_t width, const uint32_t height);
 };
 
 #endif // iimage_h__
\ No newline at end of file
@@ -2,6 +2,20 @@
 #define iimageview_h__
 
 #include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+/// <summary>
+/// An attachment as framebuffers and the render pass cache see it
+/// </summary>
+struct FrameBufferAttachment
+{
+	// VkImageView or GL texture name
+	void* view;
+
+	// Image the view belongs to, the same handle IImage2D::getImageHandle returns.  Null for
+	// swap chain images, which are transitioned by their render pass.
+	void* image;
+};
 
 class IImageView
 {
@@ -13,8 +27,10 @@ class IImageView
 
 		virtual void construct(Image2D* image) = 0;
 
+		virtual FrameBufferAttachment getAttachment() const = 0;
+
     protected:
 		ContextHandle* mHandle;
 };
 
-#endif // iimageview_h__
\ No newline at end of file
+#endif // iimageview_h__
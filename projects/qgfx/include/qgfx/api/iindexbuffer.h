@@ -0,0 +1,74 @@
+#ifndef iindexbuffer_h__
+#define iindexbuffer_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qgfx/context_handle.h"
+
+enum class IndexType : int32_t
+{
+	UInt16,
+	UInt32
+};
+
+/// <summary>
+/// Index value marking a strip restart when primitive restart is enabled on the pipeline.
+/// It is narrowed to 0xFFFF when the buffer is stored with 16 bit indices.
+/// </summary>
+constexpr uint32_t primitiveRestartIndex = 0xFFFFFFFF;
+
+class IIndexBuffer
+{
+	public:
+		explicit IIndexBuffer(ContextHandle* handle);
+		virtual ~IIndexBuffer();
+
+		IIndexBuffer& operator = (const IIndexBuffer&) = delete;
+
+		/// <summary>
+		/// Copies the indices, storing them as 16 bit indices whenever the largest index
+		/// leaves room for the restart index, and as 32 bit indices otherwise.
+		/// </summary>
+		void setData(const uint32_t* indices, const size_t count);
+
+		/// <summary>
+		/// Opt-in variant of setData for triangle lists built at load time.  The triangles are
+		/// reordered for the post-transform vertex cache before they are packed.  Overdraw and
+		/// fetch ordering rewrite the vertices as well, run optimizeMesh for those.
+		/// </summary>
+		void setOptimizedData(const uint32_t* indices, const size_t count, const size_t vertexCount, const uint32_t cacheSize = 16);
+
+		/// <summary>
+		/// References already packed indices instead of copying them.  The data has to stay
+		/// valid until construct() returns.
+		/// </summary>
+		void setExternalData(const void* indices, const size_t count, const IndexType type);
+
+		virtual bool construct() = 0;
+
+		virtual void bind() = 0;
+		virtual void unbind() = 0;
+
+		uint32_t getCount() const { return mCount; }
+		IndexType getIndexType() const { return mIndexType; }
+		size_t getIndexSize() const { return mIndexType == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+		size_t getSize() const { return mCount * getIndexSize(); }
+
+		static IndexType selectIndexType(const uint32_t* indices, const size_t count);
+	protected:
+		ContextHandle* mHandle;
+		uint32_t mCount;
+		IndexType mIndexType;
+
+		/// <summary>
+		/// Packed index data waiting for construct().  Backends release it with _releaseData()
+		/// once it has been uploaded.
+		/// </summary>
+		const uint8_t* mData;
+		bool mOwnsData;
+
+		void _releaseData();
+};
+
+#endif // iindexbuffer_h__
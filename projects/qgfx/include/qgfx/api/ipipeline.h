@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include "qgfx/api/ivertexbuffer.h"
 #include "qgfx/context_handle.h"
 #include "qgfx/typedefs.h"
 
@@ -25,9 +26,22 @@ class IPipeline
 
 		virtual void construct() = 0;
 		virtual void setTopology(const Topology& topology) = 0;
+
+		/// <summary>
+		/// Enables restarting strips at primitiveRestartIndex.  Only valid for strip topologies.
+		/// </summary>
+		virtual void setPrimitiveRestart(const bool enabled) = 0;
 		virtual Shader* addShader() = 0;
+
+		/// <summary>
+		/// Adds a vertex stream to the pipeline's vertex input.  Must be called before construct(),
+		/// a layout whose binding is already in use is ignored.
+		/// </summary>
+		void addVertexLayout(const VertexBufferLayout& layout);
+		const qtl::vector<VertexBufferLayout>& getVertexLayouts() const { return mVertexLayouts; }
 	protected:
 		ContextHandle* mHandle;
+		qtl::vector<VertexBufferLayout> mVertexLayouts;
 };
 
 #endif // ipipeline_h__
\ No newline at end of file
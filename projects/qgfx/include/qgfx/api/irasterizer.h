@@ -25,6 +25,46 @@ enum class PolygonMode : int32_t
 	Fill
 };
 
+enum class CompareOp : int32_t
+{
+	Never,
+	Less,
+	Equal,
+	LessOrEqual,
+	Greater,
+	NotEqual,
+	GreaterOrEqual,
+	Always
+};
+
+enum class StencilOp : int32_t
+{
+	Keep,
+	Zero,
+	Replace,
+	IncrementClamp,
+	DecrementClamp,
+	Invert,
+	IncrementWrap,
+	DecrementWrap
+};
+
+struct StencilState
+{
+	CompareOp compareOp = CompareOp::Always;
+	StencilOp failOp = StencilOp::Keep;
+	StencilOp passOp = StencilOp::Keep;
+	StencilOp depthFailOp = StencilOp::Keep;
+	uint32_t compareMask = 0xFF;
+	uint32_t writeMask = 0xFF;
+	uint32_t reference = 0;
+};
+
+/// <summary>
+/// Raster and depth/stencil state.  OpenGL applies changes immediately, Vulkan bakes the state
+/// into pipelines when they are constructed.  Depth testing defaults to on with writes and a
+/// Less compare, which keeps early depth rejection working on every GPU.
+/// </summary>
 class IRasterizer
 {
 	public:
@@ -41,8 +81,48 @@ class IRasterizer
 		virtual void setLineWidth(const float lineWidth) = 0;
 
 		virtual void setDepthTest(const bool enabled) = 0;
+		virtual void setDepthWrite(const bool enabled) = 0;
+
+		/// <summary>
+		/// Compare as if near were depth 0 and far depth 1.  The op is flipped while reverse-Z is
+		/// on, so Less keeps the closer fragment either way.
+		/// </summary>
+		virtual void setDepthCompare(const CompareOp op) = 0;
+
+		virtual void setStencilTest(const bool enabled, const StencilState& front = StencilState(), const StencilState& back = StencilState()) = 0;
+		virtual void setColorWrite(const bool enabled) = 0;
+
+		/// <summary>
+		/// Maps the near plane to depth 1 and the far plane to 0, which spreads the precision of a
+		/// float depth buffer evenly over distance.  Needs a projection matrix that maps near to 1
+		/// and depth attachments cleared to getDepthClearValue().
+		/// </summary>
+		virtual void setReverseZ(const bool enabled) = 0;
+
+		bool isDepthTestEnabled() const { return mDepthTest; }
+		bool isDepthWriteEnabled() const { return mDepthWrite; }
+		CompareOp getDepthCompare() const { return mDepthCompare; }
+		bool isColorWriteEnabled() const { return mColorWrite; }
+		bool isReverseZ() const { return mReverseZ; }
+
+		float getDepthClearValue() const { return mReverseZ ? 0.0f : 1.0f; }
+
 	protected:
 		ContextHandle* mHandle;
+
+		bool mDepthTest;
+		bool mDepthWrite;
+		CompareOp mDepthCompare;
+		bool mStencilTest;
+		StencilState mStencilFront;
+		StencilState mStencilBack;
+		bool mColorWrite;
+		bool mReverseZ;
+
+		/// <summary>
+		/// Depth compare the device has to use, with reverse-Z applied
+		/// </summary>
+		CompareOp _getDeviceDepthCompare() const;
 };
 
-#endif // irasterizer_h__
\ No newline at end of file
+#endif // irasterizer_h__
@@ -0,0 +1,147 @@
+#ifndef ireadbackqueue_h__
+#define ireadbackqueue_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <qtl/vector.h>
+
+#include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+class IReadbackQueue;
+
+struct ReadbackStatistics
+{
+	// Readbacks requested, and those that found their slot still being copied into
+	uint32_t requests;
+	uint32_t slotWaits;
+
+	// Results collected with get(), and those that had to block on the GPU
+	uint32_t completed;
+	uint32_t stalls;
+
+	uint64_t bytesRead;
+};
+
+/// <summary>
+/// Result of a readback that may still be in flight.  Works like qtl::future, except that it is
+/// resolved by polling a GPU fence on the calling thread rather than by a promise, since GL sync
+/// objects can not be waited on from another thread.  The future stays valid until its slot is
+/// reused, slot count readbacks later.
+/// </summary>
+class ReadbackFuture
+{
+	friend class IReadbackQueue;
+	public:
+		ReadbackFuture() = default;
+
+		/// <summary>
+		/// False for default constructed futures and once the slot has been reused
+		/// </summary>
+		bool isValid() const;
+
+		/// <summary>
+		/// Whether get() can return without blocking
+		/// </summary>
+		bool isReady() const;
+
+		void wait() const;
+
+		/// <summary>
+		/// Waits for the copy and writes getSize() bytes of tightly packed rows to destination,
+		/// top row first
+		/// </summary>
+		void get(uint8_t* destination) const;
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+		size_t getSize() const;
+	private:
+		ReadbackFuture(IReadbackQueue* queue, const uint32_t slot, const uint64_t ticket);
+
+		IReadbackQueue* mQueue = nullptr;
+		uint32_t mSlot = 0;
+		uint64_t mTicket = 0;
+};
+
+/// <summary>
+/// Copies images back to the CPU without stalling on the frame that rendered them.  Every
+/// readback gets its own slot of a ring of staging buffers and is fenced when it is submitted,
+/// so with enough slots the copy of a frame has finished long before its result is collected.
+/// Request readbacks after endFrame(), once the commands that render the source are submitted.
+/// </summary>
+class IReadbackQueue
+{
+	friend class ReadbackFuture;
+	public:
+		explicit IReadbackQueue(ContextHandle* handle, const uint32_t slotCount = 3);
+		virtual ~IReadbackQueue() = default;
+
+		IReadbackQueue& operator = (const IReadbackQueue&) = delete;
+
+		virtual void construct() = 0;
+
+		/// <summary>
+		/// Reads the back buffer of the frame submitted by the last endFrame() as RGBA8, call it
+		/// before swap().  Vulkan contexts need to be headless.
+		/// </summary>
+		ReadbackFuture readBackBuffer();
+
+		/// <summary>
+		/// Reads the base level of a single sampled, uncompressed color image
+		/// </summary>
+		ReadbackFuture readImage(Image2D* image);
+
+		uint32_t getSlotCount() const { return static_cast<uint32_t>(mSlots.size()); }
+
+		const ReadbackStatistics& getStatistics() const { return mStatistics; }
+		void resetStatistics() { mStatistics = {}; }
+
+	protected:
+		struct Slot
+		{
+			uint64_t ticket;
+			uint32_t width;
+			uint32_t height;
+			size_t size;
+			bool pending;
+			bool flipRows;
+		};
+
+		ContextHandle* mHandle;
+		qtl::vector<Slot> mSlots;
+
+		/// <summary>
+		/// Makes the staging memory of the slot hold at least size bytes
+		/// </summary>
+		virtual void _reserve(const uint32_t slot, const size_t size) = 0;
+
+		/// <summary>
+		/// Record and submit the copy into the slot and fence it.  _copyBackBuffer returns
+		/// whether the rows come out bottom first.
+		/// </summary>
+		virtual bool _copyBackBuffer(const uint32_t slot) = 0;
+		virtual void _copyImage(const uint32_t slot, Image2D* image) = 0;
+
+		virtual bool _isComplete(const uint32_t slot) = 0;
+		virtual void _wait(const uint32_t slot) = 0;
+
+		/// <summary>
+		/// Mapped staging memory of a completed slot, made visible to the CPU
+		/// </summary>
+		virtual const uint8_t* _getData(const uint32_t slot) = 0;
+
+	private:
+		uint32_t mNextSlot;
+		uint64_t mNextTicket;
+		ReadbackStatistics mStatistics;
+
+		uint32_t _acquire(const uint32_t width, const uint32_t height, const size_t size);
+		const Slot* _find(const uint32_t slot, const uint64_t ticket) const;
+		bool _isReady(const uint32_t slot, const uint64_t ticket);
+		void _waitFor(const uint32_t slot, const uint64_t ticket);
+		void _read(const uint32_t slot, const uint64_t ticket, uint8_t* destination);
+};
+
+#endif // ireadbackqueue_h__
@@ -1,9 +1,90 @@
 #ifndef irenderpass_h__
 #define irenderpass_h__
 
+#include <stdint.h>
+
+#include "qgfx/api/iimage2d.h"
 #include "qgfx/context_handle.h"
 #include "qgfx/typedefs.h"
 
+enum class AttachmentLoadOp : uint32_t
+{
+	Load,
+	Clear,
+
+	// Previous contents are undefined, tiled GPUs skip reading them into tile memory
+	DontCare
+};
+
+enum class AttachmentStoreOp : uint32_t
+{
+	Store,
+
+	// Contents are undefined after the pass, tiled GPUs skip writing them back to memory
+	DontCare
+};
+
+struct RenderPassAttachment
+{
+	ImageFormat format = ImageFormat::RGBA;
+	ImageDataType type = ImageDataType::UByte;
+	ImageType imageType = ImageType::Color;
+
+	AttachmentLoadOp loadOp = AttachmentLoadOp::Clear;
+	AttachmentStoreOp storeOp = AttachmentStoreOp::Store;
+	AttachmentLoadOp stencilLoadOp = AttachmentLoadOp::DontCare;
+	AttachmentStoreOp stencilStoreOp = AttachmentStoreOp::DontCare;
+
+	// Renders to the window's swap chain image, format and type are ignored
+	bool swapChain = false;
+};
+
+/// <summary>
+/// Attachment formats and load/store ops of a single subpass render pass.  Framebuffers list
+/// the color attachments first, then the depth attachment, then the resolve attachments in
+/// the order of the color attachments they belong to.
+/// </summary>
+struct RenderPassDescription
+{
+	static constexpr uint32_t maxColorAttachments = 8;
+
+	RenderPassAttachment colorAttachments[maxColorAttachments];
+	uint32_t colorAttachmentCount = 0;
+
+	RenderPassAttachment depthAttachment;
+	bool hasDepthAttachment = false;
+
+	// Samples of the color and depth attachments, resolve attachments always have one
+	uint32_t samples = 1;
+
+	// Single sampled targets multisampled color attachments are resolved into at the end of the
+	// pass, which tiled GPUs do from tile memory without writing the samples out
+	RenderPassAttachment resolveAttachments[maxColorAttachments];
+	bool hasResolveAttachment[maxColorAttachments] = {};
+	uint32_t resolveAttachmentCount = 0;
+
+	void addColorAttachment(const RenderPassAttachment& attachment);
+	void setDepthAttachment(const RenderPassAttachment& attachment);
+	void setResolveAttachment(const uint32_t colorAttachment, const RenderPassAttachment& attachment);
+
+	uint32_t getAttachmentCount() const { return colorAttachmentCount + (hasDepthAttachment ? 1 : 0) + resolveAttachmentCount; }
+
+	/// <summary>
+	/// Framebuffer attachment index of the resolve target of a color attachment
+	/// </summary>
+	uint32_t getResolveAttachmentIndex(const uint32_t colorAttachment) const;
+
+	uint64_t getHash() const;
+	bool operator == (const RenderPassDescription& other) const;
+};
+
+struct ClearValue
+{
+	float color[4];
+	float depth;
+	uint32_t stencil;
+};
+
 class IRenderPass
 {
 	public:
@@ -12,10 +93,13 @@ class IRenderPass
 
 		IRenderPass& operator = (const IRenderPass&) = delete;
 
-		virtual void construct(Pipeline* pipeline) = 0;
+		virtual void construct(const RenderPassDescription& description) = 0;
+
+		const RenderPassDescription& getDescription() const { return mDescription; }
 
 	protected:
 		ContextHandle* mHandle;
+		RenderPassDescription mDescription;
 };
 
-#endif // irenderpass_h__
\ No newline at end of file
+#endif // irenderpass_h__
@@ -8,16 +8,74 @@
 #include "qgfx/context_handle.h"
 #include "qgfx/qassert.h"
 
+/// <summary>
+/// Backend neutral component type of a vertex attribute.  Integer types are read as
+/// snorm/unorm when the attribute is normalized, and as integers (ivec/uvec inputs) when it
+/// is not.  The packed 2_10_10_10 types always have four components stored in a single 32 bit
+/// word and are read as floats, converted without normalization when not normalized.
+/// </summary>
+enum class VertexAttribType : int32_t
+{
+	Float,
+	Half,
+	Int32,
+	UInt32,
+	Int16,
+	UInt16,
+	Int8,
+	UInt8,
+	Int2_10_10_10,
+	UInt2_10_10_10
+};
+
+constexpr size_t getVertexAttribSize(const VertexAttribType type, const uint32_t count)
+{
+	switch (type)
+	{
+		case VertexAttribType::Float:
+		case VertexAttribType::Int32:
+		case VertexAttribType::UInt32: return 4 * count;
+		case VertexAttribType::Half:
+		case VertexAttribType::Int16:
+		case VertexAttribType::UInt16: return 2 * count;
+		case VertexAttribType::Int8:
+		case VertexAttribType::UInt8: return count;
+		case VertexAttribType::Int2_10_10_10:
+		case VertexAttribType::UInt2_10_10_10: return 4;
+	}
+
+	return 0;
+}
+
+constexpr bool isIntegerVertexAttrib(const VertexAttribType type)
+{
+	return type == VertexAttribType::Int32 || type == VertexAttribType::UInt32 || type == VertexAttribType::Int16 ||
+		type == VertexAttribType::UInt16 || type == VertexAttribType::Int8 || type == VertexAttribType::UInt8;
+}
+
 struct VertexBufferLayoutElement
 {
 	qtl::string name;
-	uint32_t type;
+	VertexAttribType type;
+
+	// Size of the whole attribute in bytes
 	size_t size;
 	uint32_t count;
 	size_t offset;
 	bool normalized;
 };
 
+enum class VertexInputRate : int32_t
+{
+	Vertex,
+	Instance
+};
+
+/// <summary>
+/// Describes the attributes of a single vertex stream.  Pipelines combine several layouts,
+/// each on its own binding, and number the attribute locations in the order the layouts
+/// were added.
+/// </summary>
 class VertexBufferLayout
 {
 	public:
@@ -27,50 +85,113 @@ class VertexBufferLayout
 		const qtl::vector<VertexBufferLayoutElement>& getLayout() const { return mLayout; }
 		size_t getStride() const { return mSize; }
 
+		void setBinding(const uint32_t binding) { mBinding = binding; }
+		uint32_t getBinding() const { return mBinding; }
+
+		/// <summary>
+		/// Instance rate streams advance once every divisor instances instead of once per vertex.
+		/// </summary>
+		void setInputRate(const VertexInputRate rate, const uint32_t divisor = 1)
+		{
+			QGFX_ASSERT_MSG(rate == VertexInputRate::Vertex || divisor > 0, "Instance rate streams need a non-zero divisor.\n");
+			mInputRate = rate;
+			mDivisor = rate == VertexInputRate::Instance ? divisor : 0;
+		}
+		VertexInputRate getInputRate() const { return mInputRate; }
+		uint32_t getDivisor() const { return mDivisor; }
+
+		/// <summary>
+		/// Hash of the attribute formats and stride.  Attribute names are ignored, so
+		/// layouts describing the same memory produce the same hash.
+		/// </summary>
+		uint64_t getHash() const
+		{
+			uint64_t hash = 14695981039346656037ULL;
+			const auto combine = [&hash](const uint64_t value)
+			{
+				hash ^= value;
+				hash *= 1099511628211ULL;
+			};
+
+			combine(mSize);
+			combine(mBinding);
+			combine(static_cast<uint64_t>(mInputRate));
+			combine(mDivisor);
+			for (const auto& element : mLayout)
+			{
+				combine(static_cast<uint64_t>(element.type));
+				combine(element.count);
+				combine(element.offset);
+				combine(element.normalized);
+			}
+
+			return hash;
+		}
+
 		template<typename T>
 		void push(const qtl::string& name, const uint32_t count = 1, const bool normalize = false)
 		{
 			QGFX_ASSERT(false);
 		}
-	private:
-		size_t mSize = 0;
-		qtl::vector<VertexBufferLayoutElement> mLayout;
 
-		void _push(const qtl::string& name, const uint32_t type, const size_t size, const uint32_t count, const bool normalized)
+		void push(const qtl::string& name, const VertexAttribType type, const uint32_t count = 1, const bool normalized = false)
 		{
+			QGFX_ASSERT_MSG(count >= 1 && count <= 4, "Vertex attributes have one to four components.\n");
+			QGFX_ASSERT_MSG(count == 4 || (type != VertexAttribType::Int2_10_10_10 && type != VertexAttribType::UInt2_10_10_10),
+				"Packed 2_10_10_10 attributes always have four components.\n");
+
+			const size_t size = getVertexAttribSize(type, count);
 			mLayout.push_back({ name, type, size, count, mSize, normalized });
-			mSize += size * count;
+			mSize += size;
 		}
+	private:
+		size_t mSize = 0;
+		uint32_t mBinding = 0;
+		VertexInputRate mInputRate = VertexInputRate::Vertex;
+		uint32_t mDivisor = 0;
+		qtl::vector<VertexBufferLayoutElement> mLayout;
 };
 
 template<>
 inline void VertexBufferLayout::push<float>(const qtl::string& name, const uint32_t count, const bool normalized)
 {
-	#if defined(QGFX_OPENGL)
-	_push(name, GL_FLOAT, sizeof(float), count, normalized);
-	#elif defined(QGFX_VULKAN)
-	_push(name, VK_FORMAT_R32_SFLOAT, sizeof(float), count, normalized);
-	#endif
+	push(name, VertexAttribType::Float, count, normalized);
+}
+
+template<>
+inline void VertexBufferLayout::push<int32_t>(const qtl::string& name, const uint32_t count, const bool normalized)
+{
+	push(name, VertexAttribType::Int32, count, normalized);
 }
 
 template<>
 inline void VertexBufferLayout::push<uint32_t>(const qtl::string& name, const uint32_t count, const bool normalized)
 {
-	#if defined(QGFX_OPENGL)
-		_push(name, GL_UNSIGNED_INT, sizeof(uint32_t), count, normalized);
-	#elif defined(QGFX_VULKAN)
-		_push(name, VK_FORMAT_R32_UINT, sizeof(uint32_t), count, normalized);
-	#endif
+	push(name, VertexAttribType::UInt32, count, normalized);
+}
+
+template<>
+inline void VertexBufferLayout::push<int16_t>(const qtl::string& name, const uint32_t count, const bool normalized)
+{
+	push(name, VertexAttribType::Int16, count, normalized);
+}
+
+template<>
+inline void VertexBufferLayout::push<uint16_t>(const qtl::string& name, const uint32_t count, const bool normalized)
+{
+	push(name, VertexAttribType::UInt16, count, normalized);
+}
+
+template<>
+inline void VertexBufferLayout::push<int8_t>(const qtl::string& name, const uint32_t count, const bool normalized)
+{
+	push(name, VertexAttribType::Int8, count, normalized);
 }
 
 template<>
 inline void VertexBufferLayout::push<uint8_t>(const qtl::string& name, const uint32_t count, const bool normalized)
 {
-	#if defined(QGFX_OPENGL)
-		_push(name, GL_UNSIGNED_BYTE, sizeof(uint8_t), count, normalized);
-	#elif defined(QGFX_VULKAN)
-		_push(name, VK_FORMAT_R8_UINT, sizeof(uint8_t), count, normalized);
-	#endif
+	push(name, VertexAttribType::UInt8, count, normalized);
 }
 
 class IVertexBuffer
@@ -82,6 +203,12 @@ class IVertexBuffer
 		IVertexBuffer& operator = (const IVertexBuffer&) = delete;
 
 		virtual void setData(void* data, const size_t size) = 0;
+
+		/// <summary>
+		/// References the data instead of copying it.  The data has to stay valid until
+		/// construct() returns.
+		/// </summary>
+		virtual void setExternalData(const void* data, const size_t size) = 0;
 		virtual void setLayout(const VertexBufferLayout& layout) = 0;
 
 		virtual bool construct() = 0;
@@ -14,6 +14,10 @@ struct WindowCreationParameters
 
 	bool fullscreen;
 	bool vsync;
+
+	// No OS window or swap chain, frames render into offscreen images that are read back
+	// with IContextHandle::readBackBuffer.  For batch jobs on machines without a display.
+	bool headless = false;
 };
 
 class IWindow
@@ -28,6 +32,10 @@ class IWindow
 		virtual void* getPlatformHandle() const = 0;
 		virtual bool shouldClose() const = 0;
 		virtual void poll() const = 0;
+
+		virtual uint32_t getWidth() const = 0;
+		virtual uint32_t getHeight() const = 0;
+		virtual bool isHeadless() const = 0;
 };
 
 #endif // iwindow_h__
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef cpu_profiler_h__
+#define cpu_profiler_h__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+
+struct CpuProfilerStatistics
+{
+	uint32_t threads;
+
+	// Zones recorded in the current capture, and those lost because a thread's buffer was full
+	uint64_t events;
+	uint64_t droppedEvents;
+};
+
+/// <summary>
+/// Records CPU zones between beginCapture() and endCapture() and writes them as a Chrome trace,
+/// which chrome://tracing and ui.perfetto.dev open.  Every thread appends to a buffer of its
+/// own, so recording a zone is two clock reads and a store without locks.  Only the first zone
+/// of a thread takes a lock, to register its buffer.
+///
+/// Zones are placed with QGFX_PROFILE_SCOPE and QGFX_PROFILE_FUNCTION, which compile to nothing
+/// unless QGFX_PROFILE is defined.  Zone names are kept by pointer and have to be string
+/// literals.
+/// </summary>
+class CpuProfiler
+{
+	public:
+		/// <summary>
+		/// Drops the events of the previous capture and starts recording.  Call it between frames,
+		/// not while writeChromeTrace() runs on another thread.
+		/// </summary>
+		static void beginCapture();
+		static void endCapture();
+
+		static bool isCapturing() { return sCapturing.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Writes the zones of the last capture in the Chrome trace event format
+		/// </summary>
+		static bool writeChromeTrace(const char* path);
+
+		/// <summary>
+		/// Names the calling thread in traces, threads are numbered otherwise
+		/// </summary>
+		static void setThreadName(const char* name);
+
+		static CpuProfilerStatistics getStatistics();
+
+		static uint64_t now()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		static void record(const char* name, const uint64_t begin, const uint64_t end);
+
+	private:
+		static std::atomic<bool> sCapturing;
+};
+
+class CpuProfileScope
+{
+	public:
+		explicit CpuProfileScope(const char* name)
+			: mName(name), mActive(CpuProfiler::isCapturing()), mBegin(mActive ? CpuProfiler::now() : 0)
+		{
+		}
+
+		~CpuProfileScope()
+		{
+			if (mActive)
+			{
+				CpuProfiler::record(mName, mBegin, CpuProfiler::now());
+			}
+		}
+
+		CpuProfileScope(const CpuProfileScope&) = delete;
+		CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+	private:
+		const char* mName;
+		bool mActive;
+		uint64_t mBegin;
+};
+
+#if defined(QGFX_PROFILE)
+	#define QGFX_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define QGFX_PROFILE_CONCAT(a, b) QGFX_PROFILE_CONCAT_IMPL(a, b)
+
+	// GCC and Clang only qualify the function name in the full signature, which is trimmed to
+	// Class::function when the trace is written
+	#if defined(_MSC_VER)
+		#define QGFX_PROFILE_FUNCTION_NAME __FUNCTION__
+	#else
+		#define QGFX_PROFILE_FUNCTION_NAME __PRETTY_FUNCTION__
+	#endif
+
+	#define QGFX_PROFILE_SCOPE(name) CpuProfileScope QGFX_PROFILE_CONCAT(qgfxProfileScope, __LINE__)(name)
+	#define QGFX_PROFILE_FUNCTION() QGFX_PROFILE_SCOPE(QGFX_PROFILE_FUNCTION_NAME)
+#else
+	#define QGFX_PROFILE_SCOPE(name)
+	#define QGFX_PROFILE_FUNCTION()
+#endif
+
+#endif // cpu_profiler_h__
@@ -0,0 +1,86 @@
+#ifndef depth_prepass_h__
+#define depth_prepass_h__
+
+#include "qgfx/api/iframegraph.h"
+#include "qgfx/context_handle.h"
+
+#include <qtl/vector.h>
+
+/// <summary>
+/// Renders the opaque geometry twice, first depth only and then shaded with an Equal depth
+/// test, so every pixel runs the expensive fragment shader exactly once.  On OpenGL the
+/// rasterizer is switched to each pass's state while it executes and restored afterwards.
+/// Vulkan bakes that state into pipelines, there the prepass pipelines have to be constructed
+/// after applyPrepassState() and the shading pipelines after applyShadingState().  The passes
+/// it adds call back into it, so it has to outlive them.
+/// </summary>
+class DepthPrepass
+{
+	public:
+		explicit DepthPrepass(ContextHandle* handle);
+		DepthPrepass(const DepthPrepass&) = delete;
+		~DepthPrepass();
+
+		DepthPrepass& operator=(const DepthPrepass&) = delete;
+
+		/// <summary>
+		/// Depth test and writes on with a Less compare, color writes off
+		/// </summary>
+		void applyPrepassState();
+
+		/// <summary>
+		/// Depth writes off with an Equal compare, color writes on
+		/// </summary>
+		void applyShadingState();
+
+		/// <summary>
+		/// Transient depth texture cleared to the far plane of the current depth mapping
+		/// </summary>
+		FrameGraphTextureDescription getDepthDescription(const uint32_t width, const uint32_t height, const bool stencil = false) const;
+
+		/// <summary>
+		/// Adds the depth only pass and returns the depth it writes.  The pass is kept only when a
+		/// shading pass uses the depth.
+		/// </summary>
+		FrameGraphResource addPrepass(IFrameGraph* graph, const char* name, const FrameGraphTextureDescription& depth,
+			IFrameGraph::ExecuteCallback execute, void* userData = nullptr);
+
+		/// <summary>
+		/// Adds a pass that loads the prepass depth and tests against it.  setup declares the color
+		/// targets and sampled textures like any other pass.
+		/// </summary>
+		FrameGraphResource addShadingPass(IFrameGraph* graph, const char* name, const FrameGraphResource depth,
+			IFrameGraph::SetupCallback setup, IFrameGraph::ExecuteCallback execute, void* userData = nullptr);
+
+		/// <summary>
+		/// Releases the callbacks of every pass added so far, call it after resetting the graph
+		/// </summary>
+		void reset();
+
+	private:
+		struct PassCallback
+		{
+			DepthPrepass* prepass;
+			IFrameGraph::SetupCallback setup;
+			IFrameGraph::ExecuteCallback execute;
+			void* userData;
+
+			// Only used while the pass is added.  The prepass creates its depth from the name and
+			// description, the shading pass writes the given depth, both return the new version.
+			const char* name;
+			const FrameGraphTextureDescription* description;
+			FrameGraphResource depth;
+		};
+
+		ContextHandle* mHandle;
+
+		// User data of the passes added to graphs
+		qtl::vector<PassCallback*> mCallbacks;
+
+		static void _setupPrepass(FrameGraphBuilder& builder, void* userData);
+		static void _setupShadingPass(FrameGraphBuilder& builder, void* userData);
+		static void _executePrepass(CommandBuffer* commandBuffer, void* userData);
+		static void _executeShadingPass(CommandBuffer* commandBuffer, void* userData);
+};
+
+#endif // depth_prepass_h__
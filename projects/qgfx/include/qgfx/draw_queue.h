@@ -0,0 +1,110 @@
+#ifndef draw_queue_h__
+#define draw_queue_h__
+
+#include <stdint.h>
+
+#include <qtl/tree_map.h>
+#include <qtl/vector.h>
+
+#include "qgfx/typedefs.h"
+
+/// <summary>
+/// Callback used by the draw queue to bind a material whenever the material of the
+/// next draw differs from the one currently bound.
+/// </summary>
+using MaterialBindFunction = void(*)(CommandBuffer* buffer, const uint32_t materialId, void* userData);
+
+struct DrawPacket
+{
+	Pipeline* pipeline;
+	VertexBuffer* vertexBuffer;
+	IndexBuffer* indexBuffer;
+	uint32_t materialId;
+
+	uint8_t layer;
+	float depth;
+	bool backToFront;
+
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t firstVertex;
+	uint32_t firstInstance;
+
+	// Only used when indexBuffer is set, in which case vertexCount and firstVertex are ignored.
+	uint32_t indexCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+};
+
+struct DrawQueueStatistics
+{
+	uint32_t draws;
+	uint32_t pipelineBinds;
+	uint32_t vertexBufferBinds;
+	uint32_t indexBufferBinds;
+	uint32_t materialBinds;
+	uint32_t skippedBinds;
+};
+
+/// <summary>
+/// Collects draws for a frame, orders them by a 64 bit state key and emits them into
+/// a command buffer, only issuing the binds that actually change state.
+///
+/// Key layout, most significant bits first:
+/// [ layer : 8 ][ pipeline : 16 ][ material : 16 ][ depth : 24 ]
+///
+/// Material ids above 0xFFFF and pipelines past the first 0xFFFF share the last value of their
+/// field, which only costs batching, binds are always decided on the full id.
+/// </summary>
+class DrawQueue
+{
+	public:
+		DrawQueue();
+		~DrawQueue() = default;
+
+		DrawQueue(const DrawQueue&) = delete;
+		DrawQueue& operator = (const DrawQueue&) = delete;
+
+		void setMaterialBinder(MaterialBindFunction binder, void* userData);
+
+		void submit(const DrawPacket& packet);
+
+		void sort();
+		void emit(CommandBuffer* buffer);
+		void clear();
+
+		/// <summary>
+		/// Forgets the ids given to pipelines so they can be handed out again, for instance after
+		/// pipelines were destroyed.  Only call it while the queue is empty.
+		/// </summary>
+		void resetPipelineIds();
+
+		size_t size() const { return mPackets.size(); }
+		const DrawQueueStatistics& getStatistics() const { return mStatistics; }
+
+		static uint64_t makeSortKey(const uint8_t layer, const uint16_t pipelineId, const uint16_t materialId, const float depth, const bool backToFront = false);
+
+	private:
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t index;
+		};
+
+		qtl::vector<DrawPacket> mPackets;
+		qtl::vector<SortEntry> mEntries;
+		qtl::vector<SortEntry> mScratch;
+
+		qtl::tree_map<Pipeline*, uint16_t> mPipelineIds;
+		uint32_t mNextPipelineId;
+
+		MaterialBindFunction mMaterialBinder;
+		void* mMaterialUserData;
+
+		bool mSorted;
+		DrawQueueStatistics mStatistics;
+
+		uint16_t _getPipelineId(Pipeline* pipeline);
+};
+
+#endif // draw_queue_h__
@@ -0,0 +1,47 @@
+#ifndef image_format_h__
+#define image_format_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qgfx/api/iimage2d.h"
+
+/// <summary>
+/// Footprint of a format's smallest addressable unit.  Uncompressed formats are 1x1 blocks
+/// of one texel.
+/// </summary>
+struct ImageBlockInfo
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t size;
+};
+
+bool isCompressedImageFormat(const ImageFormat format);
+
+/// <summary>
+/// True for data types that store every component of a texel in a single value
+/// </summary>
+bool isPackedImageDataType(const ImageDataType type);
+
+uint32_t getImageComponentCount(const ImageFormat format);
+
+/// <summary>
+/// Size of a single texel of an uncompressed format in bytes
+/// </summary>
+uint32_t getImageTexelSize(const ImageFormat format, const ImageDataType type);
+
+ImageBlockInfo getImageBlockInfo(const ImageFormat format, const ImageDataType type);
+
+/// <summary>
+/// Bytes between two rows of blocks of the given mip level
+/// </summary>
+size_t getImageRowPitch(const uint32_t width, const uint32_t level, const ImageFormat format, const ImageDataType type);
+
+/// <summary>
+/// Size of the given mip level in bytes.  Partial blocks at the edges of small mips count as
+/// whole blocks.
+/// </summary>
+size_t getImageMipSize(const uint32_t width, const uint32_t height, const uint32_t level, const ImageFormat format, const ImageDataType type);
+
+#endif // image_format_h__
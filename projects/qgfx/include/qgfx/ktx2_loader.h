@@ -0,0 +1,77 @@
+#ifndef ktx2_loader_h__
+#define ktx2_loader_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <qtl/string.h>
+#include <qtl/vector.h>
+
+#include "qgfx/api/iimage2d.h"
+
+struct Ktx2UploadStatistics
+{
+	// Bytes handed to the image, compressed unless the texture had to be transcoded
+	uint64_t bytesUploaded;
+
+	// Size of the same mip chain as RGBA8, the difference is the video memory saved
+	uint64_t uncompressedBytes;
+
+	uint32_t mipsUploaded;
+	bool transcoded;
+	double milliseconds;
+};
+
+/// <summary>
+/// A KTX2 texture container.  Block compressed mips are uploaded as stored, without
+/// decompression.  Only 2D textures without supercompression are supported, and of the
+/// compressed formats only those with an ImageFormat equivalent.
+/// </summary>
+class Ktx2Texture
+{
+	public:
+		Ktx2Texture() = default;
+
+		bool load(const qtl::string& path);
+		bool load(const uint8_t* data, const size_t size);
+
+		bool isLoaded() const { return !mLevels.empty(); }
+
+		uint32_t getWidth() const { return mWidth; }
+		uint32_t getHeight() const { return mHeight; }
+		uint32_t getMipLevels() const { return static_cast<uint32_t>(mLevels.size()); }
+		ImageFormat getImageFormat() const { return mFormat; }
+		ImageDataType getImageDataType() const { return mDataType; }
+
+		const uint8_t* getMipData(const uint32_t level) const;
+		size_t getMipSize(const uint32_t level) const;
+
+		/// <summary>
+		/// Constructs the image and uploads every mip.  When the device can not sample the format
+		/// the mips are transcoded to RGBA8 on the CPU instead, and false is returned if there is
+		/// no transcoder for the format either.
+		/// </summary>
+		bool upload(IImage2D* image, const ContextHandle* context);
+
+		const Ktx2UploadStatistics& getStatistics() const { return mStatistics; }
+	private:
+		struct Level
+		{
+			size_t offset;
+			size_t size;
+		};
+
+		qtl::vector<uint8_t> mData;
+		qtl::vector<Level> mLevels;
+
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		ImageFormat mFormat = ImageFormat::RGBA;
+		ImageDataType mDataType = ImageDataType::UInt8_8_8_8;
+
+		Ktx2UploadStatistics mStatistics = {};
+
+		bool _parse();
+};
+
+#endif // ktx2_loader_h__
@@ -0,0 +1,172 @@
+#ifndef mesh_file_h__
+#define mesh_file_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <qtl/string.h>
+
+#include "qgfx/api/iindexbuffer.h"
+#include "qgfx/api/ivertexbuffer.h"
+
+/// <summary>
+/// On disk layout of a .qmesh file.  Everything is little endian and every blob starts on a
+/// meshFileAlignment boundary, so a memory mapped file can be handed to the upload path as is.
+///
+///   MeshFileHeader
+///   MeshFileElement[elementCount]
+///   vertex data    vertexCount * vertexStride bytes
+///   index data     16 or 32 bit indices
+///   MeshFileMeshlet[meshletCount]
+/// </summary>
+constexpr uint32_t meshFileMagic = 0x48534D51; // "QMSH"
+constexpr uint32_t meshFileVersion = 1;
+constexpr uint64_t meshFileAlignment = 64;
+constexpr uint32_t meshFileMaxElements = 16;
+
+struct MeshFileBlob
+{
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t elementCount;
+	uint64_t fileSize;
+
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	uint32_t indexType;
+	uint32_t meshletCount;
+	uint32_t reserved;
+
+	MeshFileBlob elements;
+	MeshFileBlob vertices;
+	MeshFileBlob indices;
+	MeshFileBlob meshlets;
+
+	float boundsMin[3];
+	float boundsMax[3];
+	float boundingSphere[4];
+};
+
+struct MeshFileElement
+{
+	char name[32];
+	uint32_t type;
+	uint32_t count;
+	uint32_t offset;
+	uint32_t normalized;
+};
+
+/// <summary>
+/// A run of triangles in the index buffer with its bounds and normal cone, for cluster culling.
+/// Seen from far enough away, a cluster faces away from the eye and can be skipped when
+/// dot(normalize(center - eye), coneAxis) >= coneCutoff.
+/// </summary>
+struct MeshFileMeshlet
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t vertexCount;
+	uint32_t reserved;
+	float center[3];
+	float radius;
+	float coneAxis[3];
+	float coneCutoff;
+};
+
+static_assert(sizeof(MeshFileHeader) == 152, "MeshFileHeader layout changed, bump meshFileVersion.\n");
+static_assert(sizeof(MeshFileElement) == 48, "MeshFileElement layout changed, bump meshFileVersion.\n");
+static_assert(sizeof(MeshFileMeshlet) == 48, "MeshFileMeshlet layout changed, bump meshFileVersion.\n");
+
+struct MeshFileStatistics
+{
+	uint64_t bytes;
+	double milliseconds;
+
+	// Bytes per second through open(), including the prefetch when one was requested
+	double throughput;
+};
+
+/// <summary>
+/// Read only memory mapping of a .qmesh file.  The pointers returned stay valid until the
+/// file is closed, and may be passed straight to setExternalData on the buffers.
+/// </summary>
+class MeshFile
+{
+	public:
+		MeshFile() = default;
+		MeshFile(const MeshFile&) = delete;
+		~MeshFile();
+
+		MeshFile& operator=(const MeshFile&) = delete;
+
+		/// <summary>
+		/// Maps and validates the file.  With prefetch set the pages are requested up front
+		/// instead of being faulted in during the upload.
+		/// </summary>
+		bool open(const qtl::string& path, const bool prefetch = false);
+		void close();
+
+		bool isOpen() const { return mHeader != nullptr; }
+
+		const MeshFileHeader* getHeader() const { return mHeader; }
+		VertexBufferLayout getLayout() const;
+
+		const void* getVertices() const;
+		const void* getIndices() const;
+		const MeshFileMeshlet* getMeshlets() const;
+		IndexType getIndexType() const { return static_cast<IndexType>(mHeader->indexType); }
+
+		/// <summary>
+		/// Points the buffers at the mapped blobs.  The file has to stay open until both
+		/// buffers are constructed.
+		/// </summary>
+		void upload(IVertexBuffer* vertexBuffer, IIndexBuffer* indexBuffer) const;
+
+		const MeshFileStatistics& getStatistics() const { return mStatistics; }
+	private:
+		const MeshFileHeader* mHeader = nullptr;
+		const uint8_t* mMapping = nullptr;
+		uint64_t mMappingSize = 0;
+		MeshFileStatistics mStatistics = {};
+
+#if defined(_WIN32)
+		void* mFile = nullptr;
+		void* mFileMapping = nullptr;
+#else
+		int mFile = -1;
+#endif
+
+		bool _validate() const;
+};
+
+/// <summary>
+/// Mesh data to convert into a .qmesh file.  Positions are three floats at positionOffset
+/// inside each vertex.
+/// </summary>
+struct MeshFileSource
+{
+	const VertexBufferLayout* layout;
+	const void* vertices;
+	size_t vertexCount;
+	const uint32_t* indices;
+	size_t indexCount;
+	size_t positionOffset;
+
+	// Runs optimizeMesh on a copy of the data before writing it
+	bool optimize = true;
+
+	uint32_t meshletMaxVertices = 64;
+	uint32_t meshletMaxTriangles = 124;
+};
+
+bool writeMeshFile(const qtl::string& path, const MeshFileSource& source);
+
+#endif // mesh_file_h__
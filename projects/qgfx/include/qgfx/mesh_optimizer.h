@@ -0,0 +1,63 @@
+#ifndef mesh_optimizer_h__
+#define mesh_optimizer_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct VertexCacheStatistics
+{
+	// Vertices transformed when drawing with a FIFO post-transform cache
+	uint32_t vertexTransforms;
+
+	// Average cache miss ratio, transforms per triangle.  0.5 is ideal for large meshes, 3 the worst.
+	float acmr;
+
+	// Average transform to vertex ratio, 1 is ideal
+	float atvr;
+};
+
+struct MeshOptimizerOptions
+{
+	uint32_t cacheSize = 16;
+
+	// Reorders cache optimized clusters so outward facing ones are drawn first
+	bool overdraw = true;
+	float overdrawThreshold = 1.05f;
+
+	// Byte offset of the three float position inside a vertex, used for overdraw ordering
+	size_t positionOffset = 0;
+
+	bool vertexFetch = true;
+};
+
+/// <summary>
+/// Reorders triangles for post-transform vertex cache locality using Tipsify.
+/// destination and indices may not alias.
+/// </summary>
+void optimizeVertexCache(uint32_t* destination, const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize = 16);
+
+/// <summary>
+/// Splits a cache optimized index buffer into clusters at the points where the cache
+/// restarts, and where splitting costs less than threshold times the cluster's ACMR.  The
+/// clusters are then sorted so those facing away from the mesh centre are drawn first.
+/// destination and indices may not alias.
+/// </summary>
+void optimizeOverdraw(uint32_t* destination, const uint32_t* indices, const size_t indexCount, const void* vertices, const size_t vertexCount,
+	const size_t vertexSize, const size_t positionOffset, const uint32_t cacheSize = 16, const float threshold = 1.05f);
+
+/// <summary>
+/// Reorders vertices in the order the indices first reference them and remaps the indices
+/// in place.  Unreferenced vertices are dropped.  Returns the number of vertices written.
+/// </summary>
+size_t optimizeVertexFetch(void* destination, uint32_t* indices, const size_t indexCount, const void* vertices, const size_t vertexCount, const size_t vertexSize);
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize = 16);
+
+/// <summary>
+/// Runs the cache, overdraw and fetch passes in place on mesh data about to be handed to
+/// IIndexBuffer::setData and IVertexBuffer::setData.  Returns the new vertex count.
+/// </summary>
+size_t optimizeMesh(uint32_t* indices, const size_t indexCount, void* vertices, const size_t vertexCount, const size_t vertexSize,
+	const MeshOptimizerOptions& options = MeshOptimizerOptions());
+
+#endif // mesh_optimizer_h__
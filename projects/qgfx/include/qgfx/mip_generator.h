@@ -0,0 +1,27 @@
+#ifndef mip_generator_h__
+#define mip_generator_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qgfx/api/iimage2d.h"
+
+enum class MipFilter : uint32_t
+{
+	// 2x2 average, fast but soft and prone to aliasing on high frequency content
+	Box,
+
+	// Kaiser windowed sinc over 8x8 texels, sharper mips at a higher cost
+	Kaiser
+};
+
+/// <summary>
+/// Halves an image on the CPU, used where the GPU can not blit or filter the format.  The
+/// destination is max(width / 2, 1) by max(height / 2, 1) texels.  Box filtered RGBA8 runs
+/// on SSE2 when the translation unit is compiled with it, everything else goes through a
+/// float path.
+/// </summary>
+void downsampleImage(const uint8_t* source, const uint32_t width, const uint32_t height, uint8_t* destination,
+	const ImageFormat format, const ImageDataType type, const MipFilter filter = MipFilter::Box);
+
+#endif // mip_generator_h__
@@ -1,12 +1,17 @@
 #ifndef openglcommandbuffer_h__
 #define openglcommandbuffer_h__
 
+#include <glad/glad.h>
+
 #include "qgfx/api/icommandbuffer.h"
 
+struct OpenGLVertexArray;
+struct StreamAllocation;
+
 class OpenGLCommandBuffer : public ICommandBuffer
 {
 	public:
-		explicit OpenGLCommandBuffer(ContextHandle* handle);
+		explicit OpenGLCommandBuffer(ContextHandle* handle, const CommandBufferUsage usage = CommandBufferUsage::Reusable);
 		OpenGLCommandBuffer(const OpenGLCommandBuffer&) = delete;
 		OpenGLCommandBuffer(OpenGLCommandBuffer&&) noexcept;
 
@@ -17,8 +22,30 @@ class OpenGLCommandBuffer : public ICommandBuffer
 
 		void record() override;
 		void end() override;
+		void reset() override;
+
+		void beginRenderPass(RenderPass* renderPass, FrameBuffer* frameBuffer, const ClearValue* clearValues = nullptr) override;
+		void endRenderPass() override;
+
+		void bindPipeline(Pipeline* pipeline) override;
+		void bindVertexBuffer(VertexBuffer* buffer) override;
+		void bindIndexBuffer(IndexBuffer* buffer) override;
+		void draw(const uint32_t vertexCount, const uint32_t instanceCount = 1, const uint32_t firstVertex = 0, const uint32_t firstInstance = 0) override;
+		void drawIndexed(const uint32_t indexCount, const uint32_t instanceCount = 1, const uint32_t firstIndex = 0, const int32_t vertexOffset = 0, const uint32_t firstInstance = 0) override;
+
+		/// <summary>
+		/// Attaches data written to the context's vertex stream this frame, such as per-instance
+		/// transforms, to a binding of the bound pipeline's vertex input.
+		/// </summary>
+		void bindStreamVertexBuffer(const StreamAllocation& allocation, const uint32_t binding, const uint32_t stride);
 	private:
 		bool mIsRecording;
+		GLenum mTopology;
+		GLenum mIndexType;
+		size_t mIndexSize;
+		OpenGLVertexArray* mVertexArray;
+		RenderPass* mRenderPass;
+		FrameBuffer* mFrameBuffer;
 };
 
 #endif // openglcommandbuffer_h__
\ No newline at end of file
@@ -15,9 +15,10 @@ class OpenGLCommandPool : public ICommandPool
 		OpenGLCommandPool& operator=(const OpenGLCommandPool&) = delete;
 		OpenGLCommandPool& operator=(OpenGLCommandPool&&) noexcept;
 
-		CommandBuffer* addCommandBuffer() override;
+		CommandBuffer* addCommandBuffer(const CommandBufferUsage usage = CommandBufferUsage::Reusable) override;
 		qtl::vector<CommandBuffer*> getBuffers() override;
 		void construct() override;
+		void reset() override;
 	private:
 		qtl::vector<CommandBuffer*> mBuffers;
 };
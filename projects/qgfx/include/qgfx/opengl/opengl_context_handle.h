@@ -7,6 +7,11 @@
 #include "qgfx/typedefs.h"
 #include <qtl/vector.h>
 
+class OpenGLStateTracker;
+class OpenGLVertexArrayCache;
+class OpenGLStreamBuffer;
+class RenderPassCache;
+
 /// <summary>
 /// Represents an OpenGL Context Handle.  Does not contain anything
 /// as OpenGL does not need a handle.
@@ -32,6 +37,14 @@ class OpenGLContextHandle : public IContextHandle
 
 		Pipeline* getPipeline() const override;
 		Rasterizer* getRasterizer() const override;
+		OpenGLStateTracker* getStateTracker() const;
+		OpenGLVertexArrayCache* getVertexArrayCache() const;
+		OpenGLStreamBuffer* getVertexStream() const;
+		OpenGLStreamBuffer* getIndexStream() const;
+		OpenGLStreamBuffer* getUniformStream() const;
+		OpenGLStreamBuffer* getStorageStream() const;
+		OpenGLStreamBuffer* getIndirectStream() const;
+		RenderPassCache* getRenderPassCache() const;
 
 		void initializeGraphics() override;
 		void finalizeGraphics() override;
@@ -41,9 +54,21 @@ class OpenGLContextHandle : public IContextHandle
 		void startFrame() override;
 		void endFrame() override;
 		void swap() override;
+
+		bool isImageFormatSupported(const ImageFormat format, const ImageDataType type) const override;
+		uint32_t getMaxSampleCount() const override;
+		void readBackBuffer(uint8_t* destination) override;
 	private:
 		Pipeline* mPipeline;
 		Rasterizer* mRasterizer;
+		OpenGLStateTracker* mStateTracker;
+		OpenGLVertexArrayCache* mVertexArrayCache;
+		OpenGLStreamBuffer* mVertexStream;
+		OpenGLStreamBuffer* mIndexStream;
+		OpenGLStreamBuffer* mUniformStream;
+		OpenGLStreamBuffer* mStorageStream;
+		OpenGLStreamBuffer* mIndirectStream;
+		RenderPassCache* mRenderPassCache;
 		qtl::vector<CommandPool*> mCommandPools;
 };
 
@@ -0,0 +1,49 @@
+#ifndef opengl_frame_graph_h__
+#define opengl_frame_graph_h__
+
+#include <glad/glad.h>
+
+#include <qtl/vector.h>
+
+#include "qgfx/api/iframegraph.h"
+
+/// <summary>
+/// Frame graph on OpenGL.  GL has no way to place two textures in the same memory, so aliasing
+/// reuses one texture for transient resources with identical descriptions.  The driver tracks
+/// hazards itself, framebuffers come from the context's render pass cache and attachments that
+/// are not stored are invalidated at the end of their pass.
+/// </summary>
+class OpenGLFrameGraph : public IFrameGraph
+{
+	public:
+		explicit OpenGLFrameGraph(ContextHandle* handle);
+		OpenGLFrameGraph(const OpenGLFrameGraph&) = delete;
+		~OpenGLFrameGraph();
+
+		OpenGLFrameGraph& operator=(const OpenGLFrameGraph&) = delete;
+
+		void* getImageHandle(const FrameGraphResource resource) const override;
+
+	protected:
+		bool _canAlias(const FrameGraphTextureDescription& a, const FrameGraphTextureDescription& b) const override;
+
+		void _createResources() override;
+		void _destroyResources() override;
+
+		void _beginPass(const PassNode& pass, CommandBuffer* commandBuffer) override;
+		void _endPass(const PassNode& pass, CommandBuffer* commandBuffer) override;
+		void _endExecute(CommandBuffer* commandBuffer) override;
+
+	private:
+		// Indexed by resource
+		qtl::vector<GLuint> mTextures;
+
+		// Indexed by slot
+		qtl::vector<GLuint> mSlots;
+
+		// Indexed by pass, null for passes without attachments.  Owned by the render pass cache.
+		qtl::vector<RenderPass*> mRenderPasses;
+		qtl::vector<FrameBuffer*> mFrameBuffers;
+};
+
+#endif // opengl_frame_graph_h__
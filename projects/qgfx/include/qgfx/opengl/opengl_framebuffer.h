@@ -0,0 +1,44 @@
+#ifndef opengl_framebuffer_h__
+#define opengl_framebuffer_h__
+
+#include <glad/glad.h>
+
+#include "qgfx/api/iframebuffer.h"
+
+class OpenGLFrameBuffer : public IFrameBuffer
+{
+	public:
+		explicit OpenGLFrameBuffer(ContextHandle* handle);
+		OpenGLFrameBuffer(const OpenGLFrameBuffer&) = delete;
+		~OpenGLFrameBuffer();
+
+		OpenGLFrameBuffer& operator=(const OpenGLFrameBuffer&) = delete;
+
+		void construct(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+			const uint32_t width, const uint32_t height) override;
+
+		/// <summary>
+		/// Framebuffer object name, 0 when rendering to the window
+		/// </summary>
+		GLuint getFrameBuffer() const { return mFrameBuffer; }
+
+		/// <summary>
+		/// glInvalidateFramebuffer attachment enum of an attachment in render pass order
+		/// </summary>
+		GLenum getAttachmentPoint(const uint32_t index) const;
+
+		/// <summary>
+		/// Blits the multisampled color attachments into their resolve attachments.  OpenGL has no
+		/// resolve attachments, drivers for tiled GPUs turn a blit followed by an invalidate of the
+		/// samples into an on-tile resolve.
+		/// </summary>
+		void resolve();
+
+	private:
+		GLuint mFrameBuffer;
+
+		// Holds the resolve attachments, 0 when resolving to the window
+		GLuint mResolveFrameBuffer;
+};
+
+#endif // opengl_framebuffer_h__
@@ -0,0 +1,41 @@
+#ifndef opengl_gpu_profiler_h__
+#define opengl_gpu_profiler_h__
+
+#include <glad/glad.h>
+
+#include "qgfx/api/igpuprofiler.h"
+
+/// <summary>
+/// GPU profiler on OpenGL.  Timestamps are GL_TIMESTAMP queries issued with glQueryCounter.
+/// GL has no frames in flight of its own, so the profiler keeps a ring of query sets and
+/// checks GL_QUERY_RESULT_AVAILABLE before reading, which never blocks.
+/// </summary>
+class OpenGLGpuProfiler : public IGpuProfiler
+{
+	public:
+		explicit OpenGLGpuProfiler(ContextHandle* handle, const uint32_t maxScopes = 64, const uint32_t historyLength = 60,
+			const uint32_t slotCount = 4);
+		OpenGLGpuProfiler(const OpenGLGpuProfiler&) = delete;
+		~OpenGLGpuProfiler();
+
+		OpenGLGpuProfiler& operator=(const OpenGLGpuProfiler&) = delete;
+
+		void construct() override;
+		bool isSupported() const override;
+
+	protected:
+		uint32_t _acquireSlot() override;
+		void _resetQueries(CommandBuffer* commandBuffer, const uint32_t slot) override;
+		void _writeTimestamp(CommandBuffer* commandBuffer, const uint32_t slot, const uint32_t query) override;
+		bool _getTimestamps(const uint32_t slot, const uint32_t count, double* milliseconds) override;
+
+	private:
+		uint32_t mSlotCount;
+		uint32_t mNextSlot;
+		bool mSupported;
+
+		// maxScopes * 2 query names per slot
+		qtl::vector<GLuint> mQueries;
+};
+
+#endif // opengl_gpu_profiler_h__
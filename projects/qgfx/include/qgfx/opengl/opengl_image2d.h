@@ -15,9 +15,25 @@ class OpenGLImage2D : public IImage2D
 	    OpenGLImage2D& operator=(const OpenGLImage2D&) = delete;
 	    OpenGLImage2D& operator=(OpenGLImage2D&&) noexcept;
 
-	    void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType) override;
+	    void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType,
+			const uint32_t mipLevels = 1, const uint32_t samples = 1) override;
 	    void setData(const uint8_t* data, const uint32_t dataSize) override;
+		void setMipData(const uint32_t level, const uint8_t* data, const uint32_t dataSize) override;
+		void setResidentMip(const uint32_t level) override;
+
+		void generateMips() override;
+		bool canGenerateMips() const override;
 		void* getImageHandle() const override;
+
+		uint32_t getWidth() const override { return mWidth; }
+		uint32_t getHeight() const override { return mHeight; }
+
+		/// <summary>
+		/// Whether the driver supports the format as a 2D texture, compressed formats depend on extensions
+		/// </summary>
+		static bool isFormatSupported(const ImageFormat format, const ImageDataType type);
+
+		void bind(const uint32_t unit);
 	private:
 	    GLuint mId;
 
@@ -28,8 +44,9 @@ class OpenGLImage2D : public IImage2D
 	    ImageDataType mDataType;
 };
 
-constexpr GLenum getInternalFormat(const ImageFormat format, const ImageDataType type);
-constexpr GLenum getFormat(const ImageFormat& format);
-constexpr GLenum getType(const ImageDataType& type);
+GLenum getInternalFormat(const ImageFormat format, const ImageDataType type);
+GLenum getDepthInternalFormat(const ImageType type);
+GLenum getFormat(const ImageFormat& format);
+GLenum getType(const ImageDataType& type);
 
 #endif
\ No newline at end of file
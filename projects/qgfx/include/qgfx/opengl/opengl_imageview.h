@@ -9,13 +9,16 @@ public:
 	OpenGLImageView(ContextHandle* handle);
 	OpenGLImageView(const OpenGLImageView&) = delete;
 	OpenGLImageView(OpenGLImageView&& image) noexcept;
+	~OpenGLImageView();
 
 	OpenGLImageView& operator=(const OpenGLImageView&) = delete;
 	OpenGLImageView& operator=(OpenGLImageView&& image) noexcept;
 
 	void construct(Image2D* image) override;
+
+	FrameBufferAttachment getAttachment() const override;
 private:
 	Image2D* mImage;
 };
 
-#endif // opengl_imageview_h__
\ No newline at end of file
+#endif // opengl_imageview_h__
@@ -0,0 +1,32 @@
+#ifndef opengl_indexbuffer_h__
+#define opengl_indexbuffer_h__
+
+#include <glad/glad.h>
+
+#include "qgfx/api/iindexbuffer.h"
+
+class OpenGLIndexBuffer : public IIndexBuffer
+{
+	public:
+		explicit OpenGLIndexBuffer(ContextHandle* handle);
+		OpenGLIndexBuffer(const OpenGLIndexBuffer&) = delete;
+		~OpenGLIndexBuffer();
+
+		OpenGLIndexBuffer& operator=(const OpenGLIndexBuffer&) = delete;
+
+		bool construct() override;
+
+		/// <summary>
+		/// Attaches the buffer to the currently bound vertex array, so the vertex buffer
+		/// has to be bound first.
+		/// </summary>
+		void bind() override;
+		void unbind() override;
+
+		GLuint getId() const { return mId; }
+		GLenum getOpenGLIndexType() const;
+	private:
+		GLuint mId;
+};
+
+#endif // opengl_indexbuffer_h__
@@ -0,0 +1,85 @@
+#ifndef opengl_indirect_batcher_h__
+#define opengl_indirect_batcher_h__
+
+#include <glad/glad.h>
+#include <qtl/vector.h>
+
+#include "qgfx/context_handle.h"
+
+class OpenGLPipeline;
+class OpenGLVertexBuffer;
+class OpenGLIndexBuffer;
+
+struct DrawArraysIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint first;
+	GLuint baseInstance;
+};
+
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+struct IndirectBatcherStatistics
+{
+	uint32_t draws;
+	uint32_t batches;
+
+	// Draws whose command or data did not fit the streams
+	uint32_t droppedDraws;
+};
+
+/// <summary>
+/// Merges consecutive draws sharing a pipeline, vertex buffer and index buffer into a single
+/// glMultiDrawArraysIndirect or glMultiDrawElementsIndirect call.  Commands and per-draw data are written straight into
+/// the context's indirect and storage stream buffers as draws are added.  Per-draw data is
+/// bound as a shader storage buffer and indexed with gl_DrawID in the shader.  Submit draws
+/// in DrawQueue order so compatible draws end up next to each other.
+/// </summary>
+class OpenGLIndirectBatcher
+{
+	public:
+		OpenGLIndirectBatcher(ContextHandle* handle, const size_t drawDataStride, const GLuint drawDataBinding = 0);
+		OpenGLIndirectBatcher(const OpenGLIndirectBatcher&) = delete;
+		~OpenGLIndirectBatcher() = default;
+
+		OpenGLIndirectBatcher& operator=(const OpenGLIndirectBatcher&) = delete;
+
+		void add(OpenGLPipeline* pipeline, OpenGLVertexBuffer* buffer, const uint32_t vertexCount, const uint32_t firstVertex,
+			const void* drawData = nullptr, const uint32_t instanceCount = 1);
+		void addIndexed(OpenGLPipeline* pipeline, OpenGLVertexBuffer* vertices, OpenGLIndexBuffer* indices, const uint32_t indexCount,
+			const uint32_t firstIndex, const int32_t baseVertex, const void* drawData = nullptr, const uint32_t instanceCount = 1);
+		void flush();
+
+		const IndirectBatcherStatistics& getStatistics() const { return mStatistics; }
+		void resetStatistics() { mStatistics = {}; }
+	private:
+		struct Batch
+		{
+			OpenGLPipeline* pipeline;
+			OpenGLVertexBuffer* buffer;
+			OpenGLIndexBuffer* indices;
+			GLintptr commandOffset;
+			GLintptr dataOffset;
+			size_t dataSize;
+			uint32_t count;
+		};
+
+		ContextHandle* mHandle;
+		size_t mDrawDataStride;
+		GLuint mDrawDataBinding;
+		qtl::vector<Batch> mBatches;
+		IndirectBatcherStatistics mStatistics;
+
+		void _add(OpenGLPipeline* pipeline, OpenGLVertexBuffer* buffer, OpenGLIndexBuffer* indices, const void* command,
+			const size_t commandSize, const void* drawData);
+};
+
+#endif // opengl_indirect_batcher_h__
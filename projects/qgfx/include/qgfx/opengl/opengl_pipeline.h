@@ -4,6 +4,8 @@
 #include "qgfx/api/ipipeline.h"
 #include "qgfx/opengl/opengl_shader.h"
 
+struct OpenGLVertexArray;
+
 #include <qtl/vector.h>
 
 class OpenGLPipeline : public IPipeline
@@ -20,8 +22,21 @@ class OpenGLPipeline : public IPipeline
 		Shader* addShader() override;
 		void construct() override;
 		void setTopology(const Topology& topology) override;
+		void setPrimitiveRestart(const bool enabled) override;
+
+		void bind();
+		GLenum getTopology() const;
+
+		/// <summary>
+		/// Vertex array built from the pipeline's vertex layouts, or nullptr when the pipeline
+		/// has none and vertex buffers use their own single stream vertex array.
+		/// </summary>
+		OpenGLVertexArray* getVertexArray() const { return mVertexArray; }
 	private:
 		qtl::vector<Shader*> mShaders;
+		GLenum mTopology;
+		bool mPrimitiveRestart;
+		OpenGLVertexArray* mVertexArray;
 };
 
 #endif // opengl_pipeline_h__
\ No newline at end of file
@@ -19,13 +19,20 @@ class OpenGLRasterizer : public IRasterizer
 		void setPolygonMode(const PolygonMode mode, const CullMode face) override;
 		void setLineWidth(const float lineWidth) override;
 		void setDepthTest(const bool enabled) override;
+		void setDepthWrite(const bool enabled) override;
+		void setDepthCompare(const CompareOp op) override;
+		void setStencilTest(const bool enabled, const StencilState& front = StencilState(), const StencilState& back = StencilState()) override;
+		void setColorWrite(const bool enabled) override;
+		void setReverseZ(const bool enabled) override;
+
+		/// <summary>
+		/// Pushes the depth, stencil and color write state through the state tracker again,
+		/// used after a clear had to override the write masks.
+		/// </summary>
+		void apply();
+
 	private:
-		CullMode mCulling = CullMode::Back;
-		FrontFace mFace = FrontFace::CounterClockwise;
-		PolygonMode mFillMode = PolygonMode::Fill;
-		CullMode mFillFace = CullMode::FrontAndBack;
-		float mLineWidth = 1.0f;
-		bool mDepthEnabled = false;
+		void _applyStencil(const GLenum face, const StencilState& state);
 };
 
 #endif // opengl_rasterizer_h__
\ No newline at end of file
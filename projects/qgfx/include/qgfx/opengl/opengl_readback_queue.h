@@ -0,0 +1,49 @@
+#ifndef opengl_readback_queue_h__
+#define opengl_readback_queue_h__
+
+#include <glad/glad.h>
+
+#include "qgfx/api/ireadbackqueue.h"
+
+/// <summary>
+/// Readback queue on OpenGL.  Each slot is a pixel buffer object in client memory that
+/// glReadPixels or glGetTextureImage copies into asynchronously, followed by a fence.  The
+/// buffers stay persistently mapped, so collecting a result is a memcpy out of cached memory.
+/// </summary>
+class OpenGLReadbackQueue : public IReadbackQueue
+{
+	public:
+		explicit OpenGLReadbackQueue(ContextHandle* handle, const uint32_t slotCount = 3);
+		OpenGLReadbackQueue(const OpenGLReadbackQueue&) = delete;
+		~OpenGLReadbackQueue();
+
+		OpenGLReadbackQueue& operator=(const OpenGLReadbackQueue&) = delete;
+
+		void construct() override;
+
+	protected:
+		void _reserve(const uint32_t slot, const size_t size) override;
+
+		bool _copyBackBuffer(const uint32_t slot) override;
+		void _copyImage(const uint32_t slot, Image2D* image) override;
+
+		bool _isComplete(const uint32_t slot) override;
+		void _wait(const uint32_t slot) override;
+
+		const uint8_t* _getData(const uint32_t slot) override;
+
+	private:
+		struct Buffer
+		{
+			GLuint id;
+			size_t capacity;
+			const uint8_t* mapped;
+			GLsync fence;
+		};
+
+		qtl::vector<Buffer> mBuffers;
+
+		void _fence(const uint32_t slot);
+};
+
+#endif // opengl_readback_queue_h__
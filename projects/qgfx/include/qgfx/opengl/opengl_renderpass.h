@@ -0,0 +1,22 @@
+#ifndef opengl_renderpass_h__
+#define opengl_renderpass_h__
+
+#include "qgfx/api/irenderpass.h"
+
+/// <summary>
+/// OpenGL has no render pass object.  The description is kept so the command buffer can
+/// clear on begin and invalidate DontCare attachments on end.
+/// </summary>
+class OpenGLRenderPass : public IRenderPass
+{
+	public:
+		explicit OpenGLRenderPass(ContextHandle* handle);
+		OpenGLRenderPass(const OpenGLRenderPass&) = delete;
+		~OpenGLRenderPass() = default;
+
+		OpenGLRenderPass& operator=(const OpenGLRenderPass&) = delete;
+
+		void construct(const RenderPassDescription& description) override;
+};
+
+#endif // opengl_renderpass_h__
@@ -0,0 +1,162 @@
+#ifndef opengl_state_tracker_h__
+#define opengl_state_tracker_h__
+
+#include <glad/glad.h>
+
+#include <stdint.h>
+
+struct OpenGLVertexArray;
+
+struct OpenGLStateStatistics
+{
+	uint32_t issued;
+	uint32_t skipped;
+};
+
+/// <summary>
+/// Shadow copy of the OpenGL binding and raster state. Every backend call that changes
+/// bound objects or raster state goes through the tracker, which drops calls that would
+/// not change anything and counts issued and skipped calls per frame.
+/// </summary>
+class OpenGLStateTracker
+{
+	public:
+		static constexpr uint32_t maxTextureUnits = 32;
+		static constexpr uint32_t maxBufferBindings = 16;
+
+		OpenGLStateTracker();
+		OpenGLStateTracker(const OpenGLStateTracker&) = delete;
+		~OpenGLStateTracker() = default;
+
+		OpenGLStateTracker& operator=(const OpenGLStateTracker&) = delete;
+
+		void useProgram(const GLuint program);
+		void bindVertexArray(const GLuint vao);
+		void bindBuffer(const GLenum target, const GLuint buffer);
+		void bindVertexBuffer(OpenGLVertexArray* vao, const GLuint binding, const GLuint buffer, const GLintptr offset, const GLsizei stride);
+		void bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size);
+		void bindTexture(const GLuint unit, const GLuint texture);
+		void bindFramebuffer(const GLuint framebuffer);
+		void setViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
+
+		void setEnabled(const GLenum capability, const bool enabled);
+		void setCullFace(const GLenum face);
+		void setFrontFace(const GLenum face);
+		void setPolygonMode(const GLenum face, const GLenum mode);
+		void setLineWidth(const float width);
+		void setDepthMask(const bool enabled);
+		void setDepthFunc(const GLenum func);
+		void setColorMask(const bool enabled);
+		void setStencilFunc(const GLenum face, const GLenum func, const GLint reference, const GLuint mask);
+		void setStencilOp(const GLenum face, const GLenum fail, const GLenum depthFail, const GLenum pass);
+		void setStencilMask(const GLenum face, const GLuint mask);
+		void setClipControl(const GLenum depth);
+
+		/// <summary>
+		/// Row alignment of pixel data read from (unpack) and written to (pack) client memory.
+		/// </summary>
+		void setPixelStore(const GLenum name, const GLint alignment);
+
+		/// <summary>
+		/// Drops every shadowed binding of an object that is about to be deleted.  OpenGL
+		/// unbinds deleted objects and hands their names out again, a stale shadow would
+		/// filter out the first bind of the object that reuses the name.
+		/// </summary>
+		void forgetTexture(const GLuint texture);
+		void forgetBuffer(const GLuint buffer);
+		void forgetFramebuffer(const GLuint framebuffer);
+		void forgetProgram(const GLuint program);
+		void forgetVertexArray(const GLuint vao);
+
+		/// <summary>
+		/// Forgets all shadowed state, so that the next call of every setter reaches the driver.
+		/// Must be called after any code outside of qgfx has touched OpenGL state directly.
+		/// </summary>
+		void invalidate();
+
+		void beginFrame();
+		void endFrame();
+
+		const OpenGLStateStatistics& getStatistics() const { return mStatistics; }
+		const OpenGLStateStatistics& getLastFrameStatistics() const { return mLastFrameStatistics; }
+
+	private:
+		struct BufferRange
+		{
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+		enum BufferTarget : uint32_t
+		{
+			ArrayBuffer,
+			ElementArrayBuffer,
+			UniformBuffer,
+			ShaderStorageBuffer,
+			DrawIndirectBuffer,
+			PixelPackBuffer,
+			PixelUnpackBuffer,
+			CopyReadBuffer,
+			CopyWriteBuffer,
+			BufferTargetCount
+		};
+
+		// Masks are wider than GL's so that -1 can stand for an unknown mask
+		struct StencilFace
+		{
+			GLenum func;
+			GLint reference;
+			int64_t compareMask;
+			GLenum fail;
+			GLenum depthFail;
+			GLenum pass;
+			int64_t writeMask;
+		};
+
+		enum Capability : uint32_t
+		{
+			CullFace,
+			DepthTest,
+			StencilTest,
+			Blend,
+			ScissorTest,
+			PrimitiveRestart,
+			CapabilityCount
+		};
+
+		GLuint mProgram;
+		GLuint mVertexArray;
+		GLuint mBuffers[BufferTargetCount];
+		BufferRange mUniformRanges[maxBufferBindings];
+		BufferRange mStorageRanges[maxBufferBindings];
+		GLuint mTextures[maxTextureUnits];
+		GLuint mFramebuffer;
+		GLint mViewport[4];
+
+		// Flags are GL_TRUE, GL_FALSE or -1 when unknown
+		GLint mCapabilities[CapabilityCount];
+		GLenum mCullFace;
+		GLenum mFrontFace;
+		GLenum mPolygonModeFace;
+		GLenum mPolygonMode;
+		float mLineWidth;
+		GLint mDepthMask;
+		GLenum mDepthFunc;
+		GLint mColorMask;
+		StencilFace mStencil[2];
+		GLenum mClipDepth;
+		GLint mPackAlignment;
+		GLint mUnpackAlignment;
+
+		OpenGLStateStatistics mStatistics;
+		OpenGLStateStatistics mLastFrameStatistics;
+
+		bool _filter(const bool changed);
+
+		static uint32_t _getBufferTarget(const GLenum target);
+		static uint32_t _getCapability(const GLenum capability);
+		static bool _getStencilFaces(const GLenum face, uint32_t& first, uint32_t& last);
+};
+
+#endif // opengl_state_tracker_h__
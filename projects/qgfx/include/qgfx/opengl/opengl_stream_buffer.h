@@ -0,0 +1,89 @@
+#ifndef opengl_stream_buffer_h__
+#define opengl_stream_buffer_h__
+
+#include <glad/glad.h>
+
+#include "qgfx/context_handle.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct OpenGLVertexArray;
+
+/// <summary>
+/// Data is null when the allocation failed
+/// </summary>
+struct StreamAllocation
+{
+	void* data;
+	GLintptr offset;
+	size_t size;
+};
+
+struct StreamBufferStatistics
+{
+	size_t bytesWritten;
+	uint32_t allocations;
+	uint32_t fenceWaits;
+
+	// Regions moved to in the middle of a frame, and allocations that fit nowhere
+	uint32_t overflows;
+	uint32_t failedAllocations;
+};
+
+/// <summary>
+/// Persistently mapped ring of regions for data rewritten every frame.  Each frame writes
+/// into its own region, which is fenced at the end of the frame and only reused once the
+/// GPU has signalled that fence, so writes go straight into GPU visible memory.  A frame that
+/// fills its region carries on in the next one, after waiting for the GPU to be done with it.
+/// </summary>
+class OpenGLStreamBuffer
+{
+	public:
+		OpenGLStreamBuffer(ContextHandle* handle, const GLenum target, const size_t regionSize, const uint32_t regionCount = 3);
+		OpenGLStreamBuffer(const OpenGLStreamBuffer&) = delete;
+		~OpenGLStreamBuffer();
+
+		OpenGLStreamBuffer& operator=(const OpenGLStreamBuffer&) = delete;
+
+		bool construct();
+
+		/// <summary>
+		/// Reserves size bytes in the current region.  An alignment of zero uses the
+		/// alignment required by the buffer target.  Fails when size exceeds a region or every
+		/// region is already used by the current frame, check the returned data.
+		/// </summary>
+		StreamAllocation allocate(const size_t size, const size_t alignment = 0);
+
+		void bindVertexBuffer(OpenGLVertexArray* vao, const GLuint binding, const StreamAllocation& allocation, const GLsizei stride);
+		void bindRange(const GLuint index, const StreamAllocation& allocation);
+
+		void beginFrame();
+		void endFrame();
+
+		GLuint getBuffer() const { return mId; }
+		GLenum getTarget() const { return mTarget; }
+		size_t getRegionSize() const { return mRegionSize; }
+		size_t getAlignment() const { return mAlignment; }
+		const StreamBufferStatistics& getStatistics() const { return mStatistics; }
+	private:
+		ContextHandle* mHandle;
+		GLuint mId;
+		GLenum mTarget;
+		size_t mRegionSize;
+		size_t mAlignment;
+		uint32_t mRegionCount;
+		uint32_t mRegion;
+
+		// Regions written by the current frame, starting at mFirstRegion
+		uint32_t mFirstRegion;
+		uint32_t mFrameRegions;
+		size_t mHead;
+		uint8_t* mMapped;
+		GLsync* mFences;
+		StreamBufferStatistics mStatistics;
+
+		void _wait(const uint32_t region);
+};
+
+#endif // opengl_stream_buffer_h__
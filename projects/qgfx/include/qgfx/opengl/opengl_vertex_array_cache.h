@@ -0,0 +1,51 @@
+#ifndef opengl_vertex_array_cache_h__
+#define opengl_vertex_array_cache_h__
+
+#include <glad/glad.h>
+#include <qtl/tree_map.h>
+
+#include "qgfx/api/ivertexbuffer.h"
+
+class OpenGLStateTracker;
+
+struct OpenGLVertexArray
+{
+	static constexpr uint32_t maxBindings = 16;
+
+	GLuint id;
+	GLuint buffers[maxBindings];
+	GLintptr offsets[maxBindings];
+	GLsizei strides[maxBindings];
+};
+
+/// <summary>
+/// Owns one vertex array object per distinct set of vertex layouts.  Vertex buffers sharing
+/// a layout share the vertex array object and only swap the buffers attached to it.
+/// </summary>
+class OpenGLVertexArrayCache
+{
+	public:
+		explicit OpenGLVertexArrayCache(OpenGLStateTracker* tracker);
+		OpenGLVertexArrayCache(const OpenGLVertexArrayCache&) = delete;
+		~OpenGLVertexArrayCache();
+
+		OpenGLVertexArrayCache& operator=(const OpenGLVertexArrayCache&) = delete;
+
+		OpenGLVertexArray* acquire(const VertexBufferLayout& layout);
+		OpenGLVertexArray* acquire(const qtl::vector<VertexBufferLayout>& layouts);
+		size_t size() const { return mVertexArrays.size(); }
+
+		/// <summary>
+		/// Drops the shadowed vertex buffer bindings of a buffer that is about to be deleted
+		/// </summary>
+		void forgetBuffer(const GLuint buffer);
+	private:
+		OpenGLStateTracker* mStateTracker;
+		qtl::tree_map<uint64_t, OpenGLVertexArray*> mVertexArrays;
+
+		OpenGLVertexArray* _acquire(const VertexBufferLayout* layouts, const size_t count);
+
+		static OpenGLVertexArray* _create(const VertexBufferLayout* layouts, const size_t count);
+};
+
+#endif // opengl_vertex_array_cache_h__
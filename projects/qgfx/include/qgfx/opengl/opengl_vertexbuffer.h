@@ -5,6 +5,8 @@
 
 #include "qgfx/api/ivertexbuffer.h"
 
+struct OpenGLVertexArray;
+
 class OpenGLVertexBuffer : public IVertexBuffer
 {
 	public:
@@ -17,17 +19,27 @@ class OpenGLVertexBuffer : public IVertexBuffer
 		OpenGLVertexBuffer& operator=(OpenGLVertexBuffer&&) noexcept;
 
 		void setData(void* data, const size_t size) override;
+		void setExternalData(const void* data, const size_t size) override;
 		void setLayout(const VertexBufferLayout& layout) override;
 		bool construct() override;
 
 		VertexBufferLayout& getLayout() override;
 		void bind() override;
 		void unbind() override;
+
+		/// <summary>
+		/// Attaches the buffer to its binding on a vertex array built from several streams.
+		/// </summary>
+		void bind(OpenGLVertexArray* vao);
 	private:
 		GLuint mId;
+		OpenGLVertexArray* mVertexArray = nullptr;
 		VertexBufferLayout mLayout;
-		void * mData = nullptr;
+		const void* mData = nullptr;
+		bool mOwnsData = false;
 		size_t mSize = 0;
+
+		void _releaseData();
 };
 
 #endif // opengl_vertexbuffer_h__
\ No newline at end of file
@@ -16,8 +16,17 @@ class OpenGLWindow : public IWindow
 	    void* getPlatformHandle() const override;;
 	    bool shouldClose() const override;
 	    void poll() const override;
+
+	    uint32_t getWidth() const override;
+	    uint32_t getHeight() const override;
+	    bool isHeadless() const override;
     private:
 	    GLFWwindow* mHandle = nullptr;
+	    uint32_t mWidth = 0;
+	    uint32_t mHeight = 0;
+	    bool mHeadless = false;
+
+	    void _create(const uint32_t width, const uint32_t height, const qtl::string& title, const bool vsync, const bool headless);
 };
 
 #endif
\ No newline at end of file
@@ -21,24 +21,42 @@
 #endif
 
 #include "qgfx/context_handle.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/depth_prepass.h"
+#include "qgfx/draw_queue.h"
 #include "qgfx/shader_loader.h"
 #include "qgfx/qassert.h"
+#include "qgfx/render_pass_cache.h"
 
 #include "qgfx/typedefs.h"
 
 #if defined(QGFX_OPENGL)
 #include "qgfx/opengl/opengl_commandbuffer.h"
 #include "qgfx/opengl/opengl_commandpool.h"
+#include "qgfx/opengl/opengl_frame_graph.h"
+#include "qgfx/opengl/opengl_framebuffer.h"
+#include "qgfx/opengl/opengl_gpu_profiler.h"
+#include "qgfx/opengl/opengl_imageview.h"
+#include "qgfx/opengl/opengl_indexbuffer.h"
 #include "qgfx/opengl/opengl_pipeline.h"
 #include "qgfx/opengl/opengl_rasterizer.h"
+#include "qgfx/opengl/opengl_readback_queue.h"
+#include "qgfx/opengl/opengl_renderpass.h"
 #include "qgfx/opengl/opengl_shader.h"
 #include "qgfx/opengl/opengl_vertexbuffer.h"
 #include "qgfx/opengl/opengl_window.h"
 #elif defined(QGFX_VULKAN)
 #include "qgfx/vulkan/vulkan_commandbuffer.h"
 #include "qgfx/vulkan/vulkan_commandpool.h"
+#include "qgfx/vulkan/vulkan_frame_graph.h"
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/vulkan/vulkan_gpu_profiler.h"
+#include "qgfx/vulkan/vulkan_imageview.h"
+#include "qgfx/vulkan/vulkan_indexbuffer.h"
 #include "qgfx/vulkan/vulkan_pipeline.h"
 #include "qgfx/vulkan/vulkan_rasterizer.h"
+#include "qgfx/vulkan/vulkan_readback_queue.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
 #include "qgfx/vulkan/vulkan_shader.h"
 #include "qgfx/vulkan/vulkan_vertexbuffer.h"
 #include "qgfx/vulkan/vulkan_window.h"
@@ -0,0 +1,58 @@
+#ifndef render_pass_cache_h__
+#define render_pass_cache_h__
+
+#include <stdint.h>
+
+#include <qtl/tree_map.h>
+
+#include "qgfx/api/iframebuffer.h"
+#include "qgfx/api/irenderpass.h"
+#include "qgfx/context_handle.h"
+#include "qgfx/typedefs.h"
+
+struct RenderPassCacheStatistics
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint32_t evictions;
+};
+
+/// <summary>
+/// Owns every render pass and framebuffer of a context.  Render passes are keyed by their
+/// attachment formats and load/store ops, framebuffers by render pass, size and attachment
+/// views, so an offscreen pass is created the first time it is used and reused every frame
+/// after.  Framebuffers hold on to their views, evict a view before destroying it.
+/// </summary>
+class RenderPassCache
+{
+	public:
+		explicit RenderPassCache(ContextHandle* handle);
+		RenderPassCache(const RenderPassCache&) = delete;
+		~RenderPassCache();
+
+		RenderPassCache& operator=(const RenderPassCache&) = delete;
+
+		RenderPass* acquire(const RenderPassDescription& description);
+		FrameBuffer* acquire(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+			const uint32_t width, const uint32_t height);
+
+		/// <summary>
+		/// Destroys the framebuffers that use a view.  The GPU must be done with them.
+		/// </summary>
+		void evict(const void* view);
+		void clear();
+
+		size_t getRenderPassCount() const { return mRenderPasses.size(); }
+		size_t getFrameBufferCount() const { return mFrameBuffers.size(); }
+
+		const RenderPassCacheStatistics& getStatistics() const { return mStatistics; }
+	private:
+		ContextHandle* mHandle;
+
+		qtl::tree_map<uint64_t, RenderPass*> mRenderPasses;
+		qtl::tree_map<uint64_t, FrameBuffer*> mFrameBuffers;
+
+		RenderPassCacheStatistics mStatistics;
+};
+
+#endif // render_pass_cache_h__
@@ -0,0 +1,120 @@
+#ifndef texture_streamer_h__
+#define texture_streamer_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <qtl/vector.h>
+
+#include "qgfx/api/iimage2d.h"
+
+/// <summary>
+/// Provides the texel data of a streamed image one mip level at a time.  readMip is called
+/// on the streamer's I/O thread and has to fill exactly getMipSize(level) bytes.
+/// </summary>
+class TextureStreamSource
+{
+	public:
+		virtual ~TextureStreamSource() = default;
+
+		virtual uint32_t getMipSize(const uint32_t level) const = 0;
+		virtual bool readMip(const uint32_t level, uint8_t* destination) = 0;
+};
+
+struct TextureStreamerStatistics
+{
+	// Uploads done by the last update()
+	uint64_t bytesUploaded;
+	uint32_t mipsUploaded;
+
+	// Uploads that were ready but pushed to a later frame by the budget
+	uint32_t mipsDeferred;
+
+	uint32_t pendingReads;
+	uint32_t pendingUploads;
+
+	uint64_t totalBytesUploaded;
+	uint32_t failedReads;
+};
+
+/// <summary>
+/// Streams image mip chains in from a background I/O thread.  Mips are read smallest first
+/// across all images, so every streamed image gets its mip tail before any image gets finer
+/// detail.  Finished reads are uploaded by update() on the render thread, at most frameBudget
+/// bytes per frame except for the mip tail, and each image's resident mip moves down once a
+/// finer level has been uploaded.
+/// </summary>
+class TextureStreamer
+{
+	public:
+		explicit TextureStreamer(const size_t frameBudget = 4 * 1024 * 1024, const size_t mipTailSize = 64 * 1024);
+		TextureStreamer(const TextureStreamer&) = delete;
+		~TextureStreamer();
+
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+		/// <summary>
+		/// Queues every level of an image constructed with its full mip count.  The source has to
+		/// outlive the stream, until isStreaming returns false or the image is cancelled.  Images
+		/// are streamed and cancelled on the render thread, which owns their resident mips.
+		/// </summary>
+		void stream(IImage2D* image, TextureStreamSource* source);
+		void cancel(IImage2D* image);
+		bool isStreaming(IImage2D* image);
+
+		/// <summary>
+		/// Uploads finished reads within the frame budget.  Call once per frame on the render thread.
+		/// </summary>
+		void update();
+
+		void setFrameBudget(const size_t bytes) { mFrameBudget = bytes; }
+		size_t getFrameBudget() const { return mFrameBudget; }
+
+		const TextureStreamerStatistics& getStatistics() const { return mStatistics; }
+	private:
+		struct StreamJob
+		{
+			IImage2D* image;
+			TextureStreamSource* source;
+			uint32_t level;
+			uint32_t size;
+			bool tail;
+			uint8_t* data;
+		};
+
+		// Finest level uploaded so far, the mip count until the first upload
+		struct StreamedImage
+		{
+			IImage2D* image;
+			uint32_t resident;
+		};
+
+		size_t mFrameBudget;
+		size_t mMipTailSize;
+
+		std::thread mThread;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mRunning;
+
+		qtl::vector<StreamJob> mReads;
+		qtl::vector<StreamJob> mUploads;
+
+		// Only touched on the render thread
+		qtl::vector<StreamedImage> mImages;
+
+		// Image whose mip is being read outside of the lock
+		IImage2D* mReading;
+		uint32_t mFailedReads;
+
+		TextureStreamerStatistics mStatistics;
+
+		void _forget(IImage2D* image);
+		void _run();
+};
+
+#endif // texture_streamer_h__
@@ -0,0 +1,23 @@
+#ifndef texture_transcoder_h__
+#define texture_transcoder_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qgfx/api/iimage2d.h"
+
+/// <summary>
+/// Whether transcodeImage can decode the format.  BC1 to BC5 (unorm only) and ETC2 are
+/// supported, BC6H, BC7 and ASTC have no CPU fallback.
+/// </summary>
+bool canTranscodeImageFormat(const ImageFormat format, const ImageDataType type);
+
+/// <summary>
+/// Decodes one block compressed mip level to RGBA8 on the CPU, for devices that can not sample
+/// the format.  The destination holds width * height tightly packed texels and is meant to be
+/// uploaded as ImageFormat::RGBA with ImageDataType::UInt8_8_8_8.
+/// </summary>
+void transcodeImage(const uint8_t* source, const uint32_t width, const uint32_t height, uint8_t* destination,
+	const ImageFormat format, const ImageDataType type);
+
+#endif // texture_transcoder_h__
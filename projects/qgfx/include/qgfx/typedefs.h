@@ -6,39 +6,65 @@ class OpenGLPipeline;
 class OpenGLRasterizer;
 class OpenGLShader;
 class OpenGLVertexBuffer;
+class OpenGLIndexBuffer;
 class OpenGLCommandPool;
 class OpenGLCommandBuffer;
 class OpenGLWindow;
 class OpenGLImage2D;
+class OpenGLFrameGraph;
+class OpenGLReadbackQueue;
+class OpenGLGpuProfiler;
+class OpenGLImageView;
+class OpenGLRenderPass;
+class OpenGLFrameBuffer;
 
 using Pipeline = OpenGLPipeline;
 using Rasterizer = OpenGLRasterizer;
 using Shader = OpenGLShader;
 using VertexBuffer = OpenGLVertexBuffer;
+using IndexBuffer = OpenGLIndexBuffer;
 using CommandPool = OpenGLCommandPool;
 using CommandBuffer = OpenGLCommandBuffer;
 using Window = OpenGLWindow;
 using Image2D = OpenGLImage2D;
+using FrameGraph = OpenGLFrameGraph;
+using ReadbackQueue = OpenGLReadbackQueue;
+using GpuProfiler = OpenGLGpuProfiler;
+using ImageView = OpenGLImageView;
+using RenderPass = OpenGLRenderPass;
+using FrameBuffer = OpenGLFrameBuffer;
 #elif defined(QGFX_VULKAN)
 class VulkanPipeline;
 class VulkanRasterizer;
 class VulkanShader;
 class VulkanVertexBuffer;
+class VulkanIndexBuffer;
 class VulkanCommandPool;
 class VulkanCommandBuffer;
 class VulkanWindow;
 class VulkanRenderPass;
 class VulkanImage2D;
+class VulkanFrameGraph;
+class VulkanReadbackQueue;
+class VulkanGpuProfiler;
+class VulkanImageView;
+class VulkanFrameBuffer;
 
 using Pipeline = VulkanPipeline;
 using Rasterizer = VulkanRasterizer;
 using Shader = VulkanShader;
 using VertexBuffer = VulkanVertexBuffer;
+using IndexBuffer = VulkanIndexBuffer;
 using CommandPool = VulkanCommandPool;
 using CommandBuffer = VulkanCommandBuffer;
 using Window = VulkanWindow;
 using RenderPass = VulkanRenderPass;
 using Image2D = VulkanImage2D;
+using FrameGraph = VulkanFrameGraph;
+using ReadbackQueue = VulkanReadbackQueue;
+using GpuProfiler = VulkanGpuProfiler;
+using ImageView = VulkanImageView;
+using FrameBuffer = VulkanFrameBuffer;
 #endif
 
 #endif // typedefs_h__
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef vertex_compression_h__
+#define vertex_compression_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qgfx/api/ivertexbuffer.h"
+
+/// <summary>
+/// Uncompressed vertex streams to compress.  Positions and normals are three floats per
+/// vertex, tangents four (xyz and the bitangent sign in w) and uvs two.  Any stream but the
+/// positions may be null, in which case it is left out of the compressed layout.
+/// </summary>
+struct VertexCompressionInput
+{
+	const float* positions;
+	const float* normals;
+	const float* tangents;
+	const float* uvs;
+	size_t vertexCount;
+};
+
+struct VertexCompressionStatistics
+{
+	size_t vertexCount;
+	size_t uncompressedStride;
+	size_t compressedStride;
+	size_t uncompressedBytes;
+	size_t compressedBytes;
+	double milliseconds;
+};
+
+/// <summary>
+/// Interleaved compressed vertices and the layout describing them.
+///
+/// position : unorm16 x4, relative to the mesh bounds, w is always one.
+///            Decode with positionMin + position.xyz * positionExtent.
+/// normal   : snorm16 x2, octahedral encoded
+/// tangent  : snorm8 x4, octahedral encoded xy, bitangent sign in z
+/// uv       : half x2
+/// </summary>
+class CompressedVertices
+{
+	public:
+		CompressedVertices() = default;
+		CompressedVertices(const CompressedVertices&) = delete;
+		~CompressedVertices();
+
+		CompressedVertices& operator=(const CompressedVertices&) = delete;
+
+		VertexBufferLayout layout;
+		float positionMin[3] = { 0.0f, 0.0f, 0.0f };
+		float positionExtent[3] = { 0.0f, 0.0f, 0.0f };
+
+		uint8_t* data = nullptr;
+		size_t size = 0;
+		size_t vertexCount = 0;
+};
+
+/// <summary>
+/// Quantizes and interleaves the input streams.  The hot loops use AVX2 and F16C when the
+/// CPU has them, SSE2 otherwise, and scalar code for the remainder.  Every path rounds to
+/// nearest even, so the output does not depend on the CPU.
+/// </summary>
+void compressVertices(const VertexCompressionInput& input, CompressedVertices& output, VertexCompressionStatistics* statistics = nullptr);
+
+uint16_t floatToHalf(const float value);
+float halfToFloat(const uint16_t value);
+
+void encodeOctahedral(const float x, const float y, const float z, float& u, float& v);
+void decodeOctahedral(const float u, const float v, float& x, float& y, float& z);
+
+#endif // vertex_compression_h__
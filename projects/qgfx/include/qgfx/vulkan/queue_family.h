@@ -44,7 +44,15 @@ inline QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice device, const
 		}
 
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		if (surface != VK_NULL_HANDLE)
+		{
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		}
+		else
+		{
+			// Headless contexts never present, the graphics queue stands in for the present queue
+			presentSupport = indices.graphicsFamily == static_cast<uint32_t>(i);
+		}
 
 		if (queueFamily.queueCount > 0 && presentSupport)
 		{
@@ -7,11 +7,21 @@
 class VulkanCommandBuffer : public ICommandBuffer
 {
 	public:
-		explicit VulkanCommandBuffer(ContextHandle* handle);
+		explicit VulkanCommandBuffer(ContextHandle* handle, const CommandBufferUsage usage = CommandBufferUsage::Reusable);
 		~VulkanCommandBuffer();
 
 		void record() override;
 		void end() override;
+		void reset() override;
+
+		void beginRenderPass(RenderPass* renderPass, FrameBuffer* frameBuffer, const ClearValue* clearValues = nullptr) override;
+		void endRenderPass() override;
+
+		void bindPipeline(Pipeline* pipeline) override;
+		void bindVertexBuffer(VertexBuffer* buffer) override;
+		void bindIndexBuffer(IndexBuffer* buffer) override;
+		void draw(const uint32_t vertexCount, const uint32_t instanceCount = 1, const uint32_t firstVertex = 0, const uint32_t firstInstance = 0) override;
+		void drawIndexed(const uint32_t indexCount, const uint32_t instanceCount = 1, const uint32_t firstIndex = 0, const int32_t vertexOffset = 0, const uint32_t firstInstance = 0) override;
 
 		VkCommandBuffer getBuffer() const;
 
@@ -19,6 +29,9 @@ class VulkanCommandBuffer : public ICommandBuffer
 		friend class VulkanCommandPool;
 
 		VkCommandBuffer mBuffer;
+
+		bool mResettable;
+		bool mRecorded;
 };
 
-#endif // vulkan_commandbuffer_h__
\ No newline at end of file
+#endif // vulkan_commandbuffer_h__
@@ -12,12 +12,16 @@ class VulkanCommandPool : public ICommandPool
 		explicit VulkanCommandPool(ContextHandle* handle);
 		~VulkanCommandPool();
 
-		CommandBuffer* addCommandBuffer() override;
+		CommandBuffer* addCommandBuffer(const CommandBufferUsage usage = CommandBufferUsage::Reusable) override;
 		qtl::vector<CommandBuffer*> getBuffers() override;
 		void construct() override;
+		void reset() override;
+
+		VkCommandPool getPool() const;
 
 	private:
 		VkCommandPool mCommandPool;
+		VkCommandPoolCreateFlags mFlags;
 		qtl::vector<VkCommandBuffer> mVulkanBuffers;
 		qtl::vector<CommandBuffer*> mBuffers;
 };
@@ -10,6 +10,10 @@
 
 class VulkanRasterizer;
 class VulkanPipeline;
+class VulkanImageStateTracker;
+class VulkanUploadRing;
+class VulkanFrameBuffer;
+class RenderPassCache;
 /// <summary>
 /// Represents an Vulkan Context Handle. Contains all the initialization objects
 /// that Vulkan needs to bind to a window and render.
@@ -47,6 +51,14 @@ class VulkanContextHandle : public IContextHandle
 
 		void swap() override;
 
+		bool isImageFormatSupported(const ImageFormat format, const ImageDataType type) const override;
+		uint32_t getMaxSampleCount() const override;
+
+		/// <summary>
+		/// Only headless contexts can read back, their offscreen images are created as copy sources
+		/// </summary>
+		void readBackBuffer(uint8_t* destination) override;
+
 		/// <summary>
 		/// Returns the current Vulkan Instance
 		/// </summary>
@@ -75,7 +87,13 @@ class VulkanContextHandle : public IContextHandle
 		VkExtent2D getSwapChainExtent() const;
 		VkFormat getSwapChainFormat() const;
 
-		qtl::vector<VkFramebuffer> getSwapChainFramebuffers() const;
+		/// <summary>
+		/// Layout the swap chain images are left in at the end of a render pass.  Headless
+		/// contexts render into offscreen images that are left ready to be copied from.
+		/// </summary>
+		VkImageLayout getSwapChainLayout() const;
+
+		qtl::vector<VulkanFrameBuffer*> getSwapChainFramebuffers() const;
 
 		qtl::vector<VkSemaphore> getImageSemaphore() const;
 		qtl::vector<VkSemaphore> getRenderSemaphore() const;
@@ -85,6 +103,27 @@ class VulkanContextHandle : public IContextHandle
 		VkQueue getPresentQueue() const;
 
 		VkSurfaceKHR getSurface() const;
+
+		/// <summary>
+		/// Returns the index of the swap chain image acquired by the last startFrame()
+		/// </summary>
+		/// <returns>
+		/// Returns the current swap chain image index
+		/// </returns>
+		uint32_t getCurrentImageIndex() const;
+		VkImage getCurrentSwapChainImage() const;
+
+		/// <summary>
+		/// Records one off work outside of the frame's command buffers.  endSingleTimeCommands
+		/// submits to the graphics queue and waits for it to finish, uploads made while rendering
+		/// go through the upload ring instead.
+		/// </summary>
+		VkCommandBuffer beginSingleTimeCommands();
+		void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+
+		VulkanImageStateTracker* getImageStateTracker() const;
+		RenderPassCache* getRenderPassCache() const;
+		VulkanUploadRing* getUploadRing() const;
 	private:
 		VkInstance mInstance;
 		VkDebugUtilsMessengerEXT mCallback;
@@ -102,19 +141,34 @@ class VulkanContextHandle : public IContextHandle
 		qtl::vector<VkImage> mSwapChainImages;
 		qtl::vector<VkImageView> mSwapChainImageViews;
 
+		// Headless contexts own their swap chain images, one per frame in flight
+		bool mHeadless;
+		qtl::vector<VkDeviceMemory> mOffscreenMemory;
+
+		VkBuffer mReadbackBuffer;
+		VkDeviceMemory mReadbackMemory;
+		void* mReadbackData;
+
 		VulkanRasterizer* mRasterizer;
 		VulkanPipeline* mPipeline;
+		VulkanImageStateTracker* mImageStateTracker;
+		RenderPassCache* mRenderPassCache;
+		VulkanUploadRing* mUploadRing;
 
 		qtl::vector<VkSemaphore> mImageAvailableSemaphore;
 		qtl::vector<VkSemaphore> mRenderFinishedSemaphore;
 		qtl::vector<VkFence> mInFlightFences;
+		qtl::vector<VkFence> mImagesInFlight;
 
-		qtl::vector<VkFramebuffer> mSwapChainFrameBuffers;
+		// Owned by the render pass cache
+		qtl::vector<VulkanFrameBuffer*> mSwapChainFrameBuffers;
 
 		uint32_t mCurrentFrame;
 		uint32_t mImageIndex;
+		bool mFrameAcquired;
 
 		qtl::vector<VulkanCommandPool*> mCommandPools;
+		VkCommandPool mTransientCommandPool;
 
 		void _createInstance();
 		void _setupDebugCallback();
@@ -122,6 +176,8 @@ class VulkanContextHandle : public IContextHandle
 		void _createLogicalDevice();
 		void _createSurface();
 		void _createSwapChain();
+		void _createOffscreenImages();
+		void _createReadbackBuffer();
 		void _createImageViews();
 
 		void _createGraphicsPipeline();
@@ -134,7 +190,7 @@ class VulkanContextHandle : public IContextHandle
 		VkExtent2D _chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const;
 
 		bool _isDeviceSuitable(const VkPhysicalDevice device) const;
-        static bool _checkDeviceExtensionSupport(const VkPhysicalDevice device);
+		bool _checkDeviceExtensionSupport(const VkPhysicalDevice device) const;
 };
 
 #endif // vulkan_context_handle_h__
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef vulkan_frame_graph_h__
+#define vulkan_frame_graph_h__
+
+#include <vulkan/vulkan.h>
+
+#include <qtl/vector.h>
+
+#include "qgfx/api/iframegraph.h"
+
+/// <summary>
+/// Frame graph on Vulkan.  Transient textures sharing a slot are separate images bound to the
+/// same device memory, render passes and framebuffers come from the context's cache, and the
+/// barriers in front of each pass are batched by the context's image state tracker.
+/// </summary>
+class VulkanFrameGraph : public IFrameGraph
+{
+	public:
+		explicit VulkanFrameGraph(ContextHandle* handle);
+		VulkanFrameGraph(const VulkanFrameGraph&) = delete;
+		~VulkanFrameGraph();
+
+		VulkanFrameGraph& operator=(const VulkanFrameGraph&) = delete;
+
+		void* getImageHandle(const FrameGraphResource resource) const override;
+		VkImageView getImageView(const FrameGraphResource resource) const;
+
+		/// <summary>
+		/// Render pass of a pass with attachments, for building compatible pipelines
+		/// </summary>
+		RenderPass* getRenderPass(const char* pass) const;
+
+	protected:
+		bool _canAlias(const FrameGraphTextureDescription& a, const FrameGraphTextureDescription& b) const override;
+
+		void _createResources() override;
+		void _destroyResources() override;
+
+		void _beginPass(const PassNode& pass, CommandBuffer* commandBuffer) override;
+		void _endPass(const PassNode& pass, CommandBuffer* commandBuffer) override;
+		void _beginExecute(CommandBuffer* commandBuffer) override;
+		void _endExecute(CommandBuffer* commandBuffer) override;
+
+	private:
+		struct PhysicalImage
+		{
+			VkImage image;
+			VkImageView view;
+			VkFormat format;
+			bool owned;
+		};
+
+		// Indexed by resource
+		qtl::vector<PhysicalImage> mImages;
+
+		// Indexed by slot
+		qtl::vector<VkDeviceMemory> mMemory;
+
+		// Indexed by pass, null for passes without attachments.  Owned by the render pass cache.
+		qtl::vector<RenderPass*> mRenderPasses;
+		qtl::vector<FrameBuffer*> mFrameBuffers;
+
+		uint32_t mBarriersBefore;
+
+		void _createRenderPass(const uint32_t index);
+};
+
+#endif // vulkan_frame_graph_h__
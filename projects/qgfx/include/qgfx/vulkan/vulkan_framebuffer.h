@@ -0,0 +1,26 @@
+#ifndef vulkan_framebuffer_h__
+#define vulkan_framebuffer_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/iframebuffer.h"
+
+class VulkanFrameBuffer : public IFrameBuffer
+{
+	public:
+		explicit VulkanFrameBuffer(ContextHandle* handle);
+		VulkanFrameBuffer(const VulkanFrameBuffer&) = delete;
+		~VulkanFrameBuffer();
+
+		VulkanFrameBuffer& operator=(const VulkanFrameBuffer&) = delete;
+
+		void construct(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+			const uint32_t width, const uint32_t height) override;
+
+		VkFramebuffer getFrameBuffer() const { return mFrameBuffer; }
+
+	private:
+		VkFramebuffer mFrameBuffer;
+};
+
+#endif // vulkan_framebuffer_h__
@@ -0,0 +1,41 @@
+#ifndef vulkan_gpu_profiler_h__
+#define vulkan_gpu_profiler_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/igpuprofiler.h"
+
+/// <summary>
+/// GPU profiler on Vulkan.  Every swap chain image has a timestamp query pool, matching the
+/// command buffer recorded for it, that is reset at the start of the frame and written with
+/// vkCmdWriteTimestamp.  startFrame() has waited on the fence of the image's previous frame
+/// by the time the pool is reused, so its results are read without VK_QUERY_RESULT_WAIT_BIT.
+/// </summary>
+class VulkanGpuProfiler : public IGpuProfiler
+{
+	public:
+		explicit VulkanGpuProfiler(ContextHandle* handle, const uint32_t maxScopes = 64, const uint32_t historyLength = 60);
+		VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+		~VulkanGpuProfiler();
+
+		VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+		void construct() override;
+		bool isSupported() const override;
+
+	protected:
+		uint32_t _acquireSlot() override;
+		void _resetQueries(CommandBuffer* commandBuffer, const uint32_t slot) override;
+		void _writeTimestamp(CommandBuffer* commandBuffer, const uint32_t slot, const uint32_t query) override;
+		bool _getTimestamps(const uint32_t slot, const uint32_t count, double* milliseconds) override;
+
+	private:
+		qtl::vector<VkQueryPool> mQueryPools;
+		qtl::vector<uint64_t> mTicks;
+
+		// Nanoseconds per tick, and the bits of a timestamp that are valid on the graphics queue
+		double mTimestampPeriod;
+		uint64_t mTimestampMask;
+};
+
+#endif // vulkan_gpu_profiler_h__
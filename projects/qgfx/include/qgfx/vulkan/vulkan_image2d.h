@@ -9,11 +9,26 @@ class VulkanImage2D : public IImage2D
 		explicit VulkanImage2D(ContextHandle* handle);
 		~VulkanImage2D();
 
-		void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType) override;
+		void construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType,
+			const uint32_t mipLevels = 1, const uint32_t samples = 1) override;
 		void setData(const uint8_t* data, const uint32_t dataSize) override;
+		void setMipData(const uint32_t level, const uint8_t* data, const uint32_t dataSize) override;
+
+		void generateMips() override;
+		bool canGenerateMips() const override;
 
 		void* getImageHandle() const override;
 
+		uint32_t getWidth() const override { return mWidth; }
+		uint32_t getHeight() const override { return mHeight; }
+
+		/// <summary>
+		/// Whether the device can sample the format with optimal tiling
+		/// </summary>
+		static bool isFormatSupported(VkPhysicalDevice device, const ImageFormat format, const ImageDataType type);
+
+		VkFormat getFormat() const { return mFormat; }
+
 	private:
 		VkImage mImage;
 		VkDeviceMemory mMemory;
@@ -24,6 +39,12 @@ class VulkanImage2D : public IImage2D
 		uint8_t mBpp;
 };
 
-constexpr VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const ImageDataType type);
+VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const ImageDataType type);
+
+/// <summary>
+/// Depth images are always 32 bit float, the precision reverse-Z depends on
+/// </summary>
+VkFormat getVulkanDepthFormat(const ImageType type);
+VkImageAspectFlags getVulkanAspectFlags(const ImageType type);
 
 #endif // vulkan_image2d_h__
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef vulkan_image_state_tracker_h__
+#define vulkan_image_state_tracker_h__
+
+#include <vulkan/vulkan.h>
+
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Layout of a subresource, its last write and the reads since then.  writeStage is the stage
+/// a barrier has to wait on to be ordered after the write or the last layout transition, and
+/// visibleAccess and visibleStages are what that write has already been made visible to.
+/// </summary>
+struct VulkanImageState
+{
+	VkImageLayout layout;
+
+	VkAccessFlags writeAccess;
+	VkPipelineStageFlags writeStage;
+
+	VkAccessFlags visibleAccess;
+	VkPipelineStageFlags visibleStages;
+
+	// Stages that read since the last write, the next write waits on them
+	VkPipelineStageFlags readStages;
+};
+
+struct VulkanBarrierStatistics
+{
+	// Transitions requested and those dropped because the subresource was already usable
+	uint32_t requested;
+	uint32_t skipped;
+
+	// Image barriers recorded after merging mip ranges, and vkCmdPipelineBarrier calls
+	uint32_t imageBarriers;
+	uint32_t pipelineBarriers;
+};
+
+/// <summary>
+/// Tracks the layout, access mask and stage of every mip level of the images registered with
+/// it.  Transitions are queued and recorded together by flush(), one vkCmdPipelineBarrier per
+/// sync point.  A read in the same layout is dropped when the last write has already been made
+/// visible to its stage and access, and barriers only wait on the stages that last touched the
+/// subresource rather than on the whole pipeline.
+///
+/// The tracked state is the state at the end of everything recorded so far, so command buffers
+/// have to be submitted in the order they were recorded in.
+/// </summary>
+class VulkanImageStateTracker
+{
+	public:
+		VulkanImageStateTracker() = default;
+		VulkanImageStateTracker(const VulkanImageStateTracker&) = delete;
+		~VulkanImageStateTracker() = default;
+
+		VulkanImageStateTracker& operator=(const VulkanImageStateTracker&) = delete;
+
+		void addImage(VkImage image, const uint32_t mipLevels, const VkImageAspectFlags aspect, const VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+		void removeImage(VkImage image);
+
+		/// <summary>
+		/// Hands the last accesses of an image to another one bound to the same memory, so the
+		/// next transition of the new image waits for the old one to be done with the memory.
+		/// </summary>
+		void aliasImage(VkImage previous, VkImage image);
+
+		/// <summary>
+		/// Queues a transition of levelCount mips starting at baseMip.  With discard set the
+		/// previous contents are not needed and the transition starts from an undefined layout.
+		/// A second transition of the same mip before the flush replaces the first one's target.
+		/// </summary>
+		void transition(VkImage image, const uint32_t baseMip, const uint32_t levelCount, const VkImageLayout layout,
+			const VkAccessFlags access, const VkPipelineStageFlags stage, const bool discard = false);
+
+		/// <summary>
+		/// Records every queued transition into a single pipeline barrier
+		/// </summary>
+		void flush(VkCommandBuffer commandBuffer);
+
+		const VulkanImageState& getState(VkImage image, const uint32_t level) const;
+
+		const VulkanBarrierStatistics& getStatistics() const { return mStatistics; }
+		void resetStatistics() { mStatistics = {}; }
+	private:
+		struct TrackedImage
+		{
+			VkImageAspectFlags aspect;
+			std::vector<VulkanImageState> levels;
+		};
+
+		std::unordered_map<VkImage, TrackedImage> mImages;
+		std::vector<VkImageMemoryBarrier> mPending;
+		VkPipelineStageFlags mPendingSourceStages = 0;
+		VkPipelineStageFlags mPendingDestinationStages = 0;
+
+		VulkanBarrierStatistics mStatistics = {};
+};
+
+#endif // vulkan_image_state_tracker_h__
@@ -9,12 +9,20 @@ class VulkanImageView : public IImageView
 {
     public:
 		explicit VulkanImageView(ContextHandle* handle);
+		VulkanImageView(const VulkanImageView&) = delete;
 		~VulkanImageView();
 
+		VulkanImageView& operator=(const VulkanImageView&) = delete;
+
 		void construct(Image2D* image) override;
 
+		FrameBufferAttachment getAttachment() const override;
+		VkImageView getImageView() const { return mImageView; }
+
     private:
 		VkImageView mImageView;
+		VkImage mImage;
+		uint32_t mLevels;
 };
 
-#endif // vulkan_imageview_h__
\ No newline at end of file
+#endif // vulkan_imageview_h__
@@ -0,0 +1,27 @@
+#ifndef vulkan_indexbuffer_h__
+#define vulkan_indexbuffer_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/iindexbuffer.h"
+#include "qgfx/context_handle.h"
+
+class VulkanIndexBuffer : public IIndexBuffer
+{
+	public:
+		explicit VulkanIndexBuffer(ContextHandle* handle);
+		~VulkanIndexBuffer();
+
+		bool construct() override;
+
+		void bind() override;
+		void unbind() override;
+
+		VkBuffer getBuffer() const;
+		VkIndexType getVulkanIndexType() const;
+	private:
+		VkBuffer mBuffer;
+		VkDeviceMemory mMemory;
+};
+
+#endif // vulkan_indexbuffer_h__
@@ -22,6 +22,33 @@ inline uint32_t findMemoryType(const VkPhysicalDevice device, const uint32_t typ
 	return 0;
 }
 
+inline bool hasMemoryType(const VkPhysicalDevice device, const uint32_t typeFilter, const VkMemoryPropertyFlags properties)
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+	{
+		if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Memory for an image created with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT.  Tiled GPUs expose a
+/// lazily allocated heap for these, where an attachment that is never stored takes no memory.
+/// </summary>
+inline uint32_t findTransientMemoryType(const VkPhysicalDevice device, const uint32_t typeFilter)
+{
+	const VkMemoryPropertyFlags local = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	const VkMemoryPropertyFlags lazy = local | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+	return findMemoryType(device, typeFilter, hasMemoryType(device, typeFilter, lazy) ? lazy : local);
+}
+
 inline void createBuffer(const VkDevice device, const VkPhysicalDevice gpu, const VkDeviceSize size, 
 	const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) 
 {
@@ -17,17 +17,24 @@ class VulkanPipeline : public IPipeline
 		void construct() override;
 
 		void setTopology(const Topology& topology) override;
+		void setPrimitiveRestart(const bool enabled) override;
 		Shader* addShader() override;
 
-		VkRenderPass getRenderPass() const;
+		/// <summary>
+		/// Render pass the pipeline draws in, or one compatible with it.  Must be called before
+		/// construct(), pipelines draw to the swap chain otherwise.
+		/// </summary>
+		void setRenderPass(RenderPass* renderPass);
+		RenderPass* getRenderPass() const;
 		VkPipeline getPipeline() const;
 
 	private:
 		VkPipelineLayout mLayout;
-		VkRenderPass mRenderPass;
+		RenderPass* mRenderPass;
 		VkPipeline mPipeline;
 
 		VkPipelineInputAssemblyStateCreateInfo mInputAssembly;
+		bool mPrimitiveRestart;
 
 		qtl::vector<Shader*> mShaders;
 };
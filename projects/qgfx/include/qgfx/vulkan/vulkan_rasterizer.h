@@ -18,11 +18,26 @@ class VulkanRasterizer : public IRasterizer
 		void setLineWidth(const float lineWidth) override;
 
 		void setDepthTest(const bool enabled) override;
+		void setDepthWrite(const bool enabled) override;
+		void setDepthCompare(const CompareOp op) override;
+		void setStencilTest(const bool enabled, const StencilState& front = StencilState(), const StencilState& back = StencilState()) override;
+		void setColorWrite(const bool enabled) override;
+		void setReverseZ(const bool enabled) override;
 
-		VkPipelineRasterizationStateCreateInfo getStateInfo() const;
+		const VkPipelineRasterizationStateCreateInfo& getStateInfo() const;
+
+		/// <summary>
+		/// Depth and stencil state for pipelines constructed from now on
+		/// </summary>
+		const VkPipelineDepthStencilStateCreateInfo& getDepthStencilStateInfo() const;
+
+		VkColorComponentFlags getColorWriteMask() const;
 
 	private:
 		VkPipelineRasterizationStateCreateInfo mRasterizer;
+		VkPipelineDepthStencilStateCreateInfo mDepthStencil;
+
+		void _updateDepthStencil();
 };
 
 #endif // vulkan_rasterizer_h__
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef vulkan_readback_queue_h__
+#define vulkan_readback_queue_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/ireadbackqueue.h"
+
+/// <summary>
+/// Readback queue on Vulkan.  Each slot owns a staging buffer in host cached memory, a command
+/// buffer and a fence.  Copies are submitted to the graphics queue behind the frame that
+/// rendered the source, and the buffers stay mapped so a result is an invalidate and a memcpy.
+/// </summary>
+class VulkanReadbackQueue : public IReadbackQueue
+{
+	public:
+		explicit VulkanReadbackQueue(ContextHandle* handle, const uint32_t slotCount = 3);
+		VulkanReadbackQueue(const VulkanReadbackQueue&) = delete;
+		~VulkanReadbackQueue();
+
+		VulkanReadbackQueue& operator=(const VulkanReadbackQueue&) = delete;
+
+		void construct() override;
+
+	protected:
+		void _reserve(const uint32_t slot, const size_t size) override;
+
+		bool _copyBackBuffer(const uint32_t slot) override;
+		void _copyImage(const uint32_t slot, Image2D* image) override;
+
+		bool _isComplete(const uint32_t slot) override;
+		void _wait(const uint32_t slot) override;
+
+		const uint8_t* _getData(const uint32_t slot) override;
+
+	private:
+		struct Buffer
+		{
+			VkBuffer buffer;
+			VkDeviceMemory memory;
+			VkDeviceSize capacity;
+			const uint8_t* mapped;
+			VkCommandBuffer commandBuffer;
+			VkFence fence;
+		};
+
+		VkCommandPool mCommandPool;
+		qtl::vector<Buffer> mBuffers;
+
+		void _destroyBuffer(Buffer& buffer);
+		VkCommandBuffer _begin(const uint32_t slot);
+		void _submit(const uint32_t slot);
+};
+
+#endif // vulkan_readback_queue_h__
@@ -0,0 +1,32 @@
+#ifndef vulkan_renderpass_h__
+#define vulkan_renderpass_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/irenderpass.h"
+
+/// <summary>
+/// Offscreen attachments stay in their attachment layout across the pass, the command buffer
+/// moves them there through the image state tracker before the pass begins.  Swap chain
+/// attachments are transitioned to present by the render pass itself.
+/// </summary>
+class VulkanRenderPass : public IRenderPass
+{
+	public:
+		explicit VulkanRenderPass(ContextHandle* handle);
+		VulkanRenderPass(const VulkanRenderPass&) = delete;
+		~VulkanRenderPass();
+
+		VulkanRenderPass& operator=(const VulkanRenderPass&) = delete;
+
+		void construct(const RenderPassDescription& description) override;
+
+		VkRenderPass getRenderPass() const { return mRenderPass; }
+
+		static VkImageLayout getAttachmentLayout(const RenderPassAttachment& attachment);
+
+	private:
+		VkRenderPass mRenderPass;
+};
+
+#endif // vulkan_renderpass_h__
@@ -0,0 +1,97 @@
+#ifndef vulkan_upload_ring_h__
+#define vulkan_upload_ring_h__
+
+#include <qtl/vector.h>
+
+#include <vulkan/vulkan.h>
+
+#include <stdint.h>
+
+class VulkanContextHandle;
+
+struct VulkanStagingAllocation
+{
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	uint8_t* data;
+};
+
+struct VulkanUploadRingStatistics
+{
+	uint32_t submissions;
+	uint32_t fenceWaits;
+
+	// Uploads larger than the ring, staged in a buffer of their own
+	uint32_t dedicatedBuffers;
+};
+
+/// <summary>
+/// Persistently mapped staging ring for uploads recorded outside of a frame.  Every upload is
+/// submitted to the graphics queue with a fence and without waiting, and its staging memory
+/// is reused once that fence has signalled.  Submissions execute before any frame submitted
+/// after them, so the frame can sample what they wrote.
+/// </summary>
+class VulkanUploadRing
+{
+	public:
+		VulkanUploadRing(VulkanContextHandle* handle, const VkDeviceSize size = 16 * 1024 * 1024);
+		VulkanUploadRing(const VulkanUploadRing&) = delete;
+		~VulkanUploadRing();
+
+		VulkanUploadRing& operator=(const VulkanUploadRing&) = delete;
+
+		void construct();
+
+		/// <summary>
+		/// Reserves staging memory and begins a command buffer that copies from it.  Waits for the
+		/// oldest submissions when the ring is full.  Offsets are a multiple of alignment, which does
+		/// not have to be a power of two.
+		/// </summary>
+		VkCommandBuffer begin(const VkDeviceSize size, const VkDeviceSize alignment, VulkanStagingAllocation& allocation);
+		void submit(VkCommandBuffer commandBuffer);
+
+		/// <summary>
+		/// Releases the staging memory of every submission the GPU has finished
+		/// </summary>
+		void retire();
+		void wait();
+
+		const VulkanUploadRingStatistics& getStatistics() const { return mStatistics; }
+	private:
+		struct Submission
+		{
+			VkCommandBuffer commandBuffer;
+			VkFence fence;
+
+			// End of the ring range, or the buffer of an upload that did not fit the ring
+			VkDeviceSize end;
+			VkBuffer dedicatedBuffer;
+			VkDeviceMemory dedicatedMemory;
+		};
+
+		VulkanContextHandle* mHandle;
+		VkDeviceSize mSize;
+		VkBuffer mBuffer;
+		VkDeviceMemory mMemory;
+		uint8_t* mMapped;
+
+		// Free space is [mHead, mSize) and [0, mTail) until the ring wraps, [mHead, mTail) after
+		VkDeviceSize mHead;
+		VkDeviceSize mTail;
+		uint32_t mRingSubmissions;
+
+		VkCommandPool mCommandPool;
+		qtl::vector<Submission> mSubmissions;
+		qtl::vector<VkFence> mFreeFences;
+		qtl::vector<VkCommandBuffer> mFreeCommandBuffers;
+
+		// Filled by begin and consumed by the submit that follows it
+		Submission mRecording;
+
+		VulkanUploadRingStatistics mStatistics;
+
+		bool _allocate(const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize& offset);
+		void _release(const Submission& submission);
+};
+
+#endif // vulkan_upload_ring_h__
@@ -0,0 +1,44 @@
+#ifndef vulkan_vertex_format_h__
+#define vulkan_vertex_format_h__
+
+#include <vulkan/vulkan.h>
+
+#include "qgfx/api/ivertexbuffer.h"
+
+inline VkFormat qgfxVertexAttribToVulkan(const VertexAttribType type, const uint32_t count, const bool normalized)
+{
+	static const VkFormat floats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat halves[] = { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT };
+	static const VkFormat ints[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat uints[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+	static const VkFormat shorts[] = { VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT };
+	static const VkFormat snorm16[] = { VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16B16_SNORM, VK_FORMAT_R16G16B16A16_SNORM };
+	static const VkFormat ushorts[] = { VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT };
+	static const VkFormat unorm16[] = { VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16A16_UNORM };
+	static const VkFormat bytes[] = { VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8A8_SINT };
+	static const VkFormat snorm8[] = { VK_FORMAT_R8_SNORM, VK_FORMAT_R8G8_SNORM, VK_FORMAT_R8G8B8_SNORM, VK_FORMAT_R8G8B8A8_SNORM };
+	static const VkFormat ubytes[] = { VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8A8_UINT };
+	static const VkFormat unorm8[] = { VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM };
+
+	QGFX_ASSERT_MSG(count >= 1 && count <= 4, "Vertex attributes have one to four components.\n");
+	const uint32_t idx = count - 1;
+
+	switch (type)
+	{
+		case VertexAttribType::Float: return floats[idx];
+		case VertexAttribType::Half: return halves[idx];
+		case VertexAttribType::Int32: return ints[idx];
+		case VertexAttribType::UInt32: return uints[idx];
+		case VertexAttribType::Int16: return normalized ? snorm16[idx] : shorts[idx];
+		case VertexAttribType::UInt16: return normalized ? unorm16[idx] : ushorts[idx];
+		case VertexAttribType::Int8: return normalized ? snorm8[idx] : bytes[idx];
+		case VertexAttribType::UInt8: return normalized ? unorm8[idx] : ubytes[idx];
+		// OpenGL has no integer form of the packed types, both backends read them as floats
+		case VertexAttribType::Int2_10_10_10: return normalized ? VK_FORMAT_A2B10G10R10_SNORM_PACK32 : VK_FORMAT_A2B10G10R10_SSCALED_PACK32;
+		case VertexAttribType::UInt2_10_10_10: return normalized ? VK_FORMAT_A2B10G10R10_UNORM_PACK32 : VK_FORMAT_A2B10G10R10_USCALED_PACK32;
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+#endif // vulkan_vertex_format_h__
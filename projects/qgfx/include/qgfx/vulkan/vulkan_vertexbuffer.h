@@ -3,8 +3,6 @@
 
 #include <vulkan/vulkan.h>
 
-#include <qtl/vector.h>
-
 #include "qgfx/api/ivertexbuffer.h"
 #include "qgfx/context_handle.h"
 
@@ -15,6 +13,7 @@ class VulkanVertexBuffer : public IVertexBuffer
 		~VulkanVertexBuffer();
 
 		void setData(void* data, const size_t size) override;
+		void setExternalData(const void* data, const size_t size) override;
 		void setLayout(const VertexBufferLayout& layout) override;
 
 		bool construct() override;
@@ -24,16 +23,15 @@ class VulkanVertexBuffer : public IVertexBuffer
 		void bind() override;
 		void unbind() override;
 
+		VkBuffer getBuffer() const;
+
 	private:
 		VkBuffer mBuffer;
 		VkDeviceMemory mMemory;
 		VertexBufferLayout mLayout;
 
-		VkVertexInputBindingDescription mBindingDescription;
-		qtl::vector<VkVertexInputAttributeDescription> mAttributeDescriptions;
-
 		size_t mSize;
-		void* mData;
+		const void* mData;
 };
 
 #endif // vulkan_vertexbuffer_h__
\ No newline at end of file
@@ -18,8 +18,15 @@ class VulkanWindow : public IWindow
 
 		bool shouldClose() const override;
 		void poll() const override;
+
+		uint32_t getWidth() const override;
+		uint32_t getHeight() const override;
+		bool isHeadless() const override;
 	private:
 		GLFWwindow* mWindow;
+		uint32_t mWidth;
+		uint32_t mHeight;
+		bool mHeadless;
 };
 
 #endif // vulkan_window_h__
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "qgfx/api/icommandbuffer.h"
 
-ICommandBuffer::ICommandBuffer(ContextHandle* handle)
-	: mHandle(handle)
+ICommandBuffer::ICommandBuffer(ContextHandle* handle, const CommandBufferUsage usage)
+	: mHandle(handle), mUsage(usage)
 {
 	
 }
\ No newline at end of file
@@ -1,6 +1,27 @@
 #include "qgfx/api/icontexthandle.h"
 
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_window.h"
+#elif defined(QGFX_VULKAN)
+#include "qgfx/vulkan/vulkan_window.h"
+#endif
+
 IContextHandle::IContextHandle(Window* window)
-	: mWindow(window)
+	: mWindow(window), mRenderStatistics({})
+{
+}
+
+uint32_t IContextHandle::getBackBufferWidth() const
+{
+	return mWindow->getWidth();
+}
+
+uint32_t IContextHandle::getBackBufferHeight() const
+{
+	return mWindow->getHeight();
+}
+
+bool IContextHandle::isHeadless() const
 {
+	return mWindow->isHeadless();
 }
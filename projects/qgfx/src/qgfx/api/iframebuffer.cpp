@@ -1,7 +1,7 @@
 #include "qgfx/api/iframebuffer.h"
 
 IFrameBuffer::IFrameBuffer(ContextHandle* handle)
-	: mHandle(handle)
+	: mHandle(handle), mRenderPass(nullptr), mWidth(0), mHeight(0)
 {
 	
-}
\ No newline at end of file
+}
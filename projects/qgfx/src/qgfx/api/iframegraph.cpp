@@ -0,0 +1,604 @@
+#include "qgfx/api/iframegraph.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_image2d.h"
+#elif defined(QGFX_VULKAN)
+#include "qgfx/vulkan/vulkan_image2d.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static constexpr uint32_t noPass = 0xFFFFFFFF;
+static constexpr uint32_t noResource = 0xFFFFFFFF;
+
+static bool contains(const qtl::vector<uint32_t>& values, const uint32_t value)
+{
+	for (const auto entry : values)
+	{
+		if (entry == value)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+FrameGraphResource FrameGraphBuilder::create(const char* name, const FrameGraphTextureDescription& description)
+{
+	QGFX_ASSERT_MSG(description.width > 0 && description.height > 0, "Frame graph texture %s is empty.\n", name);
+
+	IFrameGraph::ResourceNode node = {};
+	node.name = name;
+	node.description = description;
+	node.imported = nullptr;
+
+	const uint32_t resource = static_cast<uint32_t>(mGraph->mResources.size());
+	mGraph->mResources.push_back(node);
+
+	const FrameGraphResource version = static_cast<FrameGraphResource>(mGraph->mVersions.size());
+	mGraph->mVersions.push_back({ resource, noPass, invalidFrameGraphResource, {} });
+	mGraph->mLatest.push_back(version);
+
+	return version;
+}
+
+FrameGraphResource FrameGraphBuilder::read(const FrameGraphResource resource, const ShaderStage stages)
+{
+	QGFX_ASSERT_MSG(resource < mGraph->mVersions.size(), "Invalid frame graph resource.\n");
+
+	auto& version = mGraph->mVersions[resource];
+	[[maybe_unused]] const auto& node = mGraph->mResources[version.resource];
+	QGFX_ASSERT_MSG(version.producer != noPass || node.imported != nullptr, "Frame graph texture %s is read before anything wrote it.\n", node.name.c_str());
+	QGFX_ASSERT_MSG(node.description.samples == 1, "Frame graph texture %s is multisampled, resolve it before sampling.\n", node.name.c_str());
+
+	// Reading the same version again only adds stages
+	auto& pass = mGraph->mPasses[mPass];
+	for (auto& read : pass.reads)
+	{
+		if (read.version == resource)
+		{
+			read.stages = read.stages | stages;
+			return resource;
+		}
+	}
+
+	version.readers.push_back(mPass);
+	pass.reads.push_back({ resource, stages });
+
+	return resource;
+}
+
+FrameGraphResource FrameGraphBuilder::write(const FrameGraphResource resource)
+{
+	QGFX_ASSERT_MSG(resource < mGraph->mVersions.size(), "Invalid frame graph resource.\n");
+
+	const uint32_t index = mGraph->mVersions[resource].resource;
+	QGFX_ASSERT_MSG(mGraph->mLatest[index] == resource, "Frame graph texture %s is written through an old version.\n",
+		mGraph->mResources[index].name.c_str());
+
+	auto& pass = mGraph->mPasses[mPass];
+#if defined(_DEBUG)
+	for (const auto& read : pass.reads)
+	{
+		QGFX_ASSERT_MSG(mGraph->mVersions[read.version].resource != index, "Pass %s samples and renders to %s.\n",
+			pass.name.c_str(), mGraph->mResources[index].name.c_str());
+	}
+#endif
+
+	// Writing on top of existing contents loads them, which makes the pass a reader of the old version
+	auto& previous = mGraph->mVersions[resource];
+	if (previous.producer != noPass || mGraph->mResources[index].imported != nullptr)
+	{
+		previous.readers.push_back(mPass);
+	}
+
+	const FrameGraphResource version = static_cast<FrameGraphResource>(mGraph->mVersions.size());
+	mGraph->mVersions.push_back({ index, mPass, resource, {} });
+	mGraph->mLatest[index] = version;
+
+	pass.writes.push_back(version);
+
+	return version;
+}
+
+FrameGraphResource FrameGraphBuilder::resolve(const FrameGraphResource source, const FrameGraphResource destination)
+{
+	QGFX_ASSERT_MSG(source < mGraph->mVersions.size(), "Invalid frame graph resource.\n");
+
+	[[maybe_unused]] const auto& pass = mGraph->mPasses[mPass];
+	[[maybe_unused]] const auto& sourceNode = mGraph->mResources[mGraph->mVersions[source].resource];
+	QGFX_ASSERT_MSG(contains(pass.writes, source), "Pass %s resolves %s without rendering to it.\n", pass.name.c_str(), sourceNode.name.c_str());
+	QGFX_ASSERT_MSG(sourceNode.description.samples > 1 && !hasDepthAspect(sourceNode.description.imageType),
+		"Only multisampled color textures can be resolved.\n");
+
+	const FrameGraphResource version = write(destination);
+	[[maybe_unused]] const auto& destinationNode = mGraph->mResources[mGraph->mVersions[version].resource];
+	QGFX_ASSERT_MSG(destinationNode.description.samples == 1, "Resolve destination %s is multisampled.\n", destinationNode.name.c_str());
+
+	mGraph->mPasses[mPass].resolves.push_back({ source, version });
+
+	return version;
+}
+
+void FrameGraphBuilder::setSideEffect()
+{
+	mGraph->mPasses[mPass].sideEffect = true;
+}
+
+IFrameGraph::IFrameGraph(ContextHandle* handle)
+	: mHandle(handle), mStatistics(), mCompiled(false)
+{
+}
+
+FrameGraphResource IFrameGraph::importImage(const char* name, Image2D* image)
+{
+	QGFX_ASSERT_MSG(!mCompiled, "Frame graph is already compiled, reset it first.\n");
+	QGFX_ASSERT_MSG(image != nullptr, "Can not import a null image.\n");
+
+	ResourceNode node = {};
+	node.name = name;
+	node.description.width = image->getWidth();
+	node.description.height = image->getHeight();
+	node.description.format = image->getImageFormat();
+	node.description.type = image->getImageDataType();
+	node.description.imageType = image->getImageType();
+	node.description.samples = image->getSamples();
+	node.imported = image;
+
+	const uint32_t resource = static_cast<uint32_t>(mResources.size());
+	mResources.push_back(node);
+
+	const FrameGraphResource version = static_cast<FrameGraphResource>(mVersions.size());
+	mVersions.push_back({ resource, noPass, invalidFrameGraphResource, {} });
+	mLatest.push_back(version);
+
+	return version;
+}
+
+void IFrameGraph::addPass(const char* name, SetupCallback setup, ExecuteCallback execute, void* userData)
+{
+	QGFX_ASSERT_MSG(!mCompiled, "Frame graph is already compiled, reset it first.\n");
+
+	PassNode pass = {};
+	pass.name = name;
+	pass.execute = execute;
+	pass.userData = userData;
+
+	const uint32_t index = static_cast<uint32_t>(mPasses.size());
+	mPasses.push_back(pass);
+
+	if (setup != nullptr)
+	{
+		FrameGraphBuilder builder(this, index);
+		setup(builder, userData);
+	}
+}
+
+void IFrameGraph::compile()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(!mCompiled, "Frame graph is already compiled, reset it first.\n");
+
+	mStatistics = {};
+
+	_cull();
+	_schedule();
+	_computeLifetimes();
+	_assignSlots();
+	_createResources();
+
+	mCompiled = true;
+}
+
+void IFrameGraph::execute(CommandBuffer* commandBuffer)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mCompiled, "Frame graph has not been compiled.\n");
+
+	_beginExecute(commandBuffer);
+
+	for (const auto index : mSchedule)
+	{
+		const PassNode& pass = mPasses[index];
+
+		_beginPass(pass, commandBuffer);
+		if (pass.execute != nullptr)
+		{
+			pass.execute(commandBuffer, pass.userData);
+		}
+		_endPass(pass, commandBuffer);
+	}
+
+	_endExecute(commandBuffer);
+}
+
+void IFrameGraph::reset()
+{
+	if (mCompiled)
+	{
+		_destroyResources();
+	}
+
+	mResources.clear();
+	mPasses.clear();
+	mSchedule.clear();
+	mVersions.clear();
+	mLatest.clear();
+	mStatistics = {};
+	mCompiled = false;
+}
+
+bool IFrameGraph::isPassCulled(const char* name) const
+{
+	for (const auto& pass : mPasses)
+	{
+		if (strcmp(pass.name.c_str(), name) == 0)
+		{
+			return pass.culled;
+		}
+	}
+
+	return true;
+}
+
+const FrameGraphTextureDescription& IFrameGraph::getDescription(const FrameGraphResource resource) const
+{
+	return mResources[_getResourceIndex(resource)].description;
+}
+
+uint32_t IFrameGraph::_getResourceIndex(const FrameGraphResource resource) const
+{
+	QGFX_ASSERT_MSG(resource < mVersions.size(), "Invalid frame graph resource.\n");
+	return mVersions[resource].resource;
+}
+
+void IFrameGraph::_cull()
+{
+	std::vector<uint32_t> versionReferences(mVersions.size());
+	for (size_t i = 0; i < mVersions.size(); i++)
+	{
+		versionReferences[i] = static_cast<uint32_t>(mVersions[i].readers.size());
+	}
+
+	std::vector<FrameGraphResource> unreferenced;
+	for (auto& pass : mPasses)
+	{
+		pass.references = static_cast<uint32_t>(pass.writes.size());
+		pass.culled = false;
+
+		// Passes with results outside of the graph are kept however little the graph uses them
+		bool external = pass.sideEffect;
+		for (const auto write : pass.writes)
+		{
+			external |= mResources[mVersions[write].resource].imported != nullptr;
+		}
+
+		if (external)
+		{
+			pass.references++;
+		}
+	}
+
+	auto cullPass = [&](const uint32_t index)
+	{
+		PassNode& pass = mPasses[index];
+		pass.culled = true;
+		mStatistics.culledPasses++;
+
+		auto release = [&](const FrameGraphResource consumed)
+		{
+			if (--versionReferences[consumed] == 0 && mVersions[consumed].producer != noPass)
+			{
+				unreferenced.push_back(consumed);
+			}
+		};
+
+		for (const auto& read : pass.reads)
+		{
+			release(read.version);
+		}
+
+		for (const auto write : pass.writes)
+		{
+			const FrameGraphResource previous = mVersions[write].previous;
+			if (contains(mVersions[previous].readers, index))
+			{
+				release(previous);
+			}
+		}
+	};
+
+	for (FrameGraphResource version = 0; version < mVersions.size(); version++)
+	{
+		if (mVersions[version].producer != noPass && versionReferences[version] == 0)
+		{
+			unreferenced.push_back(version);
+		}
+	}
+
+	// Passes that write nothing and have no side effect do not contribute to the frame
+	for (uint32_t index = 0; index < mPasses.size(); index++)
+	{
+		if (mPasses[index].references == 0)
+		{
+			cullPass(index);
+		}
+	}
+
+	// Results nobody reads release their producer, which in turn releases what it consumed
+	while (!unreferenced.empty())
+	{
+		const FrameGraphResource version = unreferenced.back();
+		unreferenced.pop_back();
+
+		PassNode& producer = mPasses[mVersions[version].producer];
+		if (!producer.culled && --producer.references == 0)
+		{
+			cullPass(mVersions[version].producer);
+		}
+	}
+}
+
+void IFrameGraph::_schedule()
+{
+	const uint32_t passCount = static_cast<uint32_t>(mPasses.size());
+
+	std::vector<std::vector<uint32_t>> successors(passCount);
+	std::vector<uint32_t> predecessors(passCount, 0);
+
+	auto addEdge = [&](const uint32_t from, const uint32_t to)
+	{
+		if (from == to || mPasses[from].culled)
+		{
+			return;
+		}
+
+		auto& edges = successors[from];
+		if (std::find(edges.begin(), edges.end(), to) == edges.end())
+		{
+			edges.push_back(to);
+			predecessors[to]++;
+		}
+	};
+
+	for (uint32_t index = 0; index < passCount; index++)
+	{
+		const PassNode& pass = mPasses[index];
+		if (pass.culled)
+		{
+			continue;
+		}
+
+		for (const auto& read : pass.reads)
+		{
+			if (mVersions[read.version].producer != noPass)
+			{
+				addEdge(mVersions[read.version].producer, index);
+			}
+		}
+
+		for (const auto write : pass.writes)
+		{
+			const FrameGraphResource previous = mVersions[write].previous;
+			if (previous == invalidFrameGraphResource)
+			{
+				continue;
+			}
+
+			// Read after write on the loaded contents, write after read against earlier samplers
+			if (mVersions[previous].producer != noPass)
+			{
+				addEdge(mVersions[previous].producer, index);
+			}
+
+			for (const auto reader : mVersions[previous].readers)
+			{
+				addEdge(reader, index);
+			}
+		}
+	}
+
+	// Kahn's algorithm, ties go to the pass declared first so the order stays predictable
+	std::vector<bool> scheduled(passCount, false);
+	mSchedule.clear();
+
+	while (true)
+	{
+		uint32_t next = noPass;
+		for (uint32_t index = 0; index < passCount; index++)
+		{
+			if (!mPasses[index].culled && !scheduled[index] && predecessors[index] == 0)
+			{
+				next = index;
+				break;
+			}
+		}
+
+		if (next == noPass)
+		{
+			break;
+		}
+
+		scheduled[next] = true;
+		mSchedule.push_back(next);
+
+		for (const auto successor : successors[next])
+		{
+			predecessors[successor]--;
+		}
+	}
+
+	QGFX_ASSERT_MSG(mSchedule.size() + mStatistics.culledPasses == passCount, "Frame graph has a dependency cycle.\n");
+	mStatistics.passes = static_cast<uint32_t>(mSchedule.size());
+}
+
+void IFrameGraph::_computeLifetimes()
+{
+	for (auto& resource : mResources)
+	{
+		resource.firstUse = noPass;
+		resource.lastUse = noPass;
+		resource.slot = noResource;
+		resource.aliasedFrom = noResource;
+		resource.lazy = false;
+	}
+
+	auto use = [this](const uint32_t resource, const uint32_t position)
+	{
+		ResourceNode& node = mResources[resource];
+		if (node.firstUse == noPass)
+		{
+			node.firstUse = position;
+		}
+		node.lastUse = position;
+	};
+
+	for (uint32_t position = 0; position < mSchedule.size(); position++)
+	{
+		const PassNode& pass = mPasses[mSchedule[position]];
+		for (const auto& read : pass.reads)
+		{
+			use(mVersions[read.version].resource, position);
+		}
+
+		for (const auto write : pass.writes)
+		{
+			use(mVersions[write].resource, position);
+		}
+	}
+
+	for (uint32_t position = 0; position < mSchedule.size(); position++)
+	{
+		PassNode& pass = mPasses[mSchedule[position]];
+		pass.sampled.clear();
+		pass.colorAttachments.clear();
+		pass.resolveAttachments.clear();
+		pass.hasDepthAttachment = false;
+
+		for (const auto& read : pass.reads)
+		{
+			pass.sampled.push_back({ mVersions[read.version].resource, read.stages });
+		}
+
+		auto getAttachment = [&](const FrameGraphResource write)
+		{
+			const uint32_t resource = mVersions[write].resource;
+			const ResourceNode& node = mResources[resource];
+			const FrameGraphResource previous = mVersions[write].previous;
+
+			Attachment attachment;
+			attachment.resource = resource;
+
+			// Nothing was written before, so there is nothing to load
+			attachment.clear = node.imported == nullptr && mVersions[previous].producer == noPass;
+
+			// Contents nobody looks at again never have to leave tile memory
+			attachment.store = node.imported != nullptr || node.lastUse > position;
+
+			return attachment;
+		};
+
+		auto isResolveDestination = [&pass](const FrameGraphResource write)
+		{
+			for (const auto& resolve : pass.resolves)
+			{
+				if (resolve.destination == write)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		};
+
+		for (const auto write : pass.writes)
+		{
+			if (isResolveDestination(write))
+			{
+				continue;
+			}
+
+			const Attachment attachment = getAttachment(write);
+			if (hasDepthAspect(mResources[attachment.resource].description.imageType))
+			{
+				QGFX_ASSERT_MSG(!pass.hasDepthAttachment, "Pass %s writes more than one depth texture.\n", pass.name.c_str());
+				pass.depthAttachment = attachment;
+				pass.hasDepthAttachment = true;
+			}
+			else
+			{
+				pass.colorAttachments.push_back(attachment);
+
+				Attachment resolve = { noResource, false, false };
+				for (const auto& entry : pass.resolves)
+				{
+					if (entry.source == write)
+					{
+						resolve = getAttachment(entry.destination);
+					}
+				}
+				pass.resolveAttachments.push_back(resolve);
+			}
+
+			// Written once and never looked at again, the texture only ever lives in tile memory
+			ResourceNode& node = mResources[attachment.resource];
+			node.lazy = attachment.clear && !attachment.store && node.firstUse == position;
+		}
+	}
+}
+
+void IFrameGraph::_assignSlots()
+{
+	std::vector<uint32_t> transients;
+	for (uint32_t resource = 0; resource < mResources.size(); resource++)
+	{
+		if (mResources[resource].imported == nullptr && mResources[resource].firstUse != noPass)
+		{
+			transients.push_back(resource);
+		}
+	}
+
+	std::sort(transients.begin(), transients.end(), [this](const uint32_t a, const uint32_t b)
+	{
+		return mResources[a].firstUse < mResources[b].firstUse;
+	});
+
+	// Last resource to use each slot
+	std::vector<uint32_t> slots;
+
+	for (const auto resource : transients)
+	{
+		ResourceNode& node = mResources[resource];
+		for (uint32_t slot = 0; slot < slots.size(); slot++)
+		{
+			const ResourceNode& previous = mResources[slots[slot]];
+			if (previous.lastUse < node.firstUse && previous.lazy == node.lazy && _canAlias(previous.description, node.description))
+			{
+				node.slot = slot;
+				node.aliasedFrom = slots[slot];
+				slots[slot] = resource;
+				break;
+			}
+		}
+
+		if (node.slot == noResource)
+		{
+			node.slot = static_cast<uint32_t>(slots.size());
+			slots.push_back(resource);
+		}
+	}
+
+	mStatistics.transientTextures = static_cast<uint32_t>(transients.size());
+	for (const auto resource : transients)
+	{
+		mStatistics.lazyTextures += mResources[resource].lazy ? 1 : 0;
+	}
+	mStatistics.physicalTextures = static_cast<uint32_t>(slots.size());
+}
@@ -0,0 +1,250 @@
+#include "qgfx/api/igpuprofiler.h"
+#include "qgfx/qassert.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static constexpr uint32_t noScope = ~0u;
+
+IGpuProfiler::IGpuProfiler(ContextHandle* handle, const uint32_t maxScopes, const uint32_t historyLength)
+	: mHandle(handle), mMaxScopes(maxScopes), mHistoryLength(historyLength), mSummaryInterval(0), mCurrentSlot(0),
+	  mCurrentScope(noScope), mInFrame(false), mStatistics({})
+{
+	QGFX_ASSERT_MSG(maxScopes > 0, "GPU profiler needs room for at least one scope.\n");
+	QGFX_ASSERT_MSG(historyLength > 0, "GPU profiler needs a history of at least one frame.\n");
+}
+
+void IGpuProfiler::beginFrame(CommandBuffer* commandBuffer)
+{
+	QGFX_ASSERT_MSG(!mInFrame, "GPU profiler frame already begun.\n");
+	QGFX_ASSERT_MSG(!mSlots.empty(), "GPU profiler is not constructed.\n");
+
+	mInFrame = true;
+	if (!isSupported())
+	{
+		return;
+	}
+
+	mCurrentSlot = _acquireSlot();
+	Slot& slot = mSlots[mCurrentSlot];
+
+	if (slot.pending)
+	{
+		_resolve(slot, mCurrentSlot);
+	}
+
+	slot.scopes.clear();
+	slot.queryCount = 0;
+	slot.pending = false;
+	mCurrentScope = noScope;
+
+	_resetQueries(commandBuffer, mCurrentSlot);
+}
+
+void IGpuProfiler::endFrame()
+{
+	QGFX_ASSERT_MSG(mInFrame, "GPU profiler frame was not begun.\n");
+	QGFX_ASSERT_MSG(mCurrentScope == noScope, "GPU profiler scope left open at the end of the frame.\n");
+
+	mInFrame = false;
+	if (!isSupported())
+	{
+		return;
+	}
+
+	Slot& slot = mSlots[mCurrentSlot];
+	slot.pending = !slot.scopes.empty();
+}
+
+void IGpuProfiler::beginScope(CommandBuffer* commandBuffer, const char* name)
+{
+	QGFX_ASSERT_MSG(mInFrame, "GPU profiler scopes have to be inside beginFrame and endFrame.\n");
+	if (!isSupported())
+	{
+		return;
+	}
+
+	Slot& slot = mSlots[mCurrentSlot];
+
+	// Overflowing scopes still have to nest, they are recorded without queries
+	const bool overflow = slot.queryCount + 2 > mMaxScopes * 2;
+	uint32_t depth = 0;
+	for (uint32_t parent = mCurrentScope; parent != noScope; parent = slot.scopes[parent].parent)
+	{
+		depth++;
+	}
+
+	Scope scope;
+	scope.timing = _findOrAddTiming(name, depth);
+	scope.parent = mCurrentScope;
+	scope.beginQuery = overflow ? noScope : slot.queryCount++;
+	scope.endQuery = overflow ? noScope : slot.queryCount++;
+
+	if (overflow)
+	{
+		mStatistics.overflowedScopes++;
+	}
+	else
+	{
+		_writeTimestamp(commandBuffer, mCurrentSlot, scope.beginQuery);
+	}
+
+	mCurrentScope = static_cast<uint32_t>(slot.scopes.size());
+	slot.scopes.push_back(scope);
+}
+
+void IGpuProfiler::endScope(CommandBuffer* commandBuffer)
+{
+	QGFX_ASSERT_MSG(mInFrame, "GPU profiler scopes have to be inside beginFrame and endFrame.\n");
+	if (!isSupported())
+	{
+		return;
+	}
+
+	QGFX_ASSERT_MSG(mCurrentScope != noScope, "GPU profiler scope ended without being begun.\n");
+
+	Slot& slot = mSlots[mCurrentSlot];
+	const Scope& scope = slot.scopes[mCurrentScope];
+	if (scope.endQuery != noScope)
+	{
+		_writeTimestamp(commandBuffer, mCurrentSlot, scope.endQuery);
+	}
+
+	mCurrentScope = scope.parent;
+}
+
+const GpuScopeTiming* IGpuProfiler::findTiming(const char* name) const
+{
+	for (const auto& timing : mTimings)
+	{
+		if (strcmp(timing.name, name) == 0)
+		{
+			return &timing;
+		}
+	}
+
+	return nullptr;
+}
+
+void IGpuProfiler::printSummary() const
+{
+	printf("GPU timings over the last %u frames (ms)\n", std::min(mHistoryLength, mStatistics.resolvedFrames));
+	printf("%-32s %10s %10s %10s %10s\n", "scope", "last", "avg", "min", "max");
+
+	for (const auto& timing : mTimings)
+	{
+		const int indent = static_cast<int>(timing.depth * 2);
+		printf("%*s%-*s %10.3f %10.3f %10.3f %10.3f\n", indent, "", 32 - indent, timing.name, timing.lastMs, timing.averageMs,
+			timing.minMs, timing.maxMs);
+	}
+
+	if (mStatistics.droppedFrames > 0 || mStatistics.overflowedScopes > 0)
+	{
+		printf("%u frames dropped, %u scopes overflowed\n", mStatistics.droppedFrames, mStatistics.overflowedScopes);
+	}
+}
+
+void IGpuProfiler::_initialize(const uint32_t slotCount)
+{
+	QGFX_ASSERT_MSG(mSlots.empty(), "GPU profiler already constructed.\n");
+
+	mSlots.resize(slotCount);
+	for (auto& slot : mSlots)
+	{
+		slot.queryCount = 0;
+		slot.pending = false;
+	}
+
+	mTimestamps.resize(mMaxScopes * 2);
+}
+
+uint32_t IGpuProfiler::_findOrAddTiming(const char* name, const uint32_t depth)
+{
+	for (uint32_t i = 0; i < mTimings.size(); i++)
+	{
+		if (strcmp(mTimings[i].name, name) == 0)
+		{
+			return i;
+		}
+	}
+
+	GpuScopeTiming timing = {};
+	timing.name = name;
+	timing.depth = depth;
+	mTimings.push_back(timing);
+
+	History history;
+	history.samples.resize(mHistoryLength);
+	history.next = 0;
+	history.frameMs = 0.0;
+	history.touched = false;
+	mHistories.push_back(history);
+
+	return static_cast<uint32_t>(mTimings.size() - 1);
+}
+
+void IGpuProfiler::_resolve(Slot& slot, const uint32_t index)
+{
+	slot.pending = false;
+
+	// The slot's frame has had several frames to finish, a result that is still missing is
+	// dropped instead of stalling the CPU on it
+	if (!_getTimestamps(index, slot.queryCount, mTimestamps.data()))
+	{
+		mStatistics.droppedFrames++;
+		return;
+	}
+
+	for (const auto& scope : slot.scopes)
+	{
+		if (scope.beginQuery == noScope)
+		{
+			continue;
+		}
+
+		History& history = mHistories[scope.timing];
+		history.frameMs += std::max(0.0, mTimestamps[scope.endQuery] - mTimestamps[scope.beginQuery]);
+		history.touched = true;
+	}
+
+	for (uint32_t i = 0; i < mHistories.size(); i++)
+	{
+		if (mHistories[i].touched)
+		{
+			_addSample(i, mHistories[i].frameMs);
+			mHistories[i].frameMs = 0.0;
+			mHistories[i].touched = false;
+		}
+	}
+
+	mStatistics.resolvedFrames++;
+	if (mSummaryInterval > 0 && mStatistics.resolvedFrames % mSummaryInterval == 0)
+	{
+		printSummary();
+	}
+}
+
+void IGpuProfiler::_addSample(const uint32_t timing, const double milliseconds)
+{
+	History& history = mHistories[timing];
+	history.samples[history.next] = milliseconds;
+	history.next = (history.next + 1) % mHistoryLength;
+
+	GpuScopeTiming& result = mTimings[timing];
+	result.samples = std::min(result.samples + 1, mHistoryLength);
+	result.lastMs = milliseconds;
+
+	// The window is short, rescanning it keeps min and max exact as old samples fall out
+	double sum = 0.0;
+	result.minMs = milliseconds;
+	result.maxMs = milliseconds;
+	for (uint32_t i = 0; i < result.samples; i++)
+	{
+		const double sample = history.samples[(history.next + mHistoryLength - 1 - i) % mHistoryLength];
+		sum += sample;
+		result.minMs = std::min(result.minMs, sample);
+		result.maxMs = std::max(result.maxMs, sample);
+	}
+	result.averageMs = sum / result.samples;
+}
@@ -1,7 +1,54 @@
 #include "qgfx/api/iimage2d.h"
+#include "qgfx/image_format.h"
+#include "qgfx/mip_generator.h"
+#include "qgfx/qassert.h"
 
 IImage2D::IImage2D(ContextHandle* handle)
-	: mHandle(handle)
+	: mHandle(handle), mMipLevels(1), mResidentMip(0), mSamples(1)
 {
 	
-}
\ No newline at end of file
+}
+
+void IImage2D::setResidentMip(const uint32_t level)
+{
+	QGFX_ASSERT_MSG(level < mMipLevels, "Resident mip is outside of the mip chain.\n");
+	mResidentMip = level;
+}
+
+uint32_t IImage2D::getMipChainLength(const uint32_t width, const uint32_t height)
+{
+	uint32_t levels = 1;
+	uint32_t size = width > height ? width : height;
+	while (size > 1)
+	{
+		size >>= 1;
+		levels++;
+	}
+
+	return levels;
+}
+
+void IImage2D::_generateMipsOnCpu(const uint8_t* data, const uint32_t width, const uint32_t height)
+{
+	uint8_t* buffers[2] = {
+		new uint8_t[getImageMipSize(width, height, 1, mImageFormat, mImageDataType)],
+		new uint8_t[getImageMipSize(width, height, 2, mImageFormat, mImageDataType)]
+	};
+
+	const uint8_t* source = data;
+	for (uint32_t level = 1; level < mMipLevels; level++)
+	{
+		const uint32_t sourceWidth = width >> (level - 1) ? width >> (level - 1) : 1;
+		const uint32_t sourceHeight = height >> (level - 1) ? height >> (level - 1) : 1;
+
+		// Each level is at most half the size of the one before, so two buffers are enough
+		uint8_t* destination = buffers[(level - 1) % 2];
+		downsampleImage(source, sourceWidth, sourceHeight, destination, mImageFormat, mImageDataType);
+		setMipData(level, destination, static_cast<uint32_t>(getImageMipSize(width, height, level, mImageFormat, mImageDataType)));
+
+		source = destination;
+	}
+
+	delete[] buffers[0];
+	delete[] buffers[1];
+}
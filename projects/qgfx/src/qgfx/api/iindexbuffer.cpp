@@ -0,0 +1,80 @@
+#include "qgfx/api/iindexbuffer.h"
+#include "qgfx/mesh_optimizer.h"
+
+#include <cstring>
+
+IIndexBuffer::IIndexBuffer(ContextHandle* handle)
+	: mHandle(handle), mCount(0), mIndexType(IndexType::UInt32), mData(nullptr), mOwnsData(false)
+{
+}
+
+IIndexBuffer::~IIndexBuffer()
+{
+	_releaseData();
+}
+
+void IIndexBuffer::setData(const uint32_t* indices, const size_t count)
+{
+	_releaseData();
+
+	mCount = static_cast<uint32_t>(count);
+	mIndexType = selectIndexType(indices, count);
+	uint8_t* data = new uint8_t[getSize()];
+	mData = data;
+	mOwnsData = true;
+
+	if (mIndexType == IndexType::UInt32)
+	{
+		memcpy(data, indices, getSize());
+		return;
+	}
+
+	uint16_t* narrow = reinterpret_cast<uint16_t*>(data);
+	for (size_t i = 0; i < count; i++)
+	{
+		narrow[i] = indices[i] == primitiveRestartIndex ? 0xFFFF : static_cast<uint16_t>(indices[i]);
+	}
+}
+
+void IIndexBuffer::setOptimizedData(const uint32_t* indices, const size_t count, const size_t vertexCount, const uint32_t cacheSize)
+{
+	uint32_t* optimized = new uint32_t[count];
+	optimizeVertexCache(optimized, indices, count, vertexCount, cacheSize);
+	setData(optimized, count);
+	delete[] optimized;
+}
+
+void IIndexBuffer::setExternalData(const void* indices, const size_t count, const IndexType type)
+{
+	_releaseData();
+
+	mCount = static_cast<uint32_t>(count);
+	mIndexType = type;
+	mData = reinterpret_cast<const uint8_t*>(indices);
+	mOwnsData = false;
+}
+
+IndexType IIndexBuffer::selectIndexType(const uint32_t* indices, const size_t count)
+{
+	uint32_t maxIndex = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (indices[i] != primitiveRestartIndex && indices[i] > maxIndex)
+		{
+			maxIndex = indices[i];
+		}
+	}
+
+	// 0xFFFF is the 16 bit restart index, so it can not be used as a vertex index.
+	return maxIndex < 0xFFFF ? IndexType::UInt16 : IndexType::UInt32;
+}
+
+void IIndexBuffer::_releaseData()
+{
+	if (mOwnsData)
+	{
+		delete[] mData;
+	}
+	mData = nullptr;
+	mOwnsData = false;
+}
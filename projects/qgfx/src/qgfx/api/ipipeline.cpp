@@ -2,4 +2,18 @@
 
 IPipeline::IPipeline(ContextHandle* handle)
 	: mHandle(handle)
-{	}
\ No newline at end of file
+{	}
+
+void IPipeline::addVertexLayout(const VertexBufferLayout& layout)
+{
+	// Two layouts on one binding would describe the same buffer twice
+	for (const auto& existing : mVertexLayouts)
+	{
+		if (existing.getBinding() == layout.getBinding())
+		{
+			QGFX_ASSERT_MSG(false, "Vertex layout binding already in use.\n");
+			return;
+		}
+	}
+	mVertexLayouts.push_back(layout);
+}
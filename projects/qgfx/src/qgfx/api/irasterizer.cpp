@@ -1,6 +1,24 @@
 #include "qgfx/api/irasterizer.h"
 
 IRasterizer::IRasterizer(ContextHandle * handle)
-	: mHandle(handle)
+	: mHandle(handle), mDepthTest(true), mDepthWrite(true), mDepthCompare(CompareOp::Less), mStencilTest(false), mColorWrite(true),
+	  mReverseZ(false)
 {
 }
+
+CompareOp IRasterizer::_getDeviceDepthCompare() const
+{
+	if (!mReverseZ)
+	{
+		return mDepthCompare;
+	}
+
+	switch (mDepthCompare)
+	{
+		case CompareOp::Less: return CompareOp::Greater;
+		case CompareOp::LessOrEqual: return CompareOp::GreaterOrEqual;
+		case CompareOp::Greater: return CompareOp::Less;
+		case CompareOp::GreaterOrEqual: return CompareOp::LessOrEqual;
+		default: return mDepthCompare;
+	}
+}
@@ -0,0 +1,170 @@
+#include "qgfx/api/ireadbackqueue.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/image_format.h"
+#include "qgfx/qassert.h"
+
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_image2d.h"
+#elif defined(QGFX_VULKAN)
+#include "qgfx/vulkan/vulkan_image2d.h"
+#endif
+
+#include <cstring>
+
+ReadbackFuture::ReadbackFuture(IReadbackQueue* queue, const uint32_t slot, const uint64_t ticket)
+	: mQueue(queue), mSlot(slot), mTicket(ticket)
+{
+}
+
+bool ReadbackFuture::isValid() const
+{
+	return mQueue != nullptr && mQueue->_find(mSlot, mTicket) != nullptr;
+}
+
+bool ReadbackFuture::isReady() const
+{
+	return isValid() && mQueue->_isReady(mSlot, mTicket);
+}
+
+void ReadbackFuture::wait() const
+{
+	QGFX_ASSERT_MSG(isValid(), "Readback is no longer valid, its slot has been reused.\n");
+	mQueue->_waitFor(mSlot, mTicket);
+}
+
+void ReadbackFuture::get(uint8_t* destination) const
+{
+	QGFX_ASSERT_MSG(isValid(), "Readback is no longer valid, its slot has been reused.\n");
+	mQueue->_read(mSlot, mTicket, destination);
+}
+
+uint32_t ReadbackFuture::getWidth() const
+{
+	return isValid() ? mQueue->_find(mSlot, mTicket)->width : 0;
+}
+
+uint32_t ReadbackFuture::getHeight() const
+{
+	return isValid() ? mQueue->_find(mSlot, mTicket)->height : 0;
+}
+
+size_t ReadbackFuture::getSize() const
+{
+	return isValid() ? mQueue->_find(mSlot, mTicket)->size : 0;
+}
+
+IReadbackQueue::IReadbackQueue(ContextHandle* handle, const uint32_t slotCount)
+	: mHandle(handle), mNextSlot(0), mNextTicket(1), mStatistics({})
+{
+	QGFX_ASSERT_MSG(slotCount > 0, "Readback queue needs at least one slot.\n");
+
+	mSlots.resize(slotCount);
+	for (auto& slot : mSlots)
+	{
+		slot = {};
+	}
+}
+
+ReadbackFuture IReadbackQueue::readBackBuffer()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const uint32_t width = mHandle->getBackBufferWidth();
+	const uint32_t height = mHandle->getBackBufferHeight();
+
+	const uint32_t slot = _acquire(width, height, static_cast<size_t>(width) * height * 4);
+	mSlots[slot].flipRows = _copyBackBuffer(slot);
+
+	return ReadbackFuture(this, slot, mSlots[slot].ticket);
+}
+
+ReadbackFuture IReadbackQueue::readImage(Image2D* image)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(image->getImageType() == ImageType::Color, "Only color images can be read back.\n");
+	QGFX_ASSERT_MSG(image->getSamples() == 1, "Resolve multisampled images before reading them back.\n");
+	QGFX_ASSERT_MSG(!isCompressedImageFormat(image->getImageFormat()), "Compressed images can not be read back.\n");
+
+	const size_t size = getImageMipSize(image->getWidth(), image->getHeight(), 0, image->getImageFormat(), image->getImageDataType());
+	const uint32_t slot = _acquire(image->getWidth(), image->getHeight(), size);
+	_copyImage(slot, image);
+
+	return ReadbackFuture(this, slot, mSlots[slot].ticket);
+}
+
+uint32_t IReadbackQueue::_acquire(const uint32_t width, const uint32_t height, const size_t size)
+{
+	const uint32_t slot = mNextSlot;
+	mNextSlot = (mNextSlot + 1) % static_cast<uint32_t>(mSlots.size());
+
+	// The GPU may still be copying into the oldest slot when readbacks are requested faster
+	// than they complete.  Its result is dropped either way, the wait only protects the memory.
+	Slot& state = mSlots[slot];
+	if (state.pending)
+	{
+		if (!_isComplete(slot))
+		{
+			mStatistics.slotWaits++;
+			_wait(slot);
+		}
+		state.pending = false;
+	}
+
+	_reserve(slot, size);
+
+	state.ticket = mNextTicket++;
+	state.width = width;
+	state.height = height;
+	state.size = size;
+	state.pending = true;
+	state.flipRows = false;
+
+	mStatistics.requests++;
+
+	return slot;
+}
+
+const IReadbackQueue::Slot* IReadbackQueue::_find(const uint32_t slot, const uint64_t ticket) const
+{
+	return slot < mSlots.size() && mSlots[slot].ticket == ticket ? &mSlots[slot] : nullptr;
+}
+
+bool IReadbackQueue::_isReady(const uint32_t slot, const uint64_t ticket)
+{
+	const Slot* state = _find(slot, ticket);
+	return state != nullptr && (!state->pending || _isComplete(slot));
+}
+
+void IReadbackQueue::_waitFor(const uint32_t slot, const uint64_t ticket)
+{
+	if (!_isReady(slot, ticket))
+	{
+		mStatistics.stalls++;
+		_wait(slot);
+	}
+}
+
+void IReadbackQueue::_read(const uint32_t slot, const uint64_t ticket, uint8_t* destination)
+{
+	_waitFor(slot, ticket);
+
+	const Slot& state = mSlots[slot];
+	const uint8_t* data = _getData(slot);
+
+	if (state.flipRows)
+	{
+		const size_t rowSize = state.size / state.height;
+		for (uint32_t y = 0; y < state.height; y++)
+		{
+			memcpy(destination + y * rowSize, data + (state.height - 1 - y) * rowSize, rowSize);
+		}
+	}
+	else
+	{
+		memcpy(destination, data, state.size);
+	}
+
+	mStatistics.completed++;
+	mStatistics.bytesRead += state.size;
+}
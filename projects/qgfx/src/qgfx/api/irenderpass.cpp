@@ -1,7 +1,129 @@
 #include "qgfx/api/irenderpass.h"
+#include "qgfx/qassert.h"
+
+static bool isSameAttachment(const RenderPassAttachment& a, const RenderPassAttachment& b)
+{
+	if (a.swapChain != b.swapChain || a.loadOp != b.loadOp || a.storeOp != b.storeOp || a.stencilLoadOp != b.stencilLoadOp ||
+		a.stencilStoreOp != b.stencilStoreOp)
+	{
+		return false;
+	}
+
+	return a.swapChain || (a.format == b.format && a.type == b.type && a.imageType == b.imageType);
+}
 
 IRenderPass::IRenderPass(ContextHandle* handle)
 	: mHandle(handle)
 {
 	
-}
\ No newline at end of file
+}
+
+void RenderPassDescription::addColorAttachment(const RenderPassAttachment& attachment)
+{
+	QGFX_ASSERT_MSG(colorAttachmentCount < maxColorAttachments, "Render pass has too many color attachments.\n");
+	colorAttachments[colorAttachmentCount++] = attachment;
+}
+
+void RenderPassDescription::setDepthAttachment(const RenderPassAttachment& attachment)
+{
+	QGFX_ASSERT_MSG((static_cast<uint32_t>(attachment.imageType) & static_cast<uint32_t>(ImageType::Depth)) != 0,
+		"Depth attachment needs a depth image type.\n");
+	depthAttachment = attachment;
+	hasDepthAttachment = true;
+}
+
+void RenderPassDescription::setResolveAttachment(const uint32_t colorAttachment, const RenderPassAttachment& attachment)
+{
+	QGFX_ASSERT_MSG(colorAttachment < colorAttachmentCount, "Resolve attachment needs a color attachment.\n");
+	QGFX_ASSERT_MSG(!hasDepthAspect(attachment.imageType), "Only color attachments can be resolved.\n");
+
+	if (!hasResolveAttachment[colorAttachment])
+	{
+		hasResolveAttachment[colorAttachment] = true;
+		resolveAttachmentCount++;
+	}
+	resolveAttachments[colorAttachment] = attachment;
+}
+
+uint32_t RenderPassDescription::getResolveAttachmentIndex(const uint32_t colorAttachment) const
+{
+	QGFX_ASSERT_MSG(colorAttachment < colorAttachmentCount && hasResolveAttachment[colorAttachment], "Color attachment is not resolved.\n");
+
+	uint32_t index = colorAttachmentCount + (hasDepthAttachment ? 1 : 0);
+	for (uint32_t i = 0; i < colorAttachment; i++)
+	{
+		index += hasResolveAttachment[i] ? 1 : 0;
+	}
+
+	return index;
+}
+
+uint64_t RenderPassDescription::getHash() const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const auto combine = [&hash](const uint64_t value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ULL;
+	};
+
+	const auto combineAttachment = [&combine](const RenderPassAttachment& attachment)
+	{
+		// Swap chain formats are picked by the context, so the ones given are not part of the key
+		combine(attachment.swapChain);
+		combine(attachment.swapChain ? 0 : static_cast<uint64_t>(attachment.format));
+		combine(attachment.swapChain ? 0 : static_cast<uint64_t>(attachment.type));
+		combine(attachment.swapChain ? 0 : static_cast<uint64_t>(attachment.imageType));
+		combine(static_cast<uint64_t>(attachment.loadOp));
+		combine(static_cast<uint64_t>(attachment.storeOp));
+		combine(static_cast<uint64_t>(attachment.stencilLoadOp));
+		combine(static_cast<uint64_t>(attachment.stencilStoreOp));
+	};
+
+	combine(colorAttachmentCount);
+	for (uint32_t i = 0; i < colorAttachmentCount; i++)
+	{
+		combineAttachment(colorAttachments[i]);
+	}
+
+	combine(hasDepthAttachment);
+	if (hasDepthAttachment)
+	{
+		combineAttachment(depthAttachment);
+	}
+
+	combine(samples);
+	for (uint32_t i = 0; i < colorAttachmentCount; i++)
+	{
+		combine(hasResolveAttachment[i]);
+		if (hasResolveAttachment[i])
+		{
+			combineAttachment(resolveAttachments[i]);
+		}
+	}
+
+	return hash;
+}
+
+bool RenderPassDescription::operator == (const RenderPassDescription& other) const
+{
+	if (colorAttachmentCount != other.colorAttachmentCount || hasDepthAttachment != other.hasDepthAttachment || samples != other.samples)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < colorAttachmentCount; i++)
+	{
+		if (!isSameAttachment(colorAttachments[i], other.colorAttachments[i]) || hasResolveAttachment[i] != other.hasResolveAttachment[i])
+		{
+			return false;
+		}
+
+		if (hasResolveAttachment[i] && !isSameAttachment(resolveAttachments[i], other.resolveAttachments[i]))
+		{
+			return false;
+		}
+	}
+
+	return !hasDepthAttachment || isSameAttachment(depthAttachment, other.depthAttachment);
+}
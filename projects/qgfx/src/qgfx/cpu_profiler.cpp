@@ -0,0 +1,228 @@
+#include "qgfx/cpu_profiler.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 24 bytes per event, 3 MB per thread that records zones
+static constexpr uint32_t eventsPerThread = 1u << 17;
+
+struct CpuProfilerEvent
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+// Written only by the thread that owns it.  Other threads read count and the events before
+// it, which the release store of count publishes.
+struct CpuProfilerThreadBuffer
+{
+	uint32_t id;
+	char name[64];
+	std::unique_ptr<CpuProfilerEvent[]> events;
+	std::atomic<uint32_t> count;
+	std::atomic<uint32_t> capture;
+	std::atomic<uint64_t> dropped;
+};
+
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<CpuProfilerThreadBuffer>> registry;
+
+static std::atomic<uint32_t> captureIndex(0);
+static std::atomic<uint64_t> captureBegin(0);
+static std::atomic<uint64_t> captureEnd(0);
+
+static thread_local CpuProfilerThreadBuffer* threadBuffer = nullptr;
+
+static CpuProfilerThreadBuffer* getThreadBuffer()
+{
+	if (threadBuffer == nullptr)
+	{
+		std::unique_ptr<CpuProfilerThreadBuffer> buffer(new CpuProfilerThreadBuffer());
+		buffer->events.reset(new CpuProfilerEvent[eventsPerThread]);
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->capture.store(captureIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		buffer->id = static_cast<uint32_t>(registry.size());
+		snprintf(buffer->name, sizeof(buffer->name), "Thread %u", buffer->id);
+
+		threadBuffer = buffer.get();
+		registry.push_back(std::move(buffer));
+	}
+
+	return threadBuffer;
+}
+
+// Drops the events of the previous capture the first time the thread records into a new one
+static void syncCapture(CpuProfilerThreadBuffer* buffer)
+{
+	const uint32_t capture = captureIndex.load(std::memory_order_acquire);
+	if (buffer->capture.load(std::memory_order_relaxed) != capture)
+	{
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+		buffer->capture.store(capture, std::memory_order_release);
+	}
+}
+
+// "void VulkanContextHandle::startFrame()" becomes "VulkanContextHandle::startFrame"
+static std::string trimFunctionName(const char* name)
+{
+	std::string result(name);
+
+	const size_t arguments = result.find('(');
+	if (arguments == std::string::npos)
+	{
+		return result;
+	}
+	result.resize(arguments);
+
+	const size_t returnType = result.rfind(' ');
+	if (returnType != std::string::npos)
+	{
+		result.erase(0, returnType + 1);
+	}
+
+	return result;
+}
+
+static void writeJsonString(FILE* file, const std::string& value)
+{
+	fputc('"', file);
+	for (const char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', file);
+			fputc(c, file);
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			fprintf(file, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+std::atomic<bool> CpuProfiler::sCapturing(false);
+
+void CpuProfiler::beginCapture()
+{
+	captureBegin.store(now(), std::memory_order_relaxed);
+	captureEnd.store(0, std::memory_order_relaxed);
+	captureIndex.fetch_add(1, std::memory_order_acq_rel);
+	sCapturing.store(true, std::memory_order_release);
+}
+
+void CpuProfiler::endCapture()
+{
+	sCapturing.store(false, std::memory_order_release);
+	captureEnd.store(now(), std::memory_order_relaxed);
+}
+
+void CpuProfiler::setThreadName(const char* name)
+{
+	CpuProfilerThreadBuffer* buffer = getThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+}
+
+void CpuProfiler::record(const char* name, const uint64_t begin, const uint64_t end)
+{
+	CpuProfilerThreadBuffer* buffer = getThreadBuffer();
+	syncCapture(buffer);
+
+	const uint32_t index = buffer->count.load(std::memory_order_relaxed);
+	if (index >= eventsPerThread)
+	{
+		buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer->events[index] = { name, begin, end };
+	buffer->count.store(index + 1, std::memory_order_release);
+}
+
+CpuProfilerStatistics CpuProfiler::getStatistics()
+{
+	CpuProfilerStatistics statistics = {};
+	const uint32_t capture = captureIndex.load(std::memory_order_acquire);
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	statistics.threads = static_cast<uint32_t>(registry.size());
+
+	for (const auto& buffer : registry)
+	{
+		if (buffer->capture.load(std::memory_order_acquire) == capture)
+		{
+			statistics.events += buffer->count.load(std::memory_order_acquire);
+			statistics.droppedEvents += buffer->dropped.load(std::memory_order_relaxed);
+		}
+	}
+
+	return statistics;
+}
+
+bool CpuProfiler::writeChromeTrace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	const uint32_t capture = captureIndex.load(std::memory_order_acquire);
+	const uint64_t begin = captureBegin.load(std::memory_order_relaxed);
+	const uint64_t end = captureEnd.load(std::memory_order_relaxed);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	bool first = true;
+	for (const auto& buffer : registry)
+	{
+		if (buffer->capture.load(std::memory_order_acquire) != capture)
+		{
+			continue;
+		}
+
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", buffer->id);
+		writeJsonString(file, buffer->name);
+		fprintf(file, "}}");
+		first = false;
+
+		const uint32_t count = buffer->count.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const CpuProfilerEvent& event = buffer->events[i];
+
+			// Zones opened before the capture began, or closed after it ended, are cut off
+			if (event.begin < begin || (end != 0 && event.end > end))
+			{
+				continue;
+			}
+
+			// Complete events in microseconds, three decimals keep the nanoseconds
+			fprintf(file, ",\n{\"name\":");
+			writeJsonString(file, trimFunctionName(event.name));
+			fprintf(file, ",\"cat\":\"qgfx\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->id,
+				static_cast<double>(event.begin - begin) / 1000.0, static_cast<double>(event.end - event.begin) / 1000.0);
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	return true;
+}
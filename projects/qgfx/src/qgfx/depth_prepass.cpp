@@ -0,0 +1,161 @@
+#include "qgfx/depth_prepass.h"
+
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_rasterizer.h"
+#elif defined(QGFX_VULKAN)
+#include "qgfx/vulkan/vulkan_rasterizer.h"
+#endif
+
+#if defined(QGFX_OPENGL)
+struct DepthState
+{
+	bool depthTest;
+	bool depthWrite;
+	CompareOp depthCompare;
+	bool colorWrite;
+};
+
+static DepthState saveDepthState(const Rasterizer* rasterizer)
+{
+	return { rasterizer->isDepthTestEnabled(), rasterizer->isDepthWriteEnabled(), rasterizer->getDepthCompare(), rasterizer->isColorWriteEnabled() };
+}
+
+static void restoreDepthState(Rasterizer* rasterizer, const DepthState& state)
+{
+	rasterizer->setDepthTest(state.depthTest);
+	rasterizer->setDepthWrite(state.depthWrite);
+	rasterizer->setDepthCompare(state.depthCompare);
+	rasterizer->setColorWrite(state.colorWrite);
+}
+#endif
+
+DepthPrepass::DepthPrepass(ContextHandle* handle)
+	: mHandle(handle)
+{
+}
+
+DepthPrepass::~DepthPrepass()
+{
+	reset();
+}
+
+void DepthPrepass::applyPrepassState()
+{
+	Rasterizer* rasterizer = mHandle->getRasterizer();
+	rasterizer->setDepthTest(true);
+	rasterizer->setDepthWrite(true);
+	rasterizer->setDepthCompare(CompareOp::Less);
+	rasterizer->setColorWrite(false);
+}
+
+void DepthPrepass::applyShadingState()
+{
+	// Depth already holds the closest surface, only the fragment that wrote it passes
+	Rasterizer* rasterizer = mHandle->getRasterizer();
+	rasterizer->setDepthTest(true);
+	rasterizer->setDepthWrite(false);
+	rasterizer->setDepthCompare(CompareOp::Equal);
+	rasterizer->setColorWrite(true);
+}
+
+FrameGraphTextureDescription DepthPrepass::getDepthDescription(const uint32_t width, const uint32_t height, const bool stencil) const
+{
+	FrameGraphTextureDescription description = {};
+	description.width = width;
+	description.height = height;
+	description.format = ImageFormat::Red;
+	description.type = ImageDataType::Float;
+	description.imageType = stencil ? ImageType::Depth | ImageType::Stencil : ImageType::Depth;
+	description.clearDepth = mHandle->getRasterizer()->getDepthClearValue();
+
+	return description;
+}
+
+FrameGraphResource DepthPrepass::addPrepass(IFrameGraph* graph, const char* name, const FrameGraphTextureDescription& depth,
+	IFrameGraph::ExecuteCallback execute, void* userData)
+{
+	PassCallback* callback = new PassCallback{ this, nullptr, execute, userData, name, &depth, invalidFrameGraphResource };
+	mCallbacks.push_back(callback);
+
+	graph->addPass(name, _setupPrepass, _executePrepass, callback);
+
+	return callback->depth;
+}
+
+FrameGraphResource DepthPrepass::addShadingPass(IFrameGraph* graph, const char* name, const FrameGraphResource depth,
+	IFrameGraph::SetupCallback setup, IFrameGraph::ExecuteCallback execute, void* userData)
+{
+	PassCallback* callback = new PassCallback{ this, setup, execute, userData, name, nullptr, depth };
+	mCallbacks.push_back(callback);
+
+	graph->addPass(name, _setupShadingPass, _executeShadingPass, callback);
+
+	return callback->depth;
+}
+
+void DepthPrepass::reset()
+{
+	for (auto callback : mCallbacks)
+	{
+		delete callback;
+	}
+	mCallbacks.clear();
+}
+
+void DepthPrepass::_setupPrepass(FrameGraphBuilder& builder, void* userData)
+{
+	PassCallback* callback = static_cast<PassCallback*>(userData);
+	callback->depth = builder.write(builder.create(callback->name, *callback->description));
+}
+
+void DepthPrepass::_setupShadingPass(FrameGraphBuilder& builder, void* userData)
+{
+	// Writing the prepass version loads it instead of clearing
+	PassCallback* callback = static_cast<PassCallback*>(userData);
+	callback->depth = builder.write(callback->depth);
+	if (callback->setup != nullptr)
+	{
+		callback->setup(builder, callback->userData);
+	}
+}
+
+void DepthPrepass::_executePrepass(CommandBuffer* commandBuffer, void* userData)
+{
+	PassCallback* callback = static_cast<PassCallback*>(userData);
+
+	// GL applies raster state right away, Vulkan already baked it into the pass's pipelines
+#if defined(QGFX_OPENGL)
+	Rasterizer* rasterizer = callback->prepass->mHandle->getRasterizer();
+	const DepthState state = saveDepthState(rasterizer);
+	callback->prepass->applyPrepassState();
+#endif
+
+	if (callback->execute != nullptr)
+	{
+		callback->execute(commandBuffer, callback->userData);
+	}
+
+#if defined(QGFX_OPENGL)
+	restoreDepthState(rasterizer, state);
+#endif
+}
+
+void DepthPrepass::_executeShadingPass(CommandBuffer* commandBuffer, void* userData)
+{
+	PassCallback* callback = static_cast<PassCallback*>(userData);
+
+#if defined(QGFX_OPENGL)
+	Rasterizer* rasterizer = callback->prepass->mHandle->getRasterizer();
+	const DepthState state = saveDepthState(rasterizer);
+	callback->prepass->applyShadingState();
+#endif
+
+	if (callback->execute != nullptr)
+	{
+		callback->execute(commandBuffer, callback->userData);
+	}
+
+#if defined(QGFX_OPENGL)
+	restoreDepthState(rasterizer, state);
+#endif
+}
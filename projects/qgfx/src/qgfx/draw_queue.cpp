@@ -0,0 +1,247 @@
+#include "qgfx/draw_queue.h"
+#include "qgfx/cpu_profiler.h"
+
+#include <cstring>
+
+#include "qgfx/qgfx.h"
+
+static constexpr uint32_t maxKeyId = 0xFFFF;
+
+DrawQueue::DrawQueue()
+{
+	mNextPipelineId = 0;
+	mMaterialBinder = nullptr;
+	mMaterialUserData = nullptr;
+	mSorted = true;
+	mStatistics = {};
+}
+
+void DrawQueue::setMaterialBinder(MaterialBindFunction binder, void* userData)
+{
+	mMaterialBinder = binder;
+	mMaterialUserData = userData;
+}
+
+void DrawQueue::submit(const DrawPacket& packet)
+{
+	QGFX_ASSERT_MSG(packet.pipeline != nullptr, "Draw packet has no pipeline!\n");
+
+	const uint16_t pipelineId = _getPipelineId(packet.pipeline);
+
+	SortEntry entry;
+	const uint16_t materialId = static_cast<uint16_t>(packet.materialId < maxKeyId ? packet.materialId : maxKeyId);
+	entry.key = makeSortKey(packet.layer, pipelineId, materialId, packet.depth, packet.backToFront);
+	entry.index = static_cast<uint32_t>(mPackets.size());
+
+	mPackets.push_back(packet);
+	mEntries.push_back(entry);
+	mSorted = false;
+}
+
+void DrawQueue::sort()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	if (mSorted)
+	{
+		return;
+	}
+
+	const size_t count = mEntries.size();
+	mScratch.resize(count);
+
+	// LSD radix sort over the eight bytes of the key. All histograms are built in a single
+	// pass, and any byte that is identical for every key (common for layer and pipeline)
+	// is skipped entirely.
+	uint32_t histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint64_t key = mEntries[i].key;
+		for (uint32_t pass = 0; pass < 8; pass++)
+		{
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	SortEntry* src = mEntries.data();
+	SortEntry* dst = mScratch.data();
+
+	for (uint32_t pass = 0; pass < 8; pass++)
+	{
+		uint32_t* histogram = histograms[pass];
+		const uint32_t shift = pass * 8;
+
+		if (count == 0 || histogram[(src[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < 256; bucket++)
+		{
+			const uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t bucket = (src[i].key >> shift) & 0xFF;
+			dst[histogram[bucket]++] = src[i];
+		}
+
+		SortEntry* temp = src;
+		src = dst;
+		dst = temp;
+	}
+
+	if (src != mEntries.data())
+	{
+		memcpy(mEntries.data(), src, count * sizeof(SortEntry));
+	}
+
+	mSorted = true;
+}
+
+void DrawQueue::emit(CommandBuffer* buffer)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	sort();
+
+	Pipeline* currentPipeline = nullptr;
+	VertexBuffer* currentVertexBuffer = nullptr;
+	IndexBuffer* currentIndexBuffer = nullptr;
+	uint32_t currentMaterial = 0;
+	bool materialBound = false;
+
+	for (const auto& entry : mEntries)
+	{
+		const DrawPacket& packet = mPackets[entry.index];
+
+		if (packet.pipeline != currentPipeline)
+		{
+			buffer->bindPipeline(packet.pipeline);
+			currentPipeline = packet.pipeline;
+			mStatistics.pipelineBinds++;
+
+			// Material bindings are not guaranteed to survive a pipeline change, and on OpenGL the
+			// vertex and index buffers are attached to the pipeline's vertex array.
+			materialBound = false;
+			currentVertexBuffer = nullptr;
+			currentIndexBuffer = nullptr;
+		}
+		else
+		{
+			mStatistics.skippedBinds++;
+		}
+
+		if (mMaterialBinder != nullptr)
+		{
+			if (!materialBound || packet.materialId != currentMaterial)
+			{
+				mMaterialBinder(buffer, packet.materialId, mMaterialUserData);
+				currentMaterial = packet.materialId;
+				materialBound = true;
+				mStatistics.materialBinds++;
+			}
+			else
+			{
+				mStatistics.skippedBinds++;
+			}
+		}
+
+		if (packet.vertexBuffer != nullptr)
+		{
+			if (packet.vertexBuffer != currentVertexBuffer)
+			{
+				buffer->bindVertexBuffer(packet.vertexBuffer);
+				currentVertexBuffer = packet.vertexBuffer;
+				mStatistics.vertexBufferBinds++;
+
+				// OpenGL keeps the index buffer binding in the vertex array object, which
+				// may have changed along with the vertex buffer.
+				currentIndexBuffer = nullptr;
+			}
+			else
+			{
+				mStatistics.skippedBinds++;
+			}
+		}
+
+		if (packet.indexBuffer != nullptr)
+		{
+			if (packet.indexBuffer != currentIndexBuffer)
+			{
+				buffer->bindIndexBuffer(packet.indexBuffer);
+				currentIndexBuffer = packet.indexBuffer;
+				mStatistics.indexBufferBinds++;
+			}
+			else
+			{
+				mStatistics.skippedBinds++;
+			}
+
+			buffer->drawIndexed(packet.indexCount, packet.instanceCount, packet.firstIndex, packet.vertexOffset, packet.firstInstance);
+		}
+		else
+		{
+			buffer->draw(packet.vertexCount, packet.instanceCount, packet.firstVertex, packet.firstInstance);
+		}
+		mStatistics.draws++;
+	}
+}
+
+void DrawQueue::clear()
+{
+	mPackets.clear();
+	mEntries.clear();
+	mSorted = true;
+	mStatistics = {};
+}
+
+void DrawQueue::resetPipelineIds()
+{
+	QGFX_ASSERT_MSG(mPackets.empty(), "Pipeline ids can only be reset while the queue is empty.\n");
+
+	mPipelineIds.clear();
+	mNextPipelineId = 0;
+}
+
+uint64_t DrawQueue::makeSortKey(const uint8_t layer, const uint16_t pipelineId, const uint16_t materialId, const float depth, const bool backToFront)
+{
+	// Depth is expected in [0, 1]. Translucent geometry is sorted back to front by inverting
+	// the quantized depth so that the farthest draws come first.
+	const float clamped = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+	uint32_t quantized = static_cast<uint32_t>(clamped * static_cast<float>(0xFFFFFF));
+	if (backToFront)
+	{
+		quantized = 0xFFFFFF - quantized;
+	}
+
+	return (static_cast<uint64_t>(layer) << 56) |
+		(static_cast<uint64_t>(pipelineId) << 40) |
+		(static_cast<uint64_t>(materialId) << 24) |
+		static_cast<uint64_t>(quantized & 0xFFFFFF);
+}
+
+uint16_t DrawQueue::_getPipelineId(Pipeline* pipeline)
+{
+	auto it = mPipelineIds.find(pipeline);
+	if (it != mPipelineIds.end())
+	{
+		return (*it).second;
+	}
+
+	// Pipelines past the last id share it instead of wrapping onto the first ones
+	const uint16_t id = static_cast<uint16_t>(mNextPipelineId < maxKeyId ? mNextPipelineId : maxKeyId);
+	if (mNextPipelineId < maxKeyId)
+	{
+		mNextPipelineId++;
+	}
+	mPipelineIds.insert({ pipeline, id });
+
+	return id;
+}
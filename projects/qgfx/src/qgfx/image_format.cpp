@@ -0,0 +1,98 @@
+#include "qgfx/image_format.h"
+#include "qgfx/qassert.h"
+
+static uint32_t getImageDataTypeSize(const ImageDataType type)
+{
+	switch (type)
+	{
+		case ImageDataType::Byte:
+		case ImageDataType::UByte: return 1;
+		case ImageDataType::Short:
+		case ImageDataType::UShort:
+		case ImageDataType::UShort4_4_4_4:
+		case ImageDataType::UShort5_5_5_1: return 2;
+		case ImageDataType::Int:
+		case ImageDataType::UInt:
+		case ImageDataType::Float:
+		case ImageDataType::UInt8_8_8_8:
+		case ImageDataType::UInt10_10_10_2: return 4;
+	}
+
+	return 0;
+}
+
+bool isCompressedImageFormat(const ImageFormat format)
+{
+	return static_cast<uint32_t>(format) >= static_cast<uint32_t>(ImageFormat::BC1);
+}
+
+bool isPackedImageDataType(const ImageDataType type)
+{
+	return type == ImageDataType::UShort4_4_4_4 || type == ImageDataType::UShort5_5_5_1 ||
+		type == ImageDataType::UInt8_8_8_8 || type == ImageDataType::UInt10_10_10_2;
+}
+
+uint32_t getImageComponentCount(const ImageFormat format)
+{
+	switch (format)
+	{
+		case ImageFormat::RGB:
+		case ImageFormat::ETC2_RGB:
+		case ImageFormat::BC6H: return 3;
+		case ImageFormat::LuminanceAlpha:
+		case ImageFormat::BC5: return 2;
+		case ImageFormat::Red:
+		case ImageFormat::Green:
+		case ImageFormat::Blue:
+		case ImageFormat::Alpha:
+		case ImageFormat::Luminance:
+		case ImageFormat::BC4: return 1;
+		default: return 4;
+	}
+}
+
+uint32_t getImageTexelSize(const ImageFormat format, const ImageDataType type)
+{
+	QGFX_ASSERT_MSG(!isCompressedImageFormat(format), "Block compressed formats have no texel size, use getImageBlockInfo.\n");
+
+	if (isPackedImageDataType(type))
+	{
+		return getImageDataTypeSize(type);
+	}
+
+	return getImageComponentCount(format) * getImageDataTypeSize(type);
+}
+
+ImageBlockInfo getImageBlockInfo(const ImageFormat format, const ImageDataType type)
+{
+	switch (format)
+	{
+		case ImageFormat::BC1:
+		case ImageFormat::BC4:
+		case ImageFormat::ETC2_RGB: return { 4, 4, 8 };
+		case ImageFormat::BC2:
+		case ImageFormat::BC3:
+		case ImageFormat::BC5:
+		case ImageFormat::BC6H:
+		case ImageFormat::BC7:
+		case ImageFormat::ETC2_RGBA:
+		case ImageFormat::ASTC_4x4: return { 4, 4, 16 };
+		case ImageFormat::ASTC_6x6: return { 6, 6, 16 };
+		case ImageFormat::ASTC_8x8: return { 8, 8, 16 };
+		default: return { 1, 1, getImageTexelSize(format, type) };
+	}
+}
+
+size_t getImageRowPitch(const uint32_t width, const uint32_t level, const ImageFormat format, const ImageDataType type)
+{
+	const ImageBlockInfo block = getImageBlockInfo(format, type);
+	const size_t w = width >> level ? width >> level : 1;
+	return (w + block.width - 1) / block.width * block.size;
+}
+
+size_t getImageMipSize(const uint32_t width, const uint32_t height, const uint32_t level, const ImageFormat format, const ImageDataType type)
+{
+	const ImageBlockInfo block = getImageBlockInfo(format, type);
+	const size_t h = height >> level ? height >> level : 1;
+	return getImageRowPitch(width, level, format, type) * ((h + block.height - 1) / block.height);
+}
@@ -0,0 +1,261 @@
+#include "qgfx/ktx2_loader.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/image_format.h"
+#include "qgfx/qassert.h"
+#include "qgfx/texture_transcoder.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// qtl::vector only resizes past its capacity, a smaller file reuses the storage of a larger one
+static void resizeBytes(qtl::vector<uint8_t>& bytes, const size_t size)
+{
+	bytes.clear();
+	if (size > bytes.capacity())
+	{
+		bytes.resize(size);
+		return;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		bytes.push_back(0);
+	}
+}
+
+static const uint8_t ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+struct Ktx2Header
+{
+	uint8_t identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header does not match the file layout.\n");
+static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index does not match the file layout.\n");
+
+struct Ktx2FormatMapping
+{
+	uint32_t vkFormat;
+	ImageFormat format;
+	ImageDataType type;
+};
+
+// VkFormat values, spelled out so the loader does not depend on the Vulkan headers.  qgfx has
+// no sRGB formats, sRGB encoded textures are sampled as unorm.
+static const Ktx2FormatMapping ktx2Formats[] = {
+	{ 37, ImageFormat::RGBA, ImageDataType::UInt8_8_8_8 },
+	{ 133, ImageFormat::BC1, ImageDataType::UByte },
+	{ 134, ImageFormat::BC1, ImageDataType::UByte },
+	{ 135, ImageFormat::BC2, ImageDataType::UByte },
+	{ 136, ImageFormat::BC2, ImageDataType::UByte },
+	{ 137, ImageFormat::BC3, ImageDataType::UByte },
+	{ 138, ImageFormat::BC3, ImageDataType::UByte },
+	{ 139, ImageFormat::BC4, ImageDataType::UByte },
+	{ 140, ImageFormat::BC4, ImageDataType::Byte },
+	{ 141, ImageFormat::BC5, ImageDataType::UByte },
+	{ 142, ImageFormat::BC5, ImageDataType::Byte },
+	{ 143, ImageFormat::BC6H, ImageDataType::UShort },
+	{ 144, ImageFormat::BC6H, ImageDataType::Float },
+	{ 145, ImageFormat::BC7, ImageDataType::UByte },
+	{ 146, ImageFormat::BC7, ImageDataType::UByte },
+	{ 147, ImageFormat::ETC2_RGB, ImageDataType::UByte },
+	{ 148, ImageFormat::ETC2_RGB, ImageDataType::UByte },
+	{ 151, ImageFormat::ETC2_RGBA, ImageDataType::UByte },
+	{ 152, ImageFormat::ETC2_RGBA, ImageDataType::UByte },
+	{ 157, ImageFormat::ASTC_4x4, ImageDataType::UByte },
+	{ 158, ImageFormat::ASTC_4x4, ImageDataType::UByte },
+	{ 165, ImageFormat::ASTC_6x6, ImageDataType::UByte },
+	{ 166, ImageFormat::ASTC_6x6, ImageDataType::UByte },
+	{ 171, ImageFormat::ASTC_8x8, ImageDataType::UByte },
+	{ 172, ImageFormat::ASTC_8x8, ImageDataType::UByte }
+};
+
+bool Ktx2Texture::load(const qtl::string& path)
+{
+	std::ifstream is(path.c_str(), std::ios::ate | std::ios::binary);
+	if (!is.is_open())
+	{
+		return false;
+	}
+
+	const size_t fileSize = static_cast<size_t>(is.tellg());
+	resizeBytes(mData, fileSize);
+	is.seekg(0);
+	is.read(reinterpret_cast<char*>(mData.data()), fileSize);
+	is.close();
+
+	return _parse();
+}
+
+bool Ktx2Texture::load(const uint8_t* data, const size_t size)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	resizeBytes(mData, size);
+	memcpy(mData.data(), data, size);
+	return _parse();
+}
+
+const uint8_t* Ktx2Texture::getMipData(const uint32_t level) const
+{
+	QGFX_ASSERT_MSG(level < mLevels.size(), "Mip level is outside of the mip chain.\n");
+	return mData.data() + mLevels[level].offset;
+}
+
+size_t Ktx2Texture::getMipSize(const uint32_t level) const
+{
+	QGFX_ASSERT_MSG(level < mLevels.size(), "Mip level is outside of the mip chain.\n");
+	return mLevels[level].size;
+}
+
+bool Ktx2Texture::upload(IImage2D* image, const ContextHandle* context)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(isLoaded(), "Texture has not been loaded.\n");
+	QGFX_ASSERT_MSG(image != nullptr && context != nullptr, "Uploading needs an image and a context.\n");
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const uint32_t levels = getMipLevels();
+	mStatistics = {};
+
+	for (uint32_t level = 0; level < levels; level++)
+	{
+		mStatistics.uncompressedBytes += getImageMipSize(mWidth, mHeight, level, ImageFormat::RGBA, ImageDataType::UInt8_8_8_8);
+	}
+
+	if (context->isImageFormatSupported(mFormat, mDataType))
+	{
+		const uint8_t bpp = isCompressedImageFormat(mFormat) ? 0 : static_cast<uint8_t>(getImageTexelSize(mFormat, mDataType));
+		image->construct(mWidth, mHeight, bpp, mFormat, mDataType, ImageType::Color, levels);
+
+		for (uint32_t level = 0; level < levels; level++)
+		{
+			image->setMipData(level, getMipData(level), static_cast<uint32_t>(getMipSize(level)));
+			mStatistics.bytesUploaded += getMipSize(level);
+		}
+	}
+	else
+	{
+		if (!canTranscodeImageFormat(mFormat, mDataType))
+		{
+			return false;
+		}
+
+		image->construct(mWidth, mHeight, 4, ImageFormat::RGBA, ImageDataType::UInt8_8_8_8, ImageType::Color, levels);
+
+		std::vector<uint8_t> texels(getImageMipSize(mWidth, mHeight, 0, ImageFormat::RGBA, ImageDataType::UInt8_8_8_8));
+		for (uint32_t level = 0; level < levels; level++)
+		{
+			const uint32_t width = mWidth >> level ? mWidth >> level : 1;
+			const uint32_t height = mHeight >> level ? mHeight >> level : 1;
+			const size_t size = getImageMipSize(mWidth, mHeight, level, ImageFormat::RGBA, ImageDataType::UInt8_8_8_8);
+
+			transcodeImage(getMipData(level), width, height, texels.data(), mFormat, mDataType);
+			image->setMipData(level, texels.data(), static_cast<uint32_t>(size));
+			mStatistics.bytesUploaded += size;
+		}
+
+		mStatistics.transcoded = true;
+	}
+
+	mStatistics.mipsUploaded = levels;
+	mStatistics.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return true;
+}
+
+bool Ktx2Texture::_parse()
+{
+	mLevels.clear();
+
+	Ktx2Header header;
+	if (mData.size() < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, mData.data(), sizeof(header));
+
+	if (memcmp(header.identifier, ktx2Identifier, sizeof(ktx2Identifier)) != 0)
+	{
+		return false;
+	}
+
+	// Volume textures, arrays, cube maps and supercompressed (Basis, zstd) payloads are not handled
+	if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 ||
+		header.faceCount != 1 || header.supercompressionScheme != 0)
+	{
+		return false;
+	}
+
+	const Ktx2FormatMapping* mapping = nullptr;
+	for (const auto& candidate : ktx2Formats)
+	{
+		if (candidate.vkFormat == header.vkFormat)
+		{
+			mapping = &candidate;
+			break;
+		}
+	}
+
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+
+	// A level count of zero asks the loader to generate the mips, only the base level is stored
+	const uint32_t levels = header.levelCount ? header.levelCount : 1;
+	if (levels > IImage2D::getMipChainLength(header.pixelWidth, header.pixelHeight) ||
+		mData.size() < sizeof(header) + levels * sizeof(Ktx2LevelIndex))
+	{
+		return false;
+	}
+
+	mWidth = header.pixelWidth;
+	mHeight = header.pixelHeight;
+	mFormat = mapping->format;
+	mDataType = mapping->type;
+
+	for (uint32_t level = 0; level < levels; level++)
+	{
+		Ktx2LevelIndex index;
+		memcpy(&index, mData.data() + sizeof(header) + level * sizeof(index), sizeof(index));
+
+		const size_t size = getImageMipSize(mWidth, mHeight, level, mFormat, mDataType);
+		if (index.byteLength < size || index.byteOffset > mData.size() || index.byteLength > mData.size() - index.byteOffset)
+		{
+			mLevels.clear();
+			return false;
+		}
+
+		mLevels.push_back({ static_cast<size_t>(index.byteOffset), size });
+	}
+
+	return true;
+}
@@ -0,0 +1,545 @@
+#include "qgfx/mesh_file.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/mesh_optimizer.h"
+#include "qgfx/qassert.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t alignMeshFileOffset(const uint64_t offset)
+{
+	return (offset + meshFileAlignment - 1) & ~(meshFileAlignment - 1);
+}
+
+static bool isBlobValid(const MeshFileBlob& blob, const uint64_t fileSize)
+{
+	return blob.offset % meshFileAlignment == 0 && blob.offset <= fileSize && blob.size <= fileSize - blob.offset;
+}
+
+MeshFile::~MeshFile()
+{
+	close();
+}
+
+bool MeshFile::open(const qtl::string& path, const bool prefetch)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	close();
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	mFile = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(MeshFileHeader)))
+	{
+		close();
+		return false;
+	}
+	mMappingSize = static_cast<uint64_t>(size.QuadPart);
+
+	mFileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mFileMapping == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	mMapping = reinterpret_cast<const uint8_t*>(MapViewOfFile(mFileMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mMapping == nullptr)
+	{
+		close();
+		return false;
+	}
+#else
+	mFile = ::open(path.c_str(), O_RDONLY);
+	if (mFile < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(mFile, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(MeshFileHeader)))
+	{
+		close();
+		return false;
+	}
+	mMappingSize = static_cast<uint64_t>(info.st_size);
+
+	void* mapping = mmap(nullptr, static_cast<size_t>(mMappingSize), PROT_READ, MAP_PRIVATE, mFile, 0);
+	if (mapping == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	mMapping = reinterpret_cast<const uint8_t*>(mapping);
+
+	madvise(mapping, static_cast<size_t>(mMappingSize), prefetch ? MADV_WILLNEED : MADV_SEQUENTIAL);
+#endif
+
+	mHeader = reinterpret_cast<const MeshFileHeader*>(mMapping);
+	if (!_validate())
+	{
+		close();
+		return false;
+	}
+
+	if (prefetch)
+	{
+		// Fault every page in now so the upload reads resident memory
+		volatile uint8_t sink = 0;
+		for (uint64_t offset = 0; offset < mMappingSize; offset += 4096)
+		{
+			sink ^= mMapping[offset];
+		}
+		(void)sink;
+	}
+
+	mStatistics.bytes = mMappingSize;
+	mStatistics.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	mStatistics.throughput = mStatistics.milliseconds > 0.0 ? static_cast<double>(mMappingSize) / (mStatistics.milliseconds / 1000.0) : 0.0;
+
+	return true;
+}
+
+void MeshFile::close()
+{
+#if defined(_WIN32)
+	if (mMapping)
+	{
+		UnmapViewOfFile(mMapping);
+	}
+	if (mFileMapping)
+	{
+		CloseHandle(mFileMapping);
+		mFileMapping = nullptr;
+	}
+	if (mFile)
+	{
+		CloseHandle(mFile);
+		mFile = nullptr;
+	}
+#else
+	if (mMapping)
+	{
+		munmap(const_cast<uint8_t*>(mMapping), static_cast<size_t>(mMappingSize));
+	}
+	if (mFile >= 0)
+	{
+		::close(mFile);
+		mFile = -1;
+	}
+#endif
+
+	mMapping = nullptr;
+	mMappingSize = 0;
+	mHeader = nullptr;
+}
+
+bool MeshFile::_validate() const
+{
+	const MeshFileHeader& header = *mHeader;
+	if (header.magic != meshFileMagic || header.version != meshFileVersion || header.headerSize != sizeof(MeshFileHeader))
+	{
+		return false;
+	}
+
+	if (header.fileSize != mMappingSize || header.elementCount == 0 || header.elementCount > meshFileMaxElements)
+	{
+		return false;
+	}
+
+	if (header.indexType > static_cast<uint32_t>(IndexType::UInt32))
+	{
+		return false;
+	}
+
+	if (!isBlobValid(header.elements, mMappingSize) || !isBlobValid(header.vertices, mMappingSize) ||
+		!isBlobValid(header.indices, mMappingSize) || !isBlobValid(header.meshlets, mMappingSize))
+	{
+		return false;
+	}
+
+	const uint64_t indexSize = header.indexType == static_cast<uint32_t>(IndexType::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+	if (header.elements.size != static_cast<uint64_t>(header.elementCount) * sizeof(MeshFileElement) ||
+		header.vertices.size != static_cast<uint64_t>(header.vertexCount) * header.vertexStride ||
+		header.indices.size != static_cast<uint64_t>(header.indexCount) * indexSize ||
+		header.meshlets.size != static_cast<uint64_t>(header.meshletCount) * sizeof(MeshFileMeshlet))
+	{
+		return false;
+	}
+
+	// The layout is rebuilt with VertexBufferLayout::push, which packs the elements tightly
+	const MeshFileElement* elements = reinterpret_cast<const MeshFileElement*>(mMapping + header.elements.offset);
+	uint64_t offset = 0;
+	for (uint32_t i = 0; i < header.elementCount; i++)
+	{
+		const MeshFileElement& element = elements[i];
+		if (element.type > static_cast<uint32_t>(VertexAttribType::UInt2_10_10_10) || element.count < 1 || element.count > 4 ||
+			element.offset != offset || memchr(element.name, '\0', sizeof(element.name)) == nullptr)
+		{
+			return false;
+		}
+		offset += getVertexAttribSize(static_cast<VertexAttribType>(element.type), element.count);
+	}
+
+	if (offset != header.vertexStride)
+	{
+		return false;
+	}
+
+	// Meshlets are runs of whole triangles inside the index buffer
+	const MeshFileMeshlet* meshlets = reinterpret_cast<const MeshFileMeshlet*>(mMapping + header.meshlets.offset);
+	for (uint32_t i = 0; i < header.meshletCount; i++)
+	{
+		const MeshFileMeshlet& meshlet = meshlets[i];
+		if (meshlet.indexCount % 3 != 0 || meshlet.firstIndex > header.indexCount || meshlet.indexCount > header.indexCount - meshlet.firstIndex)
+		{
+			return false;
+		}
+	}
+
+	// Out of range indices would make the GPU read past the vertex buffer
+	const uint8_t* indices = mMapping + header.indices.offset;
+	uint32_t maxIndex = 0;
+	if (header.indexType == static_cast<uint32_t>(IndexType::UInt16))
+	{
+		for (uint32_t i = 0; i < header.indexCount; i++)
+		{
+			uint16_t index;
+			memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+			maxIndex = index > maxIndex ? index : maxIndex;
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < header.indexCount; i++)
+		{
+			uint32_t index;
+			memcpy(&index, indices + i * sizeof(uint32_t), sizeof(index));
+			maxIndex = index > maxIndex ? index : maxIndex;
+		}
+	}
+
+	return header.indexCount == 0 || maxIndex < header.vertexCount;
+}
+
+VertexBufferLayout MeshFile::getLayout() const
+{
+	QGFX_ASSERT_MSG(isOpen(), "Mesh file is not open.\n");
+
+	VertexBufferLayout layout;
+	const MeshFileElement* elements = reinterpret_cast<const MeshFileElement*>(mMapping + mHeader->elements.offset);
+	for (uint32_t i = 0; i < mHeader->elementCount; i++)
+	{
+		layout.push(qtl::string(elements[i].name), static_cast<VertexAttribType>(elements[i].type), elements[i].count, elements[i].normalized != 0);
+	}
+
+	return layout;
+}
+
+const void* MeshFile::getVertices() const
+{
+	QGFX_ASSERT_MSG(isOpen(), "Mesh file is not open.\n");
+	return mMapping + mHeader->vertices.offset;
+}
+
+const void* MeshFile::getIndices() const
+{
+	QGFX_ASSERT_MSG(isOpen(), "Mesh file is not open.\n");
+	return mMapping + mHeader->indices.offset;
+}
+
+const MeshFileMeshlet* MeshFile::getMeshlets() const
+{
+	QGFX_ASSERT_MSG(isOpen(), "Mesh file is not open.\n");
+	return reinterpret_cast<const MeshFileMeshlet*>(mMapping + mHeader->meshlets.offset);
+}
+
+void MeshFile::upload(IVertexBuffer* vertexBuffer, IIndexBuffer* indexBuffer) const
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(isOpen(), "Mesh file is not open.\n");
+
+	if (vertexBuffer)
+	{
+		vertexBuffer->setLayout(getLayout());
+		vertexBuffer->setExternalData(getVertices(), static_cast<size_t>(mHeader->vertices.size));
+	}
+
+	if (indexBuffer)
+	{
+		indexBuffer->setExternalData(getIndices(), mHeader->indexCount, getIndexType());
+	}
+}
+
+static const float* meshFilePosition(const uint8_t* vertices, const size_t stride, const size_t positionOffset, const uint32_t vertex)
+{
+	return reinterpret_cast<const float*>(vertices + vertex * stride + positionOffset);
+}
+
+static void computeBoundingSphere(const uint8_t* vertices, const size_t stride, const size_t positionOffset, const uint32_t* indices,
+	const size_t count, float center[3], float& radius)
+{
+	float minimum[3] = { INFINITY, INFINITY, INFINITY };
+	float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* p = meshFilePosition(vertices, stride, positionOffset, indices ? indices[i] : static_cast<uint32_t>(i));
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			minimum[k] = fminf(minimum[k], p[k]);
+			maximum[k] = fmaxf(maximum[k], p[k]);
+		}
+	}
+
+	radius = 0.0f;
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		center[k] = count ? (minimum[k] + maximum[k]) * 0.5f : 0.0f;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* p = meshFilePosition(vertices, stride, positionOffset, indices ? indices[i] : static_cast<uint32_t>(i));
+		const float dx = p[0] - center[0];
+		const float dy = p[1] - center[1];
+		const float dz = p[2] - center[2];
+		radius = fmaxf(radius, sqrtf(dx * dx + dy * dy + dz * dz));
+	}
+}
+
+static void finishMeshlet(MeshFileMeshlet& meshlet, const uint8_t* vertices, const size_t stride, const size_t positionOffset, const uint32_t* indices)
+{
+	const uint32_t* first = indices + meshlet.firstIndex;
+	computeBoundingSphere(vertices, stride, positionOffset, first, meshlet.indexCount, meshlet.center, meshlet.radius);
+
+	std::vector<float> normals;
+	normals.reserve(meshlet.indexCount);
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (uint32_t i = 0; i < meshlet.indexCount; i += 3)
+	{
+		const float* a = meshFilePosition(vertices, stride, positionOffset, first[i]);
+		const float* b = meshFilePosition(vertices, stride, positionOffset, first[i + 1]);
+		const float* c = meshFilePosition(vertices, stride, positionOffset, first[i + 2]);
+
+		const float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		const float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+		const float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0f)
+		{
+			continue;
+		}
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			n[k] /= length;
+			axis[k] += n[k];
+			normals.push_back(n[k]);
+		}
+	}
+
+	const float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	float minimumDot = 1.0f;
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		meshlet.coneAxis[k] = axisLength > 0.0f ? axis[k] / axisLength : 0.0f;
+	}
+	for (size_t i = 0; i < normals.size(); i += 3)
+	{
+		const float d = normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] + normals[i + 2] * meshlet.coneAxis[2];
+		minimumDot = fminf(minimumDot, d);
+	}
+
+	// The cone half angle is acos(minimumDot).  Everything faces away once the view direction is
+	// within 90 degrees minus that of the axis.  Wider cones can never be culled.
+	meshlet.coneCutoff = (axisLength > 0.0f && minimumDot > 0.0f) ? sqrtf(1.0f - minimumDot * minimumDot) : 2.0f;
+}
+
+static void buildMeshlets(std::vector<MeshFileMeshlet>& meshlets, const uint8_t* vertices, const size_t vertexCount, const size_t stride,
+	const size_t positionOffset, const uint32_t* indices, const size_t indexCount, const uint32_t maxVertices, const uint32_t maxTriangles)
+{
+	QGFX_ASSERT_MSG(maxVertices >= 3 && maxTriangles >= 1, "Meshlets need room for at least one triangle.\n");
+
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	MeshFileMeshlet meshlet = {};
+	uint32_t stamp = 1;
+
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		uint32_t added = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			added += stamps[indices[i + k]] != stamp ? 1 : 0;
+		}
+
+		if (meshlet.vertexCount + added > maxVertices || meshlet.indexCount / 3 + 1 > maxTriangles)
+		{
+			finishMeshlet(meshlet, vertices, stride, positionOffset, indices);
+			meshlets.push_back(meshlet);
+
+			meshlet = {};
+			meshlet.firstIndex = static_cast<uint32_t>(i);
+			stamp++;
+			added = 3;
+		}
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			if (stamps[indices[i + k]] != stamp)
+			{
+				stamps[indices[i + k]] = stamp;
+				meshlet.vertexCount++;
+			}
+		}
+		meshlet.indexCount += 3;
+	}
+
+	if (meshlet.indexCount)
+	{
+		finishMeshlet(meshlet, vertices, stride, positionOffset, indices);
+		meshlets.push_back(meshlet);
+	}
+}
+
+static bool writeMeshFileBlob(FILE* file, const void* data, const uint64_t size, const uint64_t offset)
+{
+	static const uint8_t padding[meshFileAlignment] = {};
+
+	const long position = ftell(file);
+	QGFX_ASSERT_MSG(position >= 0 && static_cast<uint64_t>(position) <= offset, "Mesh file blobs written out of order.\n");
+
+	const size_t pad = static_cast<size_t>(offset - static_cast<uint64_t>(position));
+	if (pad && fwrite(padding, 1, pad, file) != pad)
+	{
+		return false;
+	}
+
+	return size == 0 || fwrite(data, 1, static_cast<size_t>(size), file) == size;
+}
+
+bool writeMeshFile(const qtl::string& path, const MeshFileSource& source)
+{
+	QGFX_ASSERT_MSG(source.layout != nullptr && source.vertices != nullptr && source.indices != nullptr, "Mesh file source is incomplete.\n");
+	QGFX_ASSERT_MSG(source.indexCount % 3 == 0, "Mesh files store triangle lists.\n");
+
+	const VertexBufferLayout& layout = *source.layout;
+	const size_t stride = layout.getStride();
+	QGFX_ASSERT_MSG(layout.getLayout().size() > 0 && layout.getLayout().size() <= meshFileMaxElements, "Mesh files store 1 to 16 vertex attributes.\n");
+	QGFX_ASSERT_MSG(source.positionOffset + 3 * sizeof(float) <= stride, "Position lies outside the vertex.\n");
+
+	std::vector<uint8_t> vertices(source.vertexCount * stride);
+	std::vector<uint32_t> indices(source.indices, source.indices + source.indexCount);
+	memcpy(vertices.data(), source.vertices, vertices.size());
+
+	size_t vertexCount = source.vertexCount;
+	if (source.optimize)
+	{
+		MeshOptimizerOptions options;
+		options.positionOffset = source.positionOffset;
+		vertexCount = optimizeMesh(indices.data(), indices.size(), vertices.data(), vertexCount, stride, options);
+	}
+
+	MeshFileHeader header = {};
+	header.magic = meshFileMagic;
+	header.version = meshFileVersion;
+	header.headerSize = sizeof(MeshFileHeader);
+	header.elementCount = static_cast<uint32_t>(layout.getLayout().size());
+	header.vertexCount = static_cast<uint32_t>(vertexCount);
+	header.vertexStride = static_cast<uint32_t>(stride);
+	header.indexCount = static_cast<uint32_t>(indices.size());
+
+	const IndexType indexType = IIndexBuffer::selectIndexType(indices.data(), indices.size());
+	header.indexType = static_cast<uint32_t>(indexType);
+
+	std::vector<MeshFileElement> elements(header.elementCount);
+	for (uint32_t i = 0; i < header.elementCount; i++)
+	{
+		const VertexBufferLayoutElement& attribute = layout.getLayout()[i];
+		MeshFileElement& element = elements[i];
+		memset(&element, 0, sizeof(element));
+		strncpy(element.name, attribute.name.c_str(), sizeof(element.name) - 1);
+		element.type = static_cast<uint32_t>(attribute.type);
+		element.count = attribute.count;
+		element.offset = static_cast<uint32_t>(attribute.offset);
+		element.normalized = attribute.normalized ? 1 : 0;
+	}
+
+	std::vector<uint16_t> narrowIndices;
+	const void* indexData = indices.data();
+	if (indexType == IndexType::UInt16)
+	{
+		narrowIndices.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			narrowIndices[i] = static_cast<uint16_t>(indices[i]);
+		}
+		indexData = narrowIndices.data();
+	}
+
+	std::vector<MeshFileMeshlet> meshlets;
+	buildMeshlets(meshlets, vertices.data(), vertexCount, stride, source.positionOffset, indices.data(), indices.size(),
+		source.meshletMaxVertices, source.meshletMaxTriangles);
+	header.meshletCount = static_cast<uint32_t>(meshlets.size());
+
+	float minimum[3] = { INFINITY, INFINITY, INFINITY };
+	float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		const float* p = meshFilePosition(vertices.data(), stride, source.positionOffset, static_cast<uint32_t>(v));
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			minimum[k] = fminf(minimum[k], p[k]);
+			maximum[k] = fmaxf(maximum[k], p[k]);
+		}
+	}
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		header.boundsMin[k] = vertexCount ? minimum[k] : 0.0f;
+		header.boundsMax[k] = vertexCount ? maximum[k] : 0.0f;
+	}
+	computeBoundingSphere(vertices.data(), stride, source.positionOffset, nullptr, vertexCount, header.boundingSphere, header.boundingSphere[3]);
+
+	header.elements = { alignMeshFileOffset(sizeof(MeshFileHeader)), elements.size() * sizeof(MeshFileElement) };
+	header.vertices = { alignMeshFileOffset(header.elements.offset + header.elements.size), vertexCount * stride };
+	header.indices = { alignMeshFileOffset(header.vertices.offset + header.vertices.size), indices.size() * (indexType == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t)) };
+	header.meshlets = { alignMeshFileOffset(header.indices.offset + header.indices.size), meshlets.size() * sizeof(MeshFileMeshlet) };
+	header.fileSize = header.meshlets.offset + header.meshlets.size;
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	const bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		writeMeshFileBlob(file, elements.data(), header.elements.size, header.elements.offset) &&
+		writeMeshFileBlob(file, vertices.data(), header.vertices.size, header.vertices.offset) &&
+		writeMeshFileBlob(file, indexData, header.indices.size, header.indices.offset) &&
+		writeMeshFileBlob(file, meshlets.data(), header.meshlets.size, header.meshlets.offset);
+
+	return fclose(file) == 0 && written;
+}
@@ -0,0 +1,406 @@
+#include "qgfx/mesh_optimizer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/// FIFO post-transform cache, as implemented by most hardware.
+class FifoCache
+{
+	public:
+		FifoCache(const size_t vertexCount, const uint32_t size)
+			: mTimestamps(vertexCount, 0), mSize(size), mTime(size + 1)
+		{
+		}
+
+		/// Returns true when the vertex had to be transformed.
+		bool access(const uint32_t vertex)
+		{
+			if (mTime - mTimestamps[vertex] > mSize)
+			{
+				mTimestamps[vertex] = mTime++;
+				return true;
+			}
+			return false;
+		}
+
+		void flush()
+		{
+			mTime += mSize + 1;
+		}
+	private:
+		std::vector<uint32_t> mTimestamps;
+		uint32_t mSize;
+		uint32_t mTime;
+};
+
+struct TriangleAdjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> live;
+};
+
+static void buildAdjacency(TriangleAdjacency& adjacency, const uint32_t* indices, const size_t indexCount, const size_t vertexCount)
+{
+	adjacency.live.assign(vertexCount, 0);
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	adjacency.triangles.resize(indexCount);
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		QGFX_ASSERT_MSG(indices[i] < vertexCount, "Index out of range.\n");
+		adjacency.live[indices[i]]++;
+	}
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.live[v];
+	}
+
+	std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+}
+
+void optimizeVertexCache(uint32_t* destination, const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize)
+{
+	QGFX_ASSERT_MSG(indexCount % 3 == 0, "Index count must be a multiple of three.\n");
+	QGFX_ASSERT_MSG(destination != indices, "Vertex cache optimization can not run in place.\n");
+
+	if (indexCount == 0)
+	{
+		return;
+	}
+
+	TriangleAdjacency adjacency;
+	buildAdjacency(adjacency, indices, indexCount, vertexCount);
+
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	std::vector<uint8_t> emitted(indexCount / 3, 0);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	deadEnd.reserve(indexCount);
+
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0;
+	size_t written = 0;
+	int64_t fanning = 0;
+
+	while (fanning >= 0)
+	{
+		const uint32_t f = static_cast<uint32_t>(fanning);
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (uint32_t a = adjacency.offsets[f]; a < adjacency.offsets[f + 1]; a++)
+		{
+			const uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const uint32_t v = indices[triangle * 3 + k];
+				destination[written++] = v;
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				adjacency.live[v]--;
+
+				if (time - timestamps[v] > cacheSize)
+				{
+					timestamps[v] = time++;
+				}
+			}
+			emitted[triangle] = 1;
+		}
+
+		// Prefer the candidate that is still in the cache and stays there while its
+		// remaining triangles are emitted, furthest from eviction first.
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (const uint32_t v : candidates)
+		{
+			if (adjacency.live[v] == 0)
+			{
+				continue;
+			}
+
+			int64_t priority = 0;
+			if (time - timestamps[v] + 2 * adjacency.live[v] <= cacheSize)
+			{
+				priority = time - timestamps[v];
+			}
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = v;
+			}
+		}
+
+		if (best < 0)
+		{
+			// Dead end, go back to a recently used vertex or scan forward for any live one
+			while (!deadEnd.empty())
+			{
+				const uint32_t v = deadEnd.back();
+				deadEnd.pop_back();
+				if (adjacency.live[v] > 0)
+				{
+					best = v;
+					break;
+				}
+			}
+
+			while (best < 0 && cursor < vertexCount)
+			{
+				if (adjacency.live[cursor] > 0)
+				{
+					best = static_cast<int64_t>(cursor);
+				}
+				cursor++;
+			}
+		}
+
+		fanning = best;
+	}
+
+	QGFX_ASSERT_MSG(written == indexCount, "Vertex cache optimization lost triangles.\n");
+}
+
+void optimizeOverdraw(uint32_t* destination, const uint32_t* indices, const size_t indexCount, const void* vertices, const size_t vertexCount,
+	const size_t vertexSize, const size_t positionOffset, const uint32_t cacheSize, const float threshold)
+{
+	QGFX_ASSERT_MSG(indexCount % 3 == 0, "Index count must be a multiple of three.\n");
+	QGFX_ASSERT_MSG(destination != indices, "Overdraw optimization can not run in place.\n");
+
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Hard boundaries: triangles where all three vertices miss, i.e. the cache restarts
+	std::vector<uint32_t> clusters;
+	std::vector<uint8_t> misses(triangleCount, 0);
+	{
+		FifoCache cache(vertexCount, cacheSize);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				misses[t] += cache.access(indices[t * 3 + k]) ? 1 : 0;
+			}
+			if (t == 0 || misses[t] == 3)
+			{
+				clusters.push_back(static_cast<uint32_t>(t));
+			}
+		}
+	}
+	clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+	// Soft boundaries: split a cluster wherever the part so far is already cheap enough
+	// that starting over costs less than threshold times the whole cluster's ACMR.
+	std::vector<uint32_t> split;
+	for (size_t c = 0; c + 1 < clusters.size(); c++)
+	{
+		const uint32_t begin = clusters[c];
+		const uint32_t end = clusters[c + 1];
+
+		uint32_t clusterMisses = 0;
+		for (uint32_t t = begin; t < end; t++)
+		{
+			clusterMisses += misses[t];
+		}
+		const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+		split.push_back(begin);
+		FifoCache cache(vertexCount, cacheSize);
+		uint32_t start = begin;
+		uint32_t runMisses = 0;
+		for (uint32_t t = begin; t < end; t++)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				runMisses += cache.access(indices[t * 3 + k]) ? 1 : 0;
+			}
+
+			const float runAcmr = static_cast<float>(runMisses) / static_cast<float>(t - start + 1);
+			if (t + 1 < end && runAcmr <= clusterAcmr * threshold && t - start + 1 >= cacheSize)
+			{
+				split.push_back(t + 1);
+				start = t + 1;
+				runMisses = 0;
+				cache.flush();
+			}
+		}
+	}
+	split.push_back(static_cast<uint32_t>(triangleCount));
+
+	const uint8_t* base = reinterpret_cast<const uint8_t*>(vertices) + positionOffset;
+	const auto position = [base, vertexSize](const uint32_t v)
+	{
+		return reinterpret_cast<const float*>(base + v * vertexSize);
+	};
+
+	// Mesh centroid, the sort metric measures how much each cluster faces away from it
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const float* p = position(indices[i]);
+		meshCentroid[0] += p[0];
+		meshCentroid[1] += p[1];
+		meshCentroid[2] += p[2];
+	}
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		meshCentroid[c] /= static_cast<float>(indexCount);
+	}
+
+	const size_t clusterCount = split.size() - 1;
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<uint32_t> order(clusterCount);
+
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+
+		for (uint32_t t = split[c]; t < split[c + 1]; t++)
+		{
+			const float* a = position(indices[t * 3]);
+			const float* b = position(indices[t * 3 + 1]);
+			const float* d = position(indices[t * 3 + 2]);
+
+			const float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			const float e1[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+			const float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+			const float w = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			// Area weighted, the cross product length is twice the triangle area
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				centroid[k] += (a[k] + b[k] + d[k]) / 3.0f * w;
+				normal[k] += n[k];
+			}
+			area += w;
+		}
+
+		const float invArea = area > 0.0f ? 1.0f / area : 0.0f;
+		const float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		const float invNormal = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+		float key = 0.0f;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			key += (centroid[k] * invArea - meshCentroid[k]) * normal[k] * invNormal;
+		}
+
+		sortKeys[c] = key;
+		order[c] = static_cast<uint32_t>(c);
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](const uint32_t a, const uint32_t b)
+	{
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	size_t written = 0;
+	for (const uint32_t c : order)
+	{
+		const size_t count = (split[c + 1] - split[c]) * 3;
+		memcpy(destination + written, indices + split[c] * 3, count * sizeof(uint32_t));
+		written += count;
+	}
+}
+
+size_t optimizeVertexFetch(void* destination, uint32_t* indices, const size_t indexCount, const void* vertices, const size_t vertexCount, const size_t vertexSize)
+{
+	QGFX_ASSERT_MSG(destination != vertices, "Vertex fetch optimization can not run in place.\n");
+
+	const uint32_t unused = 0xFFFFFFFF;
+	std::vector<uint32_t> remap(vertexCount, unused);
+
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(vertices);
+	uint8_t* dst = reinterpret_cast<uint8_t*>(destination);
+	uint32_t next = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const uint32_t v = indices[i];
+		QGFX_ASSERT_MSG(v < vertexCount, "Index out of range.\n");
+
+		if (remap[v] == unused)
+		{
+			memcpy(dst + next * vertexSize, src + v * vertexSize, vertexSize);
+			remap[v] = next++;
+		}
+		indices[i] = remap[v];
+	}
+
+	return next;
+}
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize)
+{
+	VertexCacheStatistics statistics = {};
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> referenced(vertexCount, 0);
+	size_t uniqueVertices = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		statistics.vertexTransforms += cache.access(indices[i]) ? 1 : 0;
+		if (!referenced[indices[i]])
+		{
+			referenced[indices[i]] = 1;
+			uniqueVertices++;
+		}
+	}
+
+	const size_t triangleCount = indexCount / 3;
+	statistics.acmr = triangleCount ? static_cast<float>(statistics.vertexTransforms) / static_cast<float>(triangleCount) : 0.0f;
+	statistics.atvr = uniqueVertices ? static_cast<float>(statistics.vertexTransforms) / static_cast<float>(uniqueVertices) : 0.0f;
+
+	return statistics;
+}
+
+size_t optimizeMesh(uint32_t* indices, const size_t indexCount, void* vertices, const size_t vertexCount, const size_t vertexSize,
+	const MeshOptimizerOptions& options)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	std::vector<uint32_t> scratch(indexCount);
+
+	optimizeVertexCache(scratch.data(), indices, indexCount, vertexCount, options.cacheSize);
+
+	if (options.overdraw)
+	{
+		optimizeOverdraw(indices, scratch.data(), indexCount, vertices, vertexCount, vertexSize, options.positionOffset,
+			options.cacheSize, options.overdrawThreshold);
+	}
+	else
+	{
+		memcpy(indices, scratch.data(), indexCount * sizeof(uint32_t));
+	}
+
+	if (!options.vertexFetch)
+	{
+		return vertexCount;
+	}
+
+	std::vector<uint8_t> reordered(vertexCount * vertexSize);
+	const size_t written = optimizeVertexFetch(reordered.data(), indices, indexCount, vertices, vertexCount, vertexSize);
+	memcpy(vertices, reordered.data(), written * vertexSize);
+
+	return written;
+}
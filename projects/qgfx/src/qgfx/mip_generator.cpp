@@ -0,0 +1,309 @@
+#include "qgfx/mip_generator.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/image_format.h"
+#include "qgfx/qassert.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QGFX_SSE2
+#endif
+
+struct PackedField
+{
+	uint32_t shift;
+	uint32_t bits;
+};
+
+static constexpr PackedField packed4444[] = { { 12, 4 }, { 8, 4 }, { 4, 4 }, { 0, 4 } };
+static constexpr PackedField packed5551[] = { { 11, 5 }, { 6, 5 }, { 1, 5 }, { 0, 1 } };
+static constexpr PackedField packed8888[] = { { 24, 8 }, { 16, 8 }, { 8, 8 }, { 0, 8 } };
+static constexpr PackedField packed1010102[] = { { 22, 10 }, { 12, 10 }, { 2, 10 }, { 0, 2 } };
+
+static const PackedField* getPackedFields(const ImageDataType type)
+{
+	switch (type)
+	{
+		case ImageDataType::UShort4_4_4_4: return packed4444;
+		case ImageDataType::UShort5_5_5_1: return packed5551;
+		case ImageDataType::UInt8_8_8_8: return packed8888;
+		case ImageDataType::UInt10_10_10_2: return packed1010102;
+		default: return nullptr;
+	}
+}
+
+static float clampRound(const float value, const float minimum, const float maximum)
+{
+	const float rounded = floorf(value + 0.5f);
+	return rounded < minimum ? minimum : (rounded > maximum ? maximum : rounded);
+}
+
+static void decodeRow(const uint8_t* source, const size_t texels, const uint32_t channels, const ImageDataType type, float* destination)
+{
+	const PackedField* fields = getPackedFields(type);
+	const size_t count = texels * channels;
+
+	if (fields)
+	{
+		for (size_t t = 0; t < texels; t++)
+		{
+			const uint32_t value = type == ImageDataType::UShort4_4_4_4 || type == ImageDataType::UShort5_5_5_1
+				? reinterpret_cast<const uint16_t*>(source)[t] : reinterpret_cast<const uint32_t*>(source)[t];
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				destination[t * 4 + c] = static_cast<float>((value >> fields[c].shift) & ((1u << fields[c].bits) - 1));
+			}
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		switch (type)
+		{
+			case ImageDataType::Byte: destination[i] = reinterpret_cast<const int8_t*>(source)[i]; break;
+			case ImageDataType::UByte: destination[i] = source[i]; break;
+			case ImageDataType::Short: destination[i] = reinterpret_cast<const int16_t*>(source)[i]; break;
+			case ImageDataType::UShort: destination[i] = reinterpret_cast<const uint16_t*>(source)[i]; break;
+			case ImageDataType::Int: destination[i] = static_cast<float>(reinterpret_cast<const int32_t*>(source)[i]); break;
+			case ImageDataType::UInt: destination[i] = static_cast<float>(reinterpret_cast<const uint32_t*>(source)[i]); break;
+			case ImageDataType::Float: destination[i] = reinterpret_cast<const float*>(source)[i]; break;
+			default: break;
+		}
+	}
+}
+
+static void encodeRow(const float* source, const size_t texels, const uint32_t channels, const ImageDataType type, uint8_t* destination)
+{
+	const PackedField* fields = getPackedFields(type);
+	const size_t count = texels * channels;
+
+	if (fields)
+	{
+		for (size_t t = 0; t < texels; t++)
+		{
+			uint32_t value = 0;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				const float maximum = static_cast<float>((1u << fields[c].bits) - 1);
+				value |= static_cast<uint32_t>(clampRound(source[t * 4 + c], 0.0f, maximum)) << fields[c].shift;
+			}
+
+			if (type == ImageDataType::UShort4_4_4_4 || type == ImageDataType::UShort5_5_5_1)
+			{
+				reinterpret_cast<uint16_t*>(destination)[t] = static_cast<uint16_t>(value);
+			}
+			else
+			{
+				reinterpret_cast<uint32_t*>(destination)[t] = value;
+			}
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float v = source[i];
+		switch (type)
+		{
+			case ImageDataType::Byte: reinterpret_cast<int8_t*>(destination)[i] = static_cast<int8_t>(clampRound(v, -128.0f, 127.0f)); break;
+			case ImageDataType::UByte: destination[i] = static_cast<uint8_t>(clampRound(v, 0.0f, 255.0f)); break;
+			case ImageDataType::Short: reinterpret_cast<int16_t*>(destination)[i] = static_cast<int16_t>(clampRound(v, -32768.0f, 32767.0f)); break;
+			case ImageDataType::UShort: reinterpret_cast<uint16_t*>(destination)[i] = static_cast<uint16_t>(clampRound(v, 0.0f, 65535.0f)); break;
+			case ImageDataType::Int: reinterpret_cast<int32_t*>(destination)[i] = static_cast<int32_t>(clampRound(v, -2147483648.0f, 2147483520.0f)); break;
+			case ImageDataType::UInt: reinterpret_cast<uint32_t*>(destination)[i] = static_cast<uint32_t>(clampRound(v, 0.0f, 4294967040.0f)); break;
+			case ImageDataType::Float: reinterpret_cast<float*>(destination)[i] = v; break;
+			default: break;
+		}
+	}
+}
+
+static float besselI0(const float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (uint32_t k = 1; k < 16; k++)
+	{
+		const float half = x / (2.0f * static_cast<float>(k));
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+/// Taps for a 2:1 reduction, relative to the first of the two source texels under each output texel.
+struct MipKernel
+{
+	int32_t first;
+	uint32_t count;
+	float weights[8];
+};
+
+static MipKernel getMipKernel(const MipFilter filter)
+{
+	MipKernel kernel = {};
+	if (filter == MipFilter::Box)
+	{
+		kernel.first = 0;
+		kernel.count = 2;
+		kernel.weights[0] = 0.5f;
+		kernel.weights[1] = 0.5f;
+		return kernel;
+	}
+
+	// Sinc in destination texels, windowed by a Kaiser window two destination texels wide
+	const float pi = 3.14159265358979f;
+	const float alpha = 4.0f;
+	const float radius = 2.0f;
+
+	kernel.first = -3;
+	kernel.count = 8;
+	float total = 0.0f;
+	for (uint32_t i = 0; i < kernel.count; i++)
+	{
+		// Distance from the output texel centre, in destination texels
+		const float d = (static_cast<float>(kernel.first + static_cast<int32_t>(i)) - 0.5f) * 0.5f;
+		const float sinc = d == 0.0f ? 1.0f : sinf(pi * d) / (pi * d);
+		const float x = d / radius;
+		const float window = x * x < 1.0f ? besselI0(alpha * sqrtf(1.0f - x * x)) / besselI0(alpha) : 0.0f;
+
+		kernel.weights[i] = sinc * window;
+		total += kernel.weights[i];
+	}
+
+	for (uint32_t i = 0; i < kernel.count; i++)
+	{
+		kernel.weights[i] /= total;
+	}
+
+	return kernel;
+}
+
+#if defined(QGFX_SSE2)
+/// 2x2 box filter of four RGBA8 texels per iteration.  Returns the number of output texels written.
+static uint32_t downsampleBoxRgba8Sse2(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, const uint32_t destinationWidth, const uint32_t sourceWidth)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(2);
+
+	uint32_t x = 0;
+	for (; x + 4 <= destinationWidth && 2 * x + 8 <= sourceWidth; x += 4)
+	{
+		__m128i pairs[2];
+		for (uint32_t half = 0; half < 2; half++)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x + 16 * half));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x + 16 * half));
+
+			// Vertical sums of texels 0,1 and 2,3 as 16 bit channels
+			const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+			const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+			// Horizontal sums land in the low 64 bits
+			const __m128i sum0 = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+			const __m128i sum1 = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+
+			pairs[half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sum0, sum1), bias), 2);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * x), _mm_packus_epi16(pairs[0], pairs[1]));
+	}
+
+	return x;
+}
+#endif
+
+void downsampleImage(const uint8_t* source, const uint32_t width, const uint32_t height, uint8_t* destination,
+	const ImageFormat format, const ImageDataType type, const MipFilter filter)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(source != nullptr && destination != nullptr, "Downsampling needs a source and a destination.\n");
+	QGFX_ASSERT_MSG(width > 0 && height > 0, "Can not downsample an empty image.\n");
+	QGFX_ASSERT_MSG(!isCompressedImageFormat(format), "Block compressed images can not be downsampled.\n");
+
+	const uint32_t destinationWidth = width > 1 ? width / 2 : 1;
+	const uint32_t destinationHeight = height > 1 ? height / 2 : 1;
+	const uint32_t texelSize = getImageTexelSize(format, type);
+	const uint32_t channels = getPackedFields(type) ? 4 : getImageComponentCount(format);
+
+	const bool rgba8 = (type == ImageDataType::UByte && channels == 4) || type == ImageDataType::UInt8_8_8_8;
+	if (filter == MipFilter::Box && rgba8)
+	{
+		// Channels are averaged independently, so packed 8_8_8_8 works regardless of byte order
+		for (uint32_t y = 0; y < destinationHeight; y++)
+		{
+			const uint8_t* row0 = source + static_cast<size_t>(2 * y < height ? 2 * y : height - 1) * width * 4;
+			const uint8_t* row1 = source + static_cast<size_t>(2 * y + 1 < height ? 2 * y + 1 : height - 1) * width * 4;
+			uint8_t* out = destination + static_cast<size_t>(y) * destinationWidth * 4;
+
+			uint32_t x = 0;
+#if defined(QGFX_SSE2)
+			x = downsampleBoxRgba8Sse2(row0, row1, out, destinationWidth, width);
+#endif
+			for (; x < destinationWidth; x++)
+			{
+				const uint32_t x0 = 2 * x < width ? 2 * x : width - 1;
+				const uint32_t x1 = 2 * x + 1 < width ? 2 * x + 1 : width - 1;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+					out[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+				}
+			}
+		}
+		return;
+	}
+
+	const MipKernel kernel = getMipKernel(filter);
+	const auto clampIndex = [](const int32_t i, const uint32_t size)
+	{
+		return static_cast<uint32_t>(i < 0 ? 0 : (i >= static_cast<int32_t>(size) ? static_cast<int32_t>(size) - 1 : i));
+	};
+
+	// Horizontal pass over every source row, then a vertical pass into the destination
+	std::vector<float> row(static_cast<size_t>(width) * channels);
+	std::vector<float> horizontal(static_cast<size_t>(destinationWidth) * height * channels);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		decodeRow(source + static_cast<size_t>(y) * width * texelSize, width, channels, type, row.data());
+
+		float* out = horizontal.data() + static_cast<size_t>(y) * destinationWidth * channels;
+		for (uint32_t x = 0; x < destinationWidth; x++)
+		{
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				float sum = 0.0f;
+				for (uint32_t k = 0; k < kernel.count; k++)
+				{
+					const uint32_t sx = clampIndex(static_cast<int32_t>(2 * x) + kernel.first + static_cast<int32_t>(k), width);
+					sum += row[sx * channels + c] * kernel.weights[k];
+				}
+				out[x * channels + c] = sum;
+			}
+		}
+	}
+
+	std::vector<float> result(static_cast<size_t>(destinationWidth) * channels);
+	const size_t stride = static_cast<size_t>(destinationWidth) * channels;
+	for (uint32_t y = 0; y < destinationHeight; y++)
+	{
+		memset(result.data(), 0, result.size() * sizeof(float));
+		for (uint32_t k = 0; k < kernel.count; k++)
+		{
+			const uint32_t sy = clampIndex(static_cast<int32_t>(2 * y) + kernel.first + static_cast<int32_t>(k), height);
+			const float* in = horizontal.data() + sy * stride;
+			const float weight = kernel.weights[k];
+			for (size_t i = 0; i < stride; i++)
+			{
+				result[i] += in[i] * weight;
+			}
+		}
+
+		encodeRow(result.data(), destinationWidth, channels, type, destination + static_cast<size_t>(y) * destinationWidth * texelSize);
+	}
+}
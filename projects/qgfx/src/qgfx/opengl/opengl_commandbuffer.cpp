@@ -1,14 +1,28 @@
 #if defined (QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_commandbuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_framebuffer.h"
+#include "qgfx/opengl/opengl_indexbuffer.h"
+#include "qgfx/opengl/opengl_pipeline.h"
+#include "qgfx/opengl/opengl_rasterizer.h"
+#include "qgfx/opengl/opengl_renderpass.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_stream_buffer.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
+#include "qgfx/opengl/opengl_vertexbuffer.h"
+#include "qgfx/qassert.h"
 
-OpenGLCommandBuffer::OpenGLCommandBuffer(ContextHandle* handle)
-	: ICommandBuffer(handle), mIsRecording(false)
+OpenGLCommandBuffer::OpenGLCommandBuffer(ContextHandle* handle, const CommandBufferUsage usage)
+	: ICommandBuffer(handle, usage), mIsRecording(false), mTopology(GL_TRIANGLES), mIndexType(GL_UNSIGNED_INT), mIndexSize(sizeof(uint32_t)), mVertexArray(nullptr),
+	  mRenderPass(nullptr), mFrameBuffer(nullptr)
 {
 }
 
 OpenGLCommandBuffer::OpenGLCommandBuffer(OpenGLCommandBuffer&& buf) noexcept
-	: ICommandBuffer(buf.mHandle), mIsRecording(buf.mIsRecording)
+	: ICommandBuffer(buf.mHandle, buf.mUsage), mIsRecording(buf.mIsRecording), mTopology(buf.mTopology),
+	  mIndexType(buf.mIndexType), mIndexSize(buf.mIndexSize), mVertexArray(buf.mVertexArray),
+	  mRenderPass(buf.mRenderPass), mFrameBuffer(buf.mFrameBuffer)
 {
 	buf.mHandle = nullptr;
 }
@@ -16,8 +30,15 @@ OpenGLCommandBuffer::OpenGLCommandBuffer(OpenGLCommandBuffer&& buf) noexcept
 OpenGLCommandBuffer& OpenGLCommandBuffer::operator=(OpenGLCommandBuffer&& buf) noexcept
 {
 	mHandle = buf.mHandle;
+	mUsage = buf.mUsage;
 	buf.mHandle = nullptr;
 	mIsRecording = buf.mIsRecording;
+	mTopology = buf.mTopology;
+	mIndexType = buf.mIndexType;
+	mIndexSize = buf.mIndexSize;
+	mVertexArray = buf.mVertexArray;
+	mRenderPass = buf.mRenderPass;
+	mFrameBuffer = buf.mFrameBuffer;
 	return *this;
 }
 
@@ -31,4 +52,164 @@ void OpenGLCommandBuffer::end()
 	mIsRecording = false;
 }
 
+void OpenGLCommandBuffer::reset()
+{
+	mIsRecording = false;
+}
+
+// OpenGL has no deferred command recording, so commands are issued immediately while recording.
+
+void OpenGLCommandBuffer::beginRenderPass(RenderPass* renderPass, FrameBuffer* frameBuffer, const ClearValue* clearValues)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	QGFX_ASSERT_MSG(mRenderPass == nullptr, "Render pass is already active.\n");
+
+	const RenderPassDescription& description = renderPass->getDescription();
+	const GLuint framebuffer = frameBuffer->getFrameBuffer();
+
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->bindFramebuffer(framebuffer);
+	tracker->setViewport(0, 0, static_cast<GLsizei>(frameBuffer->getWidth()), static_cast<GLsizei>(frameBuffer->getHeight()));
+
+	// Clears honour the write masks, which a depth prepass or a masked draw may have left off
+	OpenGLRasterizer* rasterizer = static_cast<OpenGLRasterizer*>(mHandle->getRasterizer());
+	tracker->setColorMask(true);
+	tracker->setDepthMask(true);
+	tracker->setStencilMask(GL_FRONT_AND_BACK, ~0u);
+
+	// DontCare loads are left alone, there is no cheaper way to start a pass on GL
+	static const float black[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		if (description.colorAttachments[i].loadOp == AttachmentLoadOp::Clear)
+		{
+			glClearNamedFramebufferfv(framebuffer, GL_COLOR, static_cast<GLint>(i), clearValues ? clearValues[i].color : black);
+		}
+	}
+
+	if (description.hasDepthAttachment)
+	{
+		const uint32_t index = description.colorAttachmentCount;
+		const float depth = clearValues ? clearValues[index].depth : rasterizer->getDepthClearValue();
+		const GLint stencil = clearValues ? static_cast<GLint>(clearValues[index].stencil) : 0;
+
+		const bool clearDepth = description.depthAttachment.loadOp == AttachmentLoadOp::Clear;
+		const bool clearStencil = description.depthAttachment.stencilLoadOp == AttachmentLoadOp::Clear &&
+			(static_cast<uint32_t>(description.depthAttachment.imageType) & static_cast<uint32_t>(ImageType::Stencil)) != 0;
+
+		if (clearDepth && clearStencil)
+		{
+			glClearNamedFramebufferfi(framebuffer, GL_DEPTH_STENCIL, 0, depth, stencil);
+		}
+		else if (clearDepth)
+		{
+			glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &depth);
+		}
+		else if (clearStencil)
+		{
+			glClearNamedFramebufferiv(framebuffer, GL_STENCIL, 0, &stencil);
+		}
+	}
+
+	rasterizer->apply();
+
+	mRenderPass = renderPass;
+	mFrameBuffer = frameBuffer;
+}
+
+void OpenGLCommandBuffer::endRenderPass()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mRenderPass != nullptr, "No render pass is active.\n");
+
+	const RenderPassDescription& description = mRenderPass->getDescription();
+
+	// Blits are clipped by the scissor rectangle like draws are
+	if (description.resolveAttachmentCount > 0)
+	{
+		mHandle->getStateTracker()->setEnabled(GL_SCISSOR_TEST, false);
+		mFrameBuffer->resolve();
+	}
+
+	// Lets tiled GPUs skip writing attachments nothing reads back to memory
+	GLenum discard[RenderPassDescription::maxColorAttachments + 1];
+	GLsizei count = 0;
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		if (description.colorAttachments[i].storeOp == AttachmentStoreOp::DontCare)
+		{
+			discard[count++] = mFrameBuffer->getAttachmentPoint(i);
+		}
+	}
+
+	if (description.hasDepthAttachment && description.depthAttachment.storeOp == AttachmentStoreOp::DontCare)
+	{
+		discard[count++] = mFrameBuffer->getAttachmentPoint(description.colorAttachmentCount);
+	}
+
+	if (count > 0)
+	{
+		glInvalidateNamedFramebufferData(mFrameBuffer->getFrameBuffer(), count, discard);
+	}
+
+	mRenderPass = nullptr;
+	mFrameBuffer = nullptr;
+}
+
+void OpenGLCommandBuffer::bindPipeline(Pipeline* pipeline)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	pipeline->bind();
+	mTopology = pipeline->getTopology();
+	mVertexArray = pipeline->getVertexArray();
+}
+
+void OpenGLCommandBuffer::bindVertexBuffer(VertexBuffer* buffer)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	if (mVertexArray)
+	{
+		buffer->bind(mVertexArray);
+	}
+	else
+	{
+		buffer->bind();
+	}
+}
+
+void OpenGLCommandBuffer::bindStreamVertexBuffer(const StreamAllocation& allocation, const uint32_t binding, const uint32_t stride)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	QGFX_ASSERT_MSG(mVertexArray != nullptr, "Bound pipeline has no vertex layouts to attach a stream to.\n");
+	mHandle->getStateTracker()->bindVertexArray(mVertexArray->id);
+	mHandle->getVertexStream()->bindVertexBuffer(mVertexArray, binding, allocation, static_cast<GLsizei>(stride));
+}
+
+void OpenGLCommandBuffer::bindIndexBuffer(IndexBuffer* buffer)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	buffer->bind();
+	mIndexType = buffer->getOpenGLIndexType();
+	mIndexSize = buffer->getIndexSize();
+}
+
+void OpenGLCommandBuffer::draw(const uint32_t vertexCount, const uint32_t instanceCount, const uint32_t firstVertex, const uint32_t firstInstance)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	glDrawArraysInstancedBaseInstance(mTopology, static_cast<GLint>(firstVertex), static_cast<GLsizei>(vertexCount),
+		static_cast<GLsizei>(instanceCount), firstInstance);
+	mHandle->countDrawCall();
+}
+
+void OpenGLCommandBuffer::drawIndexed(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t firstIndex, const int32_t vertexOffset, const uint32_t firstInstance)
+{
+	QGFX_ASSERT_MSG(mIsRecording, "Command buffer is not recording.\n");
+	glDrawElementsInstancedBaseVertexBaseInstance(mTopology, static_cast<GLsizei>(indexCount), mIndexType,
+		reinterpret_cast<const void*>(firstIndex * mIndexSize), static_cast<GLsizei>(instanceCount), vertexOffset, firstInstance);
+	mHandle->countDrawCall();
+}
+
 #endif
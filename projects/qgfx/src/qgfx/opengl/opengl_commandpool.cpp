@@ -1,6 +1,7 @@
 #if defined (QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_commandpool.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/opengl/opengl_commandbuffer.h"
 
 OpenGLCommandPool::OpenGLCommandPool(ContextHandle* handle)
@@ -33,9 +34,9 @@ OpenGLCommandPool& OpenGLCommandPool::operator=(OpenGLCommandPool&& other) noexc
 	return *this;
 }
 
-CommandBuffer* OpenGLCommandPool::addCommandBuffer()
+CommandBuffer* OpenGLCommandPool::addCommandBuffer(const CommandBufferUsage usage)
 {
-	const auto buf = new CommandBuffer(mHandle);
+	const auto buf = new CommandBuffer(mHandle, usage);
 	mBuffers.push_back(buf);
 
 	return buf;
@@ -48,6 +49,15 @@ qtl::vector<CommandBuffer*> OpenGLCommandPool::getBuffers()
 
 void OpenGLCommandPool::construct()
 {
+	QGFX_PROFILE_FUNCTION();
+}
+
+void OpenGLCommandPool::reset()
+{
+	for (auto buf : mBuffers)
+	{
+		buf->reset();
+	}
 }
 
 #endif
\ No newline at end of file
@@ -1,25 +1,64 @@
 #if defined(QGFX_OPENGL)
 
+#include <cstring>
+
 #include "qgfx/opengl/opengl_context_handle.h"
+#include "qgfx/cpu_profiler.h"
 
 #include "qgfx/opengl/opengl_commandpool.h"
+#include "qgfx/opengl/opengl_image2d.h"
 #include "qgfx/opengl/opengl_pipeline.h"
 #include "qgfx/opengl/opengl_rasterizer.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_stream_buffer.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
 #include "qgfx/opengl/opengl_window.h"
+#include "qgfx/render_pass_cache.h"
+
+static constexpr size_t vertexStreamSize = 4 * 1024 * 1024;
+static constexpr size_t indexStreamSize = 1024 * 1024;
+static constexpr size_t uniformStreamSize = 1024 * 1024;
+static constexpr size_t storageStreamSize = 4 * 1024 * 1024;
+static constexpr size_t indirectStreamSize = 1024 * 1024;
 
 OpenGLContextHandle::OpenGLContextHandle(Window* window)
 	: IContextHandle(window)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+	mStateTracker = new OpenGLStateTracker();
+	mVertexArrayCache = new OpenGLVertexArrayCache(mStateTracker);
+	mVertexStream = new OpenGLStreamBuffer(this, GL_ARRAY_BUFFER, vertexStreamSize);
+	mIndexStream = new OpenGLStreamBuffer(this, GL_ELEMENT_ARRAY_BUFFER, indexStreamSize);
+	mUniformStream = new OpenGLStreamBuffer(this, GL_UNIFORM_BUFFER, uniformStreamSize);
+	mVertexStream->construct();
+	mIndexStream->construct();
+	mStorageStream = new OpenGLStreamBuffer(this, GL_SHADER_STORAGE_BUFFER, storageStreamSize);
+	mIndirectStream = new OpenGLStreamBuffer(this, GL_DRAW_INDIRECT_BUFFER, indirectStreamSize);
+	mUniformStream->construct();
+	mStorageStream->construct();
+	mIndirectStream->construct();
 	mPipeline = new OpenGLPipeline(this);
 	mRasterizer = new OpenGLRasterizer(this);
+	mRenderPassCache = new RenderPassCache(this);
 }
 
 OpenGLContextHandle::OpenGLContextHandle(OpenGLContextHandle&& context) noexcept
-	: IContextHandle(context.mWindow), mPipeline(context.mPipeline), mRasterizer(context.mRasterizer), mCommandPools(qtl::move(context.mCommandPools))
+	: IContextHandle(context.mWindow), mPipeline(context.mPipeline), mRasterizer(context.mRasterizer), mStateTracker(context.mStateTracker), mVertexArrayCache(context.mVertexArrayCache), mVertexStream(context.mVertexStream),
+	  mIndexStream(context.mIndexStream), mUniformStream(context.mUniformStream),
+	  mStorageStream(context.mStorageStream), mIndirectStream(context.mIndirectStream), mRenderPassCache(context.mRenderPassCache), mCommandPools(qtl::move(context.mCommandPools))
 {
 	context.mPipeline = nullptr;
 	context.mRasterizer = nullptr;
+	context.mStateTracker = nullptr;
+	context.mVertexArrayCache = nullptr;
+	context.mVertexStream = nullptr;
+	context.mIndexStream = nullptr;
+	context.mUniformStream = nullptr;
+	context.mStorageStream = nullptr;
+	context.mIndirectStream = nullptr;
+	context.mRenderPassCache = nullptr;
 	context.mCommandPools.clear();
 }
 
@@ -32,8 +71,24 @@ OpenGLContextHandle::~OpenGLContextHandle()
 		delete pool;
 	}
 	mCommandPools.clear();
+	delete mVertexStream;
+	delete mIndexStream;
+	delete mUniformStream;
+	delete mStorageStream;
+	delete mIndirectStream;
+	delete mRenderPassCache;
+	delete mVertexArrayCache;
+	delete mStateTracker;
 	mPipeline = nullptr;
 	mRasterizer = nullptr;
+	mStateTracker = nullptr;
+	mVertexArrayCache = nullptr;
+	mVertexStream = nullptr;
+	mIndexStream = nullptr;
+	mUniformStream = nullptr;
+	mStorageStream = nullptr;
+	mIndirectStream = nullptr;
+	mRenderPassCache = nullptr;
 }
 
 OpenGLContextHandle& OpenGLContextHandle::operator=(OpenGLContextHandle&& handle) noexcept
@@ -41,8 +96,24 @@ OpenGLContextHandle& OpenGLContextHandle::operator=(OpenGLContextHandle&& handle
 	mWindow = handle.mWindow;
 	mPipeline = handle.mPipeline;
 	mRasterizer = handle.mRasterizer;
+	mStateTracker = handle.mStateTracker;
+	mVertexArrayCache = handle.mVertexArrayCache;
+	mVertexStream = handle.mVertexStream;
+	mIndexStream = handle.mIndexStream;
+	mUniformStream = handle.mUniformStream;
+	mStorageStream = handle.mStorageStream;
+	mIndirectStream = handle.mIndirectStream;
+	mRenderPassCache = handle.mRenderPassCache;
 	handle.mPipeline = nullptr;
 	handle.mRasterizer = nullptr;
+	handle.mStateTracker = nullptr;
+	handle.mVertexArrayCache = nullptr;
+	handle.mVertexStream = nullptr;
+	handle.mIndexStream = nullptr;
+	handle.mUniformStream = nullptr;
+	handle.mStorageStream = nullptr;
+	handle.mIndirectStream = nullptr;
+	handle.mRenderPassCache = nullptr;
 	return *this;
 }
 
@@ -56,13 +127,57 @@ Rasterizer* OpenGLContextHandle::getRasterizer() const
 	return mRasterizer;
 }
 
+OpenGLStateTracker* OpenGLContextHandle::getStateTracker() const
+{
+	return mStateTracker;
+}
+
+OpenGLVertexArrayCache* OpenGLContextHandle::getVertexArrayCache() const
+{
+	return mVertexArrayCache;
+}
+
+RenderPassCache* OpenGLContextHandle::getRenderPassCache() const
+{
+	return mRenderPassCache;
+}
+
+OpenGLStreamBuffer* OpenGLContextHandle::getVertexStream() const
+{
+	return mVertexStream;
+}
+
+OpenGLStreamBuffer* OpenGLContextHandle::getIndexStream() const
+{
+	return mIndexStream;
+}
+
+OpenGLStreamBuffer* OpenGLContextHandle::getUniformStream() const
+{
+	return mUniformStream;
+}
+
+OpenGLStreamBuffer* OpenGLContextHandle::getStorageStream() const
+{
+	return mStorageStream;
+}
+
+OpenGLStreamBuffer* OpenGLContextHandle::getIndirectStream() const
+{
+	return mIndirectStream;
+}
+
 void OpenGLContextHandle::initializeGraphics()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	mPipeline->construct();
 }
 
 void OpenGLContextHandle::finalizeGraphics()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	// no op
 }
 
@@ -81,15 +196,76 @@ qtl::vector<CommandPool*> OpenGLContextHandle::getCommandPools()
 
 void OpenGLContextHandle::startFrame()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	mStateTracker->beginFrame();
+	mVertexStream->beginFrame();
+	mIndexStream->beginFrame();
+	mUniformStream->beginFrame();
+	mStorageStream->beginFrame();
+	mIndirectStream->beginFrame();
 }
 
 void OpenGLContextHandle::endFrame()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	mVertexStream->endFrame();
+	mIndexStream->endFrame();
+	mUniformStream->endFrame();
+	mStorageStream->endFrame();
+	mIndirectStream->endFrame();
+	mStateTracker->endFrame();
 }
 
 void OpenGLContextHandle::swap()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	glfwSwapBuffers(reinterpret_cast<GLFWwindow*>(mWindow->getPlatformHandle()));
 }
 
+bool OpenGLContextHandle::isImageFormatSupported(const ImageFormat format, const ImageDataType type) const
+{
+	return OpenGLImage2D::isFormatSupported(format, type);
+}
+
+uint32_t OpenGLContextHandle::getMaxSampleCount() const
+{
+	// Attachments are multisample textures, which may support fewer samples than renderbuffers
+	GLint color = 1;
+	GLint depth = 1;
+	glGetIntegerv(GL_MAX_COLOR_TEXTURE_SAMPLES, &color);
+	glGetIntegerv(GL_MAX_DEPTH_TEXTURE_SAMPLES, &depth);
+
+	return static_cast<uint32_t>(color < depth ? color : depth);
+}
+
+void OpenGLContextHandle::readBackBuffer(uint8_t* destination)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const uint32_t width = getBackBufferWidth();
+	const uint32_t height = getBackBufferHeight();
+	const size_t rowSize = static_cast<size_t>(width) * 4;
+
+	// Reads from the default framebuffer's read buffer, the back buffer until swap() or the
+	// only buffer of a headless OSMesa context
+	mStateTracker->bindFramebuffer(0);
+	mStateTracker->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, destination);
+
+	// OpenGL returns the bottom row first
+	qtl::vector<uint8_t> row;
+	row.resize(rowSize);
+	for (uint32_t y = 0; y < height / 2; y++)
+	{
+		uint8_t* top = destination + y * rowSize;
+		uint8_t* bottom = destination + (height - 1 - y) * rowSize;
+		memcpy(row.data(), top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, row.data(), rowSize);
+	}
+}
+
 #endif // QGFX_OPENGL
\ No newline at end of file
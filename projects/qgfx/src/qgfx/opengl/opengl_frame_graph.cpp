@@ -0,0 +1,252 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_frame_graph.h"
+#include "qgfx/opengl/opengl_commandbuffer.h"
+#include "qgfx/opengl/opengl_framebuffer.h"
+#include "qgfx/opengl/opengl_image2d.h"
+#include "qgfx/opengl/opengl_renderpass.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/render_pass_cache.h"
+#include "qgfx/qassert.h"
+
+#include <cstring>
+
+static uint64_t getTexelSize(const GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+		case GL_R8:
+			return 1;
+		case GL_RG8:
+		case GL_R16F:
+			return 2;
+		case GL_RGB8:
+			return 3;
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return 8;
+		case GL_DEPTH32F_STENCIL8:
+			return 8;
+		case GL_RGB32F:
+			return 12;
+		case GL_RGBA32F:
+			return 16;
+		default:
+			return 4;
+	}
+}
+
+OpenGLFrameGraph::OpenGLFrameGraph(ContextHandle* handle)
+	: IFrameGraph(handle)
+{
+}
+
+OpenGLFrameGraph::~OpenGLFrameGraph()
+{
+	reset();
+}
+
+void* OpenGLFrameGraph::getImageHandle(const FrameGraphResource resource) const
+{
+	return reinterpret_cast<void*>(static_cast<uintptr_t>(mTextures[_getResourceIndex(resource)]));
+}
+
+bool OpenGLFrameGraph::_canAlias(const FrameGraphTextureDescription& a, const FrameGraphTextureDescription& b) const
+{
+	return a.width == b.width && a.height == b.height && a.format == b.format && a.type == b.type && a.imageType == b.imageType &&
+		a.samples == b.samples;
+}
+
+void OpenGLFrameGraph::_createResources()
+{
+	mTextures.clear();
+	for (uint32_t index = 0; index < mResources.size(); index++)
+	{
+		mTextures.push_back(0);
+	}
+
+	for (uint32_t index = 0; index < mResources.size(); index++)
+	{
+		const ResourceNode& resource = mResources[index];
+		if (resource.imported != nullptr)
+		{
+			mTextures[index] = static_cast<GLuint>(reinterpret_cast<uintptr_t>(resource.imported->getImageHandle()));
+			continue;
+		}
+
+		if (resource.slot == 0xFFFFFFFF)
+		{
+			continue;
+		}
+
+		while (resource.slot >= mSlots.size())
+		{
+			mSlots.push_back(0);
+		}
+
+		const FrameGraphTextureDescription& description = resource.description;
+		const GLenum internalFormat = hasDepthAspect(description.imageType) ? getDepthInternalFormat(description.imageType) :
+			getInternalFormat(description.format, description.type);
+		const uint64_t size = static_cast<uint64_t>(description.width) * description.height * description.samples * getTexelSize(internalFormat);
+
+		// The first resource in a slot creates the texture, the rest reuse it.  GL has no lazily
+		// allocated memory, invalidating the samples at the end of the pass is all it gets.
+		if (mSlots[resource.slot] == 0 && description.samples > 1)
+		{
+			glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &mSlots[resource.slot]);
+			glTextureStorage2DMultisample(mSlots[resource.slot], static_cast<GLsizei>(description.samples), internalFormat,
+				description.width, description.height, GL_TRUE);
+
+			mStatistics.allocatedBytes += size;
+		}
+		else if (mSlots[resource.slot] == 0)
+		{
+			glCreateTextures(GL_TEXTURE_2D, 1, &mSlots[resource.slot]);
+			glTextureStorage2D(mSlots[resource.slot], 1, internalFormat, description.width, description.height);
+			glTextureParameteri(mSlots[resource.slot], GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTextureParameteri(mSlots[resource.slot], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTextureParameteri(mSlots[resource.slot], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTextureParameteri(mSlots[resource.slot], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+			mStatistics.allocatedBytes += size;
+		}
+
+		mTextures[index] = mSlots[resource.slot];
+		mStatistics.transientBytes += size;
+	}
+
+	mStatistics.physicalTextures = static_cast<uint32_t>(mSlots.size());
+	mRenderPasses.clear();
+	mFrameBuffers.clear();
+	for (uint32_t index = 0; index < mPasses.size(); index++)
+	{
+		mRenderPasses.push_back(nullptr);
+		mFrameBuffers.push_back(nullptr);
+	}
+
+	RenderPassCache* cache = mHandle->getRenderPassCache();
+	for (const auto index : mSchedule)
+	{
+		const PassNode& pass = mPasses[index];
+		if (pass.colorAttachments.empty() && !pass.hasDepthAttachment)
+		{
+			continue;
+		}
+
+		RenderPassDescription description;
+		qtl::vector<FrameBufferAttachment> attachments;
+
+		auto addAttachment = [&](const Attachment& attachment)
+		{
+			const ResourceNode& resource = mResources[attachment.resource];
+
+			RenderPassAttachment info;
+			info.format = resource.description.format;
+			info.type = resource.description.type;
+			info.imageType = resource.description.imageType;
+			info.loadOp = attachment.clear ? AttachmentLoadOp::Clear : AttachmentLoadOp::Load;
+			info.storeOp = attachment.store ? AttachmentStoreOp::Store : AttachmentStoreOp::DontCare;
+			info.stencilLoadOp = info.loadOp;
+			info.stencilStoreOp = info.storeOp;
+
+			void* texture = reinterpret_cast<void*>(static_cast<uintptr_t>(mTextures[attachment.resource]));
+			attachments.push_back({ texture, texture });
+			return info;
+		};
+
+		for (const auto& attachment : pass.colorAttachments)
+		{
+			description.addColorAttachment(addAttachment(attachment));
+		}
+
+		if (pass.hasDepthAttachment)
+		{
+			description.setDepthAttachment(addAttachment(pass.depthAttachment));
+		}
+
+		description.samples = mResources[pass.hasDepthAttachment ? pass.depthAttachment.resource : pass.colorAttachments[0].resource].description.samples;
+		for (uint32_t i = 0; i < pass.resolveAttachments.size(); i++)
+		{
+			if (pass.resolveAttachments[i].resource != 0xFFFFFFFF)
+			{
+				description.setResolveAttachment(i, addAttachment(pass.resolveAttachments[i]));
+			}
+		}
+
+		const FrameGraphTextureDescription& size = mResources[pass.hasDepthAttachment ? pass.depthAttachment.resource :
+			pass.colorAttachments[0].resource].description;
+
+		mRenderPasses[index] = cache->acquire(description);
+		mFrameBuffers[index] = cache->acquire(mRenderPasses[index], attachments.data(), static_cast<uint32_t>(attachments.size()),
+			size.width, size.height);
+	}
+}
+
+void OpenGLFrameGraph::_destroyResources()
+{
+	// Imported textures are evicted too, the graph's framebuffers should not outlive it
+	for (auto texture : mTextures)
+	{
+		if (texture != 0)
+		{
+			mHandle->getRenderPassCache()->evict(reinterpret_cast<void*>(static_cast<uintptr_t>(texture)));
+		}
+	}
+
+	if (!mSlots.empty())
+	{
+		for (auto slot : mSlots)
+		{
+			mHandle->getStateTracker()->forgetTexture(slot);
+		}
+		glDeleteTextures(static_cast<GLsizei>(mSlots.size()), mSlots.data());
+	}
+
+	mTextures.clear();
+	mSlots.clear();
+	mRenderPasses.clear();
+	mFrameBuffers.clear();
+}
+
+void OpenGLFrameGraph::_beginPass(const PassNode& pass, CommandBuffer* commandBuffer)
+{
+	const uint32_t index = static_cast<uint32_t>(&pass - mPasses.data());
+	if (mRenderPasses[index] == nullptr)
+	{
+		return;
+	}
+
+	qtl::vector<ClearValue> clearValues;
+	for (const auto& attachment : pass.colorAttachments)
+	{
+		ClearValue value = {};
+		memcpy(value.color, mResources[attachment.resource].description.clearColor, sizeof(value.color));
+		clearValues.push_back(value);
+	}
+
+	if (pass.hasDepthAttachment)
+	{
+		ClearValue value = {};
+		value.depth = mResources[pass.depthAttachment.resource].description.clearDepth;
+		clearValues.push_back(value);
+	}
+
+	commandBuffer->beginRenderPass(mRenderPasses[index], mFrameBuffers[index], clearValues.data());
+}
+
+void OpenGLFrameGraph::_endPass(const PassNode& pass, CommandBuffer* commandBuffer)
+{
+	const uint32_t index = static_cast<uint32_t>(&pass - mPasses.data());
+	if (mRenderPasses[index] != nullptr)
+	{
+		commandBuffer->endRenderPass();
+	}
+}
+
+void OpenGLFrameGraph::_endExecute(CommandBuffer* commandBuffer)
+{
+	(void)commandBuffer;
+	mHandle->getStateTracker()->bindFramebuffer(0);
+}
+
+#endif // QGFX_OPENGL
@@ -0,0 +1,152 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_framebuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_context_handle.h"
+#include "qgfx/opengl/opengl_renderpass.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/qassert.h"
+
+OpenGLFrameBuffer::OpenGLFrameBuffer(ContextHandle* handle)
+	: IFrameBuffer(handle), mFrameBuffer(0), mResolveFrameBuffer(0)
+{
+}
+
+OpenGLFrameBuffer::~OpenGLFrameBuffer()
+{
+	if (mFrameBuffer != 0)
+	{
+		mHandle->getStateTracker()->forgetFramebuffer(mFrameBuffer);
+		glDeleteFramebuffers(1, &mFrameBuffer);
+	}
+
+	if (mResolveFrameBuffer != 0)
+	{
+		mHandle->getStateTracker()->forgetFramebuffer(mResolveFrameBuffer);
+		glDeleteFramebuffers(1, &mResolveFrameBuffer);
+	}
+}
+
+void OpenGLFrameBuffer::construct(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+	const uint32_t width, const uint32_t height)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const RenderPassDescription& description = renderPass->getDescription();
+	QGFX_ASSERT_MSG(attachmentCount == description.getAttachmentCount(), "Framebuffer attachments do not match the render pass.\n");
+
+	mRenderPass = renderPass;
+	mWidth = width;
+	mHeight = height;
+
+	for (uint32_t i = 0; i < attachmentCount; i++)
+	{
+		mAttachments.push_back(attachments[i]);
+	}
+
+	if (description.colorAttachmentCount == 1 && description.colorAttachments[0].swapChain)
+	{
+		return;
+	}
+
+	glCreateFramebuffers(1, &mFrameBuffer);
+
+	GLenum drawBuffers[RenderPassDescription::maxColorAttachments];
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(attachments[i].view));
+		glNamedFramebufferTexture(mFrameBuffer, GL_COLOR_ATTACHMENT0 + i, texture, 0);
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+	}
+
+	if (description.colorAttachmentCount == 0)
+	{
+		glNamedFramebufferDrawBuffer(mFrameBuffer, GL_NONE);
+	}
+	else
+	{
+		glNamedFramebufferDrawBuffers(mFrameBuffer, static_cast<GLsizei>(description.colorAttachmentCount), drawBuffers);
+	}
+
+	if (description.hasDepthAttachment)
+	{
+		const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(attachments[description.colorAttachmentCount].view));
+		glNamedFramebufferTexture(mFrameBuffer, getAttachmentPoint(description.colorAttachmentCount), texture, 0);
+	}
+
+	// Checking completeness can stall on the driver, only debug builds pay for it
+#if defined(_DEBUG)
+	const GLenum status = glCheckNamedFramebufferStatus(mFrameBuffer, GL_FRAMEBUFFER);
+	QGFX_ASSERT_MSG(status == GL_FRAMEBUFFER_COMPLETE, "Framebuffer is incomplete (0x%x).\n", status);
+#endif
+
+	if (description.resolveAttachmentCount == 0)
+	{
+		return;
+	}
+
+	QGFX_ASSERT_MSG(description.samples > 1, "Resolve attachments need a multisampled render pass.\n");
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		if (description.hasResolveAttachment[i] && description.resolveAttachments[i].swapChain)
+		{
+			QGFX_ASSERT_MSG(description.resolveAttachmentCount == 1, "Resolving to the window has to be the only resolve.\n");
+			return;
+		}
+	}
+
+	glCreateFramebuffers(1, &mResolveFrameBuffer);
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		if (description.hasResolveAttachment[i])
+		{
+			const FrameBufferAttachment& attachment = attachments[description.getResolveAttachmentIndex(i)];
+			const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(attachment.view));
+			glNamedFramebufferTexture(mResolveFrameBuffer, GL_COLOR_ATTACHMENT0 + i, texture, 0);
+		}
+	}
+
+#if defined(_DEBUG)
+	const GLenum resolveStatus = glCheckNamedFramebufferStatus(mResolveFrameBuffer, GL_FRAMEBUFFER);
+	QGFX_ASSERT_MSG(resolveStatus == GL_FRAMEBUFFER_COMPLETE, "Resolve framebuffer is incomplete (0x%x).\n", resolveStatus);
+#endif
+}
+
+void OpenGLFrameBuffer::resolve()
+{
+	const RenderPassDescription& description = mRenderPass->getDescription();
+	const GLint width = static_cast<GLint>(mWidth);
+	const GLint height = static_cast<GLint>(mHeight);
+
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		if (!description.hasResolveAttachment[i])
+		{
+			continue;
+		}
+
+		glNamedFramebufferReadBuffer(mFrameBuffer, GL_COLOR_ATTACHMENT0 + i);
+		glNamedFramebufferDrawBuffer(mResolveFrameBuffer, mResolveFrameBuffer != 0 ? GL_COLOR_ATTACHMENT0 + i : GL_BACK);
+		glBlitNamedFramebuffer(mFrameBuffer, mResolveFrameBuffer, 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+}
+
+GLenum OpenGLFrameBuffer::getAttachmentPoint(const uint32_t index) const
+{
+	const RenderPassDescription& description = mRenderPass->getDescription();
+
+	// The default framebuffer names its buffers differently
+	if (mFrameBuffer == 0)
+	{
+		return index < description.colorAttachmentCount ? GL_COLOR : GL_DEPTH;
+	}
+
+	if (index < description.colorAttachmentCount)
+	{
+		return GL_COLOR_ATTACHMENT0 + index;
+	}
+
+	return hasStencilAspect(description.depthAttachment.imageType) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+#endif // QGFX_OPENGL
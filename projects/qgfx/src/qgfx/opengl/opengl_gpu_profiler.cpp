@@ -0,0 +1,89 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_gpu_profiler.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+OpenGLGpuProfiler::OpenGLGpuProfiler(ContextHandle* handle, const uint32_t maxScopes, const uint32_t historyLength, const uint32_t slotCount)
+	: IGpuProfiler(handle, maxScopes, historyLength), mSlotCount(slotCount), mNextSlot(0), mSupported(false)
+{
+	QGFX_ASSERT_MSG(slotCount > 0, "GPU profiler needs at least one slot.\n");
+}
+
+OpenGLGpuProfiler::~OpenGLGpuProfiler()
+{
+	if (!mQueries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(mQueries.size()), mQueries.data());
+		mQueries.clear();
+	}
+}
+
+void OpenGLGpuProfiler::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	_initialize(mSlotCount);
+
+	// Implementations may report 0 bits, timestamps are meaningless then
+	GLint bits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+	mSupported = bits > 0;
+
+	if (mSupported)
+	{
+		mQueries.resize(mSlotCount * mMaxScopes * 2);
+		glGenQueries(static_cast<GLsizei>(mQueries.size()), mQueries.data());
+	}
+}
+
+bool OpenGLGpuProfiler::isSupported() const
+{
+	return mSupported;
+}
+
+uint32_t OpenGLGpuProfiler::_acquireSlot()
+{
+	const uint32_t slot = mNextSlot;
+	mNextSlot = (mNextSlot + 1) % mSlotCount;
+
+	return slot;
+}
+
+void OpenGLGpuProfiler::_resetQueries(CommandBuffer*, const uint32_t)
+{
+	// Query objects are overwritten by the next glQueryCounter, there is nothing to reset
+}
+
+void OpenGLGpuProfiler::_writeTimestamp(CommandBuffer*, const uint32_t slot, const uint32_t query)
+{
+	// Commands are issued as they are recorded, the timestamp is taken once the GPU has
+	// finished everything issued before it
+	glQueryCounter(mQueries[slot * mMaxScopes * 2 + query], GL_TIMESTAMP);
+}
+
+bool OpenGLGpuProfiler::_getTimestamps(const uint32_t slot, const uint32_t count, double* milliseconds)
+{
+	const GLuint* queries = &mQueries[slot * mMaxScopes * 2];
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+		{
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanoseconds);
+		milliseconds[i] = static_cast<double>(nanoseconds) / 1000000.0;
+	}
+
+	return true;
+}
+
+#endif
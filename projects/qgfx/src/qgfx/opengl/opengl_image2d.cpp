@@ -1,11 +1,35 @@
 #if defined (QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_image2d.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_context_handle.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/image_format.h"
 #include "qgfx/qassert.h"
 
 #include "qtl/utility.h"
 
-constexpr GLenum getInternalFormat(const ImageFormat format, const ImageDataType type)
+// S3TC and ASTC are extensions, the core profile loader does not define their enums
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+#define GL_COMPRESSED_RGBA_ASTC_6x6_KHR 0x93B4
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
+
+GLenum getInternalFormat(const ImageFormat format, const ImageDataType type)
 {
 	switch (format)
 	{
@@ -125,11 +149,29 @@ constexpr GLenum getInternalFormat(const ImageFormat format, const ImageDataType
 			default: return 0;
 		}
 	}
+	case ImageFormat::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case ImageFormat::BC2: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case ImageFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case ImageFormat::BC4: return type == ImageDataType::Byte ? GL_COMPRESSED_SIGNED_RED_RGTC1 : GL_COMPRESSED_RED_RGTC1;
+	case ImageFormat::BC5: return type == ImageDataType::Byte ? GL_COMPRESSED_SIGNED_RG_RGTC2 : GL_COMPRESSED_RG_RGTC2;
+	case ImageFormat::BC6H: return type == ImageDataType::Float ? GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT : GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+	case ImageFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	case ImageFormat::ETC2_RGB: return GL_COMPRESSED_RGB8_ETC2;
+	case ImageFormat::ETC2_RGBA: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+	case ImageFormat::ASTC_4x4: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+	case ImageFormat::ASTC_6x6: return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+	case ImageFormat::ASTC_8x8: return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
 	default: return 0;
 	}
 }
 
-constexpr GLenum getFormat(const ImageFormat& format)
+GLenum getDepthInternalFormat(const ImageType type)
+{
+	// Float depth keeps reverse-Z precision, matching the Vulkan backend
+	return hasStencilAspect(type) ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+}
+
+GLenum getFormat(const ImageFormat& format)
 {
 	switch (format)
 	{
@@ -141,12 +183,13 @@ constexpr GLenum getFormat(const ImageFormat& format)
 		case ImageFormat::RGBA: return GL_RGBA;
 		case ImageFormat::Luminance: return GL_RED;
 		case ImageFormat::LuminanceAlpha: return GL_RG;
+		default: return 0;
 	}
 	
 	return 0;
 }
 
-constexpr GLenum getType(const ImageDataType& type)
+GLenum getType(const ImageDataType& type)
 {
 	switch (type)
 	{
@@ -159,7 +202,7 @@ constexpr GLenum getType(const ImageDataType& type)
 		case ImageDataType::Float: return GL_FLOAT;
 		case ImageDataType::UShort4_4_4_4: return GL_UNSIGNED_SHORT_4_4_4_4;
 		case ImageDataType::UShort5_5_5_1: return GL_UNSIGNED_SHORT_5_5_5_1;
-		case ImageDataType::UInt8_8_8_8: return GL_UNSIGNED_INT_8_8_8_8;
+		case ImageDataType::UInt8_8_8_8: return GL_UNSIGNED_INT_8_8_8_8_REV;
 		case ImageDataType::UInt10_10_10_2: return GL_UNSIGNED_INT_10_10_10_2;
 	}
 
@@ -182,6 +225,7 @@ OpenGLImage2D::~OpenGLImage2D()
 {
 	if (mId)
 	{
+		mHandle->getStateTracker()->forgetTexture(mId);
 		glDeleteTextures(1, &mId);
 	}
 	mId = 0;
@@ -199,23 +243,131 @@ OpenGLImage2D& OpenGLImage2D::operator=(OpenGLImage2D&& image) noexcept
 	return *this;
 }
 
-void OpenGLImage2D::construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType)
+void OpenGLImage2D::construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType,
+	const uint32_t mipLevels, const uint32_t samples)
 {
-	glGenTextures(1, &mId);
-	const GLenum glFormat = getInternalFormat(format, type);
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mId == 0, "Image already constructed.\n");
+	QGFX_ASSERT_MSG(mipLevels <= getMipChainLength(width, height), "Invalid number of mip levels.\n");
+	QGFX_ASSERT_MSG(samples == 1 || mipLevels == 1, "Multisampled images have a single mip level.\n");
+	QGFX_ASSERT_MSG(samples <= mHandle->getMaxSampleCount(), "Unsupported sample count %u.\n", samples);
+
+	const uint32_t levels = mipLevels == fullMipChain ? getMipChainLength(width, height) : mipLevels;
+
+	const GLenum glFormat = hasDepthAspect(imageType) ? getDepthInternalFormat(imageType) : getInternalFormat(format, type);
 	QGFX_ASSERT_MSG(glFormat != 0, "Could not determine internal OpenGL format from format and type provided.\n");
-	glTexStorage2D(mId, 1, glFormat, width, height);
+	if (samples > 1)
+	{
+		glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &mId);
+		glTextureStorage2DMultisample(mId, static_cast<GLsizei>(samples), glFormat, width, height, GL_TRUE);
+	}
+	else
+	{
+		glCreateTextures(GL_TEXTURE_2D, 1, &mId);
+		glTextureStorage2D(mId, static_cast<GLsizei>(levels), glFormat, width, height);
+	}
 	mWidth = width;
 	mHeight = height;
 	mBpp = bpp;
 	mFormat = format;
 	mDataType = type;
+	mImageFormat = format;
+	mImageDataType = type;
 	mImageType = imageType;
+	mMipLevels = levels;
+	mResidentMip = 0;
+	mSamples = samples;
 }
 
 void OpenGLImage2D::setData(const uint8_t* data, const uint32_t dataSize)
 {
-	glTextureSubImage2D(mId, 0, 0, 0, mWidth, mHeight, getFormat(mFormat), getType(mDataType), data);
+	QGFX_PROFILE_FUNCTION();
+
+	setMipData(0, data, dataSize);
+
+	// Block compressed mips can not be derived from the base level, they come with the texture
+	if (mMipLevels > 1 && !isCompressedImageFormat(mImageFormat))
+	{
+		if (canGenerateMips())
+		{
+			generateMips();
+		}
+		else
+		{
+			_generateMipsOnCpu(data, mWidth, mHeight);
+		}
+	}
+}
+
+void OpenGLImage2D::generateMips()
+{
+	QGFX_ASSERT_MSG(canGenerateMips(), "Format does not support mipmap generation, generate the mips on the CPU.\n");
+	glGenerateTextureMipmap(mId);
+}
+
+bool OpenGLImage2D::canGenerateMips() const
+{
+	if (isCompressedImageFormat(mFormat) || hasDepthAspect(mImageType) || mSamples > 1)
+	{
+		return false;
+	}
+
+	// Integer formats can not be filtered, the driver reports whether glGenerateMipmap can build the chain
+	GLint support = GL_NONE;
+	glGetInternalformativ(GL_TEXTURE_2D, getInternalFormat(mFormat, mDataType), GL_MANUAL_GENERATE_MIPMAP, 1, &support);
+	return support == GL_FULL_SUPPORT || support == GL_CAVEAT_SUPPORT;
+}
+
+void OpenGLImage2D::setMipData(const uint32_t level, const uint8_t* data, const uint32_t dataSize)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(level < mMipLevels, "Mip level is outside of the mip chain.\n");
+	QGFX_ASSERT_MSG(mSamples == 1, "Multisampled images can only be rendered to.\n");
+
+	const uint32_t width = mWidth >> level ? mWidth >> level : 1;
+	const uint32_t height = mHeight >> level ? mHeight >> level : 1;
+	const size_t size = getImageMipSize(mWidth, mHeight, level, mFormat, mDataType);
+
+	// Uploading from a short buffer would read past its end
+	if (dataSize < size)
+	{
+		QGFX_ASSERT_MSG(false, "Not enough data for the mip level.\n");
+		return;
+	}
+
+	if (isCompressedImageFormat(mFormat))
+	{
+		glCompressedTextureSubImage2D(mId, static_cast<GLint>(level), 0, 0, width, height, getInternalFormat(mFormat, mDataType),
+			static_cast<GLsizei>(size), data);
+	}
+	else
+	{
+		// Rows are tightly packed, an RGB8 or R8 row is rarely a multiple of GL's default four bytes
+		mHandle->getStateTracker()->setPixelStore(GL_UNPACK_ALIGNMENT, 1);
+		glTextureSubImage2D(mId, static_cast<GLint>(level), 0, 0, width, height, getFormat(mFormat), getType(mDataType), data);
+	}
+	mHandle->countUpload(size);
+}
+
+void OpenGLImage2D::setResidentMip(const uint32_t level)
+{
+	IImage2D::setResidentMip(level);
+	glTextureParameteri(mId, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level));
+}
+
+bool OpenGLImage2D::isFormatSupported(const ImageFormat format, const ImageDataType type)
+{
+	const GLenum internalFormat = getInternalFormat(format, type);
+	if (internalFormat == 0)
+	{
+		return false;
+	}
+
+	GLint support = GL_FALSE;
+	glGetInternalformativ(GL_TEXTURE_2D, internalFormat, GL_INTERNALFORMAT_SUPPORTED, 1, &support);
+	return support == GL_TRUE;
 }
 
 void* OpenGLImage2D::getImageHandle() const
@@ -223,6 +375,11 @@ void* OpenGLImage2D::getImageHandle() const
 	return reinterpret_cast<void*>(mId);
 }
 
+void OpenGLImage2D::bind(const uint32_t unit)
+{
+	mHandle->getStateTracker()->bindTexture(unit, mId);
+}
+
 #endif
 
 
@@ -1,9 +1,12 @@
 #if defined (QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_imageview.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_image2d.h"
+#include "qgfx/render_pass_cache.h"
 
 OpenGLImageView::OpenGLImageView(ContextHandle* handle)
-	: IImageView(handle)
+	: IImageView(handle), mImage(nullptr)
 {	}
 
 OpenGLImageView::OpenGLImageView(OpenGLImageView&& image) noexcept
@@ -13,6 +16,15 @@ OpenGLImageView::OpenGLImageView(OpenGLImageView&& image) noexcept
 	image.mImage = nullptr;
 }
 
+OpenGLImageView::~OpenGLImageView()
+{
+	// Views share the texture name, framebuffers using it go when the view does
+	if (mImage != nullptr)
+	{
+		mHandle->getRenderPassCache()->evict(mImage->getImageHandle());
+	}
+}
+
 OpenGLImageView & OpenGLImageView::operator=(OpenGLImageView && image) noexcept
 {
 	mHandle = image.mHandle;
@@ -23,7 +35,14 @@ OpenGLImageView & OpenGLImageView::operator=(OpenGLImageView && image) noexcept
 
 void OpenGLImageView::construct(Image2D* image)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	mImage = image;
 }
 
-#endif
\ No newline at end of file
+FrameBufferAttachment OpenGLImageView::getAttachment() const
+{
+	return { mImage->getImageHandle(), mImage->getImageHandle() };
+}
+
+#endif
@@ -0,0 +1,56 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_indexbuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/qassert.h"
+
+OpenGLIndexBuffer::OpenGLIndexBuffer(ContextHandle* handle)
+	: IIndexBuffer(handle), mId(0)
+{
+}
+
+OpenGLIndexBuffer::~OpenGLIndexBuffer()
+{
+	if (mId)
+	{
+		mHandle->getStateTracker()->forgetBuffer(mId);
+		glDeleteBuffers(1, &mId);
+		mId = 0;
+	}
+}
+
+bool OpenGLIndexBuffer::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mId == 0, "Index Buffer already constructed.\n");
+	QGFX_ASSERT_MSG(mData != nullptr, "Index Buffer has no data.\n");
+	glCreateBuffers(1, &mId);
+	if (mId == 0)
+	{
+		return false;
+	}
+	glNamedBufferStorage(mId, static_cast<GLsizeiptr>(getSize()), mData, 0);
+	mHandle->countUpload(getSize());
+
+	_releaseData();
+	return true;
+}
+
+void OpenGLIndexBuffer::bind()
+{
+	mHandle->getStateTracker()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mId);
+}
+
+void OpenGLIndexBuffer::unbind()
+{
+	mHandle->getStateTracker()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+GLenum OpenGLIndexBuffer::getOpenGLIndexType() const
+{
+	return mIndexType == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+#endif // QGFX_OPENGL
@@ -0,0 +1,140 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_indirect_batcher.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_indexbuffer.h"
+#include "qgfx/opengl/opengl_pipeline.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_stream_buffer.h"
+#include "qgfx/opengl/opengl_vertexbuffer.h"
+#include "qgfx/qassert.h"
+
+#include <cstring>
+
+OpenGLIndirectBatcher::OpenGLIndirectBatcher(ContextHandle* handle, const size_t drawDataStride, const GLuint drawDataBinding)
+	: mHandle(handle), mDrawDataStride(drawDataStride), mDrawDataBinding(drawDataBinding), mStatistics({})
+{
+}
+
+void OpenGLIndirectBatcher::add(OpenGLPipeline* pipeline, OpenGLVertexBuffer* buffer, const uint32_t vertexCount, const uint32_t firstVertex,
+	const void* drawData, const uint32_t instanceCount)
+{
+	const DrawArraysIndirectCommand command = { vertexCount, instanceCount, firstVertex, 0 };
+	_add(pipeline, buffer, nullptr, &command, sizeof(command), drawData);
+}
+
+void OpenGLIndirectBatcher::addIndexed(OpenGLPipeline* pipeline, OpenGLVertexBuffer* vertices, OpenGLIndexBuffer* indices, const uint32_t indexCount,
+	const uint32_t firstIndex, const int32_t baseVertex, const void* drawData, const uint32_t instanceCount)
+{
+	QGFX_ASSERT_MSG(indices != nullptr, "Indexed indirect draw needs an index buffer.\n");
+
+	const DrawElementsIndirectCommand command = { indexCount, instanceCount, firstIndex, baseVertex, 0 };
+	_add(pipeline, vertices, indices, &command, sizeof(command), drawData);
+}
+
+void OpenGLIndirectBatcher::flush()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	OpenGLStateTracker* state = mHandle->getStateTracker();
+	OpenGLStreamBuffer* indirect = mHandle->getIndirectStream();
+	OpenGLStreamBuffer* storage = mHandle->getStorageStream();
+
+	state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect->getBuffer());
+
+	for (const auto& batch : mBatches)
+	{
+		batch.pipeline->bind();
+		batch.buffer->bind();
+		if (batch.indices)
+		{
+			batch.indices->bind();
+		}
+
+		if (batch.dataSize)
+		{
+			storage->bindRange(mDrawDataBinding, { nullptr, batch.dataOffset, batch.dataSize });
+		}
+
+		if (batch.indices)
+		{
+			glMultiDrawElementsIndirect(batch.pipeline->getTopology(), batch.indices->getOpenGLIndexType(),
+				reinterpret_cast<const void*>(batch.commandOffset), static_cast<GLsizei>(batch.count), 0);
+		}
+		else
+		{
+			glMultiDrawArraysIndirect(batch.pipeline->getTopology(), reinterpret_cast<const void*>(batch.commandOffset),
+				static_cast<GLsizei>(batch.count), 0);
+		}
+
+		mStatistics.draws += batch.count;
+		mStatistics.batches++;
+		mHandle->countDrawCall();
+	}
+
+	mBatches.clear();
+}
+
+void OpenGLIndirectBatcher::_add(OpenGLPipeline* pipeline, OpenGLVertexBuffer* buffer, OpenGLIndexBuffer* indices, const void* command,
+	const size_t commandSize, const void* drawData)
+{
+	QGFX_ASSERT_MSG(pipeline != nullptr && buffer != nullptr, "Indirect draw needs a pipeline and a vertex buffer.\n");
+
+	bool compatible = !mBatches.empty() && mBatches.back().pipeline == pipeline && mBatches.back().buffer == buffer &&
+		mBatches.back().indices == indices;
+
+	// Commands are tightly packed, so a batch's commands stay contiguous in the stream.
+	const StreamAllocation commandAllocation = mHandle->getIndirectStream()->allocate(commandSize, sizeof(GLuint));
+	if (commandAllocation.data == nullptr)
+	{
+		mStatistics.droppedDraws++;
+		return;
+	}
+	memcpy(commandAllocation.data, command, commandSize);
+
+	// A stream that moved on to its next region starts a new batch
+	compatible = compatible && commandAllocation.offset == mBatches.back().commandOffset +
+		static_cast<GLintptr>(mBatches.back().count * commandSize);
+
+	// Only the first draw of a batch needs the storage buffer offset alignment, the rest
+	// follow at the stride so gl_DrawID indexes them directly.
+	StreamAllocation data = { nullptr, 0, 0 };
+	if (mDrawDataStride)
+	{
+		QGFX_ASSERT_MSG(drawData != nullptr, "Indirect draw is missing its per-draw data.\n");
+		OpenGLStreamBuffer* stream = mHandle->getStorageStream();
+		data = stream->allocate(mDrawDataStride, compatible ? 1 : 0);
+
+		// A wrap to the next region or another user of the stream breaks the batch.  The new
+		// batch binds its data as a range of its own, which has to start aligned.  Regions
+		// start aligned, so only an allocation in the middle of one is made again.
+		if (compatible && data.data != nullptr && data.offset != mBatches.back().dataOffset + static_cast<GLintptr>(mBatches.back().dataSize))
+		{
+			compatible = false;
+			if (data.offset % static_cast<GLintptr>(stream->getAlignment()) != 0)
+			{
+				data = stream->allocate(mDrawDataStride, 0);
+			}
+		}
+
+		if (data.data == nullptr)
+		{
+			mStatistics.droppedDraws++;
+			return;
+		}
+		memcpy(data.data, drawData, mDrawDataStride);
+	}
+
+	if (compatible)
+	{
+		Batch& batch = mBatches.back();
+		batch.count++;
+		batch.dataSize += mDrawDataStride;
+	}
+	else
+	{
+		mBatches.push_back({ pipeline, buffer, indices, commandAllocation.offset, data.offset, mDrawDataStride, 1 });
+	}
+}
+
+#endif // QGFX_OPENGL
@@ -1,17 +1,35 @@
 #if defined(QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_pipeline.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
+#include "qgfx/qassert.h"
 
 #include <glad/glad.h>
 
+GLenum qgfxTopologyToOpenGL(const Topology& topology)
+{
+	switch (topology)
+	{
+		case Topology::TriangleList: return GL_TRIANGLES;
+		case Topology::TriangleStrip: return GL_TRIANGLE_STRIP;
+		case Topology::Line: return GL_LINES;
+		case Topology::Points: return GL_POINTS;
+		default: return static_cast<GLenum>(-1);
+	}
+}
+
 OpenGLPipeline::OpenGLPipeline(ContextHandle* handle)
-	: IPipeline(handle)
+	: IPipeline(handle), mTopology(GL_TRIANGLES), mPrimitiveRestart(false), mVertexArray(nullptr)
 {
 }
 
 OpenGLPipeline::OpenGLPipeline(OpenGLPipeline&& pipeline) noexcept
-	: IPipeline(pipeline.mHandle), mShaders(qtl::move(pipeline.mShaders))
+	: IPipeline(pipeline.mHandle), mShaders(qtl::move(pipeline.mShaders)), mTopology(pipeline.mTopology), mPrimitiveRestart(pipeline.mPrimitiveRestart),
+	  mVertexArray(pipeline.mVertexArray)
 {
+	mVertexLayouts = pipeline.mVertexLayouts;
 	pipeline.mShaders.clear();
 }
 
@@ -28,6 +46,10 @@ OpenGLPipeline& OpenGLPipeline::operator=(OpenGLPipeline&& pipeline) noexcept
 {
 	mHandle = pipeline.mHandle;
 	mShaders = qtl::move(pipeline.mShaders);
+	mTopology = pipeline.mTopology;
+	mPrimitiveRestart = pipeline.mPrimitiveRestart;
+	mVertexArray = pipeline.mVertexArray;
+	mVertexLayouts = pipeline.mVertexLayouts;
 	pipeline.mShaders.clear();
 	return *this;
 }
@@ -41,11 +63,40 @@ Shader* OpenGLPipeline::addShader()
 
 void OpenGLPipeline::construct()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(!mPrimitiveRestart || mTopology == GL_TRIANGLE_STRIP, "Primitive restart requires a strip topology.\n");
+
+	if (!mVertexLayouts.empty())
+	{
+		mVertexArray = mHandle->getVertexArrayCache()->acquire(mVertexLayouts);
+	}
 }
 
 void OpenGLPipeline::setTopology(const Topology& topology)
 {
-	// no op
+	mTopology = qgfxTopologyToOpenGL(topology);
+}
+
+void OpenGLPipeline::setPrimitiveRestart(const bool enabled)
+{
+	mPrimitiveRestart = enabled;
+}
+
+void OpenGLPipeline::bind()
+{
+	// The fixed restart index matches primitiveRestartIndex for both index sizes.
+	mHandle->getStateTracker()->setEnabled(GL_PRIMITIVE_RESTART_FIXED_INDEX, mPrimitiveRestart);
+
+	for (auto shader : mShaders)
+	{
+		shader->bind();
+	}
+}
+
+GLenum OpenGLPipeline::getTopology() const
+{
+	return mTopology;
 }
 
 #endif
\ No newline at end of file
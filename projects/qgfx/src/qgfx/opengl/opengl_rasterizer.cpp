@@ -1,10 +1,60 @@
 #if defined(QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_rasterizer.h"
+#include "qgfx/opengl/opengl_context_handle.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+
+static GLenum qgfxCullModeToOpenGL(const CullMode mode)
+{
+	switch (mode)
+	{
+		case CullMode::Front: return GL_FRONT;
+		case CullMode::Back: return GL_BACK;
+		case CullMode::FrontAndBack: return GL_FRONT_AND_BACK;
+	}
+
+	return GL_BACK;
+}
+
+static GLenum qgfxCompareOpToOpenGL(const CompareOp op)
+{
+	switch (op)
+	{
+		case CompareOp::Never: return GL_NEVER;
+		case CompareOp::Less: return GL_LESS;
+		case CompareOp::Equal: return GL_EQUAL;
+		case CompareOp::LessOrEqual: return GL_LEQUAL;
+		case CompareOp::Greater: return GL_GREATER;
+		case CompareOp::NotEqual: return GL_NOTEQUAL;
+		case CompareOp::GreaterOrEqual: return GL_GEQUAL;
+		case CompareOp::Always: return GL_ALWAYS;
+	}
+
+	return GL_LESS;
+}
+
+static GLenum qgfxStencilOpToOpenGL(const StencilOp op)
+{
+	switch (op)
+	{
+		case StencilOp::Keep: return GL_KEEP;
+		case StencilOp::Zero: return GL_ZERO;
+		case StencilOp::Replace: return GL_REPLACE;
+		case StencilOp::IncrementClamp: return GL_INCR;
+		case StencilOp::DecrementClamp: return GL_DECR;
+		case StencilOp::Invert: return GL_INVERT;
+		case StencilOp::IncrementWrap: return GL_INCR_WRAP;
+		case StencilOp::DecrementWrap: return GL_DECR_WRAP;
+	}
+
+	return GL_KEEP;
+}
 
 OpenGLRasterizer::OpenGLRasterizer(ContextHandle* handle)
 	: IRasterizer(handle)
 {
+	// OpenGL starts with depth testing off, bring it in line with the defaults
+	apply();
 }
 
 OpenGLRasterizer::~OpenGLRasterizer()
@@ -13,81 +63,17 @@ OpenGLRasterizer::~OpenGLRasterizer()
 
 void OpenGLRasterizer::setCullMode(const CullMode mode)
 {
-	if (mode == mCulling)
-	{
-		return;
-	}
-	mCulling = mode;
-	switch (mode)
-	{
-		case CullMode::Front:
-		{
-			glCullFace(GL_FRONT);
-			break;
-		}
-		case CullMode::Back:
-		{
-			glCullFace(GL_BACK);
-			break;
-		}
-		case CullMode::FrontAndBack:
-		{	
-			glCullFace(GL_FRONT_AND_BACK); 
-			break; 
-		}
-	}
+	mHandle->getStateTracker()->setCullFace(qgfxCullModeToOpenGL(mode));
 }
 
 void OpenGLRasterizer::setFrontFace(const FrontFace face)
 {
-	if (face == mFace)
-	{
-		return;
-	}
-	mFace = face;
-	switch (face)
-	{
-		case FrontFace::Clockwise:
-		{
-			glFrontFace(GL_CW);
-			break;
-		}
-		case FrontFace::CounterClockwise:
-		{
-			glFrontFace(GL_CCW);
-			break;
-		}
-	}
+	mHandle->getStateTracker()->setFrontFace(face == FrontFace::Clockwise ? GL_CW : GL_CCW);
 }
 
 void OpenGLRasterizer::setPolygonMode(const PolygonMode mode, const CullMode face)
 {
 	GLenum pmode = GL_FILL;
-	GLenum pface = GL_FRONT_AND_BACK;
-
-	if (mode == mFillMode && face == mFillFace)
-	{
-		return;
-	}
-
-	switch (face)
-	{
-		case CullMode::Front:
-		{
-			pface = GL_FRONT;
-			break;
-		}
-		case CullMode::Back:
-		{
-			pface = GL_BACK;
-			break;
-		}
-		case CullMode::FrontAndBack:
-		{
-			pface = GL_FRONT_AND_BACK;
-			break;
-		}
-	}
 
 	switch (mode)
 	{
@@ -107,33 +93,79 @@ void OpenGLRasterizer::setPolygonMode(const PolygonMode mode, const CullMode fac
 			break;
 		}
 	}
-	
-	mFillFace = face;
-	mFillMode = mode;
-	glPolygonMode(pface, pmode);
+
+	mHandle->getStateTracker()->setPolygonMode(qgfxCullModeToOpenGL(face), pmode);
 }
 
 void OpenGLRasterizer::setLineWidth(const float lineWidth)
 {
-	mLineWidth = lineWidth;
-	glLineWidth(lineWidth);
+	mHandle->getStateTracker()->setLineWidth(lineWidth);
 }
 
 void OpenGLRasterizer::setDepthTest(const bool enabled)
 {
-	if (mDepthEnabled == enabled)
-	{
-		return;
-	}
-	mDepthEnabled = enabled;
-	if (enabled)
-	{
-		glEnable(GL_DEPTH_TEST);
-	}
-	else
-	{
-		glDisable(GL_DEPTH_TEST);
-	}
+	mDepthTest = enabled;
+	mHandle->getStateTracker()->setEnabled(GL_DEPTH_TEST, enabled);
+}
+
+void OpenGLRasterizer::setDepthWrite(const bool enabled)
+{
+	mDepthWrite = enabled;
+	mHandle->getStateTracker()->setDepthMask(enabled);
+}
+
+void OpenGLRasterizer::setDepthCompare(const CompareOp op)
+{
+	mDepthCompare = op;
+	mHandle->getStateTracker()->setDepthFunc(qgfxCompareOpToOpenGL(_getDeviceDepthCompare()));
+}
+
+void OpenGLRasterizer::setStencilTest(const bool enabled, const StencilState& front, const StencilState& back)
+{
+	mStencilTest = enabled;
+	mStencilFront = front;
+	mStencilBack = back;
+
+	mHandle->getStateTracker()->setEnabled(GL_STENCIL_TEST, enabled);
+	_applyStencil(GL_FRONT, front);
+	_applyStencil(GL_BACK, back);
+}
+
+void OpenGLRasterizer::setColorWrite(const bool enabled)
+{
+	mColorWrite = enabled;
+	mHandle->getStateTracker()->setColorMask(enabled);
+}
+
+void OpenGLRasterizer::setReverseZ(const bool enabled)
+{
+	mReverseZ = enabled;
+
+	// Without a [0, 1] clip range the depth values near 0 lose the float precision reverse-Z is after
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->setClipControl(enabled ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+	tracker->setDepthFunc(qgfxCompareOpToOpenGL(_getDeviceDepthCompare()));
+}
+
+void OpenGLRasterizer::apply()
+{
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->setEnabled(GL_DEPTH_TEST, mDepthTest);
+	tracker->setDepthMask(mDepthWrite);
+	tracker->setClipControl(mReverseZ ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+	tracker->setDepthFunc(qgfxCompareOpToOpenGL(_getDeviceDepthCompare()));
+	tracker->setColorMask(mColorWrite);
+	tracker->setEnabled(GL_STENCIL_TEST, mStencilTest);
+	_applyStencil(GL_FRONT, mStencilFront);
+	_applyStencil(GL_BACK, mStencilBack);
+}
+
+void OpenGLRasterizer::_applyStencil(const GLenum face, const StencilState& state)
+{
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->setStencilFunc(face, qgfxCompareOpToOpenGL(state.compareOp), static_cast<GLint>(state.reference), state.compareMask);
+	tracker->setStencilOp(face, qgfxStencilOpToOpenGL(state.failOp), qgfxStencilOpToOpenGL(state.depthFailOp), qgfxStencilOpToOpenGL(state.passOp));
+	tracker->setStencilMask(face, state.writeMask);
 }
 
 #endif
@@ -0,0 +1,149 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_readback_queue.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_image2d.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/qassert.h"
+
+// Client storage asks for system memory the CPU reads from at full speed
+static constexpr GLbitfield readbackBufferFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_CLIENT_STORAGE_BIT;
+static constexpr GLbitfield readbackMapFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+static constexpr GLuint64 readbackWaitTimeout = 1000000000;
+
+OpenGLReadbackQueue::OpenGLReadbackQueue(ContextHandle* handle, const uint32_t slotCount)
+	: IReadbackQueue(handle, slotCount)
+{
+}
+
+OpenGLReadbackQueue::~OpenGLReadbackQueue()
+{
+	for (auto& buffer : mBuffers)
+	{
+		if (buffer.fence)
+		{
+			glDeleteSync(buffer.fence);
+		}
+		if (buffer.id)
+		{
+			mHandle->getStateTracker()->forgetBuffer(buffer.id);
+			glUnmapNamedBuffer(buffer.id);
+			glDeleteBuffers(1, &buffer.id);
+		}
+	}
+	mBuffers.clear();
+}
+
+void OpenGLReadbackQueue::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mBuffers.empty(), "Readback queue already constructed.\n");
+
+	mBuffers.resize(mSlots.size());
+	for (auto& buffer : mBuffers)
+	{
+		buffer = { 0, 0, nullptr, nullptr };
+	}
+}
+
+void OpenGLReadbackQueue::_reserve(const uint32_t slot, const size_t size)
+{
+	Buffer& buffer = mBuffers[slot];
+	if (buffer.capacity >= size)
+	{
+		return;
+	}
+
+	if (buffer.id)
+	{
+		mHandle->getStateTracker()->forgetBuffer(buffer.id);
+		glUnmapNamedBuffer(buffer.id);
+		glDeleteBuffers(1, &buffer.id);
+	}
+
+	glCreateBuffers(1, &buffer.id);
+	glNamedBufferStorage(buffer.id, static_cast<GLsizeiptr>(size), nullptr, readbackBufferFlags);
+	buffer.mapped = reinterpret_cast<const uint8_t*>(glMapNamedBufferRange(buffer.id, 0, static_cast<GLsizeiptr>(size), readbackMapFlags));
+	buffer.capacity = size;
+	QGFX_ASSERT_MSG(buffer.mapped != nullptr, "Failed to persistently map readback buffer.\n");
+}
+
+bool OpenGLReadbackQueue::_copyBackBuffer(const uint32_t slot)
+{
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->bindFramebuffer(0);
+	tracker->bindBuffer(GL_PIXEL_PACK_BUFFER, mBuffers[slot].id);
+
+	// Rows of images are read back tightly packed
+	tracker->setPixelStore(GL_PACK_ALIGNMENT, 1);
+
+	glReadPixels(0, 0, static_cast<GLsizei>(mSlots[slot].width), static_cast<GLsizei>(mSlots[slot].height), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	tracker->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	_fence(slot);
+
+	// The default framebuffer's origin is its bottom left corner
+	return true;
+}
+
+void OpenGLReadbackQueue::_copyImage(const uint32_t slot, Image2D* image)
+{
+	OpenGLStateTracker* tracker = mHandle->getStateTracker();
+	tracker->bindBuffer(GL_PIXEL_PACK_BUFFER, mBuffers[slot].id);
+	tracker->setPixelStore(GL_PACK_ALIGNMENT, 1);
+
+	const GLuint texture = static_cast<GLuint>(reinterpret_cast<uintptr_t>(image->getImageHandle()));
+	glGetTextureImage(texture, 0, getFormat(image->getImageFormat()), getType(image->getImageDataType()),
+		static_cast<GLsizei>(mSlots[slot].size), nullptr);
+
+	tracker->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	_fence(slot);
+}
+
+bool OpenGLReadbackQueue::_isComplete(const uint32_t slot)
+{
+	GLsync fence = mBuffers[slot].fence;
+	if (!fence)
+	{
+		return true;
+	}
+
+	// Flushing makes sure the fence gets to the GPU when the caller polls instead of waiting
+	return glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+}
+
+void OpenGLReadbackQueue::_wait(const uint32_t slot)
+{
+	GLsync fence = mBuffers[slot].fence;
+	if (!fence)
+	{
+		return;
+	}
+
+	GLenum result;
+	do
+	{
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, readbackWaitTimeout);
+	} while (result == GL_TIMEOUT_EXPIRED);
+	QGFX_ASSERT_MSG(result != GL_WAIT_FAILED, "Waiting on readback fence failed.\n");
+}
+
+const uint8_t* OpenGLReadbackQueue::_getData(const uint32_t slot)
+{
+	return mBuffers[slot].mapped;
+}
+
+void OpenGLReadbackQueue::_fence(const uint32_t slot)
+{
+	Buffer& buffer = mBuffers[slot];
+	if (buffer.fence)
+	{
+		glDeleteSync(buffer.fence);
+	}
+
+	// Coherent mappings only need the fence, the copy is visible once it has signalled
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+#endif // QGFX_OPENGL
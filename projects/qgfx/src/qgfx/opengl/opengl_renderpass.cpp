@@ -0,0 +1,30 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_renderpass.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+OpenGLRenderPass::OpenGLRenderPass(ContextHandle* handle)
+	: IRenderPass(handle)
+{
+}
+
+void OpenGLRenderPass::construct(const RenderPassDescription& description)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		// The default framebuffer can not be combined with textures
+		QGFX_ASSERT_MSG(!description.colorAttachments[i].swapChain || description.getAttachmentCount() == 1,
+			"Swap chain attachments can not be mixed with other attachments on OpenGL.\n");
+		QGFX_ASSERT_MSG(!description.colorAttachments[i].swapChain || description.samples == 1,
+			"Swap chain images are single sampled, resolve into them instead.\n");
+	}
+
+	QGFX_ASSERT_MSG(description.resolveAttachmentCount == 0 || description.samples > 1, "Resolve attachments need a multisampled render pass.\n");
+
+	mDescription = description;
+}
+
+#endif // QGFX_OPENGL
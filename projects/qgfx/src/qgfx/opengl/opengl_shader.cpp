@@ -1,6 +1,8 @@
 #if defined(QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_shader.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
 #include "qgfx/qassert.h"
 
 OpenGLShader::OpenGLShader(ContextHandle* handle)
@@ -20,6 +22,7 @@ OpenGLShader::~OpenGLShader()
 {
 	if (mId)
 	{
+		mHandle->getStateTracker()->forgetProgram(mId);
 		glDeleteProgram(mId);
 		mId = 0;
 	}
@@ -69,6 +72,8 @@ bool OpenGLShader::attachFragmentShader(const qtl::vector<char>& source)
 
 bool OpenGLShader::compile()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	for (const auto stage : mStages)
 	{
 		glAttachShader(mId, stage.second);
@@ -115,14 +120,14 @@ bool OpenGLShader::cleanup()
 
 bool OpenGLShader::bind()
 {
-	glUseProgram(mId);
+	mHandle->getStateTracker()->useProgram(mId);
 
 	return true;
 }
 
 bool OpenGLShader::unbind()
 {
-	glUseProgram(0);
+	mHandle->getStateTracker()->useProgram(0);
 
 	return true;
 }
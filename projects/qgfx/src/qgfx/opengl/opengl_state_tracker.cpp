@@ -0,0 +1,477 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
+#include "qgfx/qassert.h"
+
+OpenGLStateTracker::OpenGLStateTracker()
+{
+	mStatistics = {};
+	mLastFrameStatistics = {};
+	invalidate();
+}
+
+void OpenGLStateTracker::useProgram(const GLuint program)
+{
+	if (_filter(mProgram != program))
+	{
+		mProgram = program;
+		glUseProgram(program);
+	}
+}
+
+void OpenGLStateTracker::bindVertexArray(const GLuint vao)
+{
+	if (_filter(mVertexArray != vao))
+	{
+		mVertexArray = vao;
+		glBindVertexArray(vao);
+
+		// The element array binding is part of the vertex array object state.
+		mBuffers[ElementArrayBuffer] = static_cast<GLuint>(-1);
+	}
+}
+
+void OpenGLStateTracker::bindBuffer(const GLenum target, const GLuint buffer)
+{
+	const uint32_t slot = _getBufferTarget(target);
+	QGFX_ASSERT_MSG(slot != BufferTargetCount, "Buffer target is not tracked.\n");
+
+	if (_filter(mBuffers[slot] != buffer))
+	{
+		mBuffers[slot] = buffer;
+		glBindBuffer(target, buffer);
+	}
+}
+
+void OpenGLStateTracker::bindVertexBuffer(OpenGLVertexArray* vao, const GLuint binding, const GLuint buffer, const GLintptr offset, const GLsizei stride)
+{
+	QGFX_ASSERT_MSG(binding < OpenGLVertexArray::maxBindings, "Vertex buffer binding out of range.\n");
+
+	// Vertex buffer bindings live in the vertex array object, so the shadow copy does too.
+	if (_filter(vao->buffers[binding] != buffer || vao->offsets[binding] != offset || vao->strides[binding] != stride))
+	{
+		vao->buffers[binding] = buffer;
+		vao->offsets[binding] = offset;
+		vao->strides[binding] = stride;
+		glVertexArrayVertexBuffer(vao->id, binding, buffer, offset, stride);
+	}
+}
+
+void OpenGLStateTracker::bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size)
+{
+	QGFX_ASSERT_MSG(index < maxBufferBindings, "Indexed buffer binding out of range.\n");
+	QGFX_ASSERT_MSG(target == GL_UNIFORM_BUFFER || target == GL_SHADER_STORAGE_BUFFER, "Buffer target is not an indexed target.\n");
+
+	BufferRange& range = target == GL_UNIFORM_BUFFER ? mUniformRanges[index] : mStorageRanges[index];
+	if (_filter(range.buffer != buffer || range.offset != offset || range.size != size))
+	{
+		range = { buffer, offset, size };
+		glBindBufferRange(target, index, buffer, offset, size);
+
+		// Indexed binds also replace the generic binding point of the target.
+		mBuffers[_getBufferTarget(target)] = buffer;
+	}
+}
+
+void OpenGLStateTracker::bindTexture(const GLuint unit, const GLuint texture)
+{
+	QGFX_ASSERT_MSG(unit < maxTextureUnits, "Texture unit out of range.\n");
+
+	if (_filter(mTextures[unit] != texture))
+	{
+		mTextures[unit] = texture;
+		glBindTextureUnit(unit, texture);
+	}
+}
+
+void OpenGLStateTracker::bindFramebuffer(const GLuint framebuffer)
+{
+	if (_filter(mFramebuffer != framebuffer))
+	{
+		mFramebuffer = framebuffer;
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+}
+
+void OpenGLStateTracker::setViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+{
+	if (_filter(mViewport[0] != x || mViewport[1] != y || mViewport[2] != width || mViewport[3] != height))
+	{
+		mViewport[0] = x;
+		mViewport[1] = y;
+		mViewport[2] = width;
+		mViewport[3] = height;
+		glViewport(x, y, width, height);
+	}
+}
+
+void OpenGLStateTracker::setEnabled(const GLenum capability, const bool enabled)
+{
+	const uint32_t slot = _getCapability(capability);
+	QGFX_ASSERT_MSG(slot != CapabilityCount, "Capability is not tracked.\n");
+
+	const GLint value = enabled ? GL_TRUE : GL_FALSE;
+	if (_filter(mCapabilities[slot] != value))
+	{
+		mCapabilities[slot] = value;
+		if (enabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+}
+
+void OpenGLStateTracker::setCullFace(const GLenum face)
+{
+	if (_filter(mCullFace != face))
+	{
+		mCullFace = face;
+		glCullFace(face);
+	}
+}
+
+void OpenGLStateTracker::setFrontFace(const GLenum face)
+{
+	if (_filter(mFrontFace != face))
+	{
+		mFrontFace = face;
+		glFrontFace(face);
+	}
+}
+
+void OpenGLStateTracker::setPolygonMode(const GLenum face, const GLenum mode)
+{
+	if (_filter(mPolygonModeFace != face || mPolygonMode != mode))
+	{
+		mPolygonModeFace = face;
+		mPolygonMode = mode;
+		glPolygonMode(face, mode);
+	}
+}
+
+void OpenGLStateTracker::setLineWidth(const float width)
+{
+	if (_filter(mLineWidth != width))
+	{
+		mLineWidth = width;
+		glLineWidth(width);
+	}
+}
+
+void OpenGLStateTracker::setDepthMask(const bool enabled)
+{
+	const GLint value = enabled ? GL_TRUE : GL_FALSE;
+	if (_filter(mDepthMask != value))
+	{
+		mDepthMask = value;
+		glDepthMask(static_cast<GLboolean>(value));
+	}
+}
+
+void OpenGLStateTracker::setDepthFunc(const GLenum func)
+{
+	if (_filter(mDepthFunc != func))
+	{
+		mDepthFunc = func;
+		glDepthFunc(func);
+	}
+}
+
+void OpenGLStateTracker::setColorMask(const bool enabled)
+{
+	const GLint value = enabled ? GL_TRUE : GL_FALSE;
+	if (_filter(mColorMask != value))
+	{
+		mColorMask = value;
+		const GLboolean mask = static_cast<GLboolean>(value);
+		glColorMask(mask, mask, mask, mask);
+	}
+}
+
+void OpenGLStateTracker::setStencilFunc(const GLenum face, const GLenum func, const GLint reference, const GLuint mask)
+{
+	uint32_t first = 0;
+	uint32_t last = 0;
+	if (!_getStencilFaces(face, first, last))
+	{
+		QGFX_ASSERT_MSG(false, "Stencil face is not tracked.\n");
+		return;
+	}
+
+	bool changed = false;
+	for (uint32_t i = first; i <= last; i++)
+	{
+		changed |= mStencil[i].func != func || mStencil[i].reference != reference || mStencil[i].compareMask != mask;
+	}
+
+	if (_filter(changed))
+	{
+		for (uint32_t i = first; i <= last; i++)
+		{
+			mStencil[i].func = func;
+			mStencil[i].reference = reference;
+			mStencil[i].compareMask = mask;
+		}
+		glStencilFuncSeparate(face, func, reference, mask);
+	}
+}
+
+void OpenGLStateTracker::setStencilOp(const GLenum face, const GLenum fail, const GLenum depthFail, const GLenum pass)
+{
+	uint32_t first = 0;
+	uint32_t last = 0;
+	if (!_getStencilFaces(face, first, last))
+	{
+		QGFX_ASSERT_MSG(false, "Stencil face is not tracked.\n");
+		return;
+	}
+
+	bool changed = false;
+	for (uint32_t i = first; i <= last; i++)
+	{
+		changed |= mStencil[i].fail != fail || mStencil[i].depthFail != depthFail || mStencil[i].pass != pass;
+	}
+
+	if (_filter(changed))
+	{
+		for (uint32_t i = first; i <= last; i++)
+		{
+			mStencil[i].fail = fail;
+			mStencil[i].depthFail = depthFail;
+			mStencil[i].pass = pass;
+		}
+		glStencilOpSeparate(face, fail, depthFail, pass);
+	}
+}
+
+void OpenGLStateTracker::setStencilMask(const GLenum face, const GLuint mask)
+{
+	uint32_t first = 0;
+	uint32_t last = 0;
+	if (!_getStencilFaces(face, first, last))
+	{
+		QGFX_ASSERT_MSG(false, "Stencil face is not tracked.\n");
+		return;
+	}
+
+	bool changed = false;
+	for (uint32_t i = first; i <= last; i++)
+	{
+		changed |= mStencil[i].writeMask != mask;
+	}
+
+	if (_filter(changed))
+	{
+		for (uint32_t i = first; i <= last; i++)
+		{
+			mStencil[i].writeMask = mask;
+		}
+		glStencilMaskSeparate(face, mask);
+	}
+}
+
+void OpenGLStateTracker::setClipControl(const GLenum depth)
+{
+	if (_filter(mClipDepth != depth))
+	{
+		mClipDepth = depth;
+		glClipControl(GL_LOWER_LEFT, depth);
+	}
+}
+
+void OpenGLStateTracker::setPixelStore(const GLenum name, const GLint alignment)
+{
+	QGFX_ASSERT_MSG(name == GL_PACK_ALIGNMENT || name == GL_UNPACK_ALIGNMENT, "Pixel store parameter is not tracked.\n");
+
+	GLint& current = name == GL_PACK_ALIGNMENT ? mPackAlignment : mUnpackAlignment;
+	if (_filter(current != alignment))
+	{
+		current = alignment;
+		glPixelStorei(name, alignment);
+	}
+}
+
+void OpenGLStateTracker::forgetTexture(const GLuint texture)
+{
+	for (uint32_t i = 0; i < maxTextureUnits; i++)
+	{
+		if (mTextures[i] == texture)
+		{
+			mTextures[i] = static_cast<GLuint>(-1);
+		}
+	}
+}
+
+void OpenGLStateTracker::forgetBuffer(const GLuint buffer)
+{
+	for (uint32_t i = 0; i < BufferTargetCount; i++)
+	{
+		if (mBuffers[i] == buffer)
+		{
+			mBuffers[i] = static_cast<GLuint>(-1);
+		}
+	}
+
+	for (uint32_t i = 0; i < maxBufferBindings; i++)
+	{
+		if (mUniformRanges[i].buffer == buffer)
+		{
+			mUniformRanges[i] = { static_cast<GLuint>(-1), 0, 0 };
+		}
+		if (mStorageRanges[i].buffer == buffer)
+		{
+			mStorageRanges[i] = { static_cast<GLuint>(-1), 0, 0 };
+		}
+	}
+}
+
+void OpenGLStateTracker::forgetFramebuffer(const GLuint framebuffer)
+{
+	if (mFramebuffer == framebuffer)
+	{
+		mFramebuffer = static_cast<GLuint>(-1);
+	}
+}
+
+void OpenGLStateTracker::forgetProgram(const GLuint program)
+{
+	if (mProgram == program)
+	{
+		mProgram = static_cast<GLuint>(-1);
+	}
+}
+
+void OpenGLStateTracker::forgetVertexArray(const GLuint vao)
+{
+	if (mVertexArray == vao)
+	{
+		// Deleting the bound vertex array binds 0, which has its own element array binding
+		mVertexArray = static_cast<GLuint>(-1);
+		mBuffers[ElementArrayBuffer] = static_cast<GLuint>(-1);
+	}
+}
+
+void OpenGLStateTracker::invalidate()
+{
+	// Names and values that no call can pass force the next call of every setter through to
+	// the driver.  Resetting to the GL defaults instead would skip a set to the default after
+	// outside code changed the state, leaking that state into qgfx draws.
+	mProgram = static_cast<GLuint>(-1);
+	mVertexArray = static_cast<GLuint>(-1);
+
+	for (uint32_t i = 0; i < BufferTargetCount; i++)
+	{
+		mBuffers[i] = static_cast<GLuint>(-1);
+	}
+
+	for (uint32_t i = 0; i < maxBufferBindings; i++)
+	{
+		mUniformRanges[i] = { static_cast<GLuint>(-1), 0, 0 };
+		mStorageRanges[i] = { static_cast<GLuint>(-1), 0, 0 };
+	}
+
+	for (uint32_t i = 0; i < maxTextureUnits; i++)
+	{
+		mTextures[i] = static_cast<GLuint>(-1);
+	}
+
+	mFramebuffer = static_cast<GLuint>(-1);
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		mViewport[i] = -1;
+	}
+
+	for (uint32_t i = 0; i < CapabilityCount; i++)
+	{
+		mCapabilities[i] = -1;
+	}
+
+	mCullFace = static_cast<GLenum>(-1);
+	mFrontFace = static_cast<GLenum>(-1);
+	mPolygonModeFace = static_cast<GLenum>(-1);
+	mPolygonMode = static_cast<GLenum>(-1);
+	mLineWidth = -1.0f;
+	mDepthMask = -1;
+	mDepthFunc = static_cast<GLenum>(-1);
+	mColorMask = -1;
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		mStencil[i] = { static_cast<GLenum>(-1), 0, -1, static_cast<GLenum>(-1), static_cast<GLenum>(-1), static_cast<GLenum>(-1), -1 };
+	}
+	mClipDepth = static_cast<GLenum>(-1);
+	mPackAlignment = -1;
+	mUnpackAlignment = -1;
+}
+
+void OpenGLStateTracker::beginFrame()
+{
+	mStatistics = {};
+}
+
+void OpenGLStateTracker::endFrame()
+{
+	mLastFrameStatistics = mStatistics;
+}
+
+bool OpenGLStateTracker::_filter(const bool changed)
+{
+	if (changed)
+	{
+		mStatistics.issued++;
+	}
+	else
+	{
+		mStatistics.skipped++;
+	}
+
+	return changed;
+}
+
+uint32_t OpenGLStateTracker::_getBufferTarget(const GLenum target)
+{
+	switch (target)
+	{
+		case GL_ARRAY_BUFFER: return ArrayBuffer;
+		case GL_ELEMENT_ARRAY_BUFFER: return ElementArrayBuffer;
+		case GL_UNIFORM_BUFFER: return UniformBuffer;
+		case GL_SHADER_STORAGE_BUFFER: return ShaderStorageBuffer;
+		case GL_DRAW_INDIRECT_BUFFER: return DrawIndirectBuffer;
+		case GL_PIXEL_PACK_BUFFER: return PixelPackBuffer;
+		case GL_PIXEL_UNPACK_BUFFER: return PixelUnpackBuffer;
+		case GL_COPY_READ_BUFFER: return CopyReadBuffer;
+		case GL_COPY_WRITE_BUFFER: return CopyWriteBuffer;
+		default: return BufferTargetCount;
+	}
+}
+
+uint32_t OpenGLStateTracker::_getCapability(const GLenum capability)
+{
+	switch (capability)
+	{
+		case GL_CULL_FACE: return CullFace;
+		case GL_DEPTH_TEST: return DepthTest;
+		case GL_STENCIL_TEST: return StencilTest;
+		case GL_BLEND: return Blend;
+		case GL_SCISSOR_TEST: return ScissorTest;
+		case GL_PRIMITIVE_RESTART_FIXED_INDEX: return PrimitiveRestart;
+		default: return CapabilityCount;
+	}
+}
+
+bool OpenGLStateTracker::_getStencilFaces(const GLenum face, uint32_t& first, uint32_t& last)
+{
+	switch (face)
+	{
+		case GL_FRONT: first = 0; last = 0; return true;
+		case GL_BACK: first = 1; last = 1; return true;
+		case GL_FRONT_AND_BACK: first = 0; last = 1; return true;
+		default: return false;
+	}
+}
+
+#endif // QGFX_OPENGL
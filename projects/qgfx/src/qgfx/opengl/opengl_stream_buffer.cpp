@@ -0,0 +1,171 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_stream_buffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
+#include "qgfx/qassert.h"
+
+static constexpr GLbitfield streamBufferFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+static constexpr GLuint64 streamBufferWaitTimeout = 1000000000;
+
+OpenGLStreamBuffer::OpenGLStreamBuffer(ContextHandle* handle, const GLenum target, const size_t regionSize, const uint32_t regionCount)
+	: mHandle(handle), mId(0), mTarget(target), mRegionSize(regionSize), mAlignment(16), mRegionCount(regionCount), mRegion(0),
+	  mFirstRegion(0), mFrameRegions(1), mHead(0), mMapped(nullptr), mFences(nullptr), mStatistics({})
+{
+	QGFX_ASSERT_MSG(regionCount > 0, "Stream buffer needs at least one region.\n");
+}
+
+OpenGLStreamBuffer::~OpenGLStreamBuffer()
+{
+	if (mFences)
+	{
+		for (uint32_t i = 0; i < mRegionCount; i++)
+		{
+			if (mFences[i])
+			{
+				glDeleteSync(mFences[i]);
+			}
+		}
+		delete[] mFences;
+		mFences = nullptr;
+	}
+	if (mId)
+	{
+		mHandle->getStateTracker()->forgetBuffer(mId);
+		mHandle->getVertexArrayCache()->forgetBuffer(mId);
+		glUnmapNamedBuffer(mId);
+		glDeleteBuffers(1, &mId);
+		mId = 0;
+	}
+	mMapped = nullptr;
+}
+
+bool OpenGLStreamBuffer::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mId == 0, "Stream buffer already constructed.\n");
+
+	if (mTarget == GL_UNIFORM_BUFFER || mTarget == GL_SHADER_STORAGE_BUFFER)
+	{
+		GLint alignment = 0;
+		glGetIntegerv(mTarget == GL_UNIFORM_BUFFER ? GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT : GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (static_cast<size_t>(alignment) > mAlignment)
+		{
+			mAlignment = static_cast<size_t>(alignment);
+		}
+	}
+
+	// Keep every region start aligned so allocations never need to straddle regions.
+	mRegionSize = (mRegionSize + mAlignment - 1) / mAlignment * mAlignment;
+	const GLsizeiptr totalSize = static_cast<GLsizeiptr>(mRegionSize * mRegionCount);
+
+	glCreateBuffers(1, &mId);
+	if (mId == 0)
+	{
+		return false;
+	}
+	glNamedBufferStorage(mId, totalSize, nullptr, streamBufferFlags);
+	mMapped = reinterpret_cast<uint8_t*>(glMapNamedBufferRange(mId, 0, totalSize, streamBufferFlags));
+	QGFX_ASSERT_MSG(mMapped != nullptr, "Failed to persistently map stream buffer.\n");
+
+	mFences = new GLsync[mRegionCount];
+	for (uint32_t i = 0; i < mRegionCount; i++)
+	{
+		mFences[i] = nullptr;
+	}
+
+	return mMapped != nullptr;
+}
+
+StreamAllocation OpenGLStreamBuffer::allocate(const size_t size, const size_t alignment)
+{
+	const size_t align = alignment ? alignment : mAlignment;
+	size_t head = (mHead + align - 1) / align * align;
+
+	if (head + size > mRegionSize)
+	{
+		// Regions of this frame are only fenced at its end, so it can not wrap onto itself
+		if (size > mRegionSize || mFrameRegions == mRegionCount)
+		{
+			mStatistics.failedAllocations++;
+			return { nullptr, 0, 0 };
+		}
+
+		mRegion = (mRegion + 1) % mRegionCount;
+		mFrameRegions++;
+		mStatistics.overflows++;
+		_wait(mRegion);
+		head = 0;
+	}
+
+	mHead = head + size;
+	mStatistics.bytesWritten += size;
+	mHandle->countUpload(size);
+	mStatistics.allocations++;
+
+	const size_t offset = mRegion * mRegionSize + head;
+	return { mMapped + offset, static_cast<GLintptr>(offset), size };
+}
+
+void OpenGLStreamBuffer::bindVertexBuffer(OpenGLVertexArray* vao, const GLuint binding, const StreamAllocation& allocation, const GLsizei stride)
+{
+	mHandle->getStateTracker()->bindVertexBuffer(vao, binding, mId, allocation.offset, stride);
+}
+
+void OpenGLStreamBuffer::bindRange(const GLuint index, const StreamAllocation& allocation)
+{
+	mHandle->getStateTracker()->bindBufferRange(mTarget, index, mId, allocation.offset, static_cast<GLsizeiptr>(allocation.size));
+}
+
+void OpenGLStreamBuffer::beginFrame()
+{
+	mRegion = (mRegion + 1) % mRegionCount;
+	mFirstRegion = mRegion;
+	mFrameRegions = 1;
+	mHead = 0;
+	mStatistics = {};
+	_wait(mRegion);
+}
+
+void OpenGLStreamBuffer::endFrame()
+{
+	for (uint32_t i = 0; i < mFrameRegions; i++)
+	{
+		const uint32_t region = (mFirstRegion + i) % mRegionCount;
+		if (mFences[region])
+		{
+			glDeleteSync(mFences[region]);
+		}
+		mFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+void OpenGLStreamBuffer::_wait(const uint32_t region)
+{
+	GLsync fence = mFences[region];
+	if (!fence)
+	{
+		return;
+	}
+
+	GLbitfield flags = 0;
+	GLenum result = glClientWaitSync(fence, flags, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		// The GPU is still reading this region, flush so the fence is guaranteed to signal.
+		mStatistics.fenceWaits++;
+		flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do
+		{
+			result = glClientWaitSync(fence, flags, streamBufferWaitTimeout);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	QGFX_ASSERT_MSG(result != GL_WAIT_FAILED, "Waiting on stream buffer fence failed.\n");
+
+	glDeleteSync(fence);
+	mFences[region] = nullptr;
+}
+
+#endif // QGFX_OPENGL
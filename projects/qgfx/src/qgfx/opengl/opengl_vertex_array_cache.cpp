@@ -0,0 +1,131 @@
+#if defined(QGFX_OPENGL)
+
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+
+static GLenum qgfxVertexAttribToOpenGL(const VertexAttribType type)
+{
+	switch (type)
+	{
+		case VertexAttribType::Float: return GL_FLOAT;
+		case VertexAttribType::Half: return GL_HALF_FLOAT;
+		case VertexAttribType::Int32: return GL_INT;
+		case VertexAttribType::UInt32: return GL_UNSIGNED_INT;
+		case VertexAttribType::Int16: return GL_SHORT;
+		case VertexAttribType::UInt16: return GL_UNSIGNED_SHORT;
+		case VertexAttribType::Int8: return GL_BYTE;
+		case VertexAttribType::UInt8: return GL_UNSIGNED_BYTE;
+		case VertexAttribType::Int2_10_10_10: return GL_INT_2_10_10_10_REV;
+		case VertexAttribType::UInt2_10_10_10: return GL_UNSIGNED_INT_2_10_10_10_REV;
+	}
+
+	return GL_FLOAT;
+}
+
+OpenGLVertexArrayCache::OpenGLVertexArrayCache(OpenGLStateTracker* tracker)
+	: mStateTracker(tracker)
+{
+}
+
+OpenGLVertexArrayCache::~OpenGLVertexArrayCache()
+{
+	for (auto entry : mVertexArrays)
+	{
+		mStateTracker->forgetVertexArray(entry.second->id);
+		glDeleteVertexArrays(1, &entry.second->id);
+		delete entry.second;
+	}
+}
+
+void OpenGLVertexArrayCache::forgetBuffer(const GLuint buffer)
+{
+	for (auto entry : mVertexArrays)
+	{
+		OpenGLVertexArray* vao = entry.second;
+		for (uint32_t i = 0; i < OpenGLVertexArray::maxBindings; i++)
+		{
+			if (vao->buffers[i] == buffer)
+			{
+				vao->buffers[i] = static_cast<GLuint>(-1);
+			}
+		}
+	}
+}
+
+OpenGLVertexArray* OpenGLVertexArrayCache::acquire(const VertexBufferLayout& layout)
+{
+	return _acquire(&layout, 1);
+}
+
+OpenGLVertexArray* OpenGLVertexArrayCache::acquire(const qtl::vector<VertexBufferLayout>& layouts)
+{
+	return _acquire(layouts.data(), layouts.size());
+}
+
+OpenGLVertexArray* OpenGLVertexArrayCache::_acquire(const VertexBufferLayout* layouts, const size_t count)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < count; i++)
+	{
+		hash = (hash ^ layouts[i].getHash()) * 1099511628211ULL;
+	}
+
+	auto it = mVertexArrays.find(hash);
+	if (it != mVertexArrays.end())
+	{
+		return (*it).second;
+	}
+
+	OpenGLVertexArray* vao = _create(layouts, count);
+	mVertexArrays.insert({ hash, vao });
+
+	return vao;
+}
+
+OpenGLVertexArray* OpenGLVertexArrayCache::_create(const VertexBufferLayout* layouts, const size_t count)
+{
+	OpenGLVertexArray* vao = new OpenGLVertexArray();
+	glCreateVertexArrays(1, &vao->id);
+	QGFX_ASSERT_MSG(vao->id != 0, "Failed to create OpenGL Vertex Array.\n");
+
+	for (uint32_t i = 0; i < OpenGLVertexArray::maxBindings; i++)
+	{
+		vao->buffers[i] = 0;
+		vao->offsets[i] = 0;
+		vao->strides[i] = 0;
+	}
+
+	// Attribute locations continue across streams in the order the layouts are given.
+	GLuint idx = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		const VertexBufferLayout& layout = layouts[i];
+		const GLuint binding = layout.getBinding();
+		QGFX_ASSERT_MSG(binding < OpenGLVertexArray::maxBindings, "Vertex buffer binding out of range.\n");
+
+		for (const auto& format : layout.getLayout())
+		{
+			glEnableVertexArrayAttrib(vao->id, idx);
+
+			// glVertexArrayAttribFormat would convert integers to float, Vulkan reads them as *_SINT/*_UINT
+			if (isIntegerVertexAttrib(format.type) && !format.normalized)
+			{
+				glVertexArrayAttribIFormat(vao->id, idx, static_cast<GLint>(format.count), qgfxVertexAttribToOpenGL(format.type),
+					static_cast<GLuint>(format.offset));
+			}
+			else
+			{
+				glVertexArrayAttribFormat(vao->id, idx, static_cast<GLint>(format.count), qgfxVertexAttribToOpenGL(format.type), format.normalized,
+					static_cast<GLuint>(format.offset));
+			}
+			glVertexArrayAttribBinding(vao->id, idx, binding);
+			++idx;
+		}
+
+		glVertexArrayBindingDivisor(vao->id, binding, layout.getDivisor());
+	}
+
+	return vao;
+}
+
+#endif // QGFX_OPENGL
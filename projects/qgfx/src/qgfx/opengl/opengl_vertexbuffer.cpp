@@ -1,6 +1,10 @@
 #if defined(QGFX_OPENGL)
 
 #include "qgfx/opengl/opengl_vertexbuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/opengl/opengl_context_handle.h"
+#include "qgfx/opengl/opengl_state_tracker.h"
+#include "qgfx/opengl/opengl_vertex_array_cache.h"
 #include "qgfx/qassert.h"
 
 #include <cstring>
@@ -11,21 +15,22 @@ OpenGLVertexBuffer::OpenGLVertexBuffer(ContextHandle* handle)
 }
 
 OpenGLVertexBuffer::OpenGLVertexBuffer(OpenGLVertexBuffer&& buf) noexcept
-	: IVertexBuffer(buf.mHandle), mId(buf.mId), mData(buf.mData)
+	: IVertexBuffer(buf.mHandle), mId(buf.mId), mVertexArray(buf.mVertexArray), mLayout(buf.mLayout), mData(buf.mData), mOwnsData(buf.mOwnsData), mSize(buf.mSize)
 {
 	buf.mId = 0;
+	buf.mVertexArray = nullptr;
 	buf.mData = nullptr;
+	buf.mOwnsData = false;
+	buf.mSize = 0;
 }
 
 OpenGLVertexBuffer::~OpenGLVertexBuffer()
 {
-	if (mData)
-	{
-		delete[] reinterpret_cast<char*>(mData);
-		mData = nullptr;
-	}
+	_releaseData();
 	if (mId)
 	{
+		mHandle->getStateTracker()->forgetBuffer(mId);
+		mHandle->getVertexArrayCache()->forgetBuffer(mId);
 		glDeleteBuffers(1, &mId);
 		mId = 0;
 	}
@@ -33,23 +38,55 @@ OpenGLVertexBuffer::~OpenGLVertexBuffer()
 
 OpenGLVertexBuffer& OpenGLVertexBuffer::operator=(OpenGLVertexBuffer&& buf) noexcept
 {
+	if (this == &buf)
+	{
+		return *this;
+	}
+
+	// The buffer and data this one held are replaced, not handed to the source
+	_releaseData();
+	if (mId)
+	{
+		mHandle->getStateTracker()->forgetBuffer(mId);
+		mHandle->getVertexArrayCache()->forgetBuffer(mId);
+		glDeleteBuffers(1, &mId);
+	}
+
+	mHandle = buf.mHandle;
 	mId = buf.mId;
+	mVertexArray = buf.mVertexArray;
+	mLayout = buf.mLayout;
 	mData = buf.mData;
+	mOwnsData = buf.mOwnsData;
+	mSize = buf.mSize;
 
 	buf.mId = 0;
+	buf.mVertexArray = nullptr;
 	buf.mData = nullptr;
+	buf.mOwnsData = false;
+	buf.mSize = 0;
 
 	return *this;
 }
 
 void OpenGLVertexBuffer::setData(void* data, const size_t size)
 {
-	if (mData)
-	{
-		delete[] reinterpret_cast<char*>(mData);
-	}
-	mData = new char[size];
-	memcpy(mData, data, size);
+	QGFX_PROFILE_FUNCTION();
+
+	_releaseData();
+	char* copy = new char[size];
+	memcpy(copy, data, size);
+	mData = copy;
+	mOwnsData = true;
+	mSize = size;
+}
+
+void OpenGLVertexBuffer::setExternalData(const void* data, const size_t size)
+{
+	_releaseData();
+	mData = data;
+	mOwnsData = false;
+	mSize = size;
 }
 
 void OpenGLVertexBuffer::setLayout(const VertexBufferLayout& layout)
@@ -59,30 +96,22 @@ void OpenGLVertexBuffer::setLayout(const VertexBufferLayout& layout)
 
 bool OpenGLVertexBuffer::construct()
 {
-	QGFX_ASSERT_MSG(mId != 0, "Vertex Buffer already constructed.\n");
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mId == 0, "Vertex Buffer already constructed.\n");
 	QGFX_ASSERT_MSG(mData != nullptr, "Vertex Buffer has no data.\n");
 	glCreateBuffers(1, &mId);
 	if (mId == 0)
 	{
 		return false;
 	}
-	glBindBuffer(GL_VERTEX_ARRAY, mId);
-	glBufferStorage(GL_VERTEX_ARRAY, mSize, mData, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-	GLuint idx = 0;
-	for (const auto& format : mLayout.getLayout())
-	{
-		auto sz = format.size;
-		const auto ct = format.count;
-		const auto tp = format.type;
-		const auto of = format.offset;
-		const auto nm = format.normalized;
-
-		glVertexAttribPointer(idx, ct, tp, nm, static_cast<GLsizei>(mLayout.getStride()), reinterpret_cast<const void*>(of));
-		glEnableVertexAttribArray(idx);
-		++idx;
-	}
-	glBindBuffer(GL_VERTEX_ARRAY, 0);
-	mData = nullptr;
+	glNamedBufferStorage(mId, static_cast<GLsizeiptr>(mSize), mData, 0);
+	mHandle->countUpload(mSize);
+
+	// The data lives in the buffer storage now, the staging copy is no longer needed.
+	_releaseData();
+
+	mVertexArray = mHandle->getVertexArrayCache()->acquire(mLayout);
 	return true;
 }
 
@@ -93,12 +122,29 @@ VertexBufferLayout& OpenGLVertexBuffer::getLayout()
 
 void OpenGLVertexBuffer::bind()
 {
-	glBindBuffer(GL_VERTEX_ARRAY, mId);
+	bind(mVertexArray);
+}
+
+void OpenGLVertexBuffer::bind(OpenGLVertexArray* vao)
+{
+	OpenGLStateTracker* state = mHandle->getStateTracker();
+	state->bindVertexArray(vao->id);
+	state->bindVertexBuffer(vao, mLayout.getBinding(), mId, 0, static_cast<GLsizei>(mLayout.getStride()));
 }
 
 void OpenGLVertexBuffer::unbind()
 {
-	glBindBuffer(GL_VERTEX_ARRAY, 0);
+	mHandle->getStateTracker()->bindVertexArray(0);
+}
+
+void OpenGLVertexBuffer::_releaseData()
+{
+	if (mOwnsData)
+	{
+		delete[] reinterpret_cast<const char*>(mData);
+	}
+	mData = nullptr;
+	mOwnsData = false;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,6 +1,7 @@
 #if defined(QGFX_OPENGL)
 
 #include "qgfx/qassert.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/opengl/opengl_window.h"
 
 OpenGLWindow::~OpenGLWindow()
@@ -10,10 +11,17 @@ OpenGLWindow::~OpenGLWindow()
 
 void OpenGLWindow::construct(const WindowCreationParameters& params)
 {
-	construct(params.width, params.height, params.title, params.fullscreen, params.vsync);
+	_create(params.width, params.height, params.title, params.vsync, params.headless);
 }
 
 void OpenGLWindow::construct(const uint32_t width, const uint32_t height, const qtl::string & title, const bool fullscreen, const bool vsync)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	_create(width, height, title, vsync, false);
+}
+
+void OpenGLWindow::_create(const uint32_t width, const uint32_t height, const qtl::string& title, const bool vsync, const bool headless)
 {
 	if (!glfwInit())
 	{
@@ -21,7 +29,16 @@ void OpenGLWindow::construct(const uint32_t width, const uint32_t height, const
 		return;
 	}
 
+	if (headless)
+	{
+		// OSMesa renders into a buffer in system memory, the hidden window never touches a display
+		// when GLFW is built on its OSMesa backend (premake --headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+	}
+
 	mHandle = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+	glfwDefaultWindowHints();
 	if (!mHandle)
 	{
 		QGFX_ASSERT_MSG(false, "Failed to create window!");
@@ -29,8 +46,12 @@ void OpenGLWindow::construct(const uint32_t width, const uint32_t height, const
 		return;
 	}
 
+	mWidth = width;
+	mHeight = height;
+	mHeadless = headless;
+
 	glfwMakeContextCurrent(mHandle);
-	glfwSwapInterval(vsync ? 1 : 0);
+	glfwSwapInterval(vsync && !headless ? 1 : 0);
 }
 
 void* OpenGLWindow::getPlatformHandle() const
@@ -45,7 +66,24 @@ bool OpenGLWindow::shouldClose() const
 
 void OpenGLWindow::poll() const
 {
+	QGFX_PROFILE_FUNCTION();
+
 	glfwPollEvents();
 }
 
+uint32_t OpenGLWindow::getWidth() const
+{
+	return mWidth;
+}
+
+uint32_t OpenGLWindow::getHeight() const
+{
+	return mHeight;
+}
+
+bool OpenGLWindow::isHeadless() const
+{
+	return mHeadless;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "qgfx/render_pass_cache.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+#if defined(QGFX_OPENGL)
+#include "qgfx/opengl/opengl_framebuffer.h"
+#include "qgfx/opengl/opengl_renderpass.h"
+#elif defined(QGFX_VULKAN)
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#endif
+
+#if defined(_DEBUG)
+static bool isSameFrameBuffer(const FrameBuffer* frameBuffer, RenderPass* renderPass, const FrameBufferAttachment* attachments,
+	const uint32_t attachmentCount, const uint32_t width, const uint32_t height)
+{
+	const auto& existing = frameBuffer->getAttachments();
+	if (frameBuffer->getRenderPass() != renderPass || existing.size() != attachmentCount || frameBuffer->getWidth() != width ||
+		frameBuffer->getHeight() != height)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < attachmentCount; i++)
+	{
+		if (existing[i].view != attachments[i].view)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif
+
+RenderPassCache::RenderPassCache(ContextHandle* handle)
+	: mHandle(handle), mStatistics()
+{
+}
+
+RenderPassCache::~RenderPassCache()
+{
+	clear();
+}
+
+RenderPass* RenderPassCache::acquire(const RenderPassDescription& description)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const uint64_t hash = description.getHash();
+
+	auto it = mRenderPasses.find(hash);
+	if (it != mRenderPasses.end())
+	{
+		QGFX_ASSERT_MSG((*it).second->getDescription() == description, "Render pass hash collision.\n");
+		mStatistics.hits++;
+		return (*it).second;
+	}
+
+	RenderPass* renderPass = new RenderPass(mHandle);
+	renderPass->construct(description);
+	mRenderPasses.insert({ hash, renderPass });
+	mStatistics.misses++;
+
+	return renderPass;
+}
+
+FrameBuffer* RenderPassCache::acquire(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+	const uint32_t width, const uint32_t height)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	uint64_t hash = 14695981039346656037ULL;
+	const auto combine = [&hash](const uint64_t value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ULL;
+	};
+
+	combine(reinterpret_cast<uintptr_t>(renderPass));
+	combine(width);
+	combine(height);
+	for (uint32_t i = 0; i < attachmentCount; i++)
+	{
+		combine(reinterpret_cast<uintptr_t>(attachments[i].view));
+	}
+
+	auto it = mFrameBuffers.find(hash);
+	if (it != mFrameBuffers.end())
+	{
+		QGFX_ASSERT_MSG(isSameFrameBuffer((*it).second, renderPass, attachments, attachmentCount, width, height),
+			"Framebuffer hash collision.\n");
+		mStatistics.hits++;
+		return (*it).second;
+	}
+
+	FrameBuffer* frameBuffer = new FrameBuffer(mHandle);
+	frameBuffer->construct(renderPass, attachments, attachmentCount, width, height);
+	mFrameBuffers.insert({ hash, frameBuffer });
+	mStatistics.misses++;
+
+	return frameBuffer;
+}
+
+void RenderPassCache::evict(const void* view)
+{
+	qtl::vector<uint64_t> evicted;
+	for (auto entry : mFrameBuffers)
+	{
+		for (const auto& attachment : entry.second->getAttachments())
+		{
+			if (attachment.view == view)
+			{
+				evicted.push_back(entry.first);
+				break;
+			}
+		}
+	}
+
+	for (const auto hash : evicted)
+	{
+		auto it = mFrameBuffers.find(hash);
+		delete (*it).second;
+		mFrameBuffers.erase(hash);
+	}
+
+	mStatistics.evictions += static_cast<uint32_t>(evicted.size());
+}
+
+void RenderPassCache::clear()
+{
+	for (auto entry : mFrameBuffers)
+	{
+		delete entry.second;
+	}
+
+	for (auto entry : mRenderPasses)
+	{
+		delete entry.second;
+	}
+
+	mFrameBuffers.clear();
+	mRenderPasses.clear();
+}
@@ -1,4 +1,5 @@
 #include "qgfx/shader_loader.h"
+#include "qgfx/cpu_profiler.h"
 
 #include "qgfx/qassert.h"
 
@@ -8,6 +9,8 @@
 
 qtl::vector<char> loadSpirv(const qtl::string& file)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	std::ifstream is(file.c_str(), std::ios::ate | std::ios::binary);
 	QGFX_ASSERT_MSG(is.is_open(), "File %s could not be opened!\n", file.c_str());
 	const size_t fileSize = static_cast<size_t>(is.tellg());
@@ -21,6 +24,8 @@ qtl::vector<char> loadSpirv(const qtl::string& file)
 
 qtl::vector<char> loadText(const qtl::string& file)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	std::ifstream is(file.c_str());
 	std::string fileData;
 
@@ -0,0 +1,279 @@
+#include "qgfx/texture_streamer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+#include <algorithm>
+#include <vector>
+
+template <typename T>
+static void eraseAt(qtl::vector<T>& values, const size_t index)
+{
+	values.erase(typename qtl::vector<T>::template forward_iterator<T>(values.data(), index));
+}
+
+TextureStreamer::TextureStreamer(const size_t frameBudget, const size_t mipTailSize)
+	: mFrameBudget(frameBudget), mMipTailSize(mipTailSize), mRunning(true), mReading(nullptr), mFailedReads(0), mStatistics()
+{
+	mThread = std::thread(&TextureStreamer::_run, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+	mCondition.notify_all();
+	mThread.join();
+
+	for (auto& job : mUploads)
+	{
+		delete[] job.data;
+	}
+}
+
+void TextureStreamer::stream(IImage2D* image, TextureStreamSource* source)
+{
+	QGFX_ASSERT_MSG(image != nullptr && source != nullptr, "Streaming needs an image and a source.\n");
+	QGFX_ASSERT_MSG(!isStreaming(image), "Image is already streaming.\n");
+
+	const uint32_t levels = image->getMipLevels();
+
+	// Nothing is resident until the smallest mip has been uploaded
+	_forget(image);
+	mImages.push_back({ image, levels });
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (uint32_t level = levels; level-- > 0;)
+		{
+			const uint32_t size = source->getMipSize(level);
+			mReads.push_back({ image, source, level, size, size <= mMipTailSize, nullptr });
+		}
+	}
+	mCondition.notify_one();
+}
+
+void TextureStreamer::cancel(IImage2D* image)
+{
+	_forget(image);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	for (size_t i = 0; i < mReads.size();)
+	{
+		if (mReads[i].image == image)
+		{
+			eraseAt(mReads, i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// A read that is already in flight is left to finish and dropped afterwards
+	mCondition.wait(lock, [this, image] { return mReading != image; });
+
+	for (size_t i = 0; i < mUploads.size();)
+	{
+		if (mUploads[i].image == image)
+		{
+			delete[] mUploads[i].data;
+			eraseAt(mUploads, i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+bool TextureStreamer::isStreaming(IImage2D* image)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mReading == image)
+	{
+		return true;
+	}
+
+	for (const auto& job : mReads)
+	{
+		if (job.image == image)
+		{
+			return true;
+		}
+	}
+
+	for (const auto& job : mUploads)
+	{
+		if (job.image == image)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TextureStreamer::update()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	std::vector<StreamJob> uploads;
+	uint64_t bytes = 0;
+	uint32_t deferred = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// Mip tails are always uploaded.  Finer levels share the budget, and a level that does
+		// not fit holds back the rest of its image so each image still goes coarse to fine.
+		std::vector<IImage2D*> blocked;
+		std::vector<StreamJob> remaining;
+		bool progressed = false;
+
+		for (const auto& job : mUploads)
+		{
+			bool take = job.tail;
+			if (!take && std::find(blocked.begin(), blocked.end(), job.image) == blocked.end())
+			{
+				// Always make progress, even when a single level is larger than the budget
+				take = bytes + job.size <= mFrameBudget || !progressed;
+				progressed |= take;
+			}
+
+			if (take)
+			{
+				uploads.push_back(job);
+				bytes += job.size;
+			}
+			else
+			{
+				blocked.push_back(job.image);
+				remaining.push_back(job);
+			}
+		}
+
+		deferred = static_cast<uint32_t>(remaining.size());
+		mUploads.clear();
+		for (const auto& job : remaining)
+		{
+			mUploads.push_back(job);
+		}
+
+		mStatistics.pendingReads = static_cast<uint32_t>(mReads.size()) + (mReading ? 1 : 0);
+		mStatistics.pendingUploads = deferred;
+		mStatistics.failedReads = mFailedReads;
+	}
+
+	for (auto& job : uploads)
+	{
+		if (job.data)
+		{
+			job.image->setMipData(job.level, job.data, job.size);
+
+			// The level is only sampled once its upload has been issued, uploads on the render
+			// thread are ordered before every frame submitted after them
+			for (auto& streamed : mImages)
+			{
+				if (streamed.image == job.image && job.level < streamed.resident)
+				{
+					streamed.resident = job.level;
+					job.image->setResidentMip(job.level);
+				}
+			}
+
+			if (job.level == 0)
+			{
+				_forget(job.image);
+			}
+		}
+		delete[] job.data;
+	}
+
+	mStatistics.bytesUploaded = bytes;
+	mStatistics.mipsUploaded = static_cast<uint32_t>(uploads.size());
+	mStatistics.mipsDeferred = deferred;
+	mStatistics.totalBytesUploaded += bytes;
+}
+
+void TextureStreamer::_forget(IImage2D* image)
+{
+	for (size_t i = 0; i < mImages.size(); i++)
+	{
+		if (mImages[i].image == image)
+		{
+			eraseAt(mImages, i);
+			return;
+		}
+	}
+}
+
+void TextureStreamer::_run()
+{
+#if defined(QGFX_PROFILE)
+	CpuProfiler::setThreadName("TextureStreamer");
+#endif
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true)
+	{
+		mCondition.wait(lock, [this] { return !mRunning || !mReads.empty(); });
+		if (!mRunning)
+		{
+			break;
+		}
+
+		// Smallest mip first, which is the mip tail first and coarse to fine within an image
+		size_t next = 0;
+		for (size_t i = 1; i < mReads.size(); i++)
+		{
+			if (mReads[i].size < mReads[next].size)
+			{
+				next = i;
+			}
+		}
+
+		StreamJob job = mReads[next];
+		eraseAt(mReads, next);
+		mReading = job.image;
+
+		lock.unlock();
+
+		bool read = false;
+		{
+			QGFX_PROFILE_SCOPE("TextureStreamer::readMip");
+			job.data = new uint8_t[job.size];
+			read = job.source->readMip(job.level, job.data);
+		}
+
+		lock.lock();
+
+		mReading = nullptr;
+		if (read)
+		{
+			mUploads.push_back(job);
+		}
+		else
+		{
+			// A failed level stops the image's resident mip from moving past it
+			delete[] job.data;
+			mFailedReads++;
+			for (size_t i = 0; i < mReads.size();)
+			{
+				if (mReads[i].image == job.image && mReads[i].level < job.level)
+				{
+					eraseAt(mReads, i);
+				}
+				else
+				{
+					i++;
+				}
+			}
+		}
+
+		mCondition.notify_all();
+	}
+}
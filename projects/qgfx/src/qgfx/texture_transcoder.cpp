@@ -0,0 +1,407 @@
+#include "qgfx/texture_transcoder.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/image_format.h"
+#include "qgfx/qassert.h"
+
+#include <cstring>
+
+// Every decoder writes a 4x4 block of RGBA8 texels, row major
+using DecodedBlock = uint8_t[16][4];
+
+static uint8_t clampByte(const int32_t value)
+{
+	return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void decodeRgb565(const uint16_t color, uint8_t* rgb)
+{
+	const uint32_t r = (color >> 11) & 31;
+	const uint32_t g = (color >> 5) & 63;
+	const uint32_t b = color & 31;
+
+	rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+	rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+	rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+static void decodeBc1Color(const uint8_t* block, DecodedBlock texels, const bool allowTransparent)
+{
+	const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+	const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+	uint8_t palette[4][4];
+	decodeRgb565(color0, palette[0]);
+	decodeRgb565(color1, palette[1]);
+	palette[0][3] = palette[1][3] = 255;
+
+	// BC2 and BC3 always use the four color mode, BC1 switches on the endpoint order
+	if (color0 > color1 || !allowTransparent)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+			palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+		}
+		palette[2][3] = palette[3][3] = 255;
+	}
+	else
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+			palette[3][c] = 0;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = 0;
+	}
+
+	const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		memcpy(texels[i], palette[(indices >> (2 * i)) & 3], 4);
+	}
+}
+
+// BC3 alpha, BC4 and BC5 channels share the same 8 byte block
+static void decodeBc4Channel(const uint8_t* block, DecodedBlock texels, const uint32_t channel)
+{
+	uint32_t values[8];
+	values[0] = block[0];
+	values[1] = block[1];
+
+	if (values[0] > values[1])
+	{
+		for (uint32_t i = 1; i < 7; i++)
+		{
+			values[i + 1] = ((7 - i) * values[0] + i * values[1]) / 7;
+		}
+	}
+	else
+	{
+		for (uint32_t i = 1; i < 5; i++)
+		{
+			values[i + 1] = ((5 - i) * values[0] + i * values[1]) / 5;
+		}
+		values[6] = 0;
+		values[7] = 255;
+	}
+
+	uint64_t indices = 0;
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+	}
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		texels[i][channel] = static_cast<uint8_t>(values[(indices >> (3 * i)) & 7]);
+	}
+}
+
+static const int32_t etcModifiers[8][2] = {
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int32_t etcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int32_t eacModifiers[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static int32_t expand4(const int32_t value) { return (value << 4) | value; }
+static int32_t expand5(const int32_t value) { return (value << 3) | (value >> 2); }
+static int32_t expand6(const int32_t value) { return (value << 2) | (value >> 4); }
+static int32_t expand7(const int32_t value) { return (value << 1) | (value >> 6); }
+
+static int32_t signExtend3(const int32_t value)
+{
+	return (value & 4) ? value - 8 : value;
+}
+
+static void decodeEtc2Planar(const uint8_t* block, DecodedBlock texels)
+{
+	const int32_t origin[3] = {
+		expand6((block[0] >> 1) & 63),
+		expand7(((block[0] & 1) << 6) | ((block[1] >> 1) & 63)),
+		expand6(((block[1] & 1) << 5) | (((block[2] >> 3) & 3) << 3) | ((block[2] & 3) << 1) | (block[3] >> 7))
+	};
+	const int32_t horizontal[3] = {
+		expand6((((block[3] >> 2) & 31) << 1) | (block[3] & 1)),
+		expand7(block[4] >> 1),
+		expand6(((block[4] & 1) << 5) | (block[5] >> 3))
+	};
+	const int32_t vertical[3] = {
+		expand6(((block[5] & 7) << 3) | (block[6] >> 5)),
+		expand7(((block[6] & 31) << 2) | (block[7] >> 6)),
+		expand6(block[7] & 63)
+	};
+
+	for (int32_t y = 0; y < 4; y++)
+	{
+		for (int32_t x = 0; x < 4; x++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				const int32_t value = x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2;
+				texels[y * 4 + x][c] = clampByte(value >> 2);
+			}
+			texels[y * 4 + x][3] = 255;
+		}
+	}
+}
+
+static void decodeEtc2Color(const uint8_t* block, DecodedBlock texels)
+{
+	// Pixel indices are stored column major, most significant bits in the upper half
+	const uint32_t msb = (block[4] << 8) | block[5];
+	const uint32_t lsb = (block[6] << 8) | block[7];
+
+	int32_t base[2][3];
+	const bool differential = (block[3] & 2) != 0;
+
+	if (differential)
+	{
+		int32_t first[3];
+		int32_t second[3];
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			first[c] = block[c] >> 3;
+			second[c] = first[c] + signExtend3(block[c] & 7);
+		}
+
+		// An overflowing second color selects one of the modes ETC2 added on top of ETC1
+		if (second[0] < 0 || second[0] > 31 || second[1] < 0 || second[1] > 31)
+		{
+			uint8_t palette[4][3];
+			int32_t colors[2][3];
+			int32_t distance;
+
+			if (second[0] < 0 || second[0] > 31)
+			{
+				// T mode
+				colors[0][0] = expand4((((block[0] >> 3) & 3) << 2) | (block[0] & 3));
+				colors[0][1] = expand4(block[1] >> 4);
+				colors[0][2] = expand4(block[1] & 15);
+				colors[1][0] = expand4(block[2] >> 4);
+				colors[1][1] = expand4(block[2] & 15);
+				colors[1][2] = expand4(block[3] >> 4);
+				distance = etcDistances[(((block[3] >> 2) & 3) << 1) | (block[3] & 1)];
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					palette[0][c] = static_cast<uint8_t>(colors[0][c]);
+					palette[1][c] = clampByte(colors[1][c] + distance);
+					palette[2][c] = static_cast<uint8_t>(colors[1][c]);
+					palette[3][c] = clampByte(colors[1][c] - distance);
+				}
+			}
+			else
+			{
+				// H mode
+				const int32_t r0 = (block[0] >> 3) & 15;
+				const int32_t g0 = ((block[0] & 7) << 1) | ((block[1] >> 4) & 1);
+				const int32_t b0 = (((block[1] >> 3) & 1) << 3) | ((block[1] & 3) << 1) | (block[2] >> 7);
+				const int32_t r1 = (block[2] >> 3) & 15;
+				const int32_t g1 = ((block[2] & 7) << 1) | (block[3] >> 7);
+				const int32_t b1 = (block[3] >> 3) & 15;
+
+				// The order of the two colors stores the lowest bit of the distance index
+				const int32_t order = ((r0 << 8) | (g0 << 4) | b0) >= ((r1 << 8) | (g1 << 4) | b1) ? 1 : 0;
+				distance = etcDistances[(((block[3] >> 2) & 1) << 2) | ((block[3] & 1) << 1) | order];
+
+				colors[0][0] = expand4(r0);
+				colors[0][1] = expand4(g0);
+				colors[0][2] = expand4(b0);
+				colors[1][0] = expand4(r1);
+				colors[1][1] = expand4(g1);
+				colors[1][2] = expand4(b1);
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					palette[0][c] = clampByte(colors[0][c] + distance);
+					palette[1][c] = clampByte(colors[0][c] - distance);
+					palette[2][c] = clampByte(colors[1][c] + distance);
+					palette[3][c] = clampByte(colors[1][c] - distance);
+				}
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				const uint32_t x = i / 4;
+				const uint32_t y = i % 4;
+				const uint32_t index = (((msb >> i) & 1) << 1) | ((lsb >> i) & 1);
+				memcpy(texels[y * 4 + x], palette[index], 3);
+				texels[y * 4 + x][3] = 255;
+			}
+			return;
+		}
+
+		if (second[2] < 0 || second[2] > 31)
+		{
+			decodeEtc2Planar(block, texels);
+			return;
+		}
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			base[0][c] = expand5(first[c]);
+			base[1][c] = expand5(second[c]);
+		}
+	}
+	else
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			base[0][c] = expand4(block[c] >> 4);
+			base[1][c] = expand4(block[c] & 15);
+		}
+	}
+
+	const uint32_t tables[2] = { static_cast<uint32_t>(block[3] >> 5), static_cast<uint32_t>((block[3] >> 2) & 7) };
+	const bool flip = (block[3] & 1) != 0;
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		const uint32_t x = i / 4;
+		const uint32_t y = i % 4;
+		const uint32_t subBlock = flip ? (y >= 2) : (x >= 2);
+
+		const int32_t* modifiers = etcModifiers[tables[subBlock]];
+		int32_t modifier = modifiers[(lsb >> i) & 1];
+		if ((msb >> i) & 1)
+		{
+			modifier = -modifier;
+		}
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			texels[y * 4 + x][c] = clampByte(base[subBlock][c] + modifier);
+		}
+		texels[y * 4 + x][3] = 255;
+	}
+}
+
+static void decodeEacAlpha(const uint8_t* block, DecodedBlock texels)
+{
+	const int32_t base = block[0];
+	const int32_t multiplier = block[1] >> 4;
+	const int32_t* modifiers = eacModifiers[block[1] & 15];
+
+	uint64_t indices = 0;
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		indices = (indices << 8) | block[2 + i];
+	}
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		const uint32_t x = i / 4;
+		const uint32_t y = i % 4;
+		const uint32_t index = static_cast<uint32_t>(indices >> (45 - 3 * i)) & 7;
+		texels[y * 4 + x][3] = clampByte(base + modifiers[index] * multiplier);
+	}
+}
+
+static void decodeBlock(const uint8_t* block, DecodedBlock texels, const ImageFormat format)
+{
+	switch (format)
+	{
+		case ImageFormat::BC1:
+			decodeBc1Color(block, texels, true);
+			break;
+		case ImageFormat::BC2:
+			decodeBc1Color(block + 8, texels, false);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][3] = static_cast<uint8_t>(((block[i / 2] >> (4 * (i % 2))) & 15) * 17);
+			}
+			break;
+		case ImageFormat::BC3:
+			decodeBc1Color(block + 8, texels, false);
+			decodeBc4Channel(block, texels, 3);
+			break;
+		case ImageFormat::BC4:
+		case ImageFormat::BC5:
+			memset(texels, 0, sizeof(DecodedBlock));
+			decodeBc4Channel(block, texels, 0);
+			if (format == ImageFormat::BC5)
+			{
+				decodeBc4Channel(block + 8, texels, 1);
+			}
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				texels[i][3] = 255;
+			}
+			break;
+		case ImageFormat::ETC2_RGB:
+			decodeEtc2Color(block, texels);
+			break;
+		case ImageFormat::ETC2_RGBA:
+			decodeEtc2Color(block + 8, texels);
+			decodeEacAlpha(block, texels);
+			break;
+		default:
+			break;
+	}
+}
+
+bool canTranscodeImageFormat(const ImageFormat format, const ImageDataType type)
+{
+	switch (format)
+	{
+		case ImageFormat::BC1:
+		case ImageFormat::BC2:
+		case ImageFormat::BC3:
+		case ImageFormat::ETC2_RGB:
+		case ImageFormat::ETC2_RGBA: return true;
+		case ImageFormat::BC4:
+		case ImageFormat::BC5: return type != ImageDataType::Byte;
+		default: return false;
+	}
+}
+
+void transcodeImage(const uint8_t* source, const uint32_t width, const uint32_t height, uint8_t* destination,
+	const ImageFormat format, const ImageDataType type)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(canTranscodeImageFormat(format, type), "Format can not be transcoded on the CPU.\n");
+
+	const ImageBlockInfo info = getImageBlockInfo(format, type);
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+
+	DecodedBlock texels;
+	for (uint32_t by = 0; by < blocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			decodeBlock(source, texels, format);
+			source += info.size;
+
+			// Blocks on the right and bottom edge can hang over the image
+			const uint32_t columns = width - bx * 4 < 4 ? width - bx * 4 : 4;
+			const uint32_t rows = height - by * 4 < 4 ? height - by * 4 : 4;
+			for (uint32_t y = 0; y < rows; y++)
+			{
+				uint8_t* row = destination + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4) * 4;
+				memcpy(row, texels[y * 4], columns * 4);
+			}
+		}
+	}
+}
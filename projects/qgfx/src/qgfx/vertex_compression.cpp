@@ -0,0 +1,456 @@
+#include "qgfx/vertex_compression.h"
+#include "qgfx/cpu_profiler.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QGFX_SSE2
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define QGFX_X86
+#endif
+
+#if defined(QGFX_X86)
+// vertex_compression_avx2.cpp, the only translation unit built with AVX2 and F16C
+bool hasVertexCompressionAvx2Kernels();
+size_t quantizePositionsAvx2(const float* src, uint16_t* dst, const size_t floatCount, const float offset[3], const float scale[3]);
+size_t convertToHalfAvx2(const float* src, uint16_t* dst, const size_t count);
+#endif
+
+static constexpr size_t positionSize = 4 * sizeof(uint16_t);
+static constexpr size_t normalSize = 2 * sizeof(int16_t);
+static constexpr size_t tangentSize = 4 * sizeof(int8_t);
+static constexpr size_t uvSize = 2 * sizeof(uint16_t);
+
+// Whether the AVX2 kernels were built and the CPU and OS can run them
+static bool canUseAvx2()
+{
+#if defined(QGFX_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	// The OS has to save the YMM registers on context switches
+	__cpuid(info, 1);
+	const bool f16c = (info[2] & (1 << 29)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!f16c || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0 && hasVertexCompressionAvx2Kernels();
+#elif defined(QGFX_X86)
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c") && hasVertexCompressionAvx2Kernels();
+#else
+	return false;
+#endif
+}
+
+static const bool useAvx2 = canUseAvx2();
+
+CompressedVertices::~CompressedVertices()
+{
+	delete[] data;
+	data = nullptr;
+}
+
+uint16_t floatToHalf(const float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t mantissa = bits & 0x007FFFFF;
+	const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+
+	if (((bits >> 23) & 0xFF) == 0xFF)
+	{
+		// Infinity stays infinity, NaN is quieted and keeps the top of its payload like F16C does
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x0200 | (mantissa >> 13) : 0));
+	}
+	if (exponent >= 0x1F)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+
+		// Denormal, shift the mantissa with the implicit bit and round to nearest even
+		const uint32_t full = mantissa | 0x00800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		const uint32_t rounded = full >> shift;
+		const uint32_t remainder = full & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		return static_cast<uint16_t>(sign | (rounded + (remainder > halfway || (remainder == halfway && (rounded & 1)) ? 1 : 0)));
+	}
+
+	// Ties round to even like F16C does.  Rounding may carry into the exponent, which
+	// correctly produces the next power of two, or infinity past the largest half.
+	const uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	const uint32_t remainder = mantissa & 0x1FFF;
+	return static_cast<uint16_t>(sign | (half + (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)) ? 1 : 0)));
+}
+
+float halfToFloat(const uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x03FF;
+	uint32_t bits;
+
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			int32_t e = -1;
+			do
+			{
+				e++;
+				mantissa <<= 1;
+			} while ((mantissa & 0x0400) == 0);
+			bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mantissa & 0x03FF) << 13);
+		}
+	}
+	else if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void encodeOctahedral(const float x, const float y, const float z, float& u, float& v)
+{
+	const float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+	const float inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+	const float px = x * inv;
+	const float py = y * inv;
+
+	if (z < 0.0f)
+	{
+		// Fold the lower hemisphere over the diagonals
+		u = (1.0f - fabsf(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+		v = (1.0f - fabsf(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+	}
+	else
+	{
+		u = px;
+		v = py;
+	}
+}
+
+void decodeOctahedral(const float u, const float v, float& x, float& y, float& z)
+{
+	x = u;
+	y = v;
+	z = 1.0f - fabsf(u) - fabsf(v);
+
+	if (z < 0.0f)
+	{
+		const float ox = x;
+		x = (1.0f - fabsf(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - fabsf(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	const float len = sqrtf(x * x + y * y + z * z);
+	if (len > 0.0f)
+	{
+		x /= len;
+		y /= len;
+		z /= len;
+	}
+}
+
+static int16_t toSnorm16(const float value)
+{
+	const float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+	return static_cast<int16_t>(lrintf(clamped * 32767.0f));
+}
+
+/// Quantizes a flat array of xyz floats to unorm16 relative to the bounds.
+static void quantizePositions(const float* src, uint16_t* dst, const size_t floatCount, const float offset[3], const float scale[3])
+{
+	size_t i = 0;
+
+#if defined(QGFX_X86)
+	if (useAvx2)
+	{
+		i = quantizePositionsAvx2(src, dst, floatCount, offset, scale);
+	}
+#endif
+
+#if defined(QGFX_SSE2)
+	__m128 offsets[3];
+	__m128 scales[3];
+	for (uint32_t r = 0; r < 3; r++)
+	{
+		offsets[r] = _mm_setr_ps(offset[(r * 4) % 3], offset[(r * 4 + 1) % 3], offset[(r * 4 + 2) % 3], offset[(r * 4 + 3) % 3]);
+		scales[r] = _mm_setr_ps(scale[(r * 4) % 3], scale[(r * 4 + 1) % 3], scale[(r * 4 + 2) % 3], scale[(r * 4 + 3) % 3]);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maxValue = _mm_set1_ps(65535.0f);
+	const __m128i bias = _mm_set1_epi32(32768);
+	const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+	for (; i + 12 <= floatCount; i += 12)
+	{
+		__m128i q[3];
+		for (uint32_t r = 0; r < 3; r++)
+		{
+			__m128 v = _mm_loadu_ps(src + i + r * 4);
+			v = _mm_mul_ps(_mm_sub_ps(v, offsets[r]), scales[r]);
+			v = _mm_min_ps(_mm_max_ps(v, zero), maxValue);
+
+			// SSE2 only has a signed pack, so bias into the signed range and flip back after
+			q[r] = _mm_sub_epi32(_mm_cvtps_epi32(v), bias);
+		}
+
+		const __m128i lo = _mm_xor_si128(_mm_packs_epi32(q[0], q[1]), flip);
+		const __m128i hi = _mm_xor_si128(_mm_packs_epi32(q[2], q[2]), flip);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i + 8), hi);
+	}
+#endif
+
+	for (; i < floatCount; i++)
+	{
+		float v = (src[i] - offset[i % 3]) * scale[i % 3];
+		v = v < 0.0f ? 0.0f : (v > 65535.0f ? 65535.0f : v);
+		dst[i] = static_cast<uint16_t>(lrintf(v));
+	}
+}
+
+/// Octahedral encodes vectors read at the given float stride into snorm16 pairs.
+static void encodeOctahedralSnorm16(const float* src, const size_t stride, int16_t* dst, const size_t count)
+{
+	size_t i = 0;
+
+#if defined(QGFX_SSE2)
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 snorm = _mm_set1_ps(32767.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* p = src + i * stride;
+		const __m128 x = _mm_setr_ps(p[0], p[stride], p[stride * 2], p[stride * 3]);
+		const __m128 y = _mm_setr_ps(p[1], p[stride + 1], p[stride * 2 + 1], p[stride * 3 + 1]);
+		const __m128 z = _mm_setr_ps(p[2], p[stride + 2], p[stride * 2 + 2], p[stride * 3 + 2]);
+
+		const __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+		const __m128 valid = _mm_cmpgt_ps(l1, zero);
+		const __m128 inv = _mm_and_ps(_mm_div_ps(one, l1), valid);
+		const __m128 px = _mm_mul_ps(x, inv);
+		const __m128 py = _mm_mul_ps(y, inv);
+
+		// Fold the lower hemisphere: (1 - |other|) carrying the sign of the component
+		const __m128 signX = _mm_and_ps(px, signMask);
+		const __m128 signY = _mm_and_ps(py, signMask);
+		const __m128 fx = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, py)), signX);
+		const __m128 fy = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, px)), signY);
+
+		const __m128 lower = _mm_cmplt_ps(z, zero);
+		const __m128 u = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, px));
+		const __m128 v = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, py));
+
+		const __m128i qu = _mm_cvtps_epi32(_mm_mul_ps(u, snorm));
+		const __m128i qv = _mm_cvtps_epi32(_mm_mul_ps(v, snorm));
+
+		// Interleave to u0 v0 u1 v1 ... and saturate to 16 bits
+		const __m128i uv0 = _mm_unpacklo_epi32(qu, qv);
+		const __m128i uv1 = _mm_unpackhi_epi32(qu, qv);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_packs_epi32(uv0, uv1));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float* p = src + i * stride;
+		float u, v;
+		encodeOctahedral(p[0], p[1], p[2], u, v);
+		dst[i * 2] = toSnorm16(u);
+		dst[i * 2 + 1] = toSnorm16(v);
+	}
+}
+
+/// Converts a flat float array to half floats.
+static void convertToHalf(const float* src, uint16_t* dst, const size_t count)
+{
+	size_t i = 0;
+
+#if defined(QGFX_X86)
+	if (useAvx2)
+	{
+		i = convertToHalfAvx2(src, dst, count);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+void compressVertices(const VertexCompressionInput& input, CompressedVertices& output, VertexCompressionStatistics* statistics)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(input.positions != nullptr, "Vertex compression needs positions.\n");
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	const size_t count = input.vertexCount;
+
+	output.layout = VertexBufferLayout();
+	output.layout.push("position", VertexAttribType::UInt16, 4, true);
+	if (input.normals)
+	{
+		output.layout.push("normal", VertexAttribType::Int16, 2, true);
+	}
+	if (input.tangents)
+	{
+		output.layout.push("tangent", VertexAttribType::Int8, 4, true);
+	}
+	if (input.uvs)
+	{
+		output.layout.push("uv", VertexAttribType::Half, 2, false);
+	}
+
+	const size_t stride = output.layout.getStride();
+	delete[] output.data;
+	output.size = stride * count;
+	output.data = new uint8_t[output.size];
+	output.vertexCount = count;
+
+	// Bounds, the quantization grid spans them exactly
+	float minimum[3] = { 0.0f, 0.0f, 0.0f };
+	float maximum[3] = { 0.0f, 0.0f, 0.0f };
+	if (count)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			minimum[c] = maximum[c] = input.positions[c];
+		}
+	}
+	for (size_t i = 1; i < count; i++)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			const float p = input.positions[i * 3 + c];
+			minimum[c] = p < minimum[c] ? p : minimum[c];
+			maximum[c] = p > maximum[c] ? p : maximum[c];
+		}
+	}
+
+	float scale[3];
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		const float extent = maximum[c] - minimum[c];
+		output.positionMin[c] = minimum[c];
+		output.positionExtent[c] = extent;
+		scale[c] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+	}
+
+	// Each stream is converted with the SIMD kernels into a scratch array, then interleaved.
+	uint16_t* positions = new uint16_t[count * 3];
+	quantizePositions(input.positions, positions, count * 3, minimum, scale);
+
+	int16_t* normals = nullptr;
+	if (input.normals)
+	{
+		normals = new int16_t[count * 2];
+		encodeOctahedralSnorm16(input.normals, 3, normals, count);
+	}
+
+	int16_t* tangents = nullptr;
+	if (input.tangents)
+	{
+		tangents = new int16_t[count * 2];
+		encodeOctahedralSnorm16(input.tangents, 4, tangents, count);
+	}
+
+	uint16_t* uvs = nullptr;
+	if (input.uvs)
+	{
+		uvs = new uint16_t[count * 2];
+		convertToHalf(input.uvs, uvs, count * 2);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint8_t* vertex = output.data + i * stride;
+
+		const uint16_t position[4] = { positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 0xFFFF };
+		memcpy(vertex, position, positionSize);
+		vertex += positionSize;
+
+		if (normals)
+		{
+			memcpy(vertex, normals + i * 2, normalSize);
+			vertex += normalSize;
+		}
+
+		if (tangents)
+		{
+			const int8_t tangent[4] =
+			{
+				static_cast<int8_t>(lrintf(tangents[i * 2] * (127.0f / 32767.0f))),
+				static_cast<int8_t>(lrintf(tangents[i * 2 + 1] * (127.0f / 32767.0f))),
+				static_cast<int8_t>(input.tangents[i * 4 + 3] < 0.0f ? -127 : 127),
+				0
+			};
+			memcpy(vertex, tangent, tangentSize);
+			vertex += tangentSize;
+		}
+
+		if (uvs)
+		{
+			memcpy(vertex, uvs + i * 2, uvSize);
+		}
+	}
+
+	delete[] positions;
+	delete[] normals;
+	delete[] tangents;
+	delete[] uvs;
+
+	if (statistics)
+	{
+		size_t uncompressedStride = 3 * sizeof(float);
+		uncompressedStride += input.normals ? 3 * sizeof(float) : 0;
+		uncompressedStride += input.tangents ? 4 * sizeof(float) : 0;
+		uncompressedStride += input.uvs ? 2 * sizeof(float) : 0;
+
+		statistics->vertexCount = count;
+		statistics->uncompressedStride = uncompressedStride;
+		statistics->compressedStride = stride;
+		statistics->uncompressedBytes = uncompressedStride * count;
+		statistics->compressedBytes = output.size;
+		statistics->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
@@ -0,0 +1,90 @@
+// AVX2 and F16C kernels of the vertex compressor.  This is the only translation unit built
+// with -mavx2 -mf16c (/arch:AVX2), vertex_compression.cpp only calls into it after checking
+// the CPU, so nothing outside of these loops can end up using the wider instructions.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVX2__) && (defined(__F16C__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define QGFX_AVX2
+#endif
+
+bool hasVertexCompressionAvx2Kernels()
+{
+#if defined(QGFX_AVX2)
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Returns the number of floats quantized, the caller finishes the rest
+size_t quantizePositionsAvx2(const float* src, uint16_t* dst, const size_t floatCount, const float offset[3], const float scale[3])
+{
+	size_t i = 0;
+
+#if defined(QGFX_AVX2)
+	// 24 floats hold whole vertices and fill three registers, so the xyz pattern of the
+	// offsets and scales repeats every three registers.
+	__m256 offsets[3];
+	__m256 scales[3];
+	for (uint32_t r = 0; r < 3; r++)
+	{
+		alignas(32) float o[8];
+		alignas(32) float s[8];
+		for (uint32_t lane = 0; lane < 8; lane++)
+		{
+			o[lane] = offset[(r * 8 + lane) % 3];
+			s[lane] = scale[(r * 8 + lane) % 3];
+		}
+		offsets[r] = _mm256_load_ps(o);
+		scales[r] = _mm256_load_ps(s);
+	}
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 maxValue = _mm256_set1_ps(65535.0f);
+	for (; i + 24 <= floatCount; i += 24)
+	{
+		for (uint32_t r = 0; r < 3; r++)
+		{
+			__m256 v = _mm256_loadu_ps(src + i + r * 8);
+			v = _mm256_mul_ps(_mm256_sub_ps(v, offsets[r]), scales[r]);
+			v = _mm256_min_ps(_mm256_max_ps(v, zero), maxValue);
+
+			// packus works within 128 bit lanes, the permute restores the element order
+			const __m256i q = _mm256_cvtps_epi32(v);
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(q, q), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + r * 8), _mm256_castsi256_si128(packed));
+		}
+	}
+#else
+	(void)src;
+	(void)dst;
+	(void)floatCount;
+	(void)offset;
+	(void)scale;
+#endif
+
+	return i;
+}
+
+// Returns the number of floats converted, the caller finishes the rest
+size_t convertToHalfAvx2(const float* src, uint16_t* dst, const size_t count)
+{
+	size_t i = 0;
+
+#if defined(QGFX_AVX2)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+	}
+#else
+	(void)src;
+	(void)dst;
+	(void)count;
+#endif
+
+	return i;
+}
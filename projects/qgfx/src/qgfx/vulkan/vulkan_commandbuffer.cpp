@@ -1,12 +1,35 @@
 #if defined(QGFX_VULKAN)
 #include "qgfx/qassert.h"
+#include "qgfx/cpu_profiler.h"
 
 #include "qgfx/vulkan/vulkan_commandbuffer.h"
 #include "qgfx/vulkan/vulkan_commandpool.h"
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/vulkan/vulkan_indexbuffer.h"
+#include "qgfx/vulkan/vulkan_pipeline.h"
+#include "qgfx/vulkan/vulkan_rasterizer.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/vulkan/vulkan_vertexbuffer.h"
 
-VulkanCommandBuffer::VulkanCommandBuffer(ContextHandle* handle) : ICommandBuffer(handle)
+#include <cstring>
+
+VkCommandBufferUsageFlags qgfxCommandBufferUsageToVulkan(const CommandBufferUsage usage)
 {
+	switch (usage)
+	{
+		case CommandBufferUsage::OneTimeSubmit: return VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		case CommandBufferUsage::Reusable: return 0;
+		case CommandBufferUsage::Simultaneous: return VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+		default: return 0;
+	}
+}
 
+VulkanCommandBuffer::VulkanCommandBuffer(ContextHandle* handle, const CommandBufferUsage usage) : ICommandBuffer(handle, usage)
+{
+	mBuffer = VK_NULL_HANDLE;
+	mResettable = false;
+	mRecorded = false;
 }
 
 VulkanCommandBuffer::~VulkanCommandBuffer()
@@ -16,21 +39,148 @@ VulkanCommandBuffer::~VulkanCommandBuffer()
 
 void VulkanCommandBuffer::record()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	// Beginning a buffer allocated from a pool with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+	// implicitly resets it, so re-recording only needs the pool to have been created with that flag.
+	QGFX_ASSERT_MSG(!mRecorded || mResettable, "Command buffer was already recorded and its pool does not allow re-recording!");
+
 	VkCommandBufferBeginInfo beginInfo = {};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+	beginInfo.flags = qgfxCommandBufferUsageToVulkan(mUsage);
 	beginInfo.pInheritanceInfo = nullptr;
 
 	const VkResult result = vkBeginCommandBuffer(mBuffer, &beginInfo);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to begin recording command buffer!");
+
+	mRecorded = true;
 }
 
 void VulkanCommandBuffer::end()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	const VkResult result = vkEndCommandBuffer(mBuffer);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to end recording command buffer!");
 }
 
+void VulkanCommandBuffer::reset()
+{
+	QGFX_ASSERT_MSG(mResettable, "Command buffer pool was not created with per-buffer reset!");
+
+	const VkResult result = vkResetCommandBuffer(mBuffer, 0);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to reset command buffer!");
+
+	mRecorded = false;
+}
+
+void VulkanCommandBuffer::beginRenderPass(RenderPass* renderPass, FrameBuffer* frameBuffer, const ClearValue* clearValues)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const RenderPassDescription& description = renderPass->getDescription();
+	const auto& attachments = frameBuffer->getAttachments();
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+
+	qtl::vector<VkClearValue> values;
+	const uint32_t renderedCount = description.colorAttachmentCount + (description.hasDepthAttachment ? 1 : 0);
+	for (uint32_t i = 0; i < renderedCount; i++)
+	{
+		const bool depth = i >= description.colorAttachmentCount;
+		const RenderPassAttachment& attachment = depth ? description.depthAttachment : description.colorAttachments[i];
+		const VkImage image = static_cast<VkImage>(attachments[i].image);
+
+		// Swap chain images are transitioned by the render pass, everything else is moved into
+		// its attachment layout here so the barriers batch with any others already pending
+		if (image != VK_NULL_HANDLE)
+		{
+			const bool discard = attachment.loadOp != AttachmentLoadOp::Load && (!depth || attachment.stencilLoadOp != AttachmentLoadOp::Load);
+			if (depth)
+			{
+				tracker->transition(image, 0, 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, discard);
+			}
+			else
+			{
+				const VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (discard ? 0 : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
+				tracker->transition(image, 0, 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, access, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, discard);
+			}
+		}
+
+		VkClearValue value = {};
+		if (depth)
+		{
+			value.depthStencil = { clearValues ? clearValues[i].depth : mHandle->getRasterizer()->getDepthClearValue(), clearValues ? clearValues[i].stencil : 0 };
+		}
+		else if (clearValues)
+		{
+			memcpy(value.color.float32, clearValues[i].color, sizeof(value.color.float32));
+		}
+		values.push_back(value);
+	}
+
+	// Resolve targets are written by the end of the pass and never loaded
+	for (uint32_t i = renderedCount; i < attachments.size(); i++)
+	{
+		const VkImage image = static_cast<VkImage>(attachments[i].image);
+		if (image != VK_NULL_HANDLE)
+		{
+			tracker->transition(image, 0, 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, true);
+		}
+	}
+
+	tracker->flush(mBuffer);
+
+	VkRenderPassBeginInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = renderPass->getRenderPass();
+	renderPassInfo.framebuffer = frameBuffer->getFrameBuffer();
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = { frameBuffer->getWidth(), frameBuffer->getHeight() };
+	renderPassInfo.clearValueCount = static_cast<uint32_t>(values.size());
+	renderPassInfo.pClearValues = values.data();
+
+	vkCmdBeginRenderPass(mBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void VulkanCommandBuffer::endRenderPass()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	vkCmdEndRenderPass(mBuffer);
+}
+
+void VulkanCommandBuffer::bindPipeline(Pipeline* pipeline)
+{
+	vkCmdBindPipeline(mBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipeline());
+}
+
+void VulkanCommandBuffer::bindVertexBuffer(VertexBuffer* buffer)
+{
+	VkBuffer buffers[] = { buffer->getBuffer() };
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(mBuffer, buffer->getLayout().getBinding(), 1, buffers, offsets);
+}
+
+void VulkanCommandBuffer::bindIndexBuffer(IndexBuffer* buffer)
+{
+	vkCmdBindIndexBuffer(mBuffer, buffer->getBuffer(), 0, buffer->getVulkanIndexType());
+}
+
+void VulkanCommandBuffer::draw(const uint32_t vertexCount, const uint32_t instanceCount, const uint32_t firstVertex, const uint32_t firstInstance)
+{
+	vkCmdDraw(mBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+	mHandle->countDrawCall();
+}
+
+void VulkanCommandBuffer::drawIndexed(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t firstIndex, const int32_t vertexOffset, const uint32_t firstInstance)
+{
+	vkCmdDrawIndexed(mBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	mHandle->countDrawCall();
+}
+
 VkCommandBuffer VulkanCommandBuffer::getBuffer() const
 {
 	return mBuffer;
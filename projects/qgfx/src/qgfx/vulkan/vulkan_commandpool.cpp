@@ -1,5 +1,6 @@
 #if defined(QGFX_VULKAN)
 #include "qgfx/qassert.h"
+#include "qgfx/cpu_profiler.h"
 
 #include "qgfx/vulkan/queue_family.h"
 
@@ -10,6 +11,7 @@
 VulkanCommandPool::VulkanCommandPool(ContextHandle* handle) : ICommandPool(handle)
 {
 	mCommandPool = nullptr;
+	mFlags = 0;
 }
 
 VulkanCommandPool::~VulkanCommandPool()
@@ -22,9 +24,11 @@ VulkanCommandPool::~VulkanCommandPool()
 	vkDestroyCommandPool(mHandle->getLogicalDevice(), mCommandPool, nullptr);
 }
 
-CommandBuffer* VulkanCommandPool::addCommandBuffer()
+CommandBuffer* VulkanCommandPool::addCommandBuffer(const CommandBufferUsage usage)
 {
-	CommandBuffer* buffer = new CommandBuffer(mHandle);
+	QGFX_ASSERT_MSG(mCommandPool == nullptr, "Command buffers must be added before the pool is constructed!");
+
+	CommandBuffer* buffer = new CommandBuffer(mHandle, usage);
 	mBuffers.push_back(buffer);
 
 	return buffer;
@@ -37,12 +41,35 @@ qtl::vector<CommandBuffer*> VulkanCommandPool::getBuffers()
 
 void VulkanCommandPool::construct()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(mHandle->getPhysicalDevice(), mHandle->getSurface());
 
+	// Simultaneous buffers are recorded once and replayed, so a pool made up only of them
+	// gets no reset flags. Anything else is expected to be re-recorded; one-time submit
+	// buffers are re-recorded every frame and additionally hint the pool as transient.
+	bool oneTimeOnly = !mBuffers.empty();
+	bool rerecorded = false;
+	for (const auto buffer : mBuffers)
+	{
+		oneTimeOnly = oneTimeOnly && buffer->getUsage() == CommandBufferUsage::OneTimeSubmit;
+		rerecorded = rerecorded || buffer->getUsage() != CommandBufferUsage::Simultaneous;
+	}
+
+	mFlags = 0;
+	if (rerecorded)
+	{
+		mFlags |= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	}
+	if (oneTimeOnly)
+	{
+		mFlags |= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	}
+
 	VkCommandPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-	poolInfo.flags = 0;
+	poolInfo.flags = mFlags;
 
 	VkResult result = vkCreateCommandPool(mHandle->getLogicalDevice(), &poolInfo, nullptr, &mCommandPool);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create command pool!");
@@ -62,7 +89,26 @@ void VulkanCommandPool::construct()
 	for(size_t i = 0; i < mBuffers.size(); i++)
 	{
 		mBuffers[i]->mBuffer = mVulkanBuffers[i];
+		mBuffers[i]->mResettable = (mFlags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) != 0;
 	}
 }
 
+void VulkanCommandPool::reset()
+{
+	// Resetting the whole pool is cheaper than resetting its buffers one by one and is
+	// valid for any pool, as long as none of its buffers are still pending execution.
+	const VkResult result = vkResetCommandPool(mHandle->getLogicalDevice(), mCommandPool, 0);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to reset command pool!");
+
+	for (auto buffer : mBuffers)
+	{
+		buffer->mRecorded = false;
+	}
+}
+
+VkCommandPool VulkanCommandPool::getPool() const
+{
+	return mCommandPool;
+}
+
 #endif // QGFX_VULKAN
@@ -6,14 +6,23 @@
 #include <set>
 #include <algorithm>
 #include <cstring>
+#include <limits>
 
 #include "qgfx/vulkan/queue_family.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/vulkan/vulkan_context_handle.h"
 #include "qgfx/vulkan/vulkan_rasterizer.h"
 #include "qgfx/vulkan/vulkan_pipeline.h"
 #include "qgfx/vulkan/vulkan_commandpool.h"
 #include "qgfx/vulkan/vulkan_commandbuffer.h"
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/vulkan/vulkan_memory.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/vulkan/vulkan_upload_ring.h"
 #include "qgfx/vulkan/vulkan_window.h"
+#include "qgfx/render_pass_cache.h"
 #include "GLFW/glfw3.h"
 #include "qgfx/qassert.h"
 
@@ -27,6 +36,9 @@ const std::vector<const char*> deviceExtensions = {
 	VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
+// Offscreen images of headless contexts, RGBA so readback needs no swizzle
+const VkFormat offscreenFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
 #if defined(_DEBUG)
 const bool enableValidationLayers = true;
 static VKAPI_ATTR VkBool32 VKAPI_CALL sDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -79,12 +91,17 @@ bool checkValidationLayerSupport()
 	return true;
 }
 
-std::vector<const char*> getRequiredExtensions()
+std::vector<const char*> getRequiredExtensions(const bool headless)
 {
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	std::vector<const char*> extensions;
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	// Headless contexts have no surface, so they also run on drivers without VK_KHR_surface
+	if(!headless)
+	{
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if(enableValidationLayers)
 	{
@@ -94,6 +111,11 @@ std::vector<const char*> getRequiredExtensions()
 	return extensions;
 }
 
+std::vector<const char*> getRequiredDeviceExtensions(const bool headless)
+{
+	return headless ? std::vector<const char*>() : deviceExtensions;
+}
+
 int32_t rateDeviceSuitability(const VkPhysicalDevice device)
 {
 	VkPhysicalDeviceProperties deviceProperties;
@@ -121,25 +143,54 @@ int32_t rateDeviceSuitability(const VkPhysicalDevice device)
 
 VulkanContextHandle::VulkanContextHandle(Window* window) : IContextHandle(window)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	mInstance = nullptr;
 	mPhysicalDevice = nullptr;
 	mCallback = 0;
 	mCurrentFrame = 0;
+	mImageIndex = 0;
+	mFrameAcquired = false;
+	mTransientCommandPool = VK_NULL_HANDLE;
+	mSurface = VK_NULL_HANDLE;
+	mSwapChain = VK_NULL_HANDLE;
+	mHeadless = window->isHeadless();
+	mReadbackBuffer = VK_NULL_HANDLE;
+	mReadbackMemory = VK_NULL_HANDLE;
+	mReadbackData = nullptr;
 
 	_createInstance();
 	_setupDebugCallback();
-	_createSurface();
+	if (!mHeadless)
+	{
+		_createSurface();
+	}
 	_pickPhysicalDevice();
 	_createLogicalDevice();
-	_createSwapChain();
+	if (mHeadless)
+	{
+		_createOffscreenImages();
+	}
+	else
+	{
+		_createSwapChain();
+	}
 	_createImageViews();
 
 	mRasterizer = new VulkanRasterizer(this);
 	mPipeline = new VulkanPipeline(this);
+	mImageStateTracker = new VulkanImageStateTracker();
+	mRenderPassCache = new RenderPassCache(this);
+
+	mUploadRing = new VulkanUploadRing(this);
+	mUploadRing->construct();
 }
 
 VulkanContextHandle::~VulkanContextHandle()
 {
+	// Waits for the uploads still in flight
+	delete mUploadRing;
+
 	for(size_t i = 0; i < maxFramesInFlight; i++)
 	{
 		vkDestroySemaphore(mDevice, mRenderFinishedSemaphore[i], nullptr);
@@ -152,19 +203,39 @@ VulkanContextHandle::~VulkanContextHandle()
 		delete mCommandPools[i];
 	}
 
-	for(auto framebuffer : mSwapChainFrameBuffers)
+	if (mTransientCommandPool != VK_NULL_HANDLE)
 	{
-		vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
+		vkDestroyCommandPool(mDevice, mTransientCommandPool, nullptr);
 	}
 
 	delete mPipeline;
+	delete mRenderPassCache;
+	delete mImageStateTracker;
 
 	for(auto imageView : mSwapChainImageViews)
 	{
 		vkDestroyImageView(mDevice, imageView, nullptr);
 	}
 
-	vkDestroySwapchainKHR(mDevice, mSwapChain, nullptr);
+	if (mHeadless)
+	{
+		for (size_t i = 0; i < mSwapChainImages.size(); i++)
+		{
+			vkDestroyImage(mDevice, mSwapChainImages[i], nullptr);
+			vkFreeMemory(mDevice, mOffscreenMemory[i], nullptr);
+		}
+	}
+	else
+	{
+		vkDestroySwapchainKHR(mDevice, mSwapChain, nullptr);
+	}
+
+	if (mReadbackBuffer != VK_NULL_HANDLE)
+	{
+		vkUnmapMemory(mDevice, mReadbackMemory);
+		vkDestroyBuffer(mDevice, mReadbackBuffer, nullptr);
+		vkFreeMemory(mDevice, mReadbackMemory, nullptr);
+	}
 
 	vkDestroyDevice(mDevice, nullptr);
 
@@ -179,7 +250,10 @@ VulkanContextHandle::~VulkanContextHandle()
 		}
 	}
 
-	vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+	if (!mHeadless)
+	{
+		vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+	}
 	vkDestroyInstance(mInstance, nullptr);
 
 	mInstance = nullptr;
@@ -190,7 +264,9 @@ VulkanContextHandle::VulkanContextHandle(VulkanContextHandle&& other) noexcept :
 {
 	this->mCurrentFrame = other.mCurrentFrame;
 	this->mImageIndex = other.mImageIndex;
+	this->mFrameAcquired = other.mFrameAcquired; other.mFrameAcquired = false;
 	this->mCallback = other.mCallback; other.mCallback = nullptr;
+	this->mTransientCommandPool = other.mTransientCommandPool; other.mTransientCommandPool = VK_NULL_HANDLE;
 	this->mDevice = other.mDevice; other.mDevice = nullptr;
 	this->mGraphicsQueue = other.mGraphicsQueue; other.mGraphicsQueue = nullptr;
 	this->mInstance = other.mInstance; other.mInstance = nullptr;
@@ -198,6 +274,9 @@ VulkanContextHandle::VulkanContextHandle(VulkanContextHandle&& other) noexcept :
 	this->mPipeline = other.mPipeline; other.mPipeline = nullptr;
 	this->mPresentQueue = other.mPresentQueue; other.mPresentQueue = nullptr;
 	this->mRasterizer = other.mRasterizer; other.mRasterizer = nullptr;
+	this->mImageStateTracker = other.mImageStateTracker; other.mImageStateTracker = nullptr;
+	this->mRenderPassCache = other.mRenderPassCache; other.mRenderPassCache = nullptr;
+	this->mUploadRing = other.mUploadRing; other.mUploadRing = nullptr;
 	this->mSurface = other.mSurface; other.mSurface = nullptr;
 	this->mSwapChain = other.mSwapChain; other.mSwapChain = nullptr;
 	this->mSwapChainExtent = other.mSwapChainExtent;
@@ -205,15 +284,24 @@ VulkanContextHandle::VulkanContextHandle(VulkanContextHandle&& other) noexcept :
 	this->mSwapChainImageFormat = other.mSwapChainImageFormat;
 	this->mSwapChainImages = other.mSwapChainImages; other.mSwapChainImages.clear();
 	this->mSwapChainImageViews = other.mSwapChainImageViews; other.mSwapChainImageViews.clear();
+	this->mHeadless = other.mHeadless;
+	this->mOffscreenMemory = other.mOffscreenMemory; other.mOffscreenMemory.clear();
+	this->mReadbackBuffer = other.mReadbackBuffer; other.mReadbackBuffer = VK_NULL_HANDLE;
+	this->mReadbackMemory = other.mReadbackMemory; other.mReadbackMemory = VK_NULL_HANDLE;
+	this->mReadbackData = other.mReadbackData; other.mReadbackData = nullptr;
 }
 
 void VulkanContextHandle::initializeGraphics()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	_createGraphicsPipeline();
 }
 
 void VulkanContextHandle::finalizeGraphics()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	_createSyncObjects();
 }
 
@@ -230,30 +318,115 @@ qtl::vector<VulkanCommandPool*> VulkanContextHandle::getCommandPools()
 	return mCommandPools;
 }
 
+VkCommandBuffer VulkanContextHandle::beginSingleTimeCommands()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	if (mTransientCommandPool == VK_NULL_HANDLE)
+	{
+		QueueFamilyIndices indices = findQueueFamilies(mPhysicalDevice, mSurface);
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = indices.graphicsFamily.value();
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		const VkResult result = vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mTransientCommandPool);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create transient command pool!");
+	}
+
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = mTransientCommandPool;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	vkAllocateCommandBuffers(mDevice, &allocInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	return commandBuffer;
+}
+
+void VulkanContextHandle::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(mGraphicsQueue);
+
+	vkFreeCommandBuffers(mDevice, mTransientCommandPool, 1, &commandBuffer);
+}
+
 void VulkanContextHandle::startFrame()
 {
-	vkWaitForFences(getLogicalDevice(), 1, &getFences()[mCurrentFrame],
+	QGFX_PROFILE_FUNCTION();
+
+	vkWaitForFences(getLogicalDevice(), 1, &mInFlightFences[mCurrentFrame],
 		VK_TRUE, std::numeric_limits<uint64_t>::max());
-	VkResult result = vkAcquireNextImageKHR(getLogicalDevice(), getSwapChain(),
-		std::numeric_limits<uint64_t>::max(), getImageSemaphore()[mCurrentFrame], VK_NULL_HANDLE, &mImageIndex);
 
-	if(result == VK_ERROR_OUT_OF_DATE_KHR)
+	mFrameAcquired = false;
+
+	if(mHeadless)
 	{
-		// TODO (Roderick): Implement this function
-		// _recreateSwapChain();
-		return;
+		// There is nothing to acquire, each frame in flight renders into its own offscreen image
+		mImageIndex = mCurrentFrame;
 	}
-	else if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	else
 	{
-		QGFX_ASSERT_MSG(false, "Failed to acquire swap chain image!");
+		VkResult result = vkAcquireNextImageKHR(getLogicalDevice(), getSwapChain(),
+			std::numeric_limits<uint64_t>::max(), mImageAvailableSemaphore[mCurrentFrame], VK_NULL_HANDLE, &mImageIndex);
+
+		if(result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			// TODO (Roderick): Implement this function
+			// _recreateSwapChain();
+			return;
+		}
+		else if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			QGFX_ASSERT_MSG(false, "Failed to acquire swap chain image!");
+		}
+	}
+
+	// The image may still be in use by an older frame in flight. Waiting on that frame's fence
+	// makes the command buffers belonging to this image safe to re-record before endFrame().
+	if(mImagesInFlight[mImageIndex] != VK_NULL_HANDLE)
+	{
+		vkWaitForFences(getLogicalDevice(), 1, &mImagesInFlight[mImageIndex], VK_TRUE, std::numeric_limits<uint64_t>::max());
+	}
+	mImagesInFlight[mImageIndex] = mInFlightFences[mCurrentFrame];
+
+	mFrameAcquired = true;
+}
+
+void VulkanContextHandle::endFrame()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	if(!mFrameAcquired)
+	{
+		return;
 	}
 
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore waitSemaphores[] = {getImageSemaphore()[mCurrentFrame] };
+	VkSemaphore waitSemaphores[] = { mImageAvailableSemaphore[mCurrentFrame] };
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.waitSemaphoreCount = mHeadless ? 0 : 1;
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
 
@@ -262,28 +435,37 @@ void VulkanContextHandle::startFrame()
 	VkCommandBuffer buffers[] = { mCommandPools[0]->getBuffers()[mImageIndex]->getBuffer() };
 	submitInfo.pCommandBuffers = buffers;
 
-	VkSemaphore signalSemaphores[] = { getRenderSemaphore()[mCurrentFrame] };
-	submitInfo.signalSemaphoreCount = 1;
+	VkSemaphore signalSemaphores[] = { mRenderFinishedSemaphore[mCurrentFrame] };
+	submitInfo.signalSemaphoreCount = mHeadless ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	vkResetFences(getLogicalDevice(), 1, &getFences()[mCurrentFrame]);
+	vkResetFences(getLogicalDevice(), 1, &mInFlightFences[mCurrentFrame]);
 
-	result = vkQueueSubmit(getGraphicsQueue(), 1, &submitInfo,
-		getFences()[mCurrentFrame]);
+	const VkResult result = vkQueueSubmit(getGraphicsQueue(), 1, &submitInfo,
+		mInFlightFences[mCurrentFrame]);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to submit draw command buffer!");
 }
 
-void VulkanContextHandle::endFrame()
-{
-	
-}
-
 void VulkanContextHandle::swap()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	if(!mFrameAcquired)
+	{
+		return;
+	}
+
+	if(mHeadless)
+	{
+		mCurrentFrame = (mCurrentFrame + 1) % maxFramesInFlight;
+		mFrameAcquired = false;
+		return;
+	}
+
 	VkPresentInfoKHR presentInfo = {};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-	VkSemaphore signalSemaphores[] = { getRenderSemaphore()[mCurrentFrame] };
+	VkSemaphore signalSemaphores[] = { mRenderFinishedSemaphore[mCurrentFrame] };
 
 	presentInfo.waitSemaphoreCount = 1;
 	presentInfo.pWaitSemaphores = signalSemaphores;
@@ -297,6 +479,102 @@ void VulkanContextHandle::swap()
 	vkQueuePresentKHR(getPresentQueue(), &presentInfo);
 
 	mCurrentFrame = (mCurrentFrame + 1) % maxFramesInFlight;
+	mFrameAcquired = false;
+}
+
+bool VulkanContextHandle::isImageFormatSupported(const ImageFormat format, const ImageDataType type) const
+{
+	return VulkanImage2D::isFormatSupported(mPhysicalDevice, format, type);
+}
+
+uint32_t VulkanContextHandle::getMaxSampleCount() const
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(mPhysicalDevice, &properties);
+
+	const VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+	for (uint32_t samples = VK_SAMPLE_COUNT_64_BIT; samples > VK_SAMPLE_COUNT_1_BIT; samples >>= 1)
+	{
+		if ((counts & samples) != 0)
+		{
+			return samples;
+		}
+	}
+
+	return 1;
+}
+
+void VulkanContextHandle::readBackBuffer(uint8_t* destination)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mHeadless, "Only headless contexts can read back, swap chain images are not copy sources.\n");
+
+	if (mReadbackBuffer == VK_NULL_HANDLE)
+	{
+		_createReadbackBuffer();
+	}
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+	// Orders the copy after the render pass of the frame, which was submitted to the same queue
+	VkImageMemoryBarrier imageBarrier = {};
+	imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.image = mSwapChainImages[mImageIndex];
+	imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { mSwapChainExtent.width, mSwapChainExtent.height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, mSwapChainImages[mImageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		mReadbackBuffer, 1, &region);
+
+	VkBufferMemoryBarrier bufferBarrier = {};
+	bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = mReadbackBuffer;
+	bufferBarrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+	endSingleTimeCommands(commandBuffer);
+
+	VkMappedMemoryRange range = {};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = mReadbackMemory;
+	range.size = VK_WHOLE_SIZE;
+	vkInvalidateMappedMemoryRanges(mDevice, 1, &range);
+
+	memcpy(destination, mReadbackData, static_cast<size_t>(mSwapChainExtent.width) * mSwapChainExtent.height * 4);
+}
+
+VulkanImageStateTracker* VulkanContextHandle::getImageStateTracker() const
+{
+	return mImageStateTracker;
+}
+
+RenderPassCache* VulkanContextHandle::getRenderPassCache() const
+{
+	return mRenderPassCache;
+}
+
+VulkanUploadRing* VulkanContextHandle::getUploadRing() const
+{
+	return mUploadRing;
 }
 
 VkInstance VulkanContextHandle::getInstance() const
@@ -317,6 +595,7 @@ VkDevice VulkanContextHandle::getLogicalDevice() const
 VulkanContextHandle& VulkanContextHandle::operator=(VulkanContextHandle&& other) noexcept
 {
 	this->mCallback = other.mCallback; other.mCallback = nullptr;
+	this->mTransientCommandPool = other.mTransientCommandPool; other.mTransientCommandPool = VK_NULL_HANDLE;
 	this->mDevice = other.mDevice; other.mDevice = nullptr;
 	this->mGraphicsQueue = other.mGraphicsQueue; other.mGraphicsQueue = nullptr;
 	this->mInstance = other.mInstance; other.mInstance = nullptr;
@@ -324,6 +603,9 @@ VulkanContextHandle& VulkanContextHandle::operator=(VulkanContextHandle&& other)
 	this->mPipeline = other.mPipeline; other.mPipeline = nullptr;
 	this->mPresentQueue = other.mPresentQueue; other.mPresentQueue = nullptr;
 	this->mRasterizer = other.mRasterizer; other.mRasterizer = nullptr;
+	this->mImageStateTracker = other.mImageStateTracker; other.mImageStateTracker = nullptr;
+	this->mRenderPassCache = other.mRenderPassCache; other.mRenderPassCache = nullptr;
+	this->mUploadRing = other.mUploadRing; other.mUploadRing = nullptr;
 	this->mSurface = other.mSurface; other.mSurface = nullptr;
 	this->mSwapChain = other.mSwapChain; other.mSwapChain = nullptr;
 	this->mSwapChainExtent = other.mSwapChainExtent;
@@ -331,6 +613,11 @@ VulkanContextHandle& VulkanContextHandle::operator=(VulkanContextHandle&& other)
 	this->mSwapChainImageFormat = other.mSwapChainImageFormat;
 	this->mSwapChainImages = other.mSwapChainImages; other.mSwapChainImages.clear();
 	this->mSwapChainImageViews = other.mSwapChainImageViews; other.mSwapChainImageViews.clear();
+	this->mHeadless = other.mHeadless;
+	this->mOffscreenMemory = other.mOffscreenMemory; other.mOffscreenMemory.clear();
+	this->mReadbackBuffer = other.mReadbackBuffer; other.mReadbackBuffer = VK_NULL_HANDLE;
+	this->mReadbackMemory = other.mReadbackMemory; other.mReadbackMemory = VK_NULL_HANDLE;
+	this->mReadbackData = other.mReadbackData; other.mReadbackData = nullptr;
 
 	return *this;
 }
@@ -355,7 +642,7 @@ VkFormat VulkanContextHandle::getSwapChainFormat() const
 	return mSwapChainImageFormat;
 }
 
-qtl::vector<VkFramebuffer> VulkanContextHandle::getSwapChainFramebuffers() const
+qtl::vector<VulkanFrameBuffer*> VulkanContextHandle::getSwapChainFramebuffers() const
 {
 	return mSwapChainFrameBuffers;
 }
@@ -375,6 +662,11 @@ qtl::vector<VkFence> VulkanContextHandle::getFences() const
 	return mInFlightFences;
 }
 
+VkImageLayout VulkanContextHandle::getSwapChainLayout() const
+{
+	return mHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 VkQueue VulkanContextHandle::getGraphicsQueue() const
 {
 	return mGraphicsQueue;
@@ -395,6 +687,16 @@ VulkanRasterizer* VulkanContextHandle::getRasterizer() const
 	return mRasterizer;
 }
 
+uint32_t VulkanContextHandle::getCurrentImageIndex() const
+{
+	return mImageIndex;
+}
+
+VkImage VulkanContextHandle::getCurrentSwapChainImage() const
+{
+	return mSwapChainImages[mImageIndex];
+}
+
 void VulkanContextHandle::_createInstance()
 {
 	VkApplicationInfo appInfo = {};
@@ -409,7 +711,7 @@ void VulkanContextHandle::_createInstance()
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	createInfo.pApplicationInfo = &appInfo;
 
-	auto extensions = getRequiredExtensions();
+	auto extensions = getRequiredExtensions(mHeadless);
 
 	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 	createInfo.ppEnabledExtensionNames = extensions.data();
@@ -521,8 +823,9 @@ void VulkanContextHandle::_createLogicalDevice()
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	const std::vector<const char*> extensions = getRequiredDeviceExtensions(mHeadless);
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
 
 	if(enableValidationLayers)
 	{
@@ -606,6 +909,80 @@ void VulkanContextHandle::_createSwapChain()
 	vkGetSwapchainImagesKHR(mDevice, mSwapChain, &imageCount, mSwapChainImages.data());
 }
 
+void VulkanContextHandle::_createOffscreenImages()
+{
+	mSwapChainImageFormat = offscreenFormat;
+	mSwapChainExtent = { mWindow->getWidth(), mWindow->getHeight() };
+
+	mSwapChainImages.resize(maxFramesInFlight);
+	mOffscreenMemory.resize(maxFramesInFlight);
+
+	for (size_t i = 0; i < mSwapChainImages.size(); i++)
+	{
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = mSwapChainImageFormat;
+		imageInfo.extent = { mSwapChainExtent.width, mSwapChainExtent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkResult result = vkCreateImage(mDevice, &imageInfo, nullptr, &mSwapChainImages[i]);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create offscreen image!");
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(mDevice, mSwapChainImages[i], &requirements);
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = requirements.size;
+		allocInfo.memoryTypeIndex = findMemoryType(mPhysicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		result = vkAllocateMemory(mDevice, &allocInfo, nullptr, &mOffscreenMemory[i]);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate offscreen image memory!");
+
+		vkBindImageMemory(mDevice, mSwapChainImages[i], mOffscreenMemory[i], 0);
+	}
+}
+
+void VulkanContextHandle::_createReadbackBuffer()
+{
+	const VkDeviceSize size = static_cast<VkDeviceSize>(mSwapChainExtent.width) * mSwapChainExtent.height * 4;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkResult result = vkCreateBuffer(mDevice, &bufferInfo, nullptr, &mReadbackBuffer);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create readback buffer!");
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(mDevice, mReadbackBuffer, &requirements);
+
+	// Uncached host memory is write combined, reading it back from the CPU is very slow
+	const VkMemoryPropertyFlags visible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	const VkMemoryPropertyFlags cached = visible | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = requirements.size;
+	allocInfo.memoryTypeIndex = findMemoryType(mPhysicalDevice, requirements.memoryTypeBits,
+		hasMemoryType(mPhysicalDevice, requirements.memoryTypeBits, cached) ? cached : visible);
+
+	result = vkAllocateMemory(mDevice, &allocInfo, nullptr, &mReadbackMemory);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate readback memory!");
+
+	vkBindBufferMemory(mDevice, mReadbackBuffer, mReadbackMemory, 0);
+	vkMapMemory(mDevice, mReadbackMemory, 0, VK_WHOLE_SIZE, 0, &mReadbackData);
+}
+
 void VulkanContextHandle::_createImageViews()
 {
 	mSwapChainImageViews.resize(mSwapChainImages.size());
@@ -647,21 +1024,9 @@ void VulkanContextHandle::_createFrameBuffers()
 
 	for(size_t i = 0; i < mSwapChainImageViews.size(); i++)
 	{
-		VkImageView attachments[] = {
-			mSwapChainImageViews[i]
-		};
-
-		VkFramebufferCreateInfo framebufferInfo = {};
-		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebufferInfo.renderPass = mPipeline->getRenderPass();
-		framebufferInfo.attachmentCount = 1;
-		framebufferInfo.pAttachments = attachments;
-		framebufferInfo.width = mSwapChainExtent.width;
-		framebufferInfo.height = mSwapChainExtent.height;
-		framebufferInfo.layers = 1;
-
-		const VkResult result = vkCreateFramebuffer(mDevice, &framebufferInfo, nullptr, &mSwapChainFrameBuffers[i]);
-		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create framebuffer!");
+		const FrameBufferAttachment attachment = { mSwapChainImageViews[i], nullptr };
+		mSwapChainFrameBuffers[i] = mRenderPassCache->acquire(mPipeline->getRenderPass(), &attachment, 1, mSwapChainExtent.width,
+			mSwapChainExtent.height);
 	}
 }
 
@@ -670,6 +1035,7 @@ void VulkanContextHandle::_createSyncObjects()
 	mImageAvailableSemaphore.resize(maxFramesInFlight);
 	mRenderFinishedSemaphore.resize(maxFramesInFlight);
 	mInFlightFences.resize(maxFramesInFlight);
+	mImagesInFlight.resize(mSwapChainImages.size());
 
 	VkSemaphoreCreateInfo semaphoreInfo = {};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -685,6 +1051,11 @@ void VulkanContextHandle::_createSyncObjects()
 			QGFX_ASSERT(false);
 		}
 	}
+
+	for (size_t i = 0; i < mImagesInFlight.size(); i++)
+	{
+		mImagesInFlight[i] = VK_NULL_HANDLE;
+	}
 }
 
 VkSurfaceFormatKHR VulkanContextHandle::_chooseSwapSurfaceFormat(
@@ -749,8 +1120,8 @@ bool VulkanContextHandle::_isDeviceSuitable(const VkPhysicalDevice device) const
 
 	const bool extensionSupported = _checkDeviceExtensionSupport(device);
 
-	bool swapChainAdequate = false;
-	if(extensionSupported)
+	bool swapChainAdequate = mHeadless;
+	if(extensionSupported && !mHeadless)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, mSurface);
 		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -759,15 +1130,17 @@ bool VulkanContextHandle::_isDeviceSuitable(const VkPhysicalDevice device) const
 	return indices.isComplete() && extensionSupported && swapChainAdequate;
 }
 
-bool VulkanContextHandle::_checkDeviceExtensionSupport(const VkPhysicalDevice device)
+bool VulkanContextHandle::_checkDeviceExtensionSupport(const VkPhysicalDevice device) const
 {
+	const std::vector<const char*> extensions = getRequiredDeviceExtensions(mHeadless);
+
 	uint32_t extensionCount;
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+	std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 
 	for(const auto& extension : availableExtensions)
 	{
@@ -0,0 +1,414 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_frame_graph.h"
+#include "qgfx/vulkan/vulkan_commandbuffer.h"
+#include "qgfx/vulkan/vulkan_context_handle.h"
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/render_pass_cache.h"
+#include "qgfx/qassert.h"
+#include "qgfx/vulkan/vulkan_memory.h"
+
+#include <cstring>
+
+static VkPipelineStageFlags getPipelineStages(const ShaderStage stages)
+{
+	VkPipelineStageFlags flags = 0;
+	if ((stages & ShaderStage::Vertex) == ShaderStage::Vertex)
+	{
+		flags |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+	}
+
+	if ((stages & ShaderStage::Fragment) == ShaderStage::Fragment)
+	{
+		flags |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+
+	if ((stages & ShaderStage::Compute) == ShaderStage::Compute)
+	{
+		flags |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+
+	return flags;
+}
+
+VulkanFrameGraph::VulkanFrameGraph(ContextHandle* handle)
+	: IFrameGraph(handle), mBarriersBefore(0)
+{
+}
+
+VulkanFrameGraph::~VulkanFrameGraph()
+{
+	reset();
+}
+
+void* VulkanFrameGraph::getImageHandle(const FrameGraphResource resource) const
+{
+	return mImages[_getResourceIndex(resource)].image;
+}
+
+VkImageView VulkanFrameGraph::getImageView(const FrameGraphResource resource) const
+{
+	return mImages[_getResourceIndex(resource)].view;
+}
+
+RenderPass* VulkanFrameGraph::getRenderPass(const char* pass) const
+{
+	for (size_t i = 0; i < mPasses.size(); i++)
+	{
+		if (strcmp(mPasses[i].name.c_str(), pass) == 0)
+		{
+			return mRenderPasses[i];
+		}
+	}
+
+	return nullptr;
+}
+
+bool VulkanFrameGraph::_canAlias(const FrameGraphTextureDescription& a, const FrameGraphTextureDescription& b) const
+{
+	// Color and depth images have different usage and may need different memory types
+	return hasDepthAspect(a.imageType) == hasDepthAspect(b.imageType);
+}
+
+void VulkanFrameGraph::_createResources()
+{
+	VkDevice device = mHandle->getLogicalDevice();
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+
+	mImages.clear();
+	for (uint32_t index = 0; index < mResources.size(); index++)
+	{
+		mImages.push_back({ VK_NULL_HANDLE, VK_NULL_HANDLE, VK_FORMAT_UNDEFINED, false });
+	}
+
+	uint32_t slotCount = 0;
+	for (uint32_t index = 0; index < mResources.size(); index++)
+	{
+		const ResourceNode& resource = mResources[index];
+		PhysicalImage& physical = mImages[index];
+
+		if (resource.imported != nullptr)
+		{
+			physical.image = reinterpret_cast<VkImage>(resource.imported->getImageHandle());
+			physical.format = resource.imported->getFormat();
+		}
+		else if (resource.slot != 0xFFFFFFFF)
+		{
+			const FrameGraphTextureDescription& description = resource.description;
+			if (hasDepthAspect(description.imageType))
+			{
+				physical.format = getVulkanDepthFormat(description.imageType);
+			}
+			else
+			{
+				physical.format = convertQgfxFormatToVulkan(description.format, description.type);
+			}
+			QGFX_ASSERT_MSG(physical.format != VK_FORMAT_UNDEFINED, "Frame graph texture %s has no Vulkan format.\n", resource.name.c_str());
+
+			VkImageCreateInfo imageInfo = {};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent = { description.width, description.height, 1 };
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = physical.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = hasDepthAspect(description.imageType) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+			if (resource.lazy)
+			{
+				// Lets the memory come from a lazily allocated heap where the device has one
+				imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+			}
+			else if (description.samples == 1)
+			{
+				imageInfo.usage |= VK_IMAGE_USAGE_SAMPLED_BIT | (hasDepthAspect(description.imageType) ? 0 : VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+			}
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			QGFX_ASSERT_MSG(description.samples <= mHandle->getMaxSampleCount() && (description.samples & (description.samples - 1)) == 0,
+				"Frame graph texture %s has an unsupported sample count.\n", resource.name.c_str());
+			imageInfo.samples = static_cast<VkSampleCountFlagBits>(description.samples);
+
+			[[maybe_unused]] const VkResult result = vkCreateImage(device, &imageInfo, nullptr, &physical.image);
+			QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create frame graph image %s.\n", resource.name.c_str());
+
+			physical.owned = true;
+			tracker->addImage(physical.image, 1, getVulkanAspectFlags(description.imageType));
+
+			slotCount = resource.slot + 1 > slotCount ? resource.slot + 1 : slotCount;
+		}
+		else
+		{
+			continue;
+		}
+
+		VkImageViewCreateInfo viewInfo = {};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = physical.image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = physical.format;
+		viewInfo.subresourceRange.aspectMask = getVulkanAspectFlags(resource.description.imageType) & ~VK_IMAGE_ASPECT_STENCIL_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		[[maybe_unused]] const VkResult result = vkCreateImageView(device, &viewInfo, nullptr, &physical.view);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create frame graph image view %s.\n", resource.name.c_str());
+	}
+
+	// Every image in a slot is bound to the start of one allocation large enough for the biggest
+	mMemory.clear();
+	for (uint32_t slot = 0; slot < slotCount; slot++)
+	{
+		mMemory.push_back(VK_NULL_HANDLE);
+	}
+	mStatistics.physicalTextures = slotCount;
+
+	for (uint32_t slot = 0; slot < slotCount; slot++)
+	{
+		VkDeviceSize size = 0;
+		uint32_t memoryTypeBits = 0xFFFFFFFF;
+		bool lazy = false;
+
+		// Lazy resources are only ever aliased with each other
+		for (uint32_t index = 0; index < mResources.size(); index++)
+		{
+			if (mResources[index].imported == nullptr && mResources[index].slot == slot)
+			{
+				lazy = mResources[index].lazy;
+
+				VkMemoryRequirements requirements;
+				vkGetImageMemoryRequirements(device, mImages[index].image, &requirements);
+
+				size = requirements.size > size ? requirements.size : size;
+				memoryTypeBits &= requirements.memoryTypeBits;
+				mStatistics.transientBytes += requirements.size;
+			}
+		}
+		QGFX_ASSERT_MSG(memoryTypeBits != 0, "Aliased frame graph images have no memory type in common.\n");
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = lazy ? findTransientMemoryType(mHandle->getPhysicalDevice(), memoryTypeBits) :
+			findMemoryType(mHandle->getPhysicalDevice(), memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		[[maybe_unused]] const VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &mMemory[slot]);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate frame graph memory.\n");
+		mStatistics.allocatedBytes += size;
+
+		for (uint32_t index = 0; index < mResources.size(); index++)
+		{
+			if (mResources[index].imported == nullptr && mResources[index].slot == slot)
+			{
+				vkBindImageMemory(device, mImages[index].image, mMemory[slot], 0);
+			}
+		}
+	}
+
+	mRenderPasses.clear();
+	mFrameBuffers.clear();
+	for (uint32_t index = 0; index < mPasses.size(); index++)
+	{
+		mRenderPasses.push_back(nullptr);
+		mFrameBuffers.push_back(nullptr);
+	}
+
+	for (const auto index : mSchedule)
+	{
+		if (!mPasses[index].colorAttachments.empty() || mPasses[index].hasDepthAttachment)
+		{
+			_createRenderPass(index);
+		}
+	}
+}
+
+void VulkanFrameGraph::_createRenderPass(const uint32_t index)
+{
+	const PassNode& pass = mPasses[index];
+
+	RenderPassDescription description;
+	qtl::vector<FrameBufferAttachment> attachments;
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t samples = 0;
+
+	auto addAttachment = [&](const Attachment& attachment)
+	{
+		const ResourceNode& resource = mResources[attachment.resource];
+
+		QGFX_ASSERT_MSG(width == 0 || (width == resource.description.width && height == resource.description.height),
+			"Attachments of pass %s differ in size.\n", pass.name.c_str());
+		width = resource.description.width;
+		height = resource.description.height;
+
+		RenderPassAttachment info;
+		info.format = resource.description.format;
+		info.type = resource.description.type;
+		info.imageType = resource.description.imageType;
+		info.loadOp = attachment.clear ? AttachmentLoadOp::Clear : AttachmentLoadOp::Load;
+		info.storeOp = attachment.store ? AttachmentStoreOp::Store : AttachmentStoreOp::DontCare;
+		info.stencilLoadOp = info.loadOp;
+		info.stencilStoreOp = info.storeOp;
+
+		attachments.push_back({ mImages[attachment.resource].view, mImages[attachment.resource].image });
+		return info;
+	};
+
+	// Resolve targets are single sampled, everything the pass renders to has to agree
+	auto addRendered = [&](const Attachment& attachment)
+	{
+		const uint32_t count = mResources[attachment.resource].description.samples;
+		QGFX_ASSERT_MSG(samples == 0 || samples == count, "Attachments of pass %s differ in sample count.\n", pass.name.c_str());
+		samples = count;
+
+		return addAttachment(attachment);
+	};
+
+	for (const auto& attachment : pass.colorAttachments)
+	{
+		description.addColorAttachment(addRendered(attachment));
+	}
+
+	if (pass.hasDepthAttachment)
+	{
+		description.setDepthAttachment(addRendered(pass.depthAttachment));
+	}
+
+	description.samples = samples;
+	for (uint32_t i = 0; i < pass.resolveAttachments.size(); i++)
+	{
+		if (pass.resolveAttachments[i].resource != 0xFFFFFFFF)
+		{
+			description.setResolveAttachment(i, addAttachment(pass.resolveAttachments[i]));
+		}
+	}
+
+	RenderPassCache* cache = mHandle->getRenderPassCache();
+	mRenderPasses[index] = cache->acquire(description);
+	mFrameBuffers[index] = cache->acquire(mRenderPasses[index], attachments.data(), static_cast<uint32_t>(attachments.size()), width, height);
+}
+
+void VulkanFrameGraph::_destroyResources()
+{
+	VkDevice device = mHandle->getLogicalDevice();
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+
+	// Resources may still be in use by frames in flight
+	vkDeviceWaitIdle(device);
+
+	// Render passes stay cached, they are keyed by formats and are likely to be needed again
+	for (auto& physical : mImages)
+	{
+		if (physical.view != VK_NULL_HANDLE)
+		{
+			mHandle->getRenderPassCache()->evict(physical.view);
+			vkDestroyImageView(device, physical.view, nullptr);
+		}
+
+		if (physical.owned)
+		{
+			tracker->removeImage(physical.image);
+			vkDestroyImage(device, physical.image, nullptr);
+		}
+	}
+
+	for (auto memory : mMemory)
+	{
+		vkFreeMemory(device, memory, nullptr);
+	}
+
+	mImages.clear();
+	mMemory.clear();
+	mRenderPasses.clear();
+	mFrameBuffers.clear();
+}
+
+void VulkanFrameGraph::_beginExecute(CommandBuffer* commandBuffer)
+{
+	(void)commandBuffer;
+	mBarriersBefore = mHandle->getImageStateTracker()->getStatistics().pipelineBarriers;
+}
+
+void VulkanFrameGraph::_endExecute(CommandBuffer* commandBuffer)
+{
+	(void)commandBuffer;
+	mStatistics.barriers = mHandle->getImageStateTracker()->getStatistics().pipelineBarriers - mBarriersBefore;
+}
+
+void VulkanFrameGraph::_beginPass(const PassNode& pass, CommandBuffer* commandBuffer)
+{
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+	const uint32_t index = static_cast<uint32_t>(&pass - mPasses.data());
+
+	for (const auto& sampled : pass.sampled)
+	{
+		const ResourceNode& resource = mResources[sampled.resource];
+		const uint32_t levels = resource.imported ? resource.imported->getMipLevels() : 1;
+		tracker->transition(mImages[sampled.resource].image, 0, levels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_SHADER_READ_BIT, getPipelineStages(sampled.stages));
+	}
+
+	// The first pass in an aliased slot waits for the previous user of the memory
+	auto alias = [&](const Attachment& attachment)
+	{
+		const ResourceNode& resource = mResources[attachment.resource];
+		if (attachment.clear && resource.aliasedFrom != 0xFFFFFFFF)
+		{
+			tracker->aliasImage(mImages[resource.aliasedFrom].image, mImages[attachment.resource].image);
+		}
+	};
+
+	qtl::vector<ClearValue> clearValues;
+	for (const auto& attachment : pass.resolveAttachments)
+	{
+		if (attachment.resource != 0xFFFFFFFF)
+		{
+			alias(attachment);
+		}
+	}
+
+	for (const auto& attachment : pass.colorAttachments)
+	{
+		alias(attachment);
+
+		ClearValue value = {};
+		memcpy(value.color, mResources[attachment.resource].description.clearColor, sizeof(value.color));
+		clearValues.push_back(value);
+	}
+
+	if (pass.hasDepthAttachment)
+	{
+		alias(pass.depthAttachment);
+
+		ClearValue value = {};
+		value.depth = mResources[pass.depthAttachment.resource].description.clearDepth;
+		clearValues.push_back(value);
+	}
+
+	// Attachment barriers join the sampled ones when the render pass begins
+	if (mRenderPasses[index] == nullptr)
+	{
+		tracker->flush(commandBuffer->getBuffer());
+		return;
+	}
+
+	commandBuffer->beginRenderPass(mRenderPasses[index], mFrameBuffers[index], clearValues.data());
+}
+
+void VulkanFrameGraph::_endPass(const PassNode& pass, CommandBuffer* commandBuffer)
+{
+	const uint32_t index = static_cast<uint32_t>(&pass - mPasses.data());
+	if (mRenderPasses[index] != nullptr)
+	{
+		commandBuffer->endRenderPass();
+	}
+}
+
+#endif // QGFX_VULKAN
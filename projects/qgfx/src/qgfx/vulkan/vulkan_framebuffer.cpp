@@ -0,0 +1,53 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_framebuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/qassert.h"
+
+VulkanFrameBuffer::VulkanFrameBuffer(ContextHandle* handle)
+	: IFrameBuffer(handle), mFrameBuffer(VK_NULL_HANDLE)
+{
+}
+
+VulkanFrameBuffer::~VulkanFrameBuffer()
+{
+	if (mFrameBuffer != VK_NULL_HANDLE)
+	{
+		vkDestroyFramebuffer(mHandle->getLogicalDevice(), mFrameBuffer, nullptr);
+	}
+}
+
+void VulkanFrameBuffer::construct(RenderPass* renderPass, const FrameBufferAttachment* attachments, const uint32_t attachmentCount,
+	const uint32_t width, const uint32_t height)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(attachmentCount == renderPass->getDescription().getAttachmentCount(),
+		"Framebuffer attachments do not match the render pass.\n");
+
+	mRenderPass = renderPass;
+	mWidth = width;
+	mHeight = height;
+
+	qtl::vector<VkImageView> views;
+	for (uint32_t i = 0; i < attachmentCount; i++)
+	{
+		mAttachments.push_back(attachments[i]);
+		views.push_back(reinterpret_cast<VkImageView>(attachments[i].view));
+	}
+
+	VkFramebufferCreateInfo framebufferInfo = {};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = renderPass->getRenderPass();
+	framebufferInfo.attachmentCount = attachmentCount;
+	framebufferInfo.pAttachments = views.data();
+	framebufferInfo.width = width;
+	framebufferInfo.height = height;
+	framebufferInfo.layers = 1;
+
+	const VkResult result = vkCreateFramebuffer(mHandle->getLogicalDevice(), &framebufferInfo, nullptr, &mFrameBuffer);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create framebuffer!");
+}
+
+#endif // QGFX_VULKAN
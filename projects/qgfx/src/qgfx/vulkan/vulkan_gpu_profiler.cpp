@@ -0,0 +1,112 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_gpu_profiler.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/vulkan/queue_family.h"
+#include "qgfx/vulkan/vulkan_commandbuffer.h"
+#include "qgfx/vulkan/vulkan_context_handle.h"
+#include "qgfx/qassert.h"
+
+VulkanGpuProfiler::VulkanGpuProfiler(ContextHandle* handle, const uint32_t maxScopes, const uint32_t historyLength)
+	: IGpuProfiler(handle, maxScopes, historyLength), mTimestampPeriod(0.0), mTimestampMask(0)
+{
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	for (auto pool : mQueryPools)
+	{
+		vkDestroyQueryPool(device, pool, nullptr);
+	}
+	mQueryPools.clear();
+}
+
+void VulkanGpuProfiler::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	const uint32_t slotCount = static_cast<uint32_t>(mHandle->getSwapChainFramebuffers().size());
+	_initialize(slotCount);
+
+	const VkPhysicalDevice physicalDevice = mHandle->getPhysicalDevice();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	mTimestampPeriod = static_cast<double>(properties.limits.timestampPeriod);
+
+	QueueFamilyIndices indices = findQueueFamilies(physicalDevice, mHandle->getSurface());
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+	qtl::vector<VkQueueFamilyProperties> queueFamilies;
+	queueFamilies.resize(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	// Queues without timestamp support report 0 valid bits
+	const uint32_t validBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+	mTimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	if (!isSupported())
+	{
+		return;
+	}
+
+	VkQueryPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = mMaxScopes * 2;
+
+	mQueryPools.resize(slotCount);
+	for (auto& pool : mQueryPools)
+	{
+		VkResult result = vkCreateQueryPool(mHandle->getLogicalDevice(), &poolInfo, nullptr, &pool);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create timestamp query pool!");
+	}
+
+	mTicks.resize(mMaxScopes * 2);
+}
+
+bool VulkanGpuProfiler::isSupported() const
+{
+	return mTimestampMask != 0 && mTimestampPeriod > 0.0;
+}
+
+uint32_t VulkanGpuProfiler::_acquireSlot()
+{
+	return mHandle->getCurrentImageIndex();
+}
+
+void VulkanGpuProfiler::_resetQueries(CommandBuffer* commandBuffer, const uint32_t slot)
+{
+	vkCmdResetQueryPool(commandBuffer->getBuffer(), mQueryPools[slot], 0, mMaxScopes * 2);
+}
+
+void VulkanGpuProfiler::_writeTimestamp(CommandBuffer* commandBuffer, const uint32_t slot, const uint32_t query)
+{
+	// Both ends of a scope wait for all previous work, so a scope covers the work recorded
+	// inside it and not whatever was still in the pipeline when it began
+	vkCmdWriteTimestamp(commandBuffer->getBuffer(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPools[slot], query);
+}
+
+bool VulkanGpuProfiler::_getTimestamps(const uint32_t slot, const uint32_t count, double* milliseconds)
+{
+	const VkResult result = vkGetQueryPoolResults(mHandle->getLogicalDevice(), mQueryPools[slot], 0, count,
+		count * sizeof(uint64_t), mTicks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+	if (result != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		milliseconds[i] = static_cast<double>(mTicks[i] & mTimestampMask) * mTimestampPeriod / 1000000.0;
+	}
+
+	return true;
+}
+
+#endif
@@ -1,10 +1,18 @@
 #if defined(QGFX_VULKAN)
+#include "qgfx/image_format.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/qassert.h"
 #include "qgfx/vulkan/vulkan_memory.h"
 
 #include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/vulkan/vulkan_context_handle.h"
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/vulkan/vulkan_upload_ring.h"
 
-constexpr VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const ImageDataType type)
+#include <cstring>
+#include <numeric>
+
+VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const ImageDataType type)
 {
 	switch(format)
 	{
@@ -91,7 +99,7 @@ constexpr VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const Ima
 				case ImageDataType::Float: return VK_FORMAT_R32G32B32A32_SFLOAT;
 				case ImageDataType::UShort4_4_4_4: return VK_FORMAT_R4G4B4A4_UNORM_PACK16;
 				case ImageDataType::UShort5_5_5_1: return VK_FORMAT_R5G5B5A1_UNORM_PACK16;
-				case ImageDataType::UInt8_8_8_8: return VK_FORMAT_R8G8B8A8_UINT;
+				case ImageDataType::UInt8_8_8_8: return VK_FORMAT_R8G8B8A8_UNORM;
 				case ImageDataType::UInt10_10_10_2: return VK_FORMAT_A2R10G10B10_UINT_PACK32;
 				default: return VK_FORMAT_UNDEFINED;
 			}
@@ -124,10 +132,37 @@ constexpr VkFormat convertQgfxFormatToVulkan(const ImageFormat format, const Ima
 				default: return VK_FORMAT_UNDEFINED;
 			}
 		}
+		case ImageFormat::BC1: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case ImageFormat::BC2: return VK_FORMAT_BC2_UNORM_BLOCK;
+		case ImageFormat::BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case ImageFormat::BC4: return type == ImageDataType::Byte ? VK_FORMAT_BC4_SNORM_BLOCK : VK_FORMAT_BC4_UNORM_BLOCK;
+		case ImageFormat::BC5: return type == ImageDataType::Byte ? VK_FORMAT_BC5_SNORM_BLOCK : VK_FORMAT_BC5_UNORM_BLOCK;
+		case ImageFormat::BC6H: return type == ImageDataType::Float ? VK_FORMAT_BC6H_SFLOAT_BLOCK : VK_FORMAT_BC6H_UFLOAT_BLOCK;
+		case ImageFormat::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case ImageFormat::ETC2_RGB: return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+		case ImageFormat::ETC2_RGBA: return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+		case ImageFormat::ASTC_4x4: return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+		case ImageFormat::ASTC_6x6: return VK_FORMAT_ASTC_6x6_UNORM_BLOCK;
+		case ImageFormat::ASTC_8x8: return VK_FORMAT_ASTC_8x8_UNORM_BLOCK;
 		default: return VK_FORMAT_UNDEFINED;
 	}
 }
 
+VkFormat getVulkanDepthFormat(const ImageType type)
+{
+	return hasStencilAspect(type) ? VK_FORMAT_D32_SFLOAT_S8_UINT : VK_FORMAT_D32_SFLOAT;
+}
+
+VkImageAspectFlags getVulkanAspectFlags(const ImageType type)
+{
+	if (!hasDepthAspect(type))
+	{
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+
+	return VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencilAspect(type) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+}
+
 VulkanImage2D::VulkanImage2D(ContextHandle* handle) : IImage2D(handle)
 {
 	mImage = nullptr;
@@ -140,11 +175,25 @@ VulkanImage2D::VulkanImage2D(ContextHandle* handle) : IImage2D(handle)
 
 VulkanImage2D::~VulkanImage2D()
 {
+	if (mImage != nullptr)
+	{
+		mHandle->getImageStateTracker()->removeImage(mImage);
+	}
+
 	vkDestroyImage(mHandle->getLogicalDevice(), mImage, nullptr);
+	vkFreeMemory(mHandle->getLogicalDevice(), mMemory, nullptr);
 }
 
-void VulkanImage2D::construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType)
+void VulkanImage2D::construct(const uint32_t width, const uint32_t height, const uint8_t bpp, const ImageFormat& format, const ImageDataType& type, const ImageType& imageType,
+	const uint32_t mipLevels, const uint32_t samples)
 {
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mImage == nullptr, "Image already constructed.\n");
+	QGFX_ASSERT_MSG(mipLevels <= getMipChainLength(width, height), "Invalid number of mip levels.\n");
+	QGFX_ASSERT_MSG(samples == 1 || mipLevels == 1, "Multisampled images have a single mip level.\n");
+	QGFX_ASSERT_MSG(samples <= mHandle->getMaxSampleCount() && (samples & (samples - 1)) == 0, "Unsupported sample count %u.\n", samples);
+
 	mImageSize = static_cast<VkDeviceSize>(width) * static_cast<VkDeviceSize>(height) * static_cast<VkDeviceSize>(bpp);
 	mWidth = width;
 	mHeight = height;
@@ -153,65 +202,226 @@ void VulkanImage2D::construct(const uint32_t width, const uint32_t height, const
 	mImageFormat = format;
 	mImageDataType = type;
 	mImageType = imageType;
+	mMipLevels = mipLevels == fullMipChain ? getMipChainLength(width, height) : mipLevels;
+	mResidentMip = 0;
+	mSamples = samples;
 
-	mFormat = convertQgfxFormatToVulkan(format, type);
-}
+	mFormat = hasDepthAspect(imageType) ? getVulkanDepthFormat(imageType) : convertQgfxFormatToVulkan(format, type);
 
-void VulkanImage2D::setData(const uint8_t* data, const uint32_t dataSize)
-{
-	if (data == nullptr)
+	// The image has to exist before its memory requirements can be queried
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = mWidth;
+	imageInfo.extent.height = mHeight;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = mMipLevels;
+	imageInfo.arrayLayers = 1;
+
+	imageInfo.format = mFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// Transfer source for blitting the mip chain
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+	// Color images that the device can render to may be used as attachments, for instance by a frame graph
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(mHandle->getPhysicalDevice(), mFormat, &properties);
+	if (hasDepthAspect(imageType))
+	{
+		QGFX_ASSERT_MSG((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0, "Depth format is not supported.\n");
+		imageInfo.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	}
+	else if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) != 0 && imageType == ImageType::Color)
 	{
-		QGFX_ASSERT_MSG(false, "Data is invalid");
+		imageInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 	}
 
+	// Samples only live for the render pass that resolves them, transient images may only be attachments
+	const bool transient = samples > 1;
+	if (transient)
+	{
+		QGFX_ASSERT_MSG((imageInfo.usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0,
+			"Multisampled images must be renderable.\n");
+		imageInfo.usage = (imageInfo.usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) |
+			VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+	}
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	imageInfo.samples = static_cast<VkSampleCountFlagBits>(samples);
+	imageInfo.flags = 0;
+
+	VkResult result = vkCreateImage(mHandle->getLogicalDevice(), &imageInfo, nullptr, &mImage);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create image");
+
 	VkMemoryRequirements memRequirements;
 	vkGetImageMemoryRequirements(mHandle->getLogicalDevice(), mImage, &memRequirements);
 
 	VkMemoryAllocateInfo allocInfo = {};
 	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(mHandle->getPhysicalDevice(), memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	allocInfo.memoryTypeIndex = transient ? findTransientMemoryType(mHandle->getPhysicalDevice(), memRequirements.memoryTypeBits) :
+		findMemoryType(mHandle->getPhysicalDevice(), memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-	VkResult result = vkAllocateMemory(mHandle->getLogicalDevice(), &allocInfo, nullptr, &mMemory);
+	result = vkAllocateMemory(mHandle->getLogicalDevice(), &allocInfo, nullptr, &mMemory);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocated image memory!");
 
 	vkBindImageMemory(mHandle->getLogicalDevice(), mImage, mMemory, 0);
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
+	mHandle->getImageStateTracker()->addImage(mImage, mMipLevels, getVulkanAspectFlags(imageType));
+}
 
-	createBuffer(mHandle->getLogicalDevice(), mHandle->getPhysicalDevice(), mImageSize,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+void VulkanImage2D::setData(const uint8_t* data, const uint32_t dataSize)
+{
+	QGFX_PROFILE_FUNCTION();
 
-	void* vulkanData;
-	vkMapMemory(mHandle->getLogicalDevice(), stagingBufferMemory, 0, mImageSize, 0, &vulkanData);
-	memcpy(vulkanData, data, static_cast<size_t>(mImageSize));
-	vkUnmapMemory(mHandle->getLogicalDevice(), stagingBufferMemory);
+	setMipData(0, data, dataSize);
 
-	delete data;
+	// Block compressed mips can not be derived from the base level, they come with the texture
+	if (mMipLevels > 1 && !isCompressedImageFormat(mImageFormat))
+	{
+		if (canGenerateMips())
+		{
+			generateMips();
+		}
+		else
+		{
+			_generateMipsOnCpu(data, mWidth, mHeight);
+		}
+	}
+}
 
-	VkImageCreateInfo imageInfo = {};
-	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent.width = mWidth;
-	imageInfo.extent.height = mHeight;
-	imageInfo.extent.depth = 1;
-	imageInfo.arrayLayers = 1;
+bool VulkanImage2D::canGenerateMips() const
+{
+	if (isCompressedImageFormat(mImageFormat) || hasDepthAspect(mImageType) || mSamples > 1)
+	{
+		return false;
+	}
 
-	imageInfo.format = mFormat;
-	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(mHandle->getPhysicalDevice(), mFormat, &properties);
 
-	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (properties.optimalTilingFeatures & required) == required;
+}
 
-	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-	imageInfo.flags = 0;
+void VulkanImage2D::generateMips()
+{
+	QGFX_ASSERT_MSG(canGenerateMips(), "Format does not support linear blits, generate the mips on the CPU.\n");
 
-	result = vkCreateImage(mHandle->getLogicalDevice(), &imageInfo, nullptr, &mImage);
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+	VkCommandBuffer commandBuffer = mHandle->beginSingleTimeCommands();
 
-	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create image");
+	// Every level below the base is overwritten, so their contents can be discarded
+	tracker->transition(mImage, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	tracker->transition(mImage, 1, mMipLevels - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, true);
+	tracker->flush(commandBuffer);
+
+	int32_t width = static_cast<int32_t>(mWidth);
+	int32_t height = static_cast<int32_t>(mHeight);
+
+	for (uint32_t level = 1; level < mMipLevels; level++)
+	{
+		const int32_t nextWidth = width > 1 ? width / 2 : 1;
+		const int32_t nextHeight = height > 1 ? height / 2 : 1;
+
+		VkImageBlit blit = {};
+		blit.srcOffsets[1] = { width, height, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage(commandBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		// The new level is the source of the next blit
+		if (level + 1 < mMipLevels)
+		{
+			tracker->transition(mImage, level, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			tracker->flush(commandBuffer);
+		}
+
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	tracker->transition(mImage, 0, mMipLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	tracker->flush(commandBuffer);
+
+	mHandle->endSingleTimeCommands(commandBuffer);
+}
+
+void VulkanImage2D::setMipData(const uint32_t level, const uint8_t* data, const uint32_t dataSize)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(data != nullptr, "Data is invalid");
+	QGFX_ASSERT_MSG(mImage != nullptr, "Image has not been constructed.\n");
+	QGFX_ASSERT_MSG(level < mMipLevels, "Mip level is outside of the mip chain.\n");
+	QGFX_ASSERT_MSG(mSamples == 1, "Multisampled images can only be rendered to.\n");
+
+	const uint32_t width = mWidth >> level ? mWidth >> level : 1;
+	const uint32_t height = mHeight >> level ? mHeight >> level : 1;
+	const VkDeviceSize size = static_cast<VkDeviceSize>(getImageMipSize(mWidth, mHeight, level, mImageFormat, mImageDataType));
+
+	// Uploading from a short buffer would read past its end
+	if (dataSize < size)
+	{
+		QGFX_ASSERT_MSG(false, "Not enough data for the mip level.\n");
+		return;
+	}
+
+	// Copies from a buffer start on a multiple of both 4 bytes and the format's block size
+	const ImageBlockInfo block = getImageBlockInfo(mImageFormat, mImageDataType);
+	const VkDeviceSize alignment = std::lcm(static_cast<VkDeviceSize>(4), static_cast<VkDeviceSize>(block.size));
+
+	// Submitted without waiting, streamed mips are uploaded while frames are in flight
+	VulkanUploadRing* ring = mHandle->getUploadRing();
+	VulkanStagingAllocation staging;
+	VkCommandBuffer commandBuffer = ring->begin(size, alignment, staging);
+
+	memcpy(staging.data, data, static_cast<size_t>(size));
+	mHandle->countUpload(static_cast<size_t>(size));
+
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+
+	// The whole level is overwritten, so its previous contents can be discarded
+	tracker->transition(mImage, level, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, true);
+	tracker->flush(commandBuffer);
+
+	VkBufferImageCopy region = {};
+	region.bufferOffset = staging.offset;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = level;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { width, height, 1 };
+
+	vkCmdCopyBufferToImage(commandBuffer, staging.buffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	tracker->transition(mImage, level, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	tracker->flush(commandBuffer);
+
+	ring->submit(commandBuffer);
+}
+
+bool VulkanImage2D::isFormatSupported(VkPhysicalDevice device, const ImageFormat format, const ImageDataType type)
+{
+	const VkFormat vulkanFormat = convertQgfxFormatToVulkan(format, type);
+	if (vulkanFormat == VK_FORMAT_UNDEFINED)
+	{
+		return false;
+	}
+
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(device, vulkanFormat, &properties);
+	return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 
 void* VulkanImage2D::getImageHandle() const
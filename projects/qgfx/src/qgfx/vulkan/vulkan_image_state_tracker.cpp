@@ -0,0 +1,211 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/qassert.h"
+
+static constexpr VkAccessFlags writeAccess = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+void VulkanImageStateTracker::addImage(VkImage image, const uint32_t mipLevels, const VkImageAspectFlags aspect, const VkImageLayout layout)
+{
+	QGFX_ASSERT_MSG(mImages.find(image) == mImages.end(), "Image is already tracked.\n");
+
+	TrackedImage& tracked = mImages[image];
+	tracked.aspect = aspect;
+	tracked.levels.assign(mipLevels, { layout, 0, 0, 0, 0, 0 });
+}
+
+void VulkanImageStateTracker::removeImage(VkImage image)
+{
+	mImages.erase(image);
+
+	for (size_t i = 0; i < mPending.size();)
+	{
+		if (mPending[i].image == image)
+		{
+			mPending.erase(mPending.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void VulkanImageStateTracker::aliasImage(VkImage previous, VkImage image)
+{
+	auto from = mImages.find(previous);
+	auto to = mImages.find(image);
+	QGFX_ASSERT_MSG(from != mImages.end() && to != mImages.end(), "Image is not tracked.\n");
+
+	// Everything the old image did counts as a write to the memory, and nothing of it is visible yet
+	VkAccessFlags access = 0;
+	VkPipelineStageFlags stage = 0;
+	for (const auto& level : from->second.levels)
+	{
+		access |= level.writeAccess;
+		stage |= level.writeStage | level.readStages;
+	}
+
+	for (auto& level : to->second.levels)
+	{
+		level.writeAccess = access;
+		level.writeStage = stage;
+		level.visibleAccess = 0;
+		level.visibleStages = 0;
+		level.readStages = 0;
+	}
+}
+
+void VulkanImageStateTracker::transition(VkImage image, const uint32_t baseMip, const uint32_t levelCount, const VkImageLayout layout,
+	const VkAccessFlags access, const VkPipelineStageFlags stage, const bool discard)
+{
+	auto it = mImages.find(image);
+	QGFX_ASSERT_MSG(it != mImages.end(), "Image is not tracked.\n");
+	QGFX_ASSERT_MSG(baseMip + levelCount <= it->second.levels.size(), "Mip range is outside of the mip chain.\n");
+
+	for (uint32_t level = baseMip; level < baseMip + levelCount; level++)
+	{
+		VulkanImageState& state = it->second.levels[level];
+		mStatistics.requested++;
+
+		VkImageMemoryBarrier* pending = nullptr;
+		for (auto& barrier : mPending)
+		{
+			if (barrier.image == image && barrier.subresourceRange.baseMipLevel == level)
+			{
+				pending = &barrier;
+				break;
+			}
+		}
+
+		const bool write = (access & writeAccess) != 0;
+		const bool layoutChange = state.layout != layout || discard;
+
+		// A read in the same layout needs nothing when the last write is already visible to it,
+		// or when nothing has written the subresource
+		const bool covered = (access & ~state.visibleAccess) == 0 && (stage & ~state.visibleStages) == 0;
+		const bool unwritten = state.writeAccess == 0 && state.writeStage == 0;
+		if (!layoutChange && !write && (covered || unwritten))
+		{
+			state.readStages |= stage;
+			mStatistics.skipped++;
+			continue;
+		}
+
+		// Reads in the same layout only wait on the last write, anything else also waits on the
+		// reads since then, which a write or a layout transition must not overtake
+		const VkPipelineStageFlags sourceStages = state.writeStage | (!layoutChange && !write ? 0 : state.readStages);
+
+		if (pending != nullptr)
+		{
+			// Nothing used the mip in between, so it can go straight to the new layout
+			pending->newLayout = layout;
+			pending->dstAccessMask |= access;
+		}
+		else
+		{
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+			barrier.newLayout = layout;
+
+			// Only writes have to be made available, earlier reads just need the execution dependency
+			barrier.srcAccessMask = state.writeAccess;
+			barrier.dstAccessMask = access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange.aspectMask = it->second.aspect;
+			barrier.subresourceRange.baseMipLevel = level;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+
+			mPending.push_back(barrier);
+			mPendingSourceStages |= sourceStages;
+		}
+
+		mPendingDestinationStages |= stage;
+
+		if (write)
+		{
+			state.writeAccess = access & writeAccess;
+			state.writeStage = stage;
+			state.visibleAccess = 0;
+			state.visibleStages = 0;
+			state.readStages = 0;
+		}
+		else if (layoutChange)
+		{
+			// The transition is a write that is visible to this read only.  Later barriers chain
+			// on its stage, the write before it has been made available by it.
+			state.writeAccess = 0;
+			state.writeStage = stage;
+			state.visibleAccess = access;
+			state.visibleStages = stage;
+			state.readStages = stage;
+		}
+		else
+		{
+			state.visibleAccess |= access;
+			state.visibleStages |= stage;
+			state.readStages |= stage;
+		}
+
+		state.layout = layout;
+	}
+}
+
+void VulkanImageStateTracker::flush(VkCommandBuffer commandBuffer)
+{
+	if (mPending.empty())
+	{
+		return;
+	}
+
+	// Neighbouring mips with the same transition share one barrier
+	std::vector<VkImageMemoryBarrier> barriers;
+	barriers.reserve(mPending.size());
+	for (const auto& barrier : mPending)
+	{
+		if (!barriers.empty())
+		{
+			VkImageMemoryBarrier& last = barriers.back();
+			if (last.image == barrier.image && last.oldLayout == barrier.oldLayout && last.newLayout == barrier.newLayout &&
+				last.srcAccessMask == barrier.srcAccessMask && last.dstAccessMask == barrier.dstAccessMask &&
+				last.subresourceRange.baseMipLevel + last.subresourceRange.levelCount == barrier.subresourceRange.baseMipLevel)
+			{
+				last.subresourceRange.levelCount++;
+				continue;
+			}
+		}
+
+		barriers.push_back(barrier);
+	}
+
+	// Subresources nothing has touched yet have no stage to wait on
+	const VkPipelineStageFlags sourceStages = mPendingSourceStages != 0 ? mPendingSourceStages :
+		static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+	vkCmdPipelineBarrier(commandBuffer, sourceStages, mPendingDestinationStages, 0, 0, nullptr, 0, nullptr,
+		static_cast<uint32_t>(barriers.size()), barriers.data());
+
+	mStatistics.imageBarriers += static_cast<uint32_t>(barriers.size());
+	mStatistics.pipelineBarriers++;
+
+	mPending.clear();
+	mPendingSourceStages = 0;
+	mPendingDestinationStages = 0;
+}
+
+const VulkanImageState& VulkanImageStateTracker::getState(VkImage image, const uint32_t level) const
+{
+	auto it = mImages.find(image);
+	QGFX_ASSERT_MSG(it != mImages.end(), "Image is not tracked.\n");
+	QGFX_ASSERT_MSG(level < it->second.levels.size(), "Mip level is outside of the mip chain.\n");
+
+	return it->second.levels[level];
+}
+
+#endif // QGFX_VULKAN
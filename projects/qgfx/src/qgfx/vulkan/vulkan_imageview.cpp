@@ -1,34 +1,73 @@
 #if defined(QGFX_VULKAN)
 
 #include "qgfx/vulkan/vulkan_imageview.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/render_pass_cache.h"
+#include "qgfx/qassert.h"
 
-constexpr VkImageAspectFlags convertQgfxImageTypeToVulkan(const ImageType type)
+static VkImageAspectFlags convertQgfxImageTypeToVulkan(const ImageType type)
 {
-    if(type & ImageType::Color)
-    {
-        
-    }
+	// Views used as attachments or for sampling only see depth of a depth/stencil image
+	if ((static_cast<uint32_t>(type) & static_cast<uint32_t>(ImageType::Depth)) != 0)
+	{
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	}
+
+	if ((static_cast<uint32_t>(type) & static_cast<uint32_t>(ImageType::Stencil)) != 0)
+	{
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+
+	return VK_IMAGE_ASPECT_COLOR_BIT;
 }
 
 VulkanImageView::VulkanImageView(ContextHandle* handle) : IImageView(handle)
 {
-	mImageView = nullptr;
+	mImageView = VK_NULL_HANDLE;
+	mImage = VK_NULL_HANDLE;
+	mLevels = 0;
 }
 
 VulkanImageView::~VulkanImageView()
 {
-    
+	if (mImageView != VK_NULL_HANDLE)
+	{
+		mHandle->getRenderPassCache()->evict(mImageView);
+		vkDestroyImageView(mHandle->getLogicalDevice(), mImageView, nullptr);
+	}
 }
 
 void VulkanImageView::construct(Image2D* image)
 {
+	QGFX_PROFILE_FUNCTION();
+
+	mImage = static_cast<VkImage>(image->getImageHandle());
+
+	// Vulkan has no per-image base level, sampling is clamped to the resident mips by the view.
+	// Views are not rebuilt when the resident mip moves, construct a new one to see finer mips.
+	const uint32_t baseLevel = image->getResidentMip();
+	mLevels = image->getMipLevels() - baseLevel;
+
 	VkImageViewCreateInfo viewInfo = {};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-	viewInfo.image = static_cast<VkImage>(image->getImageHandle());
+	viewInfo.image = mImage;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	viewInfo.format = convertQgfxFormatToVulkan(image->getImageFormat(), image->getImageDataType());
-	viewInfo.subresourceRange.aspectMask = image->getImageType();
+	viewInfo.format = image->getFormat();
+	viewInfo.subresourceRange.aspectMask = convertQgfxImageTypeToVulkan(image->getImageType());
+	viewInfo.subresourceRange.baseMipLevel = baseLevel;
+	viewInfo.subresourceRange.levelCount = mLevels;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	const VkResult result = vkCreateImageView(mHandle->getLogicalDevice(), &viewInfo, nullptr, &mImageView);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create image view!");
+}
+
+FrameBufferAttachment VulkanImageView::getAttachment() const
+{
+	QGFX_ASSERT_MSG(mLevels == 1, "Only views of single mip images can be framebuffer attachments.\n");
+	return { mImageView, mImage };
 }
 
-#endif // QGFX_VULKAN
\ No newline at end of file
+#endif // QGFX_VULKAN
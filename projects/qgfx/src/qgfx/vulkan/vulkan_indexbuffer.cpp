@@ -0,0 +1,62 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_indexbuffer.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/qassert.h"
+
+#include <cstring>
+
+#include "qgfx/vulkan/vulkan_memory.h"
+
+VulkanIndexBuffer::VulkanIndexBuffer(ContextHandle* handle) : IIndexBuffer(handle)
+{
+	mBuffer = VK_NULL_HANDLE;
+	mMemory = VK_NULL_HANDLE;
+}
+
+VulkanIndexBuffer::~VulkanIndexBuffer()
+{
+	vkDestroyBuffer(mHandle->getLogicalDevice(), mBuffer, nullptr);
+	vkFreeMemory(mHandle->getLogicalDevice(), mMemory, nullptr);
+}
+
+bool VulkanIndexBuffer::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mData != nullptr, "Index buffer has no data.\n");
+
+	const VkDeviceSize size = static_cast<VkDeviceSize>(getSize());
+	createBuffer(mHandle->getLogicalDevice(), mHandle->getPhysicalDevice(), size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mBuffer, mMemory);
+
+	void* data;
+	vkMapMemory(mHandle->getLogicalDevice(), mMemory, 0, size, 0, &data);
+	memcpy(data, mData, static_cast<size_t>(size));
+	vkUnmapMemory(mHandle->getLogicalDevice(), mMemory);
+	mHandle->countUpload(static_cast<size_t>(size));
+
+	_releaseData();
+	return mBuffer != VK_NULL_HANDLE;
+}
+
+void VulkanIndexBuffer::bind()
+{
+	// Index buffers are bound through VulkanCommandBuffer::bindIndexBuffer
+}
+
+void VulkanIndexBuffer::unbind()
+{
+}
+
+VkBuffer VulkanIndexBuffer::getBuffer() const
+{
+	return mBuffer;
+}
+
+VkIndexType VulkanIndexBuffer::getVulkanIndexType() const
+{
+	return mIndexType == IndexType::UInt16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+#endif // QGFX_VULKAN
@@ -1,7 +1,11 @@
 #if defined(QGFX_VULKAN)
 
 #include "qgfx/vulkan/vulkan_pipeline.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/qassert.h"
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/vulkan/vulkan_vertex_format.h"
+#include "qgfx/render_pass_cache.h"
 
 #include "qgfx/qgfx.h"
 
@@ -22,7 +26,34 @@ VulkanPipeline::VulkanPipeline(ContextHandle* handle) : IPipeline(handle)
 	mLayout = nullptr;
 	mPipeline = nullptr;
 	mRenderPass = nullptr;
-	mInputAssembly = {};
+	mPrimitiveRestart = false;
+	setTopology(Topology::TriangleList);
+}
+
+static bool isVertexFormatSupported(VkPhysicalDevice device, const VkFormat format)
+{
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(device, format, &properties);
+	return (properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0;
+}
+
+// Three component 8 and 16 bit formats are optional for vertex input and missing on many
+// desktop GPUs.  Those are fetched with the four component format instead when the extra
+// component still lies inside the vertex, the shader never reads it.
+static VkFormat getVertexFormat(VkPhysicalDevice device, const VertexBufferLayout& layout, const VertexBufferLayoutElement& element)
+{
+	const VkFormat format = qgfxVertexAttribToVulkan(element.type, element.count, element.normalized);
+	if (isVertexFormatSupported(device, format))
+	{
+		return format;
+	}
+
+	const VkFormat padded = qgfxVertexAttribToVulkan(element.type, 4, element.normalized);
+	const bool canPad = element.count == 3 && element.offset + getVertexAttribSize(element.type, 4) <= layout.getStride() &&
+		isVertexFormatSupported(device, padded);
+	QGFX_ASSERT_MSG(canPad, "Vertex attribute %s has a format the device can not fetch, pad it to four components.\n", element.name.c_str());
+
+	return canPad ? padded : format;
 }
 
 VulkanPipeline::~VulkanPipeline()
@@ -34,19 +65,47 @@ VulkanPipeline::~VulkanPipeline()
 
 	vkDestroyPipeline(mHandle->getLogicalDevice(), mPipeline, nullptr);
 	vkDestroyPipelineLayout(mHandle->getLogicalDevice(), mLayout, nullptr);
-	vkDestroyRenderPass(mHandle->getLogicalDevice(), mRenderPass, nullptr);
 }
 
 void VulkanPipeline::construct()
 {
+	QGFX_PROFILE_FUNCTION();
+
+	qtl::vector<VkVertexInputBindingDescription> bindings;
+	qtl::vector<VkVertexInputAttributeDescription> attributes;
+	uint32_t location = 0;
+
+	for (const auto& layout : mVertexLayouts)
+	{
+		VkVertexInputBindingDescription binding = {};
+		binding.binding = layout.getBinding();
+		binding.stride = static_cast<uint32_t>(layout.getStride());
+		binding.inputRate = layout.getInputRate() == VertexInputRate::Instance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX;
+		bindings.push_back(binding);
+
+		// Divisors other than one need VK_EXT_vertex_attribute_divisor, which is not enabled.
+		QGFX_ASSERT_MSG(layout.getDivisor() <= 1, "Vulkan backend only supports an instance divisor of one.\n");
+
+		for (const auto& element : layout.getLayout())
+		{
+			VkVertexInputAttributeDescription attribute = {};
+			attribute.binding = layout.getBinding();
+			attribute.location = location++;
+			attribute.format = getVertexFormat(mHandle->getPhysicalDevice(), layout, element);
+			attribute.offset = static_cast<uint32_t>(element.offset);
+			attributes.push_back(attribute);
+		}
+	}
+
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 0;
-	vertexInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexInputInfo.vertexAttributeDescriptionCount = 0;
-	vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+	vertexInputInfo.pVertexBindingDescriptions = bindings.empty() ? nullptr : bindings.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+	vertexInputInfo.pVertexAttributeDescriptions = attributes.empty() ? nullptr : attributes.data();
 
-	setTopology(Topology::TriangleList);
+	QGFX_ASSERT_MSG(!mPrimitiveRestart || mInputAssembly.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+		"Primitive restart requires a strip topology.\n");
 
 	VkViewport viewport = {};
 	viewport.x = 0.0f;
@@ -67,31 +126,51 @@ void VulkanPipeline::construct()
 	viewportState.scissorCount = 1;
 	viewportState.pScissors = &scissor;
 
+	if (mRenderPass == nullptr)
+	{
+		RenderPassAttachment swapChain;
+		swapChain.swapChain = true;
+
+		RenderPassDescription description;
+		description.addColorAttachment(swapChain);
+		mRenderPass = mHandle->getRenderPassCache()->acquire(description);
+	}
+
+	// Rasterization has to match the sample count of the attachments it renders to
+	const uint32_t samples = mRenderPass->getDescription().samples;
+	QGFX_ASSERT_MSG(samples <= mHandle->getMaxSampleCount() && (samples & (samples - 1)) == 0, "Unsupported sample count %u.\n", samples);
+
 	VkPipelineMultisampleStateCreateInfo multiSampling = {};
 	multiSampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 	multiSampling.sampleShadingEnable = VK_FALSE;
-	multiSampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multiSampling.rasterizationSamples = static_cast<VkSampleCountFlagBits>(samples);
 	multiSampling.minSampleShading = 1.0f;
 	multiSampling.pSampleMask = nullptr;
 	multiSampling.alphaToCoverageEnable = VK_FALSE;
 	multiSampling.alphaToOneEnable = VK_FALSE;
 
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_TRUE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	// Every color attachment of the render pass needs a blend state
+	qtl::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	for (uint32_t i = 0; i < mRenderPass->getDescription().colorAttachmentCount; i++)
+	{
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+		colorBlendAttachment.colorWriteMask = mHandle->getRasterizer()->getColorWriteMask();
+		colorBlendAttachment.blendEnable = VK_TRUE;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachments.push_back(colorBlendAttachment);
+	}
 
 	VkPipelineColorBlendStateCreateInfo colorBlending = {};
 	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	colorBlending.logicOpEnable = VK_FALSE;
 	colorBlending.logicOp = VK_LOGIC_OP_COPY;
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
+	colorBlending.attachmentCount = static_cast<uint32_t>(colorBlendAttachments.size());
+	colorBlending.pAttachments = colorBlendAttachments.empty() ? nullptr : colorBlendAttachments.data();
 	colorBlending.blendConstants[0] = 0.0f;
 	colorBlending.blendConstants[1] = 0.0f;
 	colorBlending.blendConstants[2] = 0.0f;
@@ -109,35 +188,6 @@ void VulkanPipeline::construct()
 	VkResult result = vkCreatePipelineLayout(mHandle->getLogicalDevice(), &pipelineLayoutInfo, nullptr, &mLayout);
 	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create pipeline layout");
 
-	VkAttachmentDescription colorAttachment = {};
-	colorAttachment.format = mHandle->getSwapChainFormat();
-	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-	VkAttachmentReference colorAttachmentRef = {};
-	colorAttachmentRef.attachment = 0;
-	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription subpass = {};
-	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpass.colorAttachmentCount = 1;
-	subpass.pColorAttachments = &colorAttachmentRef;
-
-	VkRenderPassCreateInfo renderPassInfo = {};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassInfo.attachmentCount = 1;
-	renderPassInfo.pAttachments = &colorAttachment;
-	renderPassInfo.subpassCount = 1;
-	renderPassInfo.pSubpasses = &subpass;
-
-	result = vkCreateRenderPass(mHandle->getLogicalDevice(), &renderPassInfo, nullptr, &mRenderPass);
-	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create render pass");
-
 	uint32_t stageCount = 0;
 	qtl::vector<VkPipelineShaderStageCreateInfo> stages;
 
@@ -160,10 +210,11 @@ void VulkanPipeline::construct()
 	pipelineInfo.pInputAssemblyState = &mInputAssembly;
 	pipelineInfo.pViewportState = &viewportState;
 	pipelineInfo.pRasterizationState = &mHandle->getRasterizer()->getStateInfo();
+	pipelineInfo.pDepthStencilState = mRenderPass->getDescription().hasDepthAttachment ? &mHandle->getRasterizer()->getDepthStencilStateInfo() : nullptr;
 	pipelineInfo.pMultisampleState = &multiSampling;
 	pipelineInfo.pColorBlendState = &colorBlending;
 	pipelineInfo.layout = mLayout;
-	pipelineInfo.renderPass = mRenderPass;
+	pipelineInfo.renderPass = mRenderPass->getRenderPass();
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
@@ -176,7 +227,13 @@ void VulkanPipeline::setTopology(const Topology& topology)
 	mInputAssembly = {};
 	mInputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 	mInputAssembly.topology = qgfxTopologyToVulkan(topology);
-	mInputAssembly.primitiveRestartEnable = VK_FALSE;
+	mInputAssembly.primitiveRestartEnable = mPrimitiveRestart ? VK_TRUE : VK_FALSE;
+}
+
+void VulkanPipeline::setPrimitiveRestart(const bool enabled)
+{
+	mPrimitiveRestart = enabled;
+	mInputAssembly.primitiveRestartEnable = enabled ? VK_TRUE : VK_FALSE;
 }
 
 Shader* VulkanPipeline::addShader()
@@ -187,7 +244,13 @@ Shader* VulkanPipeline::addShader()
 	return shader;
 }
 
-VkRenderPass VulkanPipeline::getRenderPass() const
+void VulkanPipeline::setRenderPass(RenderPass* renderPass)
+{
+	QGFX_ASSERT_MSG(mPipeline == nullptr, "Pipeline is already constructed.\n");
+	mRenderPass = renderPass;
+}
+
+RenderPass* VulkanPipeline::getRenderPass() const
 {
 	return mRenderPass;
 }
@@ -34,6 +34,52 @@ VkPolygonMode qgfxPolygonModeToVulkan(const PolygonMode mode)
 	}
 }
 
+VkCompareOp qgfxCompareOpToVulkan(const CompareOp op)
+{
+	switch (op)
+	{
+		case CompareOp::Never: return VK_COMPARE_OP_NEVER;
+		case CompareOp::Less: return VK_COMPARE_OP_LESS;
+		case CompareOp::Equal: return VK_COMPARE_OP_EQUAL;
+		case CompareOp::LessOrEqual: return VK_COMPARE_OP_LESS_OR_EQUAL;
+		case CompareOp::Greater: return VK_COMPARE_OP_GREATER;
+		case CompareOp::NotEqual: return VK_COMPARE_OP_NOT_EQUAL;
+		case CompareOp::GreaterOrEqual: return VK_COMPARE_OP_GREATER_OR_EQUAL;
+		case CompareOp::Always: return VK_COMPARE_OP_ALWAYS;
+		default: return static_cast<VkCompareOp>(-1);
+	}
+}
+
+VkStencilOp qgfxStencilOpToVulkan(const StencilOp op)
+{
+	switch (op)
+	{
+		case StencilOp::Keep: return VK_STENCIL_OP_KEEP;
+		case StencilOp::Zero: return VK_STENCIL_OP_ZERO;
+		case StencilOp::Replace: return VK_STENCIL_OP_REPLACE;
+		case StencilOp::IncrementClamp: return VK_STENCIL_OP_INCREMENT_AND_CLAMP;
+		case StencilOp::DecrementClamp: return VK_STENCIL_OP_DECREMENT_AND_CLAMP;
+		case StencilOp::Invert: return VK_STENCIL_OP_INVERT;
+		case StencilOp::IncrementWrap: return VK_STENCIL_OP_INCREMENT_AND_WRAP;
+		case StencilOp::DecrementWrap: return VK_STENCIL_OP_DECREMENT_AND_WRAP;
+		default: return static_cast<VkStencilOp>(-1);
+	}
+}
+
+static VkStencilOpState qgfxStencilStateToVulkan(const StencilState& state)
+{
+	VkStencilOpState result = {};
+	result.failOp = qgfxStencilOpToVulkan(state.failOp);
+	result.passOp = qgfxStencilOpToVulkan(state.passOp);
+	result.depthFailOp = qgfxStencilOpToVulkan(state.depthFailOp);
+	result.compareOp = qgfxCompareOpToVulkan(state.compareOp);
+	result.compareMask = state.compareMask;
+	result.writeMask = state.writeMask;
+	result.reference = state.reference;
+
+	return result;
+}
+
 VulkanRasterizer::VulkanRasterizer(ContextHandle* handle) : IRasterizer(handle)
 {
 	mRasterizer = {};
@@ -50,6 +96,13 @@ VulkanRasterizer::VulkanRasterizer(ContextHandle* handle) : IRasterizer(handle)
 	mRasterizer.depthBiasConstantFactor = 0.0f;
 	mRasterizer.depthBiasClamp = 0.0f;
 	mRasterizer.depthBiasSlopeFactor = 0.0f;
+
+	mDepthStencil = {};
+	mDepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	mDepthStencil.depthBoundsTestEnable = VK_FALSE;
+	mDepthStencil.minDepthBounds = 0.0f;
+	mDepthStencil.maxDepthBounds = 1.0f;
+	_updateDepthStencil();
 }
 
 VulkanRasterizer::~VulkanRasterizer()
@@ -79,12 +132,65 @@ void VulkanRasterizer::setLineWidth(const float lineWidth)
 
 void VulkanRasterizer::setDepthTest(const bool enabled)
 {
+	mDepthTest = enabled;
+	_updateDepthStencil();
+}
 
+void VulkanRasterizer::setDepthWrite(const bool enabled)
+{
+	mDepthWrite = enabled;
+	_updateDepthStencil();
+}
+
+void VulkanRasterizer::setDepthCompare(const CompareOp op)
+{
+	mDepthCompare = op;
+	_updateDepthStencil();
 }
 
-VkPipelineRasterizationStateCreateInfo VulkanRasterizer::getStateInfo() const
+void VulkanRasterizer::setStencilTest(const bool enabled, const StencilState& front, const StencilState& back)
+{
+	mStencilTest = enabled;
+	mStencilFront = front;
+	mStencilBack = back;
+	_updateDepthStencil();
+}
+
+void VulkanRasterizer::setColorWrite(const bool enabled)
+{
+	mColorWrite = enabled;
+}
+
+void VulkanRasterizer::setReverseZ(const bool enabled)
+{
+	mReverseZ = enabled;
+	_updateDepthStencil();
+}
+
+const VkPipelineRasterizationStateCreateInfo& VulkanRasterizer::getStateInfo() const
 {
 	return mRasterizer;
 }
 
+const VkPipelineDepthStencilStateCreateInfo& VulkanRasterizer::getDepthStencilStateInfo() const
+{
+	return mDepthStencil;
+}
+
+VkColorComponentFlags VulkanRasterizer::getColorWriteMask() const
+{
+	return mColorWrite ? VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT : 0;
+}
+
+void VulkanRasterizer::_updateDepthStencil()
+{
+	// Vulkan's depth range is already [0, 1], so reverse-Z only needs the compare flipped
+	mDepthStencil.depthTestEnable = mDepthTest ? VK_TRUE : VK_FALSE;
+	mDepthStencil.depthWriteEnable = mDepthWrite ? VK_TRUE : VK_FALSE;
+	mDepthStencil.depthCompareOp = qgfxCompareOpToVulkan(_getDeviceDepthCompare());
+	mDepthStencil.stencilTestEnable = mStencilTest ? VK_TRUE : VK_FALSE;
+	mDepthStencil.front = qgfxStencilStateToVulkan(mStencilFront);
+	mDepthStencil.back = qgfxStencilStateToVulkan(mStencilBack);
+}
+
 #endif // QGFX_VULKAN
@@ -0,0 +1,267 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_readback_queue.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/vulkan/queue_family.h"
+#include "qgfx/vulkan/vulkan_context_handle.h"
+#include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/vulkan/vulkan_image_state_tracker.h"
+#include "qgfx/qassert.h"
+#include "qgfx/vulkan/vulkan_memory.h"
+
+#include <limits>
+
+VulkanReadbackQueue::VulkanReadbackQueue(ContextHandle* handle, const uint32_t slotCount)
+	: IReadbackQueue(handle, slotCount), mCommandPool(VK_NULL_HANDLE)
+{
+}
+
+VulkanReadbackQueue::~VulkanReadbackQueue()
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	for (auto& buffer : mBuffers)
+	{
+		if (buffer.fence != VK_NULL_HANDLE)
+		{
+			vkWaitForFences(device, 1, &buffer.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			vkDestroyFence(device, buffer.fence, nullptr);
+		}
+		_destroyBuffer(buffer);
+	}
+	mBuffers.clear();
+
+	if (mCommandPool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(device, mCommandPool, nullptr);
+		mCommandPool = VK_NULL_HANDLE;
+	}
+}
+
+void VulkanReadbackQueue::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mCommandPool == VK_NULL_HANDLE, "Readback queue already constructed.\n");
+
+	const VkDevice device = mHandle->getLogicalDevice();
+	QueueFamilyIndices indices = findQueueFamilies(mHandle->getPhysicalDevice(), mHandle->getSurface());
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = indices.graphicsFamily.value();
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &mCommandPool);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create readback command pool!");
+
+	qtl::vector<VkCommandBuffer> commandBuffers;
+	commandBuffers.resize(mSlots.size());
+
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = mCommandPool;
+	allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+	result = vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data());
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate readback command buffers!");
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	mBuffers.resize(mSlots.size());
+	for (size_t i = 0; i < mBuffers.size(); i++)
+	{
+		mBuffers[i] = { VK_NULL_HANDLE, VK_NULL_HANDLE, 0, nullptr, commandBuffers[i], VK_NULL_HANDLE };
+
+		result = vkCreateFence(device, &fenceInfo, nullptr, &mBuffers[i].fence);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create readback fence!");
+	}
+}
+
+void VulkanReadbackQueue::_reserve(const uint32_t slot, const size_t size)
+{
+	Buffer& buffer = mBuffers[slot];
+	if (buffer.capacity >= size)
+	{
+		return;
+	}
+
+	_destroyBuffer(buffer);
+
+	const VkDevice device = mHandle->getLogicalDevice();
+	const VkPhysicalDevice gpu = mHandle->getPhysicalDevice();
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkResult result = vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.buffer);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create readback buffer!");
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(device, buffer.buffer, &requirements);
+
+	// Uncached host memory is write combined, the CPU reads it an order of magnitude slower
+	const VkMemoryPropertyFlags visible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	const VkMemoryPropertyFlags cached = visible | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = requirements.size;
+	allocInfo.memoryTypeIndex = findMemoryType(gpu, requirements.memoryTypeBits,
+		hasMemoryType(gpu, requirements.memoryTypeBits, cached) ? cached : visible);
+
+	result = vkAllocateMemory(device, &allocInfo, nullptr, &buffer.memory);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate readback memory!");
+
+	vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0);
+
+	void* mapped = nullptr;
+	vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+	buffer.mapped = static_cast<const uint8_t*>(mapped);
+	buffer.capacity = size;
+}
+
+bool VulkanReadbackQueue::_copyBackBuffer(const uint32_t slot)
+{
+	QGFX_ASSERT_MSG(mHandle->isHeadless(), "Only headless contexts can read back, swap chain images are not copy sources.\n");
+
+	const VkImage image = mHandle->getCurrentSwapChainImage();
+	VkCommandBuffer commandBuffer = _begin(slot);
+
+	// Offscreen images end their render passes in TRANSFER_SRC_OPTIMAL, the barrier only orders
+	// the copy after the frame, which was submitted to the same queue
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { mSlots[slot].width, mSlots[slot].height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mBuffers[slot].buffer, 1, &region);
+
+	_submit(slot);
+
+	return false;
+}
+
+void VulkanReadbackQueue::_copyImage(const uint32_t slot, Image2D* image)
+{
+	const VkImage handle = static_cast<VkImage>(image->getImageHandle());
+	VkCommandBuffer commandBuffer = _begin(slot);
+
+	// The tracker waits on whatever wrote the image last, so readbacks must be requested after
+	// the commands rendering it were submitted
+	VulkanImageStateTracker* tracker = mHandle->getImageStateTracker();
+	tracker->transition(handle, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	tracker->flush(commandBuffer);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { mSlots[slot].width, mSlots[slot].height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mBuffers[slot].buffer, 1, &region);
+
+	_submit(slot);
+}
+
+bool VulkanReadbackQueue::_isComplete(const uint32_t slot)
+{
+	return vkGetFenceStatus(mHandle->getLogicalDevice(), mBuffers[slot].fence) == VK_SUCCESS;
+}
+
+void VulkanReadbackQueue::_wait(const uint32_t slot)
+{
+	vkWaitForFences(mHandle->getLogicalDevice(), 1, &mBuffers[slot].fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+}
+
+const uint8_t* VulkanReadbackQueue::_getData(const uint32_t slot)
+{
+	// Host cached memory is usually not coherent
+	VkMappedMemoryRange range = {};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = mBuffers[slot].memory;
+	range.size = VK_WHOLE_SIZE;
+	vkInvalidateMappedMemoryRanges(mHandle->getLogicalDevice(), 1, &range);
+
+	return mBuffers[slot].mapped;
+}
+
+void VulkanReadbackQueue::_destroyBuffer(Buffer& buffer)
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	if (buffer.buffer != VK_NULL_HANDLE)
+	{
+		vkUnmapMemory(device, buffer.memory);
+		vkDestroyBuffer(device, buffer.buffer, nullptr);
+		vkFreeMemory(device, buffer.memory, nullptr);
+	}
+
+	buffer.buffer = VK_NULL_HANDLE;
+	buffer.memory = VK_NULL_HANDLE;
+	buffer.mapped = nullptr;
+	buffer.capacity = 0;
+}
+
+VkCommandBuffer VulkanReadbackQueue::_begin(const uint32_t slot)
+{
+	// _reserve has already waited for the slot's previous copy, so its command buffer is free
+	VkCommandBuffer commandBuffer = mBuffers[slot].commandBuffer;
+	vkResetCommandBuffer(commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	return commandBuffer;
+}
+
+void VulkanReadbackQueue::_submit(const uint32_t slot)
+{
+	Buffer& buffer = mBuffers[slot];
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer.buffer;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(buffer.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &barrier, 0, nullptr);
+
+	vkEndCommandBuffer(buffer.commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &buffer.commandBuffer;
+
+	vkResetFences(mHandle->getLogicalDevice(), 1, &buffer.fence);
+
+	const VkResult result = vkQueueSubmit(mHandle->getGraphicsQueue(), 1, &submitInfo, buffer.fence);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to submit readback!");
+}
+
+#endif // QGFX_VULKAN
@@ -0,0 +1,160 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_renderpass.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/vulkan/vulkan_image2d.h"
+#include "qgfx/qassert.h"
+
+static VkAttachmentLoadOp convertQgfxLoadOpToVulkan(const AttachmentLoadOp op)
+{
+	switch (op)
+	{
+		case AttachmentLoadOp::Load: return VK_ATTACHMENT_LOAD_OP_LOAD;
+		case AttachmentLoadOp::Clear: return VK_ATTACHMENT_LOAD_OP_CLEAR;
+		default: return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	}
+}
+
+static VkAttachmentStoreOp convertQgfxStoreOpToVulkan(const AttachmentStoreOp op)
+{
+	return op == AttachmentStoreOp::Store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+VulkanRenderPass::VulkanRenderPass(ContextHandle* handle)
+	: IRenderPass(handle), mRenderPass(VK_NULL_HANDLE)
+{
+}
+
+VulkanRenderPass::~VulkanRenderPass()
+{
+	if (mRenderPass != VK_NULL_HANDLE)
+	{
+		vkDestroyRenderPass(mHandle->getLogicalDevice(), mRenderPass, nullptr);
+	}
+}
+
+VkImageLayout VulkanRenderPass::getAttachmentLayout(const RenderPassAttachment& attachment)
+{
+	return hasDepthAspect(attachment.imageType) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+}
+
+void VulkanRenderPass::construct(const RenderPassDescription& description)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(description.resolveAttachmentCount == 0 || description.samples > 1, "Resolve attachments need a multisampled render pass.\n");
+
+	mDescription = description;
+
+	qtl::vector<VkAttachmentDescription> attachments;
+	qtl::vector<VkAttachmentReference> colorReferences;
+	qtl::vector<VkAttachmentReference> resolveReferences;
+	VkAttachmentReference depthReference = {};
+
+	auto addAttachment = [&](const RenderPassAttachment& attachment, const uint32_t samples, const bool resolve)
+	{
+		const VkImageLayout layout = getAttachmentLayout(attachment);
+		QGFX_ASSERT_MSG(samples == 1 || !attachment.swapChain, "Swap chain images are single sampled, resolve into them instead.\n");
+
+		// The resolve overwrites every pixel, so whatever the target held before is never read
+		VkAttachmentDescription info = {};
+		info.samples = static_cast<VkSampleCountFlagBits>(samples);
+		info.loadOp = resolve ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : convertQgfxLoadOpToVulkan(attachment.loadOp);
+		info.storeOp = convertQgfxStoreOpToVulkan(attachment.storeOp);
+		info.stencilLoadOp = hasStencilAspect(attachment.imageType) ? convertQgfxLoadOpToVulkan(attachment.stencilLoadOp) : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		info.stencilStoreOp = hasStencilAspect(attachment.imageType) ? convertQgfxStoreOpToVulkan(attachment.stencilStoreOp) : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+		if (attachment.swapChain)
+		{
+			info.format = mHandle->getSwapChainFormat();
+			info.initialLayout = attachment.loadOp == AttachmentLoadOp::Load && !resolve ? mHandle->getSwapChainLayout() : VK_IMAGE_LAYOUT_UNDEFINED;
+			info.finalLayout = mHandle->getSwapChainLayout();
+		}
+		else
+		{
+			if (hasDepthAspect(attachment.imageType))
+			{
+				info.format = getVulkanDepthFormat(attachment.imageType);
+			}
+			else
+			{
+				info.format = convertQgfxFormatToVulkan(attachment.format, attachment.type);
+			}
+			info.initialLayout = layout;
+			info.finalLayout = layout;
+		}
+		QGFX_ASSERT_MSG(info.format != VK_FORMAT_UNDEFINED, "Render pass attachment has no Vulkan format.\n");
+
+		attachments.push_back(info);
+		return VkAttachmentReference{ static_cast<uint32_t>(attachments.size() - 1), layout };
+	};
+
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		colorReferences.push_back(addAttachment(description.colorAttachments[i], description.samples, false));
+	}
+
+	if (description.hasDepthAttachment)
+	{
+		depthReference = addAttachment(description.depthAttachment, description.samples, false);
+	}
+
+	// Unresolved color attachments still need an entry, resolve references line up with the color ones
+	if (description.resolveAttachmentCount > 0)
+	{
+		for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+		{
+			if (description.hasResolveAttachment[i])
+			{
+				resolveReferences.push_back(addAttachment(description.resolveAttachments[i], 1, true));
+			}
+			else
+			{
+				resolveReferences.push_back({ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+			}
+		}
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+	subpass.pColorAttachments = colorReferences.empty() ? nullptr : colorReferences.data();
+	subpass.pResolveAttachments = resolveReferences.empty() ? nullptr : resolveReferences.data();
+	subpass.pDepthStencilAttachment = description.hasDepthAttachment ? &depthReference : nullptr;
+
+	bool swapChain = false;
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		swapChain |= description.colorAttachments[i].swapChain;
+	}
+
+	for (uint32_t i = 0; i < description.colorAttachmentCount; i++)
+	{
+		swapChain |= description.hasResolveAttachment[i] && description.resolveAttachments[i].swapChain;
+	}
+
+	// Swap chain images are written again while the previous use may still be reading them.  The
+	// acquire semaphore is waited on at the color output stage, and the offscreen images of headless
+	// contexts may still be copied from by a readback of an earlier frame.
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | (mHandle->isHeadless() ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0);
+	dependency.srcAccessMask = 0;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = swapChain ? 1 : 0;
+	renderPassInfo.pDependencies = swapChain ? &dependency : nullptr;
+
+	[[maybe_unused]] const VkResult result = vkCreateRenderPass(mHandle->getLogicalDevice(), &renderPassInfo, nullptr, &mRenderPass);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create render pass");
+}
+
+#endif // QGFX_VULKAN
@@ -1,5 +1,6 @@
 #if defined(QGFX_VULKAN)
 #include "qgfx/qassert.h"
+#include "qgfx/cpu_profiler.h"
 
 #include "qgfx/vulkan/vulkan_shader.h"
 
@@ -84,6 +85,8 @@ bool VulkanShader::attachTesselationEvaluationShader(const qtl::vector<char>& so
 
 bool VulkanShader::compile()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
 	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
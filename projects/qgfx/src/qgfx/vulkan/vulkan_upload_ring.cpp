@@ -0,0 +1,270 @@
+#if defined(QGFX_VULKAN)
+
+#include "qgfx/vulkan/vulkan_upload_ring.h"
+#include "qgfx/cpu_profiler.h"
+#include "qgfx/vulkan/queue_family.h"
+#include "qgfx/vulkan/vulkan_context_handle.h"
+#include "qgfx/qassert.h"
+#include "qgfx/vulkan/vulkan_memory.h"
+
+#include <limits>
+
+static VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+VulkanUploadRing::VulkanUploadRing(VulkanContextHandle* handle, const VkDeviceSize size)
+	: mHandle(handle), mSize(size), mBuffer(VK_NULL_HANDLE), mMemory(VK_NULL_HANDLE), mMapped(nullptr),
+	mHead(0), mTail(0), mRingSubmissions(0), mCommandPool(VK_NULL_HANDLE), mRecording(), mStatistics()
+{
+}
+
+VulkanUploadRing::~VulkanUploadRing()
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	wait();
+
+	for (auto fence : mFreeFences)
+	{
+		vkDestroyFence(device, fence, nullptr);
+	}
+	mFreeFences.clear();
+
+	if (mCommandPool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(device, mCommandPool, nullptr);
+		mCommandPool = VK_NULL_HANDLE;
+	}
+
+	if (mBuffer != VK_NULL_HANDLE)
+	{
+		vkUnmapMemory(device, mMemory);
+		vkDestroyBuffer(device, mBuffer, nullptr);
+		vkFreeMemory(device, mMemory, nullptr);
+	}
+}
+
+void VulkanUploadRing::construct()
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mCommandPool == VK_NULL_HANDLE, "Upload ring already constructed.\n");
+
+	const VkDevice device = mHandle->getLogicalDevice();
+	QueueFamilyIndices indices = findQueueFamilies(mHandle->getPhysicalDevice(), mHandle->getSurface());
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = indices.graphicsFamily.value();
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	[[maybe_unused]] const VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &mCommandPool);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create upload command pool!");
+
+	createBuffer(device, mHandle->getPhysicalDevice(), mSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mBuffer, mMemory);
+
+	void* mapped = nullptr;
+	vkMapMemory(device, mMemory, 0, mSize, 0, &mapped);
+	mMapped = static_cast<uint8_t*>(mapped);
+}
+
+VkCommandBuffer VulkanUploadRing::begin(const VkDeviceSize size, const VkDeviceSize alignment, VulkanStagingAllocation& allocation)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(mCommandPool != VK_NULL_HANDLE, "Upload ring has not been constructed.\n");
+	QGFX_ASSERT_MSG(mRecording.commandBuffer == VK_NULL_HANDLE, "Previous upload has not been submitted.\n");
+	QGFX_ASSERT_MSG(alignment > 0, "Alignment has to be at least one byte.\n");
+
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	retire();
+
+	mRecording = {};
+	if (size <= mSize)
+	{
+		VkDeviceSize offset = 0;
+		while (!_allocate(size, alignment, offset))
+		{
+			// Only submissions that hold ring memory can free it
+			QGFX_ASSERT_MSG(mRingSubmissions > 0, "Upload ring is empty but can not fit the upload.\n");
+
+			const Submission& oldest = mSubmissions[0];
+			vkWaitForFences(device, 1, &oldest.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			mStatistics.fenceWaits++;
+			retire();
+		}
+
+		mRecording.end = mHead;
+		allocation = { mBuffer, offset, mMapped + offset };
+	}
+	else
+	{
+		createBuffer(device, mHandle->getPhysicalDevice(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mRecording.dedicatedBuffer, mRecording.dedicatedMemory);
+
+		void* mapped = nullptr;
+		vkMapMemory(device, mRecording.dedicatedMemory, 0, size, 0, &mapped);
+		allocation = { mRecording.dedicatedBuffer, 0, static_cast<uint8_t*>(mapped) };
+		mStatistics.dedicatedBuffers++;
+	}
+
+	if (mFreeCommandBuffers.empty())
+	{
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = mCommandPool;
+		allocInfo.commandBufferCount = 1;
+
+		[[maybe_unused]] const VkResult result = vkAllocateCommandBuffers(device, &allocInfo, &mRecording.commandBuffer);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to allocate upload command buffer!");
+	}
+	else
+	{
+		// qtl::vector can not shrink through resize, take the oldest one from the front instead
+		mRecording.commandBuffer = mFreeCommandBuffers[0];
+		mFreeCommandBuffers.erase(mFreeCommandBuffers.begin());
+	}
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(mRecording.commandBuffer, &beginInfo);
+
+	return mRecording.commandBuffer;
+}
+
+void VulkanUploadRing::submit(VkCommandBuffer commandBuffer)
+{
+	QGFX_PROFILE_FUNCTION();
+
+	QGFX_ASSERT_MSG(commandBuffer == mRecording.commandBuffer, "Command buffer was not begun by this upload ring.\n");
+
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	vkEndCommandBuffer(commandBuffer);
+
+	if (mFreeFences.empty())
+	{
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		[[maybe_unused]] const VkResult result = vkCreateFence(device, &fenceInfo, nullptr, &mRecording.fence);
+		QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to create upload fence!");
+	}
+	else
+	{
+		mRecording.fence = mFreeFences[0];
+		mFreeFences.erase(mFreeFences.begin());
+	}
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	[[maybe_unused]] const VkResult result = vkQueueSubmit(mHandle->getGraphicsQueue(), 1, &submitInfo, mRecording.fence);
+	QGFX_ASSERT_MSG(result == VK_SUCCESS, "Failed to submit upload!");
+
+	if (mRecording.dedicatedBuffer == VK_NULL_HANDLE)
+	{
+		mRingSubmissions++;
+	}
+
+	mSubmissions.push_back(mRecording);
+	mRecording = {};
+	mStatistics.submissions++;
+}
+
+void VulkanUploadRing::retire()
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	// Submissions finish in order, the first one that is still running holds back the rest
+	while (!mSubmissions.empty() && vkGetFenceStatus(device, mSubmissions[0].fence) == VK_SUCCESS)
+	{
+		_release(mSubmissions[0]);
+		mSubmissions.erase(mSubmissions.begin());
+	}
+}
+
+void VulkanUploadRing::wait()
+{
+	if (mSubmissions.empty())
+	{
+		return;
+	}
+
+	const Submission& newest = mSubmissions.back();
+	vkWaitForFences(mHandle->getLogicalDevice(), 1, &newest.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	retire();
+}
+
+bool VulkanUploadRing::_allocate(const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize& offset)
+{
+	if (mRingSubmissions == 0)
+	{
+		mHead = 0;
+		mTail = 0;
+	}
+
+	const VkDeviceSize start = alignUp(mHead, alignment);
+	if (mHead >= mTail)
+	{
+		if (start + size <= mSize)
+		{
+			offset = start;
+			mHead = start + size;
+			return true;
+		}
+
+		// Wrapping may not close the gap to the tail, a full ring would look empty
+		if (size < mTail)
+		{
+			offset = 0;
+			mHead = size;
+			return true;
+		}
+
+		return false;
+	}
+
+	if (start + size < mTail)
+	{
+		offset = start;
+		mHead = start + size;
+		return true;
+	}
+
+	return false;
+}
+
+void VulkanUploadRing::_release(const Submission& submission)
+{
+	const VkDevice device = mHandle->getLogicalDevice();
+
+	if (submission.dedicatedBuffer != VK_NULL_HANDLE)
+	{
+		vkUnmapMemory(device, submission.dedicatedMemory);
+		vkDestroyBuffer(device, submission.dedicatedBuffer, nullptr);
+		vkFreeMemory(device, submission.dedicatedMemory, nullptr);
+	}
+	else
+	{
+		mTail = submission.end;
+		mRingSubmissions--;
+	}
+
+	vkResetFences(device, 1, &submission.fence);
+	mFreeFences.push_back(submission.fence);
+
+	vkResetCommandBuffer(submission.commandBuffer, 0);
+	mFreeCommandBuffers.push_back(submission.commandBuffer);
+}
+
+#endif // QGFX_VULKAN
@@ -1,6 +1,7 @@
 #if defined(QGFX_VULKAN)
 
 #include "qgfx/vulkan/vulkan_vertexbuffer.h"
+#include "qgfx/cpu_profiler.h"
 
 #include <array>
 #include "qgfx/qassert.h"
@@ -12,7 +13,6 @@ VulkanVertexBuffer::VulkanVertexBuffer(ContextHandle* handle) : IVertexBuffer(ha
 {
 	mBuffer = VK_NULL_HANDLE;
 	mMemory = VK_NULL_HANDLE;
-	mBindingDescription = {};
 	mSize = 0;
 	mData = nullptr;
 }
@@ -25,32 +25,29 @@ VulkanVertexBuffer::~VulkanVertexBuffer()
 
 void VulkanVertexBuffer::setData(void* data, const size_t size)
 {
+	QGFX_PROFILE_FUNCTION();
+
+	mSize = size;
+	mData = data;
+}
+
+void VulkanVertexBuffer::setExternalData(const void* data, const size_t size)
+{
+	// Vulkan buffers never copy, the data is read in construct()
 	mSize = size;
 	mData = data;
 }
 
 void VulkanVertexBuffer::setLayout(const VertexBufferLayout& layout)
 {
+	// The pipeline builds the binding and attribute descriptions from its vertex layouts
 	mLayout = layout;
-
-	mBindingDescription.binding = 0;
-	mBindingDescription.stride = static_cast<uint32_t>(layout.getStride());
-	mBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-	for(size_t i = 0; i < layout.getLayout().size(); i++)
-	{
-		VkVertexInputAttributeDescription desc = {};
-		desc.binding = 0;
-		desc.location = static_cast<uint32_t>(i);
-		desc.format = static_cast<VkFormat>(layout.getLayout()[i].type);
-		desc.offset = static_cast<uint32_t>(layout.getLayout()[i].offset);
-
-		mAttributeDescriptions.push_back(desc);
-	}
 }
 
 bool VulkanVertexBuffer::construct()
 {
+	QGFX_PROFILE_FUNCTION();
+
 	VkBufferCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	createInfo.size = mSize;
@@ -79,6 +76,7 @@ bool VulkanVertexBuffer::construct()
 	vkMapMemory(mHandle->getLogicalDevice(), mMemory, 0, createInfo.size, 0, &data);
 	memcpy(data, mData, static_cast<size_t>(createInfo.size));
 	vkUnmapMemory(mHandle->getLogicalDevice(), mMemory);
+	mHandle->countUpload(static_cast<size_t>(createInfo.size));
 
 	return result == VK_SUCCESS;
 }
@@ -98,4 +96,9 @@ void VulkanVertexBuffer::unbind()
 	// TODO (Roderick): unbind from pipeline list
 }
 
+VkBuffer VulkanVertexBuffer::getBuffer() const
+{
+	return mBuffer;
+}
+
 #endif // QGFX_VULKAN
\ No newline at end of file
@@ -1,25 +1,43 @@
 #if defined(QGFX_VULKAN)
 #include "qgfx/qassert.h"
+#include "qgfx/cpu_profiler.h"
 #include "qgfx/vulkan/vulkan_window.h"
 
 VulkanWindow::VulkanWindow()
 {
 	mWindow = nullptr;
+	mWidth = 0;
+	mHeight = 0;
+	mHeadless = false;
 }
 
 VulkanWindow::~VulkanWindow()
 {
-	glfwDestroyWindow(mWindow);
-	glfwTerminate();
+	if (mWindow)
+	{
+		glfwDestroyWindow(mWindow);
+		glfwTerminate();
+	}
 }
 
 void VulkanWindow::construct(const WindowCreationParameters& params)
 {
+	if (params.headless)
+	{
+		// Vulkan renders offscreen without a surface, so GLFW is never initialized
+		mWidth = params.width;
+		mHeight = params.height;
+		mHeadless = true;
+		return;
+	}
+
 	construct(params.width, params.height, params.title, params.fullscreen, params.vsync);
 }
 
 void VulkanWindow::construct(const uint32_t width, const uint32_t height, const qtl::string& title, const bool fullscreen, const bool vsync)
 {
+	QGFX_PROFILE_FUNCTION();
+
 	if (!glfwInit())
 	{
 		QGFX_ASSERT_MSG(false, "Failed to initialize GLFW!");
@@ -36,6 +54,10 @@ void VulkanWindow::construct(const uint32_t width, const uint32_t height, const
 		glfwTerminate();
 		return;
 	}
+
+	mWidth = width;
+	mHeight = height;
+	mHeadless = false;
 }
 
 void* VulkanWindow::getPlatformHandle() const
@@ -45,12 +67,32 @@ void* VulkanWindow::getPlatformHandle() const
 
 bool VulkanWindow::shouldClose() const
 {
-	return glfwWindowShouldClose(mWindow);
+	return !mHeadless && glfwWindowShouldClose(mWindow);
 }
 
 void VulkanWindow::poll() const
 {
-	glfwPollEvents();
+	QGFX_PROFILE_FUNCTION();
+
+	if (!mHeadless)
+	{
+		glfwPollEvents();
+	}
+}
+
+uint32_t VulkanWindow::getWidth() const
+{
+	return mWidth;
+}
+
+uint32_t VulkanWindow::getHeight() const
+{
+	return mHeight;
+}
+
+bool VulkanWindow::isHeadless() const
+{
+	return mHeadless;
 }
 
 #endif // QGFX_VULKAN